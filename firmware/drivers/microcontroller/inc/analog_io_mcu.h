@@ -13,6 +13,67 @@
  * 
  * @note The ESP-EDU have 4 analog inputs and 1 analog output, but the designated pin for 
  * the latter is shared with analog output 0 (CH0).
+ * 
+ * @note Continuous mode scans every started channel in hardware sequence (CH0 to CH3 order), 
+ * and stores the samples of each channel in its own ring buffer of ADC_RING_SIZE samples.
+ * Samples are stored frame by frame (one sample per scanned channel), so the buffers 
+ * are always aligned and can be read as multi-channel frames.
+ * Single and continuous modes can not be used simultaneously (both use ADC unit 1).
+ * 
+ * @note Timed mode works like continuous mode, but each frame is read with single (one-shot) 
+ * convertions from a timer_mcu alarm interrupt, at sample_frec. It is meant for low sample rates 
+ * (below the 611 Hz minimum of continuous mode) without waking a task for each sample: 
+ * the callback is called once every block_size frames, so the consumer can drain them in blocks.
+ * Single reads, continuous mode and timed mode can not be used simultaneously.
+ * 
+ * @note Continuous mode can oversample the scanned channels by 4^n and decimate them (integrate 
+ * and dump), giving 12 + n bits samples at sample_frec / 4^n (up to 16 bits, n = 4).
+ * 
+ * @note Continuous and timed mode samples can be read in blocks with a header (analog_block_t) 
+ * holding the time of the first sample, a sequence number, the sample rate and the number of 
+ * samples dropped (because the buffers were full) right before the block. Blocks never span a 
+ * gap, so the time of every sample is timestamp + i / sample_frec.
+ * 
+ * @note Channels in continuous mode can be watched by the ADC digital monitor (up to 2 channels). 
+ * The hardware compares every convertion against a high and a low threshold, and the driver calls 
+ * the callback only on crossings (above high threshold, then below low threshold: hysteresis), 
+ * so alarm inputs need no polling and respond within a few convertions. Only the threshold that 
+ * ends the current state interrupts, so a monitor costs one interrupt per crossing.
+ * 
+ * @note A scanned channel can be captured like an oscilloscope does (triggered capture): its samples 
+ * go through a circular pre-trigger buffer until a trigger condition (level crossing on a rising 
+ * and/or falling edge, with hysteresis and holdoff) is met, then a fixed number of post-trigger 
+ * samples is stored and the consumer is called. Only the captured windows are handed to the 
+ * consumer: the channel is not stored in its ring buffer while the trigger is set.
+ * 
+ * @note The analog output can play sample buffers from a timer_mcu alarm interrupt (DAC_TIMER), at up 
+ * to DAC_PLAY_MAX_RATE samples per second, with no task involvement. Long signals are streamed with 
+ * two buffers: one is played while the next one waits in the queue, and the callback asks for a new 
+ * one every time a buffer is finished. When the output runs out of samples (underrun) it holds the 
+ * last value, and the missed samples are counted. Samples can also be computed in the interrupt 
+ * by a generator function (e.g. DdsNext() from dds.h). The 16 bits variants (AnalogOutputPlay16(), 
+ * AnalogOutputQueue16(), AnalogOutputGenerate16()) use the full resolution of the PWM output.
+ * 
+ * @note The analog output uses the sigma-delta modulator by default (8 bits, AnalogOutputInit()). 
+ * AnalogOutputInitPWM() switches it to a LEDC PWM output (DAC_PWM_OUT, at 80 MHz / 2^bits) with up to 
+ * 14 bits. The resolution is chosen so the PWM ripple left by the low pass (RC) filter of the given 
+ * order, with its cutoff at the signal bandwidth, is below 1 LSB: (bandwidth / f_pwm)^order <= 2^-bits.
+ * Maximum bandwidth (Hz) for each resolution:
+ * 
+ * | Bits | PWM frequency | 1st order filter | 2nd order filter | 3rd order filter |
+ * |:----:|:-------------:|:----------------:|:----------------:|:----------------:|
+ * | 14   | 4883 Hz       | 0.3              | 38               | 192              |
+ * | 13   | 9766 Hz       | 1.2              | 108              | 484              |
+ * | 12   | 19531 Hz      | 4.8              | 305              | 1221             |
+ * | 11   | 39063 Hz      | 19               | 863              | 3076             |
+ * | 10   | 78125 Hz      | 76               | 2441             | 7751             |
+ * | 9    | 156250 Hz     | 305              | 6905             | 19531            |
+ * | 8    | 312500 Hz     | 1221             | 19531            | 49216            |
+ * | 7    | 625000 Hz     | 4883             | 55243            | 124016           |
+ * | 6    | 1250000 Hz    | 19531            | 156250           | 312500           |
+ * 
+ * @note Raw to mV convertion uses a 4096 entries table, built from the IDF curve fitting 
+ * calibration scheme on the first analog input initialization and on every attenuation change.
  *
  * @author Albano Peñalva
  *
@@ -21,11 +82,26 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 24/02/2024 | Document creation		                         						|
+ * | 01/07/2024 | Continuous multi-channel scan with per-channel ring buffers			|
+ * | 02/07/2024 | Calibration lookup table and batch raw to mV convertion				|
+ * | 03/07/2024 | Oversampling and decimation for continuous mode						|
+ * | 04/07/2024 | Timer paced (ISR) sampling mode										|
+ * | 05/07/2024 | Timestamped sample blocks with dropped samples accounting				|
+ * | 08/07/2024 | Threshold monitor with hysteresis (ADC digital monitor)				|
+ * | 09/07/2024 | Timer driven DAC playback and double buffered streaming				|
+ * | 10/07/2024 | DAC sample generator callback (DDS)									|
+ * | 11/07/2024 | LEDC PWM DAC backend (up to 14 bits) and 16 bits writes				|
+ * | 17/07/2024 | Triggered capture with pre and post-trigger samples					|
+ * | 28/07/2024 | 16 bits DAC playback, streaming and generators						|
+ * | 28/07/2024 | Reads of channels not stored by the scan return 0 samples				|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include "stdbool.h"
+#include "timer_mcu.h"
+#include "pwm_mcu.h"
 /*==================[macros]=================================================*/
 typedef enum adc_ch {
 	CH0 = 0,				/*!< Channel 0 */
@@ -37,9 +113,32 @@ typedef enum adc_ch {
 typedef enum adc_mode {
 	ADC_SINGLE,				/*!< Single read */
 	ADC_CONTINUOUS,			/*!< Continuous read */
+	ADC_TIMED,				/*!< Timer paced single reads, stored like continuous mode */
 } adc_mode_t;
 
+typedef enum analog_trigger_slope {
+	ANALOG_TRIGGER_RISING = 1,	/*!< Trigger when the input rises to the level */
+	ANALOG_TRIGGER_FALLING,		/*!< Trigger when the input falls to the level */
+	ANALOG_TRIGGER_BOTH,		/*!< Trigger on both edges */
+} analog_trigger_slope_t;
+
+typedef enum analog_atten {
+	ANALOG_ATTEN_0DB = 0,	/*!< 0 dB attenuation (0 - 0,75 V aprox.) */
+	ANALOG_ATTEN_2_5DB,		/*!< 2,5 dB attenuation (0 - 1,05 V aprox.) */
+	ANALOG_ATTEN_6DB,		/*!< 6 dB attenuation (0 - 1,3 V aprox.) */
+	ANALOG_ATTEN_12DB,		/*!< 12 dB attenuation (0 - 3,3 V aprox.), default */
+} analog_atten_t;
+
 #define DAC	0    			/*!< DAC pin. Override CH0 declaration*/
+
+#define ADC_CHANNELS	4		/*!< Number of analog inputs */
+#define ADC_RING_SIZE	1024	/*!< Samples stored per channel in continuous mode (power of 2) */
+#define ADC_OVERSAMPLING_MAX 4	/*!< Maximum oversampling exponent (4^4 = 256 samples, 16 bits) */
+#define ADC_MONITORS	2		/*!< Number of ADC digital monitors (channels that can be watched) */
+#define DAC_TIMER		TIMER_C	/*!< Timer used to pace DAC playback */
+#define DAC_PLAY_MAX_RATE 50000	/*!< Maximum DAC playback rate (samples per second) */
+#define DAC_PWM_OUT		PWM_3	/*!< PWM output used by the PWM DAC backend */
+#define DAC_PWM_MIN_BITS 6		/*!< Minimum resolution of the PWM DAC backend */
 /*==================[typedef]================================================*/
 /**
  * @brief Analog inputs config structure
@@ -48,11 +147,81 @@ typedef enum adc_mode {
 typedef struct {			
 	adc_ch_t input;			/*!< Inputs: CH0, CH1, CH2, CH3 */
 	adc_mode_t mode;		/*!< Mode: single read or continuous read */
-	void *func_p;			/*!< Pointer to callback function for convertion end (only for continuous mode) */
-	void *param_p;			/*!< Pointer to callback function parameters (only for continuous mode) */
-	uint16_t sample_frec;	/*!< Sample frequency min: 20kHz - max: 2MHz (only for continuous mode)  */
+	void *func_p;			/*!< Pointer to callback function for convertion end (only for continuous and timed modes, called from ISR) */
+	void *param_p;			/*!< Pointer to callback function parameters (only for continuous and timed modes) */
+	uint32_t sample_frec;	/*!< Sample frequency per channel, in Hz (only for continuous and timed modes). Shared by all scanned channels. 
+								 Continuous: (sample_frec * scanned channels) must be between 611 Hz and 83333 Hz. 
+								 Timed: the first timed channel initialized sets the timer period */
+	uint8_t oversampling;	/*!< Oversampling exponent n: 4^n samples are summed and decimated to one (12 + n) bits sample 
+								 (0: disabled, max: ADC_OVERSAMPLING_MAX, only for continuous and timed modes). Shared by all scanned channels */
+	bool dither;			/*!< Add pseudo-random dither before truncating the decimated sum, instead of rounding (only with oversampling) */
+	uint16_t block_size;	/*!< Frames stored between callback calls (0: call on every DMA frame or timer alarm). Shared by all scanned channels */
+	timer_mcu_t timer;		/*!< Timer used to pace convertions (only for timed mode) */
 } analog_input_config_t;	
 
+/**
+ * @brief Analog input threshold monitor config structure
+ */
+typedef struct {
+	adc_ch_t input;				/*!< Input to watch: CH0, CH1, CH2, CH3 (initialized in continuous mode) */
+	uint16_t high_threshold;	/*!< Voltage (mV) above which the input is considered high */
+	uint16_t low_threshold;		/*!< Voltage (mV) below which the input is considered low again (hysteresis, <= high_threshold) */
+	void *func_p;				/*!< Pointer to callback function for threshold crossing, called from ISR: void func(void *param, bool above) */
+	void *param_p;				/*!< Pointer to callback function parameters */
+} analog_monitor_config_t;
+
+/**
+ * @brief Triggered capture config structure
+ */
+typedef struct {
+	adc_ch_t input;					/*!< Input to capture: CH0, CH1, CH2, CH3 (initialized in continuous or timed mode) */
+	uint16_t level;					/*!< Trigger level (mV) */
+	uint16_t hysteresis;			/*!< The input must go this far (mV) below the level before a rising edge (above it before a falling edge) */
+	analog_trigger_slope_t slope;	/*!< Edge that triggers the capture */
+	uint32_t holdoff;				/*!< Samples after (re)arming during which triggers are ignored */
+	uint16_t pre_trigger;			/*!< Samples kept before the trigger sample */
+	uint16_t post_trigger;			/*!< Samples stored from the trigger sample on (at least 1) */
+	uint16_t *buffer;				/*!< Capture storage, pre_trigger + post_trigger samples */
+	bool single;					/*!< Single capture: wait for AnalogTriggerArm() after reading it (otherwise it is armed again when read) */
+	void *func_p;					/*!< Pointer to callback function for capture complete, called from ISR: void func(void *param) */
+	void *param_p;					/*!< Pointer to callback function parameters */
+} analog_trigger_config_t;
+
+/**
+ * @brief Triggered capture header
+ */
+typedef struct {
+	int64_t timestamp;		/*!< Time of the trigger sample, in us since boot (esp_timer time base) */
+	uint32_t index;			/*!< Index of the trigger sample since scan start, counting dropped samples */
+	uint32_t sequence;		/*!< Capture number, since trigger configuration */
+	uint32_t sample_frec;	/*!< Sample rate of the capture, in Hz (after oversampling decimation) */
+	uint16_t trigger;		/*!< Position of the trigger sample in the capture (pre-trigger samples) */
+	uint16_t len;			/*!< Number of samples in the capture */
+	bool rising;			/*!< Edge of the trigger: rising (true) or falling (false) */
+} analog_capture_t;
+
+/**
+ * @brief Sample block header (continuous and timed modes)
+ */
+typedef struct {
+	int64_t timestamp;		/*!< Time of the first sample, in us since boot (esp_timer time base) */
+	uint32_t sequence;		/*!< Block sequence number, since scan start */
+	uint32_t index;			/*!< Index of the first sample since scan start, counting dropped samples */
+	uint32_t sample_frec;	/*!< Sample rate of the block, in Hz (after oversampling decimation) */
+	uint32_t dropped;		/*!< Samples dropped right before the first sample of the block */
+	uint16_t len;			/*!< Number of samples (or frames) in the block */
+} analog_block_t;
+
+/**
+ * @brief Analog output playback counters (since last playback start)
+ */
+typedef struct {
+	uint32_t samples;			/*!< Samples written to the output */
+	uint32_t buffers;			/*!< Buffers played to the end (each loop counts as one) */
+	uint32_t underruns;			/*!< Times a streamed buffer ended with no other buffer queued */
+	uint32_t underrun_samples;	/*!< Sample periods with no sample to write (last value held) */
+} analog_output_stats_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -71,6 +240,19 @@ void AnalogInputInit(analog_input_config_t *config);
  */
 void AnalogOutputInit(void);
 
+/**
+ * @brief Analog output initialization (DAC) on a LEDC PWM output, with the highest resolution 
+ * that keeps the filtered PWM ripple below 1 LSB for the given bandwidth (see table above).
+ * 
+ * @note The DAC pin needs an external low pass filter with its cutoff at bandwidth. 
+ * Replaces the sigma-delta output (AnalogOutputInit() switches back). Stops any playback.
+ * 
+ * @param bandwidth Signal bandwidth (Hz), also the filter cutoff frequency
+ * @param filter_order Order of the low pass filter (1: RC, 2: RC-RC, ...)
+ * @return uint8_t Resolution (bits) selected, 0 on error
+ */
+uint8_t AnalogOutputInitPWM(uint32_t bandwidth, uint8_t filter_order);
+
 /**
  * @brief Read single channel.
  * 
@@ -81,26 +263,173 @@ void AnalogOutputInit(void);
 void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value);
 
 /**
- * @brief Start convertion for ADC module in continuous mode
+ * @brief Add a channel to the continuous (or timed) mode scan and start convertion
+ * 
+ * @note The channel must have been initialized in ADC_CONTINUOUS or ADC_TIMED mode. If the scan was
+ * already running, it is restarted including the new channel, and all channel buffers are emptied.
  * 
  * @param channel Channel selected
  */
 void AnalogStartContinuous(adc_ch_t channel);
 
 /**
- * @brief Stop convertion for ADC module
+ * @brief Remove a channel from the continuous (or timed) mode scan
+ * 
+ * @note Convertion stops when no channel is left in the scan. If other channels 
+ * remain, the scan is restarted and all channel buffers are emptied.
  * 
  * @param channel Channel selected
  */
 void AnalogStopContinuous(adc_ch_t channel);
 
 /**
- * @brief 
+ * @brief Read samples from a single channel buffer (continuous and timed modes)
+ * 
+ * @note Reading channels one at a time breaks the alignment between them, 
+ * use AnalogInputReadFrames() to keep scanned channels in sync.
  * 
  * @param channel Channel selected.
  * @param values Read variable array
+ * @param nvalues Maximum number of samples to read
+ * @return uint16_t Number of samples read (0 if the channel is not stored by the current scan)
+ */
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values, uint16_t nvalues);
+
+/**
+ * @brief Read aligned multi-channel frames (continuous and timed modes)
+ * 
+ * @note Each frame has one sample per scanned channel, in scan order (ascending channel number).
+ * 
+ * @param frames Read variable array (must hold nframes * scanned channels samples)
+ * @param nframes Maximum number of frames to read
+ * @return uint16_t Number of frames read
  */
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+uint16_t AnalogInputReadFrames(uint16_t *frames, uint16_t nframes);
+
+/**
+ * @brief Read a block of samples from a single channel buffer, with its header (continuous and timed modes)
+ * 
+ * @note The block is shorter than nvalues if a gap (dropped samples) is found.
+ * 
+ * @param channel Channel selected.
+ * @param block Block header
+ * @param values Read variable array
+ * @param nvalues Maximum number of samples to read
+ * @return uint16_t Number of samples read (0 if the channel is not stored by the current scan)
+ */
+uint16_t AnalogInputReadBlock(adc_ch_t channel, analog_block_t *block, uint16_t *values, uint16_t nvalues);
+
+/**
+ * @brief Read a block of aligned multi-channel frames, with its header (continuous and timed modes)
+ * 
+ * @note The block is shorter than nframes if a gap (dropped frames) is found.
+ * 
+ * @param block Block header
+ * @param frames Read variable array (must hold nframes * scanned channels samples)
+ * @param nframes Maximum number of frames to read
+ * @return uint16_t Number of frames read
+ */
+uint16_t AnalogInputReadFramesBlock(analog_block_t *block, uint16_t *frames, uint16_t nframes);
+
+/**
+ * @brief Total number of frames dropped since scan start, because buffers were full
+ * 
+ * @return uint32_t Dropped frames
+ */
+uint32_t AnalogInputGetDropped(void);
+
+/**
+ * @brief Get the channels included in the continuous mode scan
+ * 
+ * @note A channel captured by a trigger is scanned but not stored in the buffers, so it is 
+ * not included (the frames read by AnalogInputReadFrames() have these channels only).
+ * 
+ * @param channels Array where scanned channels will be stored, in scan order (can be NULL)
+ * @return uint8_t Number of scanned channels
+ */
+uint8_t AnalogGetScanChannels(adc_ch_t *channels);
+
+/**
+ * @brief Start watching an analog input against a high and a low threshold (ADC digital monitor).
+ * 
+ * @note The channel must be initialized in ADC_CONTINUOUS mode, and it is only watched while
+ * it is being scanned. If the scan is running it is restarted (buffers are emptied).
+ * Thresholds are not updated by AnalogSetAttenuation().
+ * 
+ * @param config Monitor config structure
+ * @return true if the monitor was created, false otherwise (no free monitor or invalid config)
+ */
+bool AnalogMonitorInit(analog_monitor_config_t *config);
+
+/**
+ * @brief Stop watching an analog input
+ * 
+ * @param channel Channel selected
+ */
+void AnalogMonitorDeinit(adc_ch_t channel);
+
+/**
+ * @brief Current monitor state of an analog input
+ * 
+ * @param channel Channel selected
+ * @return true if last crossing was above the high threshold, false otherwise
+ */
+bool AnalogMonitorIsAbove(adc_ch_t channel);
+
+/**
+ * @brief Start a triggered capture on an analog input (continuous or timed mode).
+ * 
+ * @note The trigger sample is the first one to reach the level on the selected edge, once the 
+ * pre-trigger buffer is full and the holdoff is over. Samples are compared at the resolution they 
+ * are stored with (12 + oversampling bits), so call it after AnalogInputInit(). While the trigger is set, 
+ * the channel is not stored in its ring buffer (AnalogInputRead*() functions do not return its samples). 
+ * The scan is restarted (buffers are emptied) if it was running, and every scan restart discards 
+ * the capture in progress. Thresholds are not updated by AnalogSetAttenuation().
+ * 
+ * @param config Trigger config structure
+ * @return true if the trigger was set, false otherwise (invalid config)
+ */
+bool AnalogTriggerInit(analog_trigger_config_t *config);
+
+/**
+ * @brief Stop the triggered capture. The channel is stored in its buffer again (the scan is restarted).
+ */
+void AnalogTriggerDeinit(void);
+
+/**
+ * @brief Discard any capture and wait for a new trigger (needed after reading a single capture)
+ */
+void AnalogTriggerArm(void);
+
+/**
+ * @brief Triggered capture state
+ * 
+ * @return true if a complete capture is waiting to be read, false otherwise
+ */
+bool AnalogTriggerIsReady(void);
+
+/**
+ * @brief Read a complete capture, oldest sample first, and arm the trigger again (unless single).
+ * 
+ * @note The trigger sample is at position capture->trigger (the pre-trigger length).
+ * 
+ * @param capture Capture header (can be NULL)
+ * @param values Read variable array (pre_trigger + post_trigger samples)
+ * @param nvalues Maximum number of samples to read (the rest of the capture is discarded)
+ * @return uint16_t Number of samples read, 0 if there is no complete capture
+ */
+uint16_t AnalogTriggerRead(analog_capture_t *capture, uint16_t *values, uint16_t nvalues);
+
+/**
+ * @brief Change input attenuation (input range) of all analog inputs.
+ * 
+ * @note Rebuilds the calibration table, so it takes a few milliseconds. 
+ * Continuous mode scan is restarted if it was running.
+ * 
+ * @param atten Attenuation
+ * @return true if applied, false if atten is not a valid attenuation (nothing is changed)
+ */
+bool AnalogSetAttenuation(analog_atten_t atten);
 
 /**
  * @brief Convert raw value from ADC to mV, using a calibration curve.
@@ -110,6 +439,26 @@ void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
  */
 uint16_t AnalogRaw2mV(uint16_t value);
 
+/**
+ * @brief Convert a block of raw values from ADC to mV, using a calibration curve.
+ * 
+ * @note Conversion can be done in place (raw == mv).
+ * 
+ * @param raw Raw values from ADC.
+ * @param mv Array where calibrated values (in mV) will be stored.
+ * @param n Number of values to convert.
+ */
+void AnalogRaw2mVBatch(const uint16_t *raw, uint16_t *mv, uint32_t n);
+
+/**
+ * @brief Convert an oversampled value from ADC to uV, interpolating the calibration curve.
+ * 
+ * @param value Oversampled value from ADC ((12 + oversampling) bits).
+ * @param oversampling Oversampling exponent used to acquire the value.
+ * @return uint32_t Calibrated value from ADC in uV.
+ */
+uint32_t AnalogOversampled2uV(uint16_t value, uint8_t oversampling);
+
 /**
  * @brief Digital-to-Analog convert.
  * 
@@ -117,6 +466,124 @@ uint16_t AnalogRaw2mV(uint16_t value);
  */
 void AnalogOutputWrite(uint8_t value);
 
+/**
+ * @brief Digital-to-Analog convert, with the full resolution of the output.
+ * 
+ * @param value Digital value to convert (from 0 to 65535), truncated to the output 
+ * resolution (8 bits for sigma-delta, the selected one for PWM)
+ */
+void AnalogOutputWrite16(uint16_t value);
+
+/**
+ * @brief Analog output resolution
+ * 
+ * @return uint8_t Resolution (bits), 0 if not initialized
+ */
+uint8_t AnalogOutputGetResolution(void);
+
+/**
+ * @brief Play a sample buffer on the analog output, from the DAC_TIMER interrupt.
+ * 
+ * @note Any playback in progress is stopped. If loop is false, playback stops at the end of the 
+ * buffer, unless another buffer was queued with AnalogOutputQueue(). The buffer must remain valid 
+ * while it is being played. AnalogOutputWrite() should not be used during playback.
+ * 
+ * @param buffer Samples (from 0 to 255)
+ * @param len Number of samples
+ * @param rate Samples per second (up to DAC_PLAY_MAX_RATE, rounded to a whole number of us per sample)
+ * @param loop Repeat the buffer until AnalogOutputStop() is called
+ * @return true if playback started, false otherwise (output not initialized or invalid parameters)
+ */
+bool AnalogOutputPlay(const uint8_t *buffer, uint32_t len, uint32_t rate, bool loop);
+
+/**
+ * @brief Play a buffer of 16 bits samples on the analog output (see AnalogOutputPlay()), with the 
+ * full resolution of the output.
+ * 
+ * @param buffer Samples (from 0 to 65535), truncated to the output resolution
+ * @param len Number of samples
+ * @param rate Samples per second (up to DAC_PLAY_MAX_RATE)
+ * @param loop Repeat the buffer until AnalogOutputStop() is called
+ * @return true if playback started, false otherwise
+ */
+bool AnalogOutputPlay16(const uint16_t *buffer, uint32_t len, uint32_t rate, bool loop);
+
+/**
+ * @brief Start streaming buffers to the analog output, from the DAC_TIMER interrupt.
+ * 
+ * @note Buffers are supplied with AnalogOutputQueue(): the first one should be queued before 
+ * calling this function. The callback is called every time the queued buffer starts being 
+ * played, so the next one can be queued. Periods with no buffer to play are counted as underruns.
+ * 
+ * @param rate Samples per second (up to DAC_PLAY_MAX_RATE)
+ * @param func_p Pointer to callback function, called from ISR when the queue gets empty: void func(void *param)
+ * @param param_p Pointer to callback function parameters
+ * @return true if streaming started, false otherwise
+ */
+bool AnalogOutputStream(uint32_t rate, void *func_p, void *param_p);
+
+/**
+ * @brief Write samples computed by a generator function to the analog output, from the DAC_TIMER interrupt.
+ * 
+ * @note Any playback in progress is stopped. The generator must be fast: it is called 
+ * for every sample, from ISR (e.g. DdsNext(), with a dds_t as parameter).
+ * 
+ * @param rate Samples per second (up to DAC_PLAY_MAX_RATE)
+ * @param func_p Pointer to generator function, called from ISR: uint8_t func(void *param), returns the sample (0 to 255)
+ * @param param_p Pointer to generator function parameters
+ * @return true if generation started, false otherwise
+ */
+bool AnalogOutputGenerate(uint32_t rate, void *func_p, void *param_p);
+
+/**
+ * @brief Write samples computed by a 16 bits generator function to the analog output (see 
+ * AnalogOutputGenerate()), with the full resolution of the output.
+ * 
+ * @param rate Samples per second (up to DAC_PLAY_MAX_RATE)
+ * @param func_p Pointer to generator function, called from ISR: uint16_t func(void *param), returns the sample 
+ * (0 to 65535, truncated to the output resolution), e.g. DdsNext16()
+ * @param param_p Pointer to generator function parameters
+ * @return true if generation started, false otherwise
+ */
+bool AnalogOutputGenerate16(uint32_t rate, void *func_p, void *param_p);
+
+/**
+ * @brief Queue the next buffer to be played (double buffering).
+ * 
+ * @param buffer Samples (from 0 to 255), must remain valid until it is played
+ * @param len Number of samples
+ * @return true if queued, false if another buffer is already waiting
+ */
+bool AnalogOutputQueue(const uint8_t *buffer, uint32_t len);
+
+/**
+ * @brief Queue the next buffer of 16 bits samples to be played (8 and 16 bits buffers can be mixed).
+ * 
+ * @param buffer Samples (from 0 to 65535), must remain valid until it is played
+ * @param len Number of samples
+ * @return true if queued, false if another buffer is already waiting
+ */
+bool AnalogOutputQueue16(const uint16_t *buffer, uint32_t len);
+
+/**
+ * @brief Stop playback or streaming. The output keeps its last value.
+ */
+void AnalogOutputStop(void);
+
+/**
+ * @brief Playback state
+ * 
+ * @return true if a buffer is being played or streamed, false otherwise
+ */
+bool AnalogOutputIsPlaying(void);
+
+/**
+ * @brief Get playback counters
+ * 
+ * @param stats Counters since the last playback start
+ */
+void AnalogOutputGetStats(analog_output_stats_t *stats);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
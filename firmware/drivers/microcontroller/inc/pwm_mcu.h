@@ -14,6 +14,11 @@
  * @note It can setup up to 4 PWM outputs, with independet duty 
  * cycle and frequency configuration
  *
+ * @note All outputs run from the 80 MHz LEDC clock (the LEDC timers share their clock source). 
+ * Outputs initialized with PWMInitResolution() run at 80 MHz / 2^bits, so they can be used as a 
+ * DAC (after a low pass filter) with up to PWM_MAX_BITS bits of resolution. PWMInit() uses 10 bits, 
+ * or more below 77 Hz, where the clock divider would be out of range.
+ *
  * @author Albano Peñalva
  * 
  * @section changelog
@@ -21,6 +26,8 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 23/01/2024 | Document creation		                         |
+ * | 11/07/2024 | Duty resolution selection and raw duty writes   |
+ * | 28/07/2024 | Single LEDC clock source for every output       |
  *
  */
 
@@ -28,6 +35,8 @@
 #include <stdint.h>
 #include <gpio_mcu.h>
 /*==================[macros]=================================================*/
+#define PWM_CLK_HZ		80000000	/**< LEDC clock (PLL / 6) */
+#define PWM_MAX_BITS	14			/**< Maximum duty resolution for PWMInitResolution() */
 
 /*==================[typedef]================================================*/
 typedef enum pwm_out {
@@ -52,6 +61,19 @@ typedef enum pwm_out {
  */
 uint8_t PWMInit(pwm_out_t out, gpio_t gpio, uint16_t freq);
 
+/**
+ * @brief Single PWM output inicialization with a given duty resolution, at the highest 
+ * frequency it allows (PWM_CLK_HZ / 2^bits)
+ * 
+ * @note When initialized PWM output start On with duty cycle 0%.
+ * 
+ * @param out PWM output
+ * @param gpio GPIO pin number
+ * @param bits Duty resolution (1 to PWM_MAX_BITS)
+ * @return uint32_t PWM frequency (Hz), 0 if resolution is not valid
+ */
+uint32_t PWMInitResolution(pwm_out_t out, gpio_t gpio, uint8_t bits);
+
 /**
  * @brief Resume PWM output
  * 
@@ -74,6 +96,17 @@ void PWMOff(pwm_out_t out);
  */
 void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle);
 
+/**
+ * @brief Change PWM duty of an PWM output, in counts of its duty resolution
+ * 
+ * @note It writes the LEDC registers directly (no locks, placed in IRAM), so it can be called 
+ * from ISRs. The new duty starts with the next PWM period.
+ * 
+ * @param out PWM output 
+ * @param duty duty in counts (0 to 2^bits, 2^bits = 100%)
+ */
+void PWMSetDuty(pwm_out_t out, uint32_t duty);
+
 /**
  * @brief Change frequency of an PWM output
  * 
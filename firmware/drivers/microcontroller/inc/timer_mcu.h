@@ -17,6 +17,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 09/07/2024 | Period update on running timers										|
  * 
  **/
 
@@ -68,6 +69,14 @@ void TimerStart(timer_mcu_t timer);
  */
 void TimerStop(timer_mcu_t timer);
 
+/**
+ * @brief Change timer period
+ * @note Can be called while the timer is running, the new period applies from the next alarm
+ * @param timer Timer number
+ * @param period New period (in us)
+ */
+void TimerUpdatePeriod(timer_mcu_t timer, uint32_t period);
+
 /**
  * @brief Reset timer count to 0
  * 
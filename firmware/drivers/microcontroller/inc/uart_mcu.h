@@ -9,6 +9,40 @@
  ** @{ */
 
 /** \brief UART driver for the ESP-EDU Board.
+ * 
+ * @note Transmission is buffered: data is copied to a transmit ring buffer (tx_buffer_size, 2048 bytes 
+ * by default) and the UART TX FIFO empty interrupt moves it to the FIFO in batches, so the caller 
+ * does not wait for the line. Writes come in three flavours, all returning the number of bytes 
+ * accepted: blocking (waits for room for every byte), non-blocking (takes only what fits now) and 
+ * with a timeout. UartSendString(), UartSendBuffer() and UartSendByte() are blocking writes, so 
+ * long strings are never truncated. Writes and UartTxFlush() on a port are serialized by a lock, 
+ * which a non-blocking write does not wait for: while another task is writing (or waiting for 
+ * room, or flushing) it accepts no bytes.
+ * 
+ * @note Reception can be by bytes (func_p, called when data arrives, reads with UartReadByte() or 
+ * UartReadBuffer()) or by lines (line_func_p): the UART hardware detects the line end character 
+ * and the event task reads each complete line at once and calls line_func_p with it, so the 
+ * application is woken once per line (command) instead of once per byte. command.h parses the 
+ * lines against a table of commands.
+ * 
+ * @note For high rate streams, an application buffer can be given as receive stream (rx_stream, 
+ * any power of 2 size): the event task moves received data there in bulk and UartRxView() hands 
+ * out read-only views into it, released with UartRxRelease() once processed, so the reader 
+ * never copies the data. The ESP-IDF driver (which owns the UART interrupt, and has no DMA 
+ * reception in this version) still copies from the FIFO to its own buffer (rx_buffer_size).
+ * rx_threshold and rx_timeout set when the driver is interrupted for that copy.
+ * 
+ * @note Each port counts bytes in and out, reception errors and its peak backlogs (UartGetStats()),
+ * so a link losing data can be told from a healthy one. After a RX FIFO overflow the received 
+ * data is discarded (in a receive stream, the data not viewed yet), so reception starts again 
+ * at new data instead of joining bytes across the gap. Watermarks (UartSetWatermark()) call a function when the receive or transmit backlog goes 
+ * above a high level and back below a low one, so producers can slow down before data is lost.
+ * 
+ * @note Links between boards can run up to UART_BAUD_MAX (5 Mbaud) with hardware flow control 
+ * (RTS/CTS, pins given in pins): the receiver deasserts RTS when its RX FIFO reaches rts_threshold, 
+ * and the transmitter holds while CTS is deasserted, so no byte is lost while the receiver is 
+ * busy. At such rates the RX FIFO (128 bytes) fills in a quarter of a millisecond: use larger 
+ * driver buffers (rx_buffer_size), a lower rx_threshold and a receive stream.
  * 
  * @author Albano Peñalva
  *
@@ -17,14 +51,58 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 02/07/2024 | Document creation		                         						|
+ * | 18/07/2024 | Buffered transmission: blocking, non-blocking and timeout writes		|
+ * | 21/07/2024 | Line reception with hardware line end detection						|
+ * | 22/07/2024 | Receive stream with zero-copy views, receive interrupt thresholds		|
+ * | 23/07/2024 | Error and backlog counters, overflow recovery, watermarks				|
+ * | 24/07/2024 | Hardware flow control, buffer sizes, pin mapping, up to 5 Mbaud		|
+ * | 28/07/2024 | Transmit lock: non-blocking writes never wait for other writers		|
+ * | 28/07/2024 | Lines of UART_LINE_MAX characters accepted (were discarded)			|
+ * | 28/07/2024 | The rest of a line cut by a reset or overflow is not a line		|
+ * | 28/07/2024 | Transmit room counts the ring buffer items: writes that fit never wait	|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include "stdbool.h"
+#include "gpio_mcu.h"
 /*==================[macros]=================================================*/
 #define UART_NO_INT	0		/*!< Flag used when no reading interruption is required */
+#define UART_LINE_MAX	128		/*!< Longest received line (without line end), longer ones are discarded */
+#define UART_BAUD_MAX	5000000	/*!< Highest baud rate (80 MHz UART clock) */
 /*==================[typedef]================================================*/
+/**
+ * @brief Hardware flow control
+ */
+typedef enum {
+	UART_FLOW_CTRL_NONE = 0,		/*!< No flow control */
+	UART_FLOW_CTRL_RTS = 1,			/*!< RTS: asks the other end to hold when the RX FIFO fills */
+	UART_FLOW_CTRL_CTS = 2,			/*!< CTS: holds transmission while the other end asks to */
+	UART_FLOW_CTRL_RTS_CTS = 3,		/*!< Both */
+} uart_flow_ctrl_t;
+
+/**
+ * @brief Pin mapping
+ */
+typedef struct {
+	gpio_t tx;				/*!< TX pin */
+	gpio_t rx;				/*!< RX pin */
+	gpio_t rts;				/*!< RTS pin (output, low: ready to receive) */
+	gpio_t cts;				/*!< CTS pin (input, low: the other end is ready) */
+	bool rts_used;			/*!< RTS pin given */
+	bool cts_used;			/*!< CTS pin given */
+} uart_pins_t;
+
+/**
+ * @brief Line received callback
+ * 
+ * @param line Line, without the line end (and '\r' before it), ended with '\0'. It can be 
+ * modified (e.g. tokenized), but it is only valid during the call.
+ * @param len Line length
+ * @param param Callback parameter (param_p)
+ */
+typedef void (*uart_line_func_t)(char *line, uint16_t len, void *param);
 /**
  * @brief List of UART ports available in ESP-EDU
  */
@@ -40,13 +118,77 @@ typedef struct {
 	uint32_t baud_rate;		/*!< baudrate (bits per second) */
 	void *func_p;			/*!< Pointer to callback function to call when receiving data (= UART_NO_INT if not requiered)*/
 	void *param_p;			/*!< Pointer to callback function parameters */
+	uart_line_func_t line_func_p;	/*!< Function called with each received line (NULL if not required), func_p is not used then */
+	char line_end;			/*!< Line end character for line_func_p ('\n' if 0) */
+	uint8_t *rx_stream;		/*!< Receive stream storage (NULL if not required), line_func_p is not used then */
+	uint32_t rx_stream_size;	/*!< Receive stream size (power of 2 bytes, otherwise only the largest power of 2 that fits is used) */
+	uint8_t rx_threshold;	/*!< RX FIFO bytes that interrupt the driver (1 to 127, 0: driver default) */
+	uint8_t rx_timeout;		/*!< Idle time (characters) that interrupts the driver with fewer bytes (1 to 126, 0: driver default) */
+	uart_flow_ctrl_t flow_ctrl;	/*!< Hardware flow control (RTS/CTS pins in pins) */
+	uint8_t rts_threshold;	/*!< RX FIFO bytes that deassert RTS (1 to 127, 0: 96) */
+	const uart_pins_t *pins;	/*!< Pin mapping (NULL: board default, UART_PC on the USB bridge, UART_CONNECTOR on J2) */
+	uint32_t rx_buffer_size;	/*!< Driver receive buffer (bytes, more than 128, 0: 256) */
+	uint32_t tx_buffer_size;	/*!< Transmit buffer (bytes, more than 128, 0: 2048) */
 } serial_config_t;
+
+/**
+ * @brief Port counters (since initialization or UartResetStats())
+ */
+typedef struct {
+	uint32_t bytes_in;		/*!< Bytes read from the driver (by the application, lines or receive stream) */
+	uint32_t bytes_out;		/*!< Bytes accepted for transmission */
+	uint32_t fifo_overflows;	/*!< RX FIFO overflows (bytes lost, received data discarded) */
+	uint32_t buffer_full;	/*!< Driver receive buffer full (the FIFO overflows next, unless it is drained in time) */
+	uint32_t frame_errors;	/*!< Bytes with framing errors (wrong baud rate, noise) */
+	uint32_t parity_errors;	/*!< Bytes with parity errors */
+	uint32_t breaks;		/*!< Breaks received (line held low) */
+	uint32_t long_lines;	/*!< Lines discarded for being longer than UART_LINE_MAX */
+	uint16_t queue_peak;	/*!< Peak driver event queue depth (events waiting for the event task) */
+	uint32_t rx_peak;		/*!< Peak receive backlog (bytes not read, driver buffer and receive stream) */
+} uart_stats_t;
+
+/**
+ * @brief Buffers with watermarks
+ */
+typedef enum {
+	UART_WATERMARK_RX,		/*!< Receive backlog: driver buffer and receive stream */
+	UART_WATERMARK_TX,		/*!< Transmit backlog: transmit buffer */
+} uart_watermark_t;
+
+/**
+ * @brief Watermark callback
+ * 
+ * @note It is called from the event task (receive) or from the task that reads or writes, so it 
+ * must be short (e.g. set a flag, or notify a task).
+ * 
+ * @param port Port
+ * @param buffer Buffer that crossed a watermark
+ * @param high true: above the high watermark, false: back below the low one
+ * @param param Callback parameter
+ */
+typedef void (*uart_watermark_func_t)(uart_mcu_port_t port, uart_watermark_t buffer, bool high, void *param);
+
+/**
+ * @brief Watermarks configuration
+ */
+typedef struct {
+	uint32_t rx_high;		/*!< Receive backlog (bytes) reported as high (0: not watched) */
+	uint32_t rx_low;		/*!< Receive backlog (bytes) reported as low again */
+	uint32_t tx_high;		/*!< Transmit backlog (bytes) reported as high (0: not watched) */
+	uint32_t tx_low;		/*!< Transmit backlog (bytes) reported as low again */
+	uart_watermark_func_t func_p;	/*!< Function called on each crossing */
+	void *param_p;			/*!< Callback parameter */
+} uart_watermark_config_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
 /**
  * @brief Serial port initialization
  * 
+ * @note Calling it again for an initialized port only changes its line parameters (baud rate, 
+ * flow control and receive thresholds), once the pending data has been sent. Pins, buffers and 
+ * reception mode are set by the first call.
+ * 
  * @param port_config 
  */
 void UartInit(serial_config_t *port_config);
@@ -70,6 +212,35 @@ uint8_t UartReadByte(uart_mcu_port_t port, uint8_t *data);
  */
 uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t *data, uint16_t nbytes);
 
+/**
+ * @brief View of the received data in the receive stream (no copy)
+ * 
+ * @note The view is valid until it is released. When the data wraps around the end of the 
+ * stream storage, the view ends there and the rest comes in the next view.
+ * 
+ * @param port Port to read from (initialized with rx_stream)
+ * @param data Pointer to the first received byte
+ * @param timeout_ms Maximum waiting time for data (ms, 0: do not wait)
+ * @return uint32_t Number of bytes in the view (0 if no data)
+ */
+uint32_t UartRxView(uart_mcu_port_t port, const uint8_t **data, uint32_t timeout_ms);
+
+/**
+ * @brief Release bytes of the receive stream, once processed
+ * 
+ * @param port Port to read from
+ * @param nbytes Number of bytes (from the start of the last view, may be fewer than viewed)
+ */
+void UartRxRelease(uart_mcu_port_t port, uint32_t nbytes);
+
+/**
+ * @brief Bytes waiting in the receive stream
+ * 
+ * @param port Port to read from
+ * @return uint32_t Bytes received and not released
+ */
+uint32_t UartRxAvailable(uart_mcu_port_t port);
+
 /**
  * @brief Send a single byte trough serial port
  * 
@@ -105,9 +276,99 @@ void UartSendString(uart_mcu_port_t port, const char *msg);
  */
 void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes);
 
+/**
+ * @brief Write bytes to the transmit buffer, waiting for room if needed
+ * 
+ * @note Do not call it from interrupts.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @return uint32_t Bytes accepted (nbytes, 0 on error)
+ */
+uint32_t UartWriteBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes);
+
+/**
+ * @brief Write to the transmit buffer only the bytes that fit right now (never waits)
+ * 
+ * @note If another task holds the port (a blocking or timeout write waiting for room, or 
+ * UartTxFlush()), nothing is written and 0 is returned.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @return uint32_t Bytes accepted (the first ones of data), may be less than nbytes
+ */
+uint32_t UartWriteNonBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes);
+
+/**
+ * @brief Write bytes to the transmit buffer, waiting for room up to a timeout
+ * 
+ * @note While waiting, the task sleeps (at least one tick) until the line has drained room 
+ * for the rest of the data.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @param timeout_ms Maximum waiting time (ms)
+ * @return uint32_t Bytes accepted (the first ones of data), less than nbytes on timeout
+ */
+uint32_t UartWriteTimeout(uart_mcu_port_t port, const void *data, uint32_t nbytes, uint32_t timeout_ms);
+
+/**
+ * @brief Room left in the transmit buffer
+ * 
+ * @note Less than the free bytes: the ring buffer also holds a header per write and per 
+ * chunk of data, and keeps room for a chunk that does not fit at its end. As 
+ * UartWriteNonBlocking(), it returns 0 while another task holds the port.
+ * 
+ * @param port Port selected
+ * @return uint32_t Bytes that a non-blocking write would accept now
+ */
+uint32_t UartTxFree(uart_mcu_port_t port);
+
+/**
+ * @brief Wait until every buffered byte has been sent on the line
+ * 
+ * @param port Port selected
+ * @param timeout_ms Maximum waiting time (ms)
+ * @return true if transmission finished, false on timeout
+ */
+bool UartTxFlush(uart_mcu_port_t port, uint32_t timeout_ms);
+
+/**
+ * @brief Port counters
+ * 
+ * @param port Port selected
+ * @param stats Counters
+ */
+void UartGetStats(uart_mcu_port_t port, uart_stats_t *stats);
+
+/**
+ * @brief Clear the port counters
+ * 
+ * @param port Port selected
+ */
+void UartResetStats(uart_mcu_port_t port);
+
+/**
+ * @brief Set the watermarks of a port
+ * 
+ * @note The receive backlog is checked on every driver event and read; the transmit backlog on 
+ * every write and UartTxFree() call (a producer waiting for the low watermark should poll 
+ * UartTxFree()).
+ * 
+ * @param port Port selected
+ * @param config Watermarks (NULL: disabled)
+ */
+void UartSetWatermark(uart_mcu_port_t port, const uart_watermark_config_t *config);
+
 /**
  * @brief Convert a number to a String (char array ended with '\0')
  * 
+ * @note The String is a static buffer, overwritten by the next call (from any task). 
+ * FmtUint() and FmtPrintf() (fmt.h) write to a buffer given by the caller instead.
+ * 
  * @param val Number to be converted
  * @param base Base of the converted number (2: binary, 10: decimal, 16: hexadecimal)
  * @return uint8_t* 
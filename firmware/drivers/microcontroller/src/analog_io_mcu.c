@@ -16,16 +16,53 @@
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_monitor.h"
+#include "hal/adc_ll.h"
+#include "ring_buffer.h"
+#include "timer_mcu.h"
+#include "esp_timer.h"
+#include "pwm_mcu.h"
+#include <string.h>
+#include <math.h>
 /*==================[macros and definitions]=================================*/
 #define ADC_BITWIDTH 		SOC_ADC_DIGI_MAX_BITWIDTH	// 12 bit resolution
 #define ADC_ATTENUATION		ADC_ATTEN_DB_11				// 12dB attenuation (for 0-3,3V ADC range)
+#define ADC_RAW_VALUES		(1 << ADC_BITWIDTH)			// Calibration table entries
+#define ADC_CONV_FRAME_SIZE	(64 * SOC_ADC_DIGI_RESULT_BYTES)	// DMA frame: 64 convertions
+#define ADC_POOL_SIZE		(4 * ADC_CONV_FRAME_SIZE)			// IDF internal pool (flushed, not read)
+#define US_PER_S			1000000
+#define ADC_GAP_EVENTS		16			// Pending gaps (dropped frames runs) that can be located in the buffers (power of 2)
 /*==================[internal data declaration]==============================*/
-adc_cali_handle_t adc_calibration_single, adc_calibration_cont;
+adc_cali_handle_t adc_calibration = NULL;
 adc_oneshot_unit_handle_t adc1_single; 
-adc_continuous_handle_t adc2_cont;
+adc_continuous_handle_t adc1_cont = NULL;
 sdm_channel_handle_t dac = NULL;
 bool adc1_single_used = false;
 /*==================[internal functions declaration]=========================*/
+static bool adc_conv_done_isr(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data);
+static void adc_timer_isr(void *param);
+static void adc_store_frame(void);
+static void adc_ref_set(int64_t time, uint32_t index);
+static void adc_notify(void);
+static bool adc_place_gap(void);
+static void adc_drop_frame(void);
+static void adc_trigger_frame(void);
+static void adc_trigger_arm(void);
+static int64_t adc_index2time(uint32_t index);
+static bool adc_is_stored(uint8_t ch);
+static uint16_t adc_read(const uint8_t *channels, uint8_t nch, analog_block_t *block, uint16_t *values, uint16_t n);
+static bool adc_monitor_high_isr(adc_monitor_handle_t handle, const adc_monitor_evt_data_t *edata, void *user_data);
+static bool adc_monitor_low_isr(adc_monitor_handle_t handle, const adc_monitor_evt_data_t *edata, void *user_data);
+static void adc_monitor_arm(uint8_t ch);
+static uint16_t adc_mv2raw(uint16_t mv);
+static void adc_scan_config(void);
+static void adc_cali_update(void);
+static void dac_timer_isr(void *param);
+static void dac_write(uint16_t value);
+static bool dac_start(uint32_t rate);
+static bool dac_play(const void *buffer, bool wide, uint32_t len, uint32_t rate, bool loop);
+static bool dac_generate(uint32_t rate, void *func_p, bool wide, void *param_p);
+static bool dac_queue(const void *buffer, bool wide, uint32_t len);
 
 /*==================[internal data definition]===============================*/
 adc_oneshot_unit_init_cfg_t init_config_single = {
@@ -36,24 +73,765 @@ adc_oneshot_chan_cfg_t adc_config_single = {
 	.bitwidth = ADC_BITWIDTH,
 	.atten = ADC_ATTENUATION,
 };					
+static adc_atten_t adc_attenuation = ADC_ATTENUATION;
+static uint16_t adc_cali_lut[ADC_RAW_VALUES];				/*!< Raw to mV calibration table */
+static uint8_t adc_single_configured = 0;					/*!< Mask of channels initialized in single mode */
+static const adc_channel_t adc_channel_map[ADC_CHANNELS] = {
+	ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3
+};
+static uint16_t adc_ring_data[ADC_CHANNELS][ADC_RING_SIZE];	/*!< Per-channel sample storage */
+static ring_buffer_t adc_ring[ADC_CHANNELS];					/*!< Per-channel ring buffers */
+static void (*adc_cont_isr_p[ADC_CHANNELS])(void*);			/*!< Per-channel convertion end callbacks */
+static void *adc_cont_user_data[ADC_CHANNELS];
+static uint8_t adc_cont_configured = 0;						/*!< Mask of channels initialized in continuous or timed mode */
+static uint8_t adc_cont_active = 0;							/*!< Mask of channels included in the scan */
+static uint32_t adc_cont_sample_frec = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+static adc_mode_t adc_cont_mode = ADC_CONTINUOUS;			/*!< Scan source: DMA (ADC_CONTINUOUS) or timer ISR (ADC_TIMED) */
+static timer_mcu_t adc_timer = TIMER_A;
+static bool adc_timer_initialized = false;
+static uint16_t adc_block_size = 0;							/*!< Frames between callbacks */
+static uint16_t adc_block_count = 0;						/*!< Frames stored since last callback */
+static uint8_t adc_scan_list[ADC_CHANNELS];					/*!< Scanned channels, in hardware sequence order */
+static uint8_t adc_scan_len = 0;
+static uint8_t adc_scan_pos = 0;							/*!< Position in scan of next expected convertion */
+static uint8_t adc_store_list[ADC_CHANNELS];				/*!< Scanned channels stored in ring buffers (all but the triggered one) */
+static uint8_t adc_store_frame_pos[ADC_CHANNELS];			/*!< Position of each stored channel in the scanned frame */
+static uint8_t adc_store_len = 0;
+static uint16_t adc_scan_frame[ADC_CHANNELS];				/*!< Frame being deinterleaved */
+static uint8_t adc_os_shift = 0;							/*!< Oversampling exponent */
+static bool adc_os_dither = false;
+static uint16_t adc_os_count = 0;							/*!< Frames accumulated in current decimation period */
+static uint32_t adc_os_acc[ADC_CHANNELS];					/*!< Integrate and dump accumulators (scan order) */
+static uint32_t adc_os_lfsr = 0xACE1u;						/*!< Dither generator state */
+static uint32_t adc_out_rate = 0;							/*!< Stored frames per second */
+static uint32_t adc_stored = 0;								/*!< Frames stored since scan start */
+static uint32_t adc_dropped = 0;							/*!< Frames dropped since scan start */
+typedef struct {
+	uint32_t position;		/*!< Stored frames before the gap */
+	uint32_t count;			/*!< Frames dropped */
+} adc_gap_t;
+static adc_gap_t adc_gap[ADC_GAP_EVENTS];					/*!< Gaps not yet reached by all consumers */
+static uint32_t adc_gap_head = 0;
+static uint32_t adc_gap_pending = 0;						/*!< Frames dropped at adc_stored not yet recorded in adc_gap (table full) */
+static uint32_t adc_ref_seq = 0;							/*!< Timing reference seqlock (odd while being written) */
+static int64_t adc_ref_time = 0;							/*!< Time of last timing reference (us) */
+static uint32_t adc_ref_index = 0;							/*!< Index (stored + dropped) of the last frame produced at reference time */
+static uint32_t adc_rd_pos[ADC_CHANNELS];					/*!< Per-channel read position (stored frames) */
+static uint32_t adc_rd_index[ADC_CHANNELS];					/*!< Per-channel read index (stored + dropped frames) */
+static uint32_t adc_rd_gap[ADC_CHANNELS];					/*!< Per-channel next gap to be reached */
+static uint32_t adc_rd_seq[ADC_CHANNELS];					/*!< Per-channel block sequence number */
+static bool adc_scan_running = false;
+static adc_mode_t adc_scan_running_mode;
+static adc_monitor_handle_t adc_monitor[ADC_CHANNELS];		/*!< Per-channel threshold monitors */
+static void (*adc_monitor_isr_p[ADC_CHANNELS])(void*, bool);	/*!< Per-channel threshold crossing callbacks */
+static void *adc_monitor_user_data[ADC_CHANNELS];
+static bool adc_monitor_above[ADC_CHANNELS];				/*!< Per-channel hysteresis state */
+static adc_monitor_id_t adc_monitor_id[ADC_CHANNELS];		/*!< Hardware monitor of each watched channel */
+static const void *dac_play_buf = NULL;					/*!< Buffer being played (NULL: waiting for one) */
+static bool dac_play_wide = false;							/*!< Buffer being played holds 16 bits samples */
+static uint32_t dac_play_len = 0;
+static uint32_t dac_play_pos = 0;
+static const void *dac_next_buf = NULL;						/*!< Queued buffer (NULL: queue empty) */
+static bool dac_next_wide = false;
+static uint32_t dac_next_len = 0;
+static bool dac_play_loop = false;
+static bool dac_streaming = false;							/*!< Missing buffers are underruns, not the end of playback */
+static volatile bool dac_playing = false;
+static void (*dac_stream_isr_p)(void*) = NULL;				/*!< Queue empty callback */
+static uint8_t (*dac_gen_p)(void*) = NULL;					/*!< Sample generator (NULL: play buffers) */
+static uint16_t (*dac_gen16_p)(void*) = NULL;				/*!< 16 bits sample generator (NULL: play buffers) */
+static void *dac_gen_user_data = NULL;
+static void *dac_stream_user_data = NULL;
+static bool dac_timer_initialized = false;
+static bool dac_pwm = false;								/*!< Output backend: LEDC PWM (true) or sigma-delta (false) */
+static uint8_t dac_bits = 0;								/*!< Output resolution (0: not initialized) */
+static analog_output_stats_t dac_stats;
+typedef enum {
+	ADC_TRIG_IDLE,			/*!< No trigger configured, or single capture already read */
+	ADC_TRIG_ARMED,			/*!< Filling the pre-trigger buffer and waiting for the trigger */
+	ADC_TRIG_POST,			/*!< Triggered, storing post-trigger samples */
+	ADC_TRIG_READY,			/*!< Capture complete, waiting to be read */
+} adc_trig_state_t;
+static volatile uint8_t adc_trig_state = ADC_TRIG_IDLE;
+static bool adc_trig_set = false;							/*!< A trigger is configured */
+static uint8_t adc_trig_ch;									/*!< Triggered channel */
+static uint8_t adc_trig_frame_pos = 0;						/*!< Position of the triggered channel in the scanned frame */
+static uint8_t adc_trig_slope;								/*!< Mask of analog_trigger_slope_t edges */
+static uint16_t adc_trig_level;								/*!< Trigger level (raw, scaled to the oversampled resolution) */
+static uint16_t adc_trig_rearm_low;							/*!< Rising edges are armed below this value (level - hysteresis) */
+static uint16_t adc_trig_rearm_high;						/*!< Falling edges are armed above this value (level + hysteresis) */
+static bool adc_trig_below;									/*!< Signal went below adc_trig_rearm_low since last trigger */
+static bool adc_trig_above;									/*!< Signal went above adc_trig_rearm_high since last trigger */
+static uint16_t *adc_trig_buf;								/*!< Capture window: pre (circular) + post samples */
+static uint16_t adc_trig_pre;
+static uint16_t adc_trig_post;
+static uint16_t adc_trig_wr;								/*!< Next write position in the circular pre-trigger part */
+static uint16_t adc_trig_count;								/*!< Pre-trigger samples stored (up to adc_trig_pre), then post-trigger ones */
+static uint32_t adc_trig_holdoff;
+static uint32_t adc_trig_wait;								/*!< Samples left before a trigger is accepted */
+static bool adc_trig_single;
+static bool adc_trig_done;									/*!< Single capture read, not armed again yet */
+static bool adc_trig_rising;								/*!< Edge of the last trigger */
+static uint32_t adc_trig_index;								/*!< Index (stored + dropped) of the trigger sample */
+static uint32_t adc_trig_seq = 0;							/*!< Captures since trigger configuration */
+static void (*adc_trig_isr_p)(void*);						/*!< Capture complete callback */
+static void *adc_trig_user_data;
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief DMA frame done callback. Deinterleaves convertions into per-channel ring buffers.
+ * 
+ * @note A frame is only stored if every scanned channel has room for it, so 
+ * channel buffers never get misaligned. Out of sequence convertions restart the frame.
+ */
+static bool IRAM_ATTR adc_conv_done_isr(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data){
+	const adc_digi_output_data_t *result = (const adc_digi_output_data_t *)edata->conv_frame_buffer;
+	uint32_t n = edata->size / SOC_ADC_DIGI_RESULT_BYTES;
+	uint8_t pos = adc_scan_pos;
+	for(uint32_t i = 0; i < n; i++){
+		uint8_t ch = result[i].type2.channel;
+		if(ch != adc_scan_list[pos]){
+			/* lost synchronization: discard partial frame */
+			pos = 0;
+			if(ch != adc_scan_list[0]){
+				continue;
+			}
+		}
+		adc_scan_frame[pos++] = result[i].type2.data;
+		if(pos == adc_scan_len){
+			pos = 0;
+			adc_store_frame();
+		}
+	}
+	adc_scan_pos = pos;
+	adc_notify();
+	return false;
+}
+
+/**
+ * @brief Timer alarm callback (timed mode). Reads every scanned channel and stores them as a frame.
+ */
+static void IRAM_ATTR adc_timer_isr(void *param){
+	for(uint8_t j = 0; j < adc_scan_len; j++){
+		int raw = 0;
+		adc_oneshot_read_isr(adc1_single, adc_channel_map[adc_scan_list[j]], &raw);
+		adc_scan_frame[j] = raw;
+	}
+	adc_store_frame();
+	adc_notify();
+}
+
+/**
+ * @brief Stores the complete frame in adc_scan_frame in the channel ring buffers (decimating it if oversampling).
+ * 
+ * @note A frame is only stored if every scanned channel has room for it, so 
+ * channel buffers never get misaligned.
+ */
+static inline void IRAM_ATTR adc_store_frame(void){
+	if(adc_os_shift){
+		/* integrate 4^n frames and dump them as one (12 + n) bits frame */
+		for(uint8_t j = 0; j < adc_scan_len; j++){
+			adc_os_acc[j] += adc_scan_frame[j];
+		}
+		if(++adc_os_count < (1 << (2 * adc_os_shift))){
+			return;
+		}
+		adc_os_count = 0;
+		uint32_t offset = 1 << (adc_os_shift - 1);
+		for(uint8_t j = 0; j < adc_scan_len; j++){
+			if(adc_os_dither){
+				/* xorshift32 */
+				adc_os_lfsr ^= adc_os_lfsr << 13;
+				adc_os_lfsr ^= adc_os_lfsr >> 17;
+				adc_os_lfsr ^= adc_os_lfsr << 5;
+				offset = adc_os_lfsr & ((1 << adc_os_shift) - 1);
+			}
+			adc_scan_frame[j] = (adc_os_acc[j] + offset) >> adc_os_shift;
+			adc_os_acc[j] = 0;
+		}
+	}
+	/* the trigger sees every frame, even those dropped below */
+	if(adc_trig_set){
+		adc_trigger_frame();
+	}
+	bool room = true;
+	for(uint8_t k = 0; k < adc_store_len; k++){
+		room &= (RingBufferFree(&adc_ring[adc_store_list[k]]) > 0);
+	}
+	if(room && adc_gap_pending && !adc_place_gap()){
+		/* a frame stored now would hide the pending gap */
+		room = false;
+	}
+	if(room){
+		for(uint8_t k = 0; k < adc_store_len; k++){
+			RingBufferPush(&adc_ring[adc_store_list[k]], adc_scan_frame[adc_store_frame_pos[k]]);
+		}
+		__atomic_store_n(&adc_stored, adc_stored + 1, __ATOMIC_RELEASE);
+		adc_block_count++;
+	}else{
+		adc_drop_frame();
+	}
+}
+
+/**
+ * @brief Records the pending gap (adc_gap_pending frames dropped at adc_stored) in adc_gap.
+ * 
+ * @return true if recorded, false if every slot holds a gap not yet reached by a consumer
+ */
+static inline bool IRAM_ATTR adc_place_gap(void){
+	uint32_t head = adc_gap_head;
+	uint32_t oldest = head;
+	for(uint8_t k = 0; k < adc_store_len; k++){
+		uint32_t rd = adc_rd_gap[adc_store_list[k]];
+		if(head - rd > head - oldest){
+			oldest = rd;
+		}
+	}
+	if(head - oldest >= ADC_GAP_EVENTS){
+		return false;
+	}
+	adc_gap[head & (ADC_GAP_EVENTS - 1)].position = adc_stored;
+	adc_gap[head & (ADC_GAP_EVENTS - 1)].count = adc_gap_pending;
+	__atomic_store_n(&adc_gap_head, head + 1, __ATOMIC_RELEASE);
+	adc_gap_pending = 0;
+	return true;
+}
+
+/**
+ * @brief Accounts a frame dropped because the buffers are full, recording where the gap is.
+ * 
+ * @note If the gap table is full the gap stays pending, and no frame is stored until it is 
+ * recorded (adc_store_frame()): the dropped frames are still reported at their position.
+ */
+static inline void IRAM_ATTR adc_drop_frame(void){
+	uint32_t head = adc_gap_head;
+	adc_gap_t *last = &adc_gap[(head - 1) & (ADC_GAP_EVENTS - 1)];
+	adc_dropped++;
+	if((adc_gap_pending == 0) && (head != 0) && (last->position == adc_stored)){
+		/* gap still open: no frame stored since last drop */
+		last->count++;
+		return;
+	}
+	adc_gap_pending++;
+	adc_place_gap();
+}
+
+/**
+ * @brief Feeds the triggered channel sample of the current frame to the capture: pre-trigger 
+ * samples go to a circular buffer until the trigger condition is met, then post-trigger 
+ * samples are stored after them and the consumer is notified once the window is complete.
+ */
+static inline void IRAM_ATTR adc_trigger_frame(void){
+	uint8_t state = adc_trig_state;
+	if((state == ADC_TRIG_IDLE) || (state == ADC_TRIG_READY)){
+		return;
+	}
+	uint16_t x = adc_scan_frame[adc_trig_frame_pos];
+	if(state == ADC_TRIG_POST){
+		adc_trig_buf[adc_trig_pre + adc_trig_count++] = x;
+	}else{
+		/* hysteresis: an edge is armed once the signal has been beyond level -+ hysteresis */
+		if(x < adc_trig_rearm_low){
+			adc_trig_below = true;
+		}
+		if(x > adc_trig_rearm_high){
+			adc_trig_above = true;
+		}
+		bool rising = false, falling = false;
+		if((adc_trig_count == adc_trig_pre) && (adc_trig_wait == 0)){
+			rising = (adc_trig_slope & ANALOG_TRIGGER_RISING) && adc_trig_below && (x >= adc_trig_level);
+			falling = (adc_trig_slope & ANALOG_TRIGGER_FALLING) && adc_trig_above && (x <= adc_trig_level);
+		}
+		if(!rising && !falling){
+			if(adc_trig_wait){
+				adc_trig_wait--;
+			}
+			if(adc_trig_pre){
+				adc_trig_buf[adc_trig_wr] = x;
+				adc_trig_wr = (adc_trig_wr + 1 == adc_trig_pre) ? 0 : adc_trig_wr + 1;
+				if(adc_trig_count < adc_trig_pre){
+					adc_trig_count++;
+				}
+			}
+			return;
+		}
+		/* the trigger sample is the first post-trigger one */
+		adc_trig_rising = rising;
+		adc_trig_index = adc_stored + adc_dropped;
+		adc_trig_buf[adc_trig_pre] = x;
+		adc_trig_count = 1;
+		adc_trig_state = ADC_TRIG_POST;
+	}
+	if(adc_trig_count == adc_trig_post){
+		adc_trig_seq++;
+		adc_trig_state = ADC_TRIG_READY;
+		if(adc_trig_isr_p != NULL){
+			adc_trig_isr_p(adc_trig_user_data);
+		}
+	}
+}
+
+/**
+ * @brief Discards any capture and waits for a new trigger (pre-trigger buffer empty, holdoff restarted).
+ */
+static void adc_trigger_arm(void){
+	adc_trig_state = ADC_TRIG_IDLE;
+	adc_trig_wr = 0;
+	adc_trig_count = 0;
+	adc_trig_wait = adc_trig_holdoff;
+	adc_trig_below = false;
+	adc_trig_above = false;
+	__atomic_store_n(&adc_trig_state, ADC_TRIG_ARMED, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Time of the frame with the given index (stored + dropped frames since scan start), 
+ * from the last timing reference.
+ */
+static int64_t adc_index2time(uint32_t index){
+	uint32_t seq;
+	int64_t time;
+	uint32_t ref_index;
+	/* single core: the writer (ISR) interrupts the reader, so compiler ordering is enough */
+	do{
+		seq = __atomic_load_n(&adc_ref_seq, __ATOMIC_ACQUIRE);
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+		time = adc_ref_time;
+		ref_index = adc_ref_index;
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	}while((seq & 1) || (seq != __atomic_load_n(&adc_ref_seq, __ATOMIC_RELAXED)));
+	return time - ((int64_t)(int32_t)(ref_index - index) * US_PER_S) / (adc_out_rate ? adc_out_rate : 1);
+}
+
+/**
+ * @brief Whether a channel is stored in its ring buffer by the current scan
+ */
+static bool adc_is_stored(uint8_t ch){
+	for(uint8_t k = 0; k < adc_store_len; k++){
+		if(adc_store_list[k] == ch){
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Reads a block from the buffers of the given channels (one sample of each per frame).
+ * 
+ * @note The block ends right before the next gap, so its samples are always contiguous in time. 
+ * Channels not stored by the current scan (not configured, or the triggered one) have nothing to read.
+ */
+static uint16_t adc_read(const uint8_t *channels, uint8_t nch, analog_block_t *block, uint16_t *values, uint16_t n){
+	if(nch == 0){
+		return 0;
+	}
+	for(uint8_t j = 0; j < nch; j++){
+		if(!adc_is_stored(channels[j])){
+			return 0;
+		}
+	}
+	uint8_t ref = channels[0];
+	uint32_t pos = adc_rd_pos[ref];
+	uint32_t gap = adc_rd_gap[ref];
+	uint32_t dropped = 0;
+	uint32_t stored = __atomic_load_n(&adc_stored, __ATOMIC_ACQUIRE);
+	uint32_t gap_head = __atomic_load_n(&adc_gap_head, __ATOMIC_ACQUIRE);
+	/* gaps at current position, closed by a later stored frame */
+	while((gap != gap_head) && (adc_gap[gap & (ADC_GAP_EVENTS - 1)].position == pos) && (pos < stored)){
+		dropped += adc_gap[gap & (ADC_GAP_EVENTS - 1)].count;
+		gap++;
+	}
+	if(stored - pos < n){
+		n = stored - pos;
+	}
+	/* frames are pushed before adc_stored counts them: never fewer samples than that */
+	for(uint8_t j = 0; j < nch; j++){
+		uint32_t count = RingBufferCount(&adc_ring[channels[j]]);
+		if(count < n){
+			n = count;
+		}
+	}
+	if((gap != gap_head) && (adc_gap[gap & (ADC_GAP_EVENTS - 1)].position - pos < n)){
+		n = adc_gap[gap & (ADC_GAP_EVENTS - 1)].position - pos;
+	}
+	uint32_t index = adc_rd_index[ref] + dropped;
+	if(nch == 1){
+		n = RingBufferRead(&adc_ring[ref], values, n);
+	}else{
+		for(uint16_t i = 0; i < n; i++){
+			for(uint8_t j = 0; j < nch; j++){
+				RingBufferPop(&adc_ring[channels[j]], values++);
+			}
+		}
+	}
+	if(block != NULL){
+		block->timestamp = adc_index2time(index);
+		block->sequence = adc_rd_seq[ref];
+		block->index = index;
+		block->sample_frec = adc_out_rate;
+		block->dropped = dropped;
+		block->len = n;
+	}
+	for(uint8_t j = 0; j < nch; j++){
+		adc_rd_pos[channels[j]] = pos + n;
+		adc_rd_index[channels[j]] = index + n;
+		adc_rd_gap[channels[j]] = gap;
+		adc_rd_seq[channels[j]]++;
+	}
+	return n;
+}
+
+/**
+ * @brief Writes the timing reference (seqlock writer: odd sequence while time and index change).
+ */
+static inline void IRAM_ATTR adc_ref_set(int64_t time, uint32_t index){
+	uint32_t seq = __atomic_load_n(&adc_ref_seq, __ATOMIC_RELAXED);
+	__atomic_store_n(&adc_ref_seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	adc_ref_time = time;
+	adc_ref_index = index;
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	__atomic_store_n(&adc_ref_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Updates the timing reference and calls the scanned channels callbacks once a block of frames is stored.
+ */
+static inline void IRAM_ATTR adc_notify(void){
+	/* one reference per DMA frame or timer alarm: last frame index and its time */
+	adc_ref_set(esp_timer_get_time(), adc_stored + adc_dropped - 1);
+	if((adc_block_count == 0) || (adc_block_count < adc_block_size)){
+		return;
+	}
+	adc_block_count = 0;
+	for(uint8_t j = 0; j < adc_scan_len; j++){
+		uint8_t ch = adc_scan_list[j];
+		if(adc_cont_isr_p[ch] != NULL){
+			adc_cont_isr_p[ch](adc_cont_user_data[ch]);
+		}
+	}
+}
+
+/**
+ * @brief Stops the continuous (or timed) convertion and restarts it with the active channels.
+ */
+static void adc_scan_config(void){
+	static adc_digi_pattern_config_t pattern[ADC_CHANNELS];
+	if(adc_scan_running){
+		if(adc_scan_running_mode == ADC_TIMED){
+			TimerStop(adc_timer);
+		}else{
+			adc_continuous_stop(adc1_cont);
+		}
+		adc_scan_running = false;
+	}
+	adc_scan_len = 0;
+	adc_store_len = 0;
+	adc_scan_pos = 0;
+	adc_os_count = 0;
+	adc_block_count = 0;
+	adc_stored = 0;
+	adc_dropped = 0;
+	adc_gap_head = 0;
+	adc_gap_pending = 0;
+	adc_ref_set(esp_timer_get_time(), UINT32_MAX);
+	for(uint8_t ch = 0; ch < ADC_CHANNELS; ch++){
+		RingBufferReset(&adc_ring[ch]);
+		adc_os_acc[ch] = 0;
+		adc_rd_pos[ch] = 0;
+		adc_rd_index[ch] = 0;
+		adc_rd_gap[ch] = 0;
+		adc_rd_seq[ch] = 0;
+		if(adc_cont_active & (1 << ch)){
+			pattern[adc_scan_len].atten = adc_attenuation;
+			pattern[adc_scan_len].channel = adc_channel_map[ch];
+			pattern[adc_scan_len].unit = ADC_UNIT_1;
+			pattern[adc_scan_len].bit_width = ADC_BITWIDTH;
+			if(adc_trig_set && (ch == adc_trig_ch)){
+				/* captured only: not stored in its buffer */
+				adc_trig_frame_pos = adc_scan_len;
+			}else{
+				adc_store_frame_pos[adc_store_len] = adc_scan_len;
+				adc_store_list[adc_store_len++] = ch;
+			}
+			adc_scan_list[adc_scan_len++] = ch;
+		}
+	}
+	if(adc_trig_set){
+		/* new time base: a capture in progress (or not read yet) is discarded */
+		if(adc_cont_active & (1 << adc_trig_ch)){
+			if(!adc_trig_done){
+				adc_trigger_arm();
+			}
+		}else{
+			adc_trig_state = ADC_TRIG_IDLE;
+		}
+	}
+	if(adc_scan_len == 0){
+		return;
+	}
+	adc_scan_running_mode = adc_cont_mode;
+	adc_scan_running = true;
+	if(adc_cont_mode == ADC_TIMED){
+		adc_out_rate = adc_cont_sample_frec >> (2 * adc_os_shift);
+		TimerReset(adc_timer);
+		TimerStart(adc_timer);
+		return;
+	}
+	uint32_t freq = adc_cont_sample_frec * adc_scan_len;
+	if(freq < SOC_ADC_SAMPLE_FREQ_THRES_LOW){
+		freq = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+	}
+	if(freq > SOC_ADC_SAMPLE_FREQ_THRES_HIGH){
+		freq = SOC_ADC_SAMPLE_FREQ_THRES_HIGH;
+	}
+	adc_continuous_config_t scan_config = {
+		.pattern_num = adc_scan_len,
+		.adc_pattern = pattern,
+		.sample_freq_hz = freq,
+		.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+		.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+	};
+	adc_out_rate = (freq / adc_scan_len) >> (2 * adc_os_shift);
+	adc_continuous_config(adc1_cont, &scan_config);
+	adc_continuous_start(adc1_cont);
+}
+
+/**
+ * @brief Enables only the interrupt of the threshold that ends the current state (high while 
+ * below, low while above).
+ * 
+ * @note The hardware flags every convertion beyond a threshold: with both interrupts enabled, the 
+ * one of the side the signal is at would fire on every convertion (up to 20k interrupts per second 
+ * for a single channel at the default rate). This way there is one interrupt per crossing. Stale 
+ * flags are cleared first, so the new side only fires on a convertion made after the crossing.
+ */
+static void IRAM_ATTR adc_monitor_arm(uint8_t ch){
+	bool above = adc_monitor_above[ch];
+	adc_ll_digi_monitor_enable_intr(adc_monitor_id[ch], ADC_MONITOR_MODE_HIGH, false);
+	adc_ll_digi_monitor_enable_intr(adc_monitor_id[ch], ADC_MONITOR_MODE_LOW, false);
+	adc_ll_digi_monitor_clear_intr();
+	adc_ll_digi_monitor_enable_intr(adc_monitor_id[ch], above ? ADC_MONITOR_MODE_LOW : ADC_MONITOR_MODE_HIGH, true);
+}
+
+/**
+ * @brief Monitor high threshold event: reports the crossing and arms the low threshold.
+ */
+static bool IRAM_ATTR adc_monitor_high_isr(adc_monitor_handle_t handle, const adc_monitor_evt_data_t *edata, void *user_data){
+	uint32_t ch = (uintptr_t)user_data;
+	bool crossing = !adc_monitor_above[ch];
+	adc_monitor_above[ch] = true;
+	adc_monitor_arm(ch);
+	if(crossing && (adc_monitor_isr_p[ch] != NULL)){
+		adc_monitor_isr_p[ch](adc_monitor_user_data[ch], true);
+	}
+	return false;
+}
+
+/**
+ * @brief Monitor low threshold event: reports the crossing and arms the high threshold.
+ */
+static bool IRAM_ATTR adc_monitor_low_isr(adc_monitor_handle_t handle, const adc_monitor_evt_data_t *edata, void *user_data){
+	uint32_t ch = (uintptr_t)user_data;
+	bool crossing = adc_monitor_above[ch];
+	adc_monitor_above[ch] = false;
+	adc_monitor_arm(ch);
+	if(crossing && (adc_monitor_isr_p[ch] != NULL)){
+		adc_monitor_isr_p[ch](adc_monitor_user_data[ch], false);
+	}
+	return false;
+}
+
+/**
+ * @brief Converts a voltage (mV) to the lowest raw value that reaches it, searching the calibration table.
+ */
+static uint16_t adc_mv2raw(uint16_t mv){
+	uint16_t low = 0, high = ADC_RAW_VALUES - 1;
+	while(low < high){
+		uint16_t mid = (low + high) / 2;
+		if(adc_cali_lut[mid] < mv){
+			low = mid + 1;
+		}else{
+			high = mid;
+		}
+	}
+	return low;
+}
+
+/**
+ * @brief Writes a 16 bits value to the analog output, truncated to its resolution.
+ */
+static inline void IRAM_ATTR dac_write(uint16_t value){
+	if(dac_pwm){
+		PWMSetDuty(DAC_PWM_OUT, value >> (16 - dac_bits));
+	}else{
+		sdm_channel_set_pulse_density(dac, (int8_t)((value >> 8) - 128));
+	}
+}
+
+/**
+ * @brief Timer alarm callback (DAC playback). Writes the next sample and switches buffers.
+ */
+static void IRAM_ATTR dac_timer_isr(void *param){
+	if(dac_gen16_p != NULL){
+		dac_write(dac_gen16_p(dac_gen_user_data));
+		dac_stats.samples++;
+		return;
+	}
+	if(dac_gen_p != NULL){
+		dac_write(dac_gen_p(dac_gen_user_data) * 257);
+		dac_stats.samples++;
+		return;
+	}
+	if(dac_play_buf == NULL){
+		/* waiting for a buffer: take it from the queue, or hold the last value */
+		const void *next = __atomic_load_n(&dac_next_buf, __ATOMIC_ACQUIRE);
+		if(next == NULL){
+			dac_stats.underrun_samples++;
+			return;
+		}
+		dac_play_buf = next;
+		dac_play_wide = dac_next_wide;
+		dac_play_len = dac_next_len;
+		dac_play_pos = 0;
+		__atomic_store_n(&dac_next_buf, NULL, __ATOMIC_RELEASE);
+		if(dac_stream_isr_p != NULL){
+			dac_stream_isr_p(dac_stream_user_data);
+		}
+	}
+	if(dac_play_wide){
+		dac_write(((const uint16_t *)dac_play_buf)[dac_play_pos]);
+	}else{
+		dac_write(((const uint8_t *)dac_play_buf)[dac_play_pos] * 257);
+	}
+	dac_stats.samples++;
+	if(++dac_play_pos < dac_play_len){
+		return;
+	}
+	dac_stats.buffers++;
+	dac_play_pos = 0;
+	if(dac_play_loop){
+		return;
+	}
+	dac_play_buf = NULL;
+	if(__atomic_load_n(&dac_next_buf, __ATOMIC_ACQUIRE) != NULL){
+		/* next buffer is taken on the next alarm, so the sample period is kept */
+		return;
+	}
+	if(dac_streaming){
+		dac_stats.underruns++;
+	}else{
+		TimerStop(DAC_TIMER);
+		dac_playing = false;
+	}
+}
+
+/**
+ * @brief Sets the playback rate and starts the DAC timer.
+ */
+static bool dac_start(uint32_t rate){
+	uint32_t period = (US_PER_S + rate / 2) / rate;
+	if(!dac_timer_initialized){
+		timer_config_t timer_cfg = {
+			.timer = DAC_TIMER,
+			.period = period,
+			.func_p = dac_timer_isr,
+			.param_p = NULL,
+		};
+		TimerInit(&timer_cfg);
+		dac_timer_initialized = true;
+	}else{
+		TimerUpdatePeriod(DAC_TIMER, period);
+	}
+	memset(&dac_stats, 0, sizeof(dac_stats));
+	dac_playing = true;
+	TimerReset(DAC_TIMER);
+	TimerStart(DAC_TIMER);
+	return true;
+}
+
+/**
+ * @brief Starts playing a buffer of 8 or 16 bits samples.
+ */
+static bool dac_play(const void *buffer, bool wide, uint32_t len, uint32_t rate, bool loop){
+	if((dac_bits == 0) || (buffer == NULL) || (len == 0) || (rate == 0) || (rate > DAC_PLAY_MAX_RATE)){
+		return false;
+	}
+	AnalogOutputStop();
+	dac_play_buf = buffer;
+	dac_play_wide = wide;
+	dac_play_len = len;
+	dac_play_pos = 0;
+	dac_play_loop = loop;
+	dac_streaming = false;
+	dac_stream_isr_p = NULL;
+	return dac_start(rate);
+}
+
+/**
+ * @brief Starts an 8 or 16 bits sample generator.
+ */
+static bool dac_generate(uint32_t rate, void *func_p, bool wide, void *param_p){
+	if((dac_bits == 0) || (func_p == NULL) || (rate == 0) || (rate > DAC_PLAY_MAX_RATE)){
+		return false;
+	}
+	AnalogOutputStop();
+	dac_gen_user_data = param_p;
+	if(wide){
+		dac_gen16_p = func_p;
+	}else{
+		dac_gen_p = func_p;
+	}
+	return dac_start(rate);
+}
+
+/**
+ * @brief Queues a buffer of 8 or 16 bits samples.
+ */
+static bool dac_queue(const void *buffer, bool wide, uint32_t len){
+	if((buffer == NULL) || (len == 0) || (__atomic_load_n(&dac_next_buf, __ATOMIC_ACQUIRE) != NULL)){
+		return false;
+	}
+	dac_next_len = len;
+	dac_next_wide = wide;
+	__atomic_store_n(&dac_next_buf, buffer, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief (Re)creates the calibration scheme for the current attenuation and fills the calibration table.
+ */
+static void adc_cali_update(void){
+	if(adc_calibration != NULL){
+		adc_cali_delete_scheme_curve_fitting(adc_calibration);
+		adc_calibration = NULL;
+	}
+	adc_cali_curve_fitting_config_t cali_config = {
+		.unit_id = ADC_UNIT_1,
+		.atten = adc_attenuation,
+		.bitwidth = ADC_BITWIDTH,
+	};
+	adc_cali_create_scheme_curve_fitting(&cali_config, &adc_calibration);
+	for(int raw = 0; raw < ADC_RAW_VALUES; raw++){
+		int volt = 0;
+		adc_cali_raw_to_voltage(adc_calibration, raw, &volt);
+		adc_cali_lut[raw] = volt;
+	}
+}
 
 /*==================[external functions definition]==========================*/
 
 void AnalogInputInit(analog_input_config_t *config){
 	
+	// create calibration curve and table
+	if(adc_calibration == NULL){
+		adc_cali_update();
+	}
 	// config adc channels
 	switch(config->mode){
 		case ADC_SINGLE:
-			// create calibration curve
-			adc_cali_curve_fitting_config_t cali_config_1 = {
-				.unit_id = ADC_UNIT_1,
-				.atten = ADC_ATTENUATION,
-				.bitwidth = ADC_BITWIDTH,
-			};
-			adc_cali_create_scheme_curve_fitting(&cali_config_1, &adc_calibration_single);
+		case ADC_TIMED:
         	if(!adc1_single_used){
 				adc_oneshot_new_unit(&init_config_single, &adc1_single);
 				adc1_single_used = true;
@@ -72,27 +850,62 @@ void AnalogInputInit(analog_input_config_t *config){
     				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_3, &adc_config_single);
 				break;
 			}
+			adc_single_configured |= (1 << config->input);
 		break;
 		case ADC_CONTINUOUS:
-			switch(config->input){
-				case CH0:
-
-				break;
-				case CH1:
-
-				break;
-				case CH2:
-
-				break;
-				case CH3:
-
-				break;
+			if(adc1_cont == NULL){
+				adc_continuous_handle_cfg_t handle_config = {
+					.max_store_buf_size = ADC_POOL_SIZE,
+					.conv_frame_size = ADC_CONV_FRAME_SIZE,
+					.flags.flush_pool = true,
+				};
+				adc_continuous_new_handle(&handle_config, &adc1_cont);
+				adc_continuous_evt_cbs_t cbs = {
+					.on_conv_done = adc_conv_done_isr,
+				};
+				adc_continuous_register_event_callbacks(adc1_cont, &cbs, NULL);
 			}
 		break;
 	}
+	// config channel buffers for continuous and timed modes
+	if(config->mode != ADC_SINGLE){
+		if(adc_cont_configured == 0){
+			for(uint8_t ch = 0; ch < ADC_CHANNELS; ch++){
+				RingBufferInit(&adc_ring[ch], adc_ring_data[ch], ADC_RING_SIZE);
+			}
+		}
+		if((config->mode == ADC_TIMED) && !adc_timer_initialized){
+			adc_timer = config->timer;
+			timer_config_t timer_cfg = {
+				.timer = adc_timer,
+				.period = US_PER_S / (config->sample_frec ? config->sample_frec : 1),
+				.func_p = adc_timer_isr,
+				.param_p = NULL,
+			};
+			TimerInit(&timer_cfg);
+			adc_timer_initialized = true;
+		}
+		adc_cont_isr_p[config->input] = config->func_p;
+		adc_cont_user_data[config->input] = config->param_p;
+		adc_cont_sample_frec = config->sample_frec;
+		adc_cont_mode = config->mode;
+		adc_block_size = config->block_size;
+		adc_os_shift = (config->oversampling > ADC_OVERSAMPLING_MAX) ? ADC_OVERSAMPLING_MAX : config->oversampling;
+		adc_os_dither = config->dither;
+		adc_cont_configured |= (1 << config->input);
+	}
 }
 
 void AnalogOutputInit(void){
+	AnalogOutputStop();
+	if(dac_pwm){
+		PWMDeinit(DAC_PWM_OUT);
+		dac_pwm = false;
+	}
+	if(dac != NULL){
+		dac_bits = 8;
+		return;
+	}
 	sdm_config_t dac_config = {
 		.clk_src = SDM_CLK_SRC_DEFAULT,
 		.sample_rate_hz = 1 * 1000 * 1000,
@@ -100,46 +913,382 @@ void AnalogOutputInit(void){
 	};
 	sdm_new_channel(&dac_config, &dac);
 	sdm_channel_enable(dac);
+	dac_bits = 8;
+}
+
+uint8_t AnalogOutputInitPWM(uint32_t bandwidth, uint8_t filter_order){
+	if((bandwidth == 0) || (filter_order == 0)){
+		return 0;
+	}
+	/* highest resolution whose ripple after the filter is below 1 LSB */
+	uint8_t bits = PWM_MAX_BITS;
+	while((bits > DAC_PWM_MIN_BITS) && 
+		(filter_order * log2((double)(PWM_CLK_HZ >> bits) / bandwidth) < bits)){
+		bits--;
+	}
+	AnalogOutputStop();
+	if(dac != NULL){
+		sdm_channel_disable(dac);
+		sdm_del_channel(dac);
+		dac = NULL;
+	}
+	if(PWMInitResolution(DAC_PWM_OUT, GPIO_0, bits) == 0){
+		dac_pwm = false;
+		dac_bits = 0;
+		return 0;
+	}
+	dac_pwm = true;
+	dac_bits = bits;
+	return bits;
 }
 
 void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value){
+	int raw = 0;
 	switch(channel){
 		case CH0:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_0, (int*)value);
+			adc_oneshot_read(adc1_single, ADC_CHANNEL_0, &raw);
 		break;
 		case CH1:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_1, (int*)value);
+			adc_oneshot_read(adc1_single, ADC_CHANNEL_1, &raw);
 		break;
 		case CH2:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_2, (int*)value);
+			adc_oneshot_read(adc1_single, ADC_CHANNEL_2, &raw);
 		break;
 		case CH3:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_3, (int*)value);
+			adc_oneshot_read(adc1_single, ADC_CHANNEL_3, &raw);
 		break;
 	}
+	*value = raw;
 }
 
 void AnalogStartContinuous(adc_ch_t channel){
-
+	if(!(adc_cont_configured & (1 << channel)) || (adc_cont_active & (1 << channel))){
+		return;
+	}
+	adc_cont_active |= (1 << channel);
+	adc_scan_config();
 }
 
 void AnalogStopContinuous(adc_ch_t channel){
+	if(!(adc_cont_active & (1 << channel))){
+		return;
+	}
+	adc_cont_active &= ~(1 << channel);
+	adc_scan_config();
+}
+
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values, uint16_t nvalues){
+	uint8_t ch = channel;
+	if(adc_trig_set && (ch == adc_trig_ch)){
+		return 0;
+	}
+	return adc_read(&ch, 1, NULL, values, nvalues);
+}
 
+uint16_t AnalogInputReadFrames(uint16_t *frames, uint16_t nframes){
+	return adc_read(adc_store_list, adc_store_len, NULL, frames, nframes);
 }
 
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+uint16_t AnalogInputReadBlock(adc_ch_t channel, analog_block_t *block, uint16_t *values, uint16_t nvalues){
+	uint8_t ch = channel;
+	if(adc_trig_set && (ch == adc_trig_ch)){
+		return 0;
+	}
+	return adc_read(&ch, 1, block, values, nvalues);
+}
+
+uint16_t AnalogInputReadFramesBlock(analog_block_t *block, uint16_t *frames, uint16_t nframes){
+	return adc_read(adc_store_list, adc_store_len, block, frames, nframes);
+}
 
+uint32_t AnalogInputGetDropped(void){
+	return adc_dropped;
+}
+
+uint8_t AnalogGetScanChannels(adc_ch_t *channels){
+	if(channels != NULL){
+		for(uint8_t k = 0; k < adc_store_len; k++){
+			channels[k] = adc_store_list[k];
+		}
+	}
+	return adc_store_len;
+}
+
+bool AnalogSetAttenuation(analog_atten_t atten){
+	const adc_atten_t atten_map[] = {ADC_ATTEN_DB_0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_11};
+	if((uint32_t)atten >= sizeof(atten_map) / sizeof(atten_map[0])){
+		return false;
+	}
+	adc_attenuation = atten_map[atten];
+	adc_config_single.atten = adc_attenuation;
+	for(uint8_t ch = 0; ch < ADC_CHANNELS; ch++){
+		if(adc_single_configured & (1 << ch)){
+			adc_oneshot_config_channel(adc1_single, adc_channel_map[ch], &adc_config_single);
+		}
+	}
+	adc_cali_update();
+	if(adc_cont_active){
+		adc_scan_config();
+	}
+	return true;
 }
 
 uint16_t AnalogRaw2mV(uint16_t value){
-	uint16_t volt;
-	adc_cali_raw_to_voltage(adc_calibration_single, value, (int*)&volt);
-	return volt;
+	return adc_cali_lut[value & (ADC_RAW_VALUES - 1)];
+}
+
+void AnalogRaw2mVBatch(const uint16_t *raw, uint16_t *mv, uint32_t n){
+	const uint16_t *lut = adc_cali_lut;
+	uint32_t i = 0;
+	/* unrolled by 4: loads are issued before stores so in place convertion is safe */
+	for(; i + 4 <= n; i += 4){
+		uint16_t r0 = raw[i];
+		uint16_t r1 = raw[i + 1];
+		uint16_t r2 = raw[i + 2];
+		uint16_t r3 = raw[i + 3];
+		mv[i] = lut[r0 & (ADC_RAW_VALUES - 1)];
+		mv[i + 1] = lut[r1 & (ADC_RAW_VALUES - 1)];
+		mv[i + 2] = lut[r2 & (ADC_RAW_VALUES - 1)];
+		mv[i + 3] = lut[r3 & (ADC_RAW_VALUES - 1)];
+	}
+	for(; i < n; i++){
+		mv[i] = lut[raw[i] & (ADC_RAW_VALUES - 1)];
+	}
+}
+
+bool AnalogMonitorInit(analog_monitor_config_t *config){
+	uint8_t ch = config->input;
+	if((adc1_cont == NULL) || (adc_monitor[ch] != NULL) || (config->low_threshold > config->high_threshold)){
+		return false;
+	}
+	/* monitors can only be created while convertion is stopped */
+	bool restart = adc_scan_running && (adc_scan_running_mode == ADC_CONTINUOUS);
+	if(restart){
+		adc_continuous_stop(adc1_cont);
+		adc_scan_running = false;
+	}
+	adc_monitor_config_t monitor_config = {
+		.adc_unit = ADC_UNIT_1,
+		.channel = adc_channel_map[ch],
+		.h_threshold = adc_mv2raw(config->high_threshold),
+		.l_threshold = adc_mv2raw(config->low_threshold),
+	};
+	adc_monitor_evt_cbs_t cbs = {
+		.on_over_high_thresh = adc_monitor_high_isr,
+		.on_below_low_thresh = adc_monitor_low_isr,
+	};
+	adc_monitor_isr_p[ch] = config->func_p;
+	adc_monitor_user_data[ch] = config->param_p;
+	adc_monitor_above[ch] = false;
+	/* the IDF takes the lowest free hardware monitor (only this driver creates them) */
+	uint8_t used = 0;
+	for(uint8_t i = 0; i < ADC_CHANNELS; i++){
+		if(adc_monitor[i] != NULL){
+			used |= 1 << adc_monitor_id[i];
+		}
+	}
+	uint8_t id = 0;
+	while(used & (1 << id)){
+		id++;
+	}
+	adc_monitor_id[ch] = id;
+	bool ok = (adc_new_continuous_monitor(adc1_cont, &monitor_config, &adc_monitor[ch]) == ESP_OK);
+	if(ok){
+		adc_continuous_monitor_register_event_callbacks(adc_monitor[ch], &cbs, (void*)(uintptr_t)ch);
+		adc_continuous_monitor_enable(adc_monitor[ch]);
+		/* the driver enables both thresholds: wait for the high one only */
+		adc_monitor_arm(ch);
+	}else{
+		adc_monitor[ch] = NULL;
+	}
+	if(restart){
+		adc_scan_config();
+	}
+	return ok;
+}
+
+void AnalogMonitorDeinit(adc_ch_t channel){
+	if(adc_monitor[channel] == NULL){
+		return;
+	}
+	adc_continuous_monitor_disable(adc_monitor[channel]);
+	adc_del_continuous_monitor(adc_monitor[channel]);
+	adc_monitor[channel] = NULL;
+}
+
+bool AnalogMonitorIsAbove(adc_ch_t channel){
+	return adc_monitor_above[channel];
+}
+
+bool AnalogTriggerInit(analog_trigger_config_t *config){
+	uint8_t ch = config->input;
+	if(!(adc_cont_configured & (1 << ch)) || (config->buffer == NULL) || (config->post_trigger == 0)
+		|| ((uint32_t)config->pre_trigger + config->post_trigger > UINT16_MAX)
+		|| (config->slope == 0) || (config->slope > ANALOG_TRIGGER_BOTH)){
+		return false;
+	}
+	uint16_t low = (config->level > config->hysteresis) ? config->level - config->hysteresis : 0;
+	uint16_t high = (config->level + config->hysteresis < UINT16_MAX) ? config->level + config->hysteresis : UINT16_MAX;
+	adc_trig_set = false;
+	adc_trig_state = ADC_TRIG_IDLE;
+	adc_trig_ch = ch;
+	adc_trig_slope = config->slope;
+	/* thresholds at the resolution of the stored samples (12 + oversampling bits) */
+	adc_trig_level = adc_mv2raw(config->level) << adc_os_shift;
+	adc_trig_rearm_low = adc_mv2raw(low) << adc_os_shift;
+	adc_trig_rearm_high = adc_mv2raw(high) << adc_os_shift;
+	adc_trig_buf = config->buffer;
+	adc_trig_pre = config->pre_trigger;
+	adc_trig_post = config->post_trigger;
+	adc_trig_holdoff = config->holdoff;
+	adc_trig_single = config->single;
+	adc_trig_isr_p = config->func_p;
+	adc_trig_user_data = config->param_p;
+	adc_trig_seq = 0;
+	adc_trig_done = false;
+	adc_trig_set = true;
+	/* the channel leaves (or enters) the buffers: restart the scan, which also arms the trigger */
+	adc_scan_config();
+	return true;
+}
+
+void AnalogTriggerDeinit(void){
+	if(!adc_trig_set){
+		return;
+	}
+	adc_trig_set = false;
+	adc_trig_state = ADC_TRIG_IDLE;
+	adc_scan_config();
+}
+
+void AnalogTriggerArm(void){
+	if(!adc_trig_set){
+		return;
+	}
+	adc_trig_done = false;
+	if(adc_cont_active & (1 << adc_trig_ch)){
+		adc_trigger_arm();
+	}
+}
+
+bool AnalogTriggerIsReady(void){
+	return adc_trig_state == ADC_TRIG_READY;
+}
+
+uint16_t AnalogTriggerRead(analog_capture_t *capture, uint16_t *values, uint16_t nvalues){
+	if(__atomic_load_n(&adc_trig_state, __ATOMIC_ACQUIRE) != ADC_TRIG_READY){
+		return 0;
+	}
+	/* the interrupt does not touch the window until it is armed again */
+	uint16_t n = 0;
+	uint16_t rd = adc_trig_wr;		/* oldest pre-trigger sample (the buffer was full) */
+	for(uint16_t i = 0; (i < adc_trig_pre) && (n < nvalues); i++){
+		values[n++] = adc_trig_buf[rd];
+		rd = (rd + 1 == adc_trig_pre) ? 0 : rd + 1;
+	}
+	for(uint16_t i = 0; (i < adc_trig_post) && (n < nvalues); i++){
+		values[n++] = adc_trig_buf[adc_trig_pre + i];
+	}
+	if(capture != NULL){
+		capture->timestamp = adc_index2time(adc_trig_index);
+		capture->index = adc_trig_index;
+		capture->sequence = adc_trig_seq - 1;
+		capture->sample_frec = adc_out_rate;
+		capture->trigger = adc_trig_pre;
+		capture->len = n;
+		capture->rising = adc_trig_rising;
+	}
+	if(adc_trig_single){
+		adc_trig_done = true;
+		adc_trig_state = ADC_TRIG_IDLE;
+	}else{
+		adc_trigger_arm();
+	}
+	return n;
+}
+
+uint32_t AnalogOversampled2uV(uint16_t value, uint8_t oversampling){
+	uint32_t raw = value >> oversampling;
+	uint32_t frac = value & ((1 << oversampling) - 1);
+	uint32_t low = adc_cali_lut[raw & (ADC_RAW_VALUES - 1)] * 1000;
+	if(raw >= ADC_RAW_VALUES - 1){
+		return low;
+	}
+	uint32_t high = adc_cali_lut[raw + 1] * 1000;
+	if(high <= low){
+		return low;
+	}
+	return low + (((high - low) * frac) >> oversampling);
 }
 
 void AnalogOutputWrite(uint8_t value){
-	int8_t density = value - 128;
-	sdm_channel_set_pulse_density(dac, density);
+	dac_write(value * 257);
+}
+
+void AnalogOutputWrite16(uint16_t value){
+	dac_write(value);
+}
+
+uint8_t AnalogOutputGetResolution(void){
+	return dac_bits;
+}
+
+bool AnalogOutputPlay(const uint8_t *buffer, uint32_t len, uint32_t rate, bool loop){
+	return dac_play(buffer, false, len, rate, loop);
+}
+
+bool AnalogOutputPlay16(const uint16_t *buffer, uint32_t len, uint32_t rate, bool loop){
+	return dac_play(buffer, true, len, rate, loop);
+}
+
+bool AnalogOutputGenerate(uint32_t rate, void *func_p, void *param_p){
+	return dac_generate(rate, func_p, false, param_p);
+}
+
+bool AnalogOutputGenerate16(uint32_t rate, void *func_p, void *param_p){
+	return dac_generate(rate, func_p, true, param_p);
+}
+
+bool AnalogOutputStream(uint32_t rate, void *func_p, void *param_p){
+	if((dac_bits == 0) || (rate == 0) || (rate > DAC_PLAY_MAX_RATE)){
+		return false;
+	}
+	const void *first = dac_next_buf;
+	AnalogOutputStop();
+	dac_next_buf = first;
+	dac_play_buf = NULL;
+	dac_play_loop = false;
+	dac_streaming = true;
+	dac_stream_isr_p = func_p;
+	dac_stream_user_data = param_p;
+	return dac_start(rate);
+}
+
+bool AnalogOutputQueue(const uint8_t *buffer, uint32_t len){
+	return dac_queue(buffer, false, len);
+}
+
+bool AnalogOutputQueue16(const uint16_t *buffer, uint32_t len){
+	return dac_queue(buffer, true, len);
+}
+
+void AnalogOutputStop(void){
+	if(dac_playing){
+		TimerStop(DAC_TIMER);
+		dac_playing = false;
+	}
+	dac_play_buf = NULL;
+	dac_next_buf = NULL;
+	dac_gen_p = NULL;
+	dac_gen16_p = NULL;
+}
+
+bool AnalogOutputIsPlaying(void){
+	return dac_playing;
+}
+
+void AnalogOutputGetStats(analog_output_stats_t *stats){
+	*stats = dac_stats;
 }
 
 /** @} doxygen end group definition */
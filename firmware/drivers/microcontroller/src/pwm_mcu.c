@@ -12,14 +12,19 @@
 /*==================[inclusions]=============================================*/
 #include "pwm_mcu.h"
 #include "driver/ledc.h"
+#include "hal/ledc_ll.h"
+#include "esp_attr.h"
+#include "soc/soc_caps.h"
 /*==================[macros and definitions]=================================*/
-#define DC_MAX  1023
 #define DC_100  100
+#define DEFAULT_BITS    10
+#define MAX_DIV         1024    /*!< LEDC timers divide their clock by less than 1024 */
 /*==================[internal data declaration]==============================*/
+static uint8_t pwm_bits[] = {DEFAULT_BITS, DEFAULT_BITS, DEFAULT_BITS, DEFAULT_BITS};  /*!< Duty resolution of each output */
 static ledc_timer_config_t pwm_timer_cfg = {
     .speed_mode       = LEDC_LOW_SPEED_MODE,
     .duty_resolution  = LEDC_TIMER_10_BIT,
-    .clk_cfg          = LEDC_AUTO_CLK
+    .clk_cfg          = LEDC_USE_PLL_DIV_CLK    /*!< All timers share one clock: the one of PWMInitResolution() */
 };
 static ledc_channel_config_t ledc_channel_cfg = {
     .speed_mode     = LEDC_LOW_SPEED_MODE,
@@ -37,6 +42,12 @@ static ledc_channel_config_t ledc_channel_cfg = {
 
 /*==================[external functions definition]==========================*/
 uint8_t PWMInit(pwm_out_t out, gpio_t gpio, uint16_t freq){
+    /* low frequencies need more counts per period to keep the clock divider in range */
+    uint8_t bits = DEFAULT_BITS;
+    while(((uint64_t)MAX_DIV * ((uint64_t)freq << bits) <= PWM_CLK_HZ) && (bits < SOC_LEDC_TIMER_BIT_WIDTH)){
+        bits++;
+    }
+    pwm_timer_cfg.duty_resolution = bits;
     switch(out){
         case PWM_0:
             pwm_timer_cfg.freq_hz = freq;
@@ -75,9 +86,48 @@ uint8_t PWMInit(pwm_out_t out, gpio_t gpio, uint16_t freq){
             ledc_channel_config(&ledc_channel_cfg);
             break;
     }
+    pwm_bits[out] = bits;
     return 0;
 }
 
+uint32_t PWMInitResolution(pwm_out_t out, gpio_t gpio, uint8_t bits){
+    if((bits == 0) || (bits > PWM_MAX_BITS)){
+        return 0;
+    }
+    ledc_timer_config_t timer_cfg = {
+        .speed_mode       = LEDC_LOW_SPEED_MODE,
+        .duty_resolution  = bits,
+        .freq_hz          = PWM_CLK_HZ >> bits,
+        .clk_cfg          = LEDC_USE_PLL_DIV_CLK
+    };
+    switch(out){
+        case PWM_0:
+            timer_cfg.timer_num = LEDC_TIMER_0;
+            ledc_channel_cfg.channel = LEDC_CHANNEL_0;
+            break;
+        case PWM_1:
+            timer_cfg.timer_num = LEDC_TIMER_1;
+            ledc_channel_cfg.channel = LEDC_CHANNEL_1;
+            break;
+        case PWM_2:
+            timer_cfg.timer_num = LEDC_TIMER_2;
+            ledc_channel_cfg.channel = LEDC_CHANNEL_2;
+            break;
+        case PWM_3:
+            timer_cfg.timer_num = LEDC_TIMER_3;
+            ledc_channel_cfg.channel = LEDC_CHANNEL_3;
+            break;
+    }
+    if(ledc_timer_config(&timer_cfg) != ESP_OK){
+        return 0;
+    }
+    ledc_channel_cfg.timer_sel = timer_cfg.timer_num;
+    ledc_channel_cfg.gpio_num = gpio;
+    ledc_channel_config(&ledc_channel_cfg);
+    pwm_bits[out] = bits;
+    return timer_cfg.freq_hz;
+}
+
 void PWMOn(pwm_out_t out){
     switch(out){
         case PWM_0:
@@ -116,7 +166,7 @@ void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle){
     if(duty_cycle > DC_100){
         duty_cycle = DC_100;
     }
-    uint32_t dc = ((uint32_t)duty_cycle * DC_MAX) / DC_100;
+    uint32_t dc = ((uint32_t)duty_cycle * ((1 << pwm_bits[out]) - 1)) / DC_100;
     switch(out){
         case PWM_0:
             ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, dc);
@@ -137,6 +187,15 @@ void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle){
     }
 }
 
+void IRAM_ATTR PWMSetDuty(pwm_out_t out, uint32_t duty){
+    /* LEDC LL instead of ledc_set_duty() and ledc_update_duty(), which take a lock and are not 
+    in IRAM: the fade parameters set by ledc_channel_config() are kept, only the duty changes */
+    ledc_channel_t channel = (ledc_channel_t)out;
+    ledc_ll_set_duty_int_part(LEDC_LL_GET_HW(), LEDC_LOW_SPEED_MODE, channel, duty);
+    ledc_ll_set_duty_start(LEDC_LL_GET_HW(), LEDC_LOW_SPEED_MODE, channel, true);
+    ledc_ll_ls_channel_update(LEDC_LL_GET_HW(), LEDC_LOW_SPEED_MODE, channel);
+}
+
 uint8_t PWMSetFreq(pwm_out_t out, uint32_t freq){
     switch(out){
         case PWM_0:
@@ -15,128 +15,638 @@
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
 /*==================[macros and definitions]=================================*/
 #define UART_CONN_TX        GPIO_18         /*!<  */
 #define UART_CONN_RX        GPIO_19         /*!<  */
-#define TX_BUFFER_SIZE      256             /*!<  */
-#define RX_BUFFER_SIZE      256             /*!<  */
+#define TX_BUFFER_SIZE      2048            /*!< Default transmit ring buffer, drained by the TX FIFO empty interrupt (holds 2 ticks at 921600 baud) */
+#define TX_ITEM_HEADER      8               /*!< Header of each item of the transmit ring buffer (IDF NOSPLIT ring buffer) */
+#define TX_EVENT_LEN        12              /*!< uart_tx_data_t item stored before the data of each write */
+#define TX_PENDING_MAX      16              /*!< Writes in the transmit ring buffer accounted one by one (older ones are merged) */
+#define UART_FRAME_BITS     10              /*!< Bits per byte on the line (8N1) */
+#define RX_BUFFER_SIZE      256             /*!< Default receive buffer */
+#define UART_FIFO_LEN       128             /*!< Hardware FIFO size (driver buffers must be larger) */
+#define RTS_THRESHOLD       96              /*!< Default RX FIFO level that deasserts RTS (3/4 of the FIFO) */
 #define EVENT_QUEUE_SIZE    16              /*!<  */
+#define PATTERN_QUEUE_SIZE  16              /*!< Line ends remembered before they are read */
+#define EVENT_TASK_STACK    3072            /*!< Event task stack (line callbacks run on it) */
 #define READ_TIMEOUT        100             /*!<  */
+#define UART_PORTS          2               /*!< Ports of the ESP-EDU */
 /*==================[internal data declaration]==============================*/
-void (*uart_pc_isr_p)(void*);	            /*!<  */
-void (*uart_conn_isr_p)(void*);	            /*!<  */
-void *uart_pc_user_data;	                /*!<  */
-void *uart_conn_user_data;	                /*!<  */
-static QueueHandle_t uart_pc_queue;         /*!<  */
-static QueueHandle_t uart_conn_queue;       /*!<  */
+/**
+ * @brief A write that may still be in the transmit ring buffer
+ */
+typedef struct {
+    uint32_t data;                          /*!< Data bytes */
+    uint32_t ring;                          /*!< Ring buffer bytes of its items */
+    uint32_t item;                          /*!< Ring buffer bytes of its largest item */
+} uart_tx_write_t;
+
+/**
+ * @brief Per-port state
+ */
+typedef struct {
+    void (*func_p)(void*);                  /*!< Data received callback */
+    uart_line_func_t line_func_p;           /*!< Line received callback (line mode) */
+    void *param_p;                          /*!< Callbacks parameter */
+    QueueHandle_t queue;                    /*!< Driver event queue */
+    uint32_t baud_rate;                     /*!< Baud rate (estimates the TX drain time) */
+    uint32_t tx_size;                       /*!< Transmit buffer size */
+    SemaphoreHandle_t tx_lock;              /*!< Held by writes and flushes, so the IDF tx_mux is never contended */
+    uart_tx_write_t tx_pending[TX_PENDING_MAX]; /*!< Writes that may still be in the ring buffer, oldest first (with tx_lock) */
+    uint8_t tx_first;                       /*!< Oldest write of tx_pending */
+    uint8_t tx_count;                       /*!< Writes in tx_pending */
+    uint32_t tx_data;                       /*!< Data bytes of tx_pending */
+    uint32_t tx_ring;                       /*!< Ring buffer bytes of tx_pending */
+    char line[UART_LINE_MAX + 2];           /*!< Line given to line_func_p (read with its "\r\n") */
+    bool line_cut;                          /*!< Received data discarded: up to the next line end is the rest of a line */
+    uint8_t *rx_ring;                       /*!< Receive stream storage (NULL: no stream) */
+    uint32_t rx_mask;                       /*!< Receive stream size - 1 */
+    uint32_t rx_head;                       /*!< Free running write index (only modified by the event task) */
+    uint32_t rx_tail;                       /*!< Free running read index (only modified by the reader) */
+    uint32_t rx_discard;                    /*!< Data before this index was received before an overflow: skipped by the reader */
+    bool rx_stalled;                        /*!< Stream full, data left in the driver buffer */
+    SemaphoreHandle_t rx_ready;             /*!< Given when the stream receives data */
+    uart_stats_t stats;                     /*!< Counters */
+    uart_watermark_config_t watermark;      /*!< Watermarks (callback NULL: disabled) */
+    bool rx_high;                           /*!< Receive backlog above its high watermark */
+    bool tx_high;                           /*!< Transmit backlog above its high watermark */
+} uart_state_t;
+
+static uart_state_t uart_state[UART_PORTS]; /*!< Indexed by IDF port number */
 /*==================[internal functions declaration]=========================*/
+static uart_port_t uart_mcu_num(uart_mcu_port_t port);
+static uint32_t uart_tx_item(uint32_t len);
+static uint32_t uart_tx_chunk(uint32_t tx_size);
+static uint32_t uart_tx_ring(uint32_t tx_size, uint32_t nbytes);
+static uint32_t uart_tx_update(uart_port_t uart_num);
+static uint32_t uart_tx_room(uart_port_t uart_num, uint32_t nbytes);
+static void uart_tx_add(uart_port_t uart_num, uint32_t nbytes);
+static uint32_t uart_write_available(uart_port_t uart_num, const uint8_t *data, uint32_t nbytes, TickType_t ticks);
+static void uart_rx_reset(uart_port_t uart_num);
+static void uart_rx_config(uart_port_t uart_num, const serial_config_t *port_config);
+static void uart_read_lines(uart_port_t uart_num);
+static void uart_read_stream(uart_port_t uart_num);
+static void uart_event_task(void *pvParameters);
+static int uart_read(uart_port_t uart_num, void *data, uint32_t nbytes, TickType_t ticks);
+static uint32_t uart_rx_level(uart_port_t uart_num);
+static uint32_t uart_rx_skip(uart_port_t uart_num);
+static void uart_check_watermark(uart_port_t uart_num, uart_watermark_t buffer, uint32_t level);
+static void uart_check_rx(uart_port_t uart_num);
+static void uart_check_tx(uart_port_t uart_num);
+static void uart_line_config(uart_config_t *uart_config, const serial_config_t *port_config);
 
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
-static void uart_pc_event_task(void *pvParameters){
-    uart_event_t event;
-    uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_pc_queue, 0);
-    while(1){
-        //Waiting for UART event.
-        if (xQueueReceive(uart_pc_queue, (void *)&event, (TickType_t)portMAX_DELAY)){
-            switch(event.type) {
-                case UART_DATA:
-                    uart_pc_isr_p(uart_pc_user_data);
-                    break;
-                case UART_BREAK:
-                    break;
-                case UART_BUFFER_FULL:
-                    break;
-                case UART_FIFO_OVF:
-                    break;
-                case UART_FRAME_ERR:
-                    break;
-                case UART_PARITY_ERR:
-                    break;
-                case UART_DATA_BREAK:
-                    break;
-                case UART_PATTERN_DET:
-                    break;
-                case UART_WAKEUP:
-                    break;
-                case UART_EVENT_MAX:
+/**
+ * @brief IDF port number of an ESP-EDU port
+ */
+static uart_port_t uart_mcu_num(uart_mcu_port_t port){
+    return (port == UART_CONNECTOR) ? UART_NUM_1 : UART_NUM_0;
+}
+
+/**
+ * @brief Driver read, counting the bytes received
+ */
+static int uart_read(uart_port_t uart_num, void *data, uint32_t nbytes, TickType_t ticks){
+    int read = uart_read_bytes(uart_num, data, nbytes, ticks);
+    if(read > 0){
+        __atomic_fetch_add(&uart_state[uart_num].stats.bytes_in, read, __ATOMIC_RELAXED);
+    }
+    return read;
+}
+
+/**
+ * @brief Bytes received and not read yet (driver buffer and receive stream)
+ */
+static uint32_t uart_rx_level(uart_port_t uart_num){
+    uart_state_t *state = &uart_state[uart_num];
+    size_t buffered = 0;
+    uart_get_buffered_data_len(uart_num, &buffered);
+    if(state->rx_ring != NULL){
+        uint32_t head = __atomic_load_n(&state->rx_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = __atomic_load_n(&state->rx_tail, __ATOMIC_ACQUIRE);
+        uint32_t discard = __atomic_load_n(&state->rx_discard, __ATOMIC_ACQUIRE);
+        buffered += head - (((int32_t)(discard - tail) > 0) ? discard : tail);
+    }
+    return buffered;
+}
+
+/**
+ * @brief Reader side: skips the receive stream data received before the last overflow, so 
+ * views never join bytes across the gap.
+ * 
+ * @return uint32_t Read index after the skip
+ */
+static uint32_t uart_rx_skip(uart_port_t uart_num){
+    uart_state_t *state = &uart_state[uart_num];
+    uint32_t tail = state->rx_tail;
+    uint32_t discard = __atomic_load_n(&state->rx_discard, __ATOMIC_ACQUIRE);
+    if((int32_t)(discard - tail) <= 0){
+        return tail;
+    }
+    __atomic_store_n(&state->rx_tail, discard, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&state->rx_stalled, __ATOMIC_SEQ_CST)){
+        /* wake the event task to move the data waiting in the driver buffer */
+        uart_event_t event = {.type = UART_DATA};
+        xQueueSend(state->queue, &event, 0);
+    }
+    return discard;
+}
+
+/**
+ * @brief Calls the watermark callback when the backlog crosses the high watermark upwards, or 
+ * the low one downwards (each crossing is reported once, from whichever task sees it first).
+ */
+static void uart_check_watermark(uart_port_t uart_num, uart_watermark_t buffer, uint32_t level){
+    uart_state_t *state = &uart_state[uart_num];
+    uart_watermark_config_t *wm = &state->watermark;
+    bool *above = (buffer == UART_WATERMARK_RX) ? &state->rx_high : &state->tx_high;
+    uint32_t high = (buffer == UART_WATERMARK_RX) ? wm->rx_high : wm->tx_high;
+    uint32_t low = (buffer == UART_WATERMARK_RX) ? wm->rx_low : wm->tx_low;
+    if((wm->func_p == NULL) || (high == 0)){
+        return;
+    }
+    if((level >= high) && !__atomic_exchange_n(above, true, __ATOMIC_ACQ_REL)){
+        wm->func_p((uart_num == UART_NUM_1) ? UART_CONNECTOR : UART_PC, buffer, true, wm->param_p);
+    }else if((level <= low) && __atomic_exchange_n(above, false, __ATOMIC_ACQ_REL)){
+        wm->func_p((uart_num == UART_NUM_1) ? UART_CONNECTOR : UART_PC, buffer, false, wm->param_p);
+    }
+}
+
+static void uart_check_rx(uart_port_t uart_num){
+    uint32_t level = uart_rx_level(uart_num);
+    uart_stats_t *stats = &uart_state[uart_num].stats;
+    if(level > stats->rx_peak){
+        stats->rx_peak = level;
+    }
+    uart_check_watermark(uart_num, UART_WATERMARK_RX, level);
+}
+
+static void uart_check_tx(uart_port_t uart_num){
+    uint32_t size = uart_state[uart_num].tx_size;
+    size_t free = size;
+    if(uart_state[uart_num].watermark.func_p == NULL){
+        return;
+    }
+    uart_get_tx_buffer_free_size(uart_num, &free);
+    uart_check_watermark(uart_num, UART_WATERMARK_TX, (free < size) ? size - free : 0);
+}
+
+/**
+ * @brief Transmit ring buffer bytes of an item of len data bytes (header, aligned to 4 bytes)
+ */
+static uint32_t uart_tx_item(uint32_t len){
+    return TX_ITEM_HEADER + ((len + 3) & ~3u);
+}
+
+/**
+ * @brief Largest data item of a write: uart_write_bytes() splits the data in items of half the 
+ * largest item of a NOSPLIT ring buffer (xRingbufferGetMaxItemSize())
+ */
+static uint32_t uart_tx_chunk(uint32_t tx_size){
+    return ((((tx_size / 2) + 3) & ~3u) - TX_ITEM_HEADER) / 2;
+}
+
+/**
+ * @brief Transmit ring buffer bytes of a write: its uart_tx_data_t item and its data items
+ */
+static uint32_t uart_tx_ring(uint32_t tx_size, uint32_t nbytes){
+    uint32_t chunk = uart_tx_chunk(tx_size);
+    uint32_t rest = nbytes % chunk;
+    return uart_tx_item(TX_EVENT_LEN) + (nbytes / chunk) * uart_tx_item(chunk) + (rest ? uart_tx_item(rest) : 0);
+}
+
+/**
+ * @brief Forgets the writes that have left the transmit ring buffer (with tx_lock held)
+ * 
+ * @note The IDF driver reports the free size in data bytes. Writes leave the ring buffer in 
+ * order, so those whose data is not among the bytes still waiting are gone.
+ * 
+ * @return uint32_t Data bytes waiting in the ring buffer
+ */
+static uint32_t uart_tx_update(uart_port_t uart_num){
+    uart_state_t *state = &uart_state[uart_num];
+    size_t free = 0;
+    if(uart_get_tx_buffer_free_size(uart_num, &free) != ESP_OK){
+        free = 0;
+    }
+    uint32_t waiting = (free < state->tx_size) ? state->tx_size - free : 0;
+    while((state->tx_count > 0) && (state->tx_data - state->tx_pending[state->tx_first].data >= waiting)){
+        uart_tx_write_t *write = &state->tx_pending[state->tx_first];
+        state->tx_data -= write->data;
+        state->tx_ring -= write->ring;
+        state->tx_first = (state->tx_first + 1) % TX_PENDING_MAX;
+        state->tx_count--;
+    }
+    return waiting;
+}
+
+/**
+ * @brief Largest write the transmit ring buffer takes now without waiting (with tx_lock held)
+ * 
+ * @note Each item takes a header and is aligned to 4 bytes, and a NOSPLIT ring buffer never 
+ * splits an item at its end: the space left there by an item that did not fit is lost until 
+ * the item before it is sent (one such gap at a time, smaller than the item).
+ * 
+ * @param nbytes Size of the write (its largest item may not fit at the end)
+ */
+static uint32_t uart_tx_room(uart_port_t uart_num, uint32_t nbytes){
+    uart_state_t *state = &uart_state[uart_num];
+    uint32_t chunk = uart_tx_chunk(state->tx_size);
+    uint32_t waiting = uart_tx_update(uart_num);
+    uint32_t used = state->tx_ring + uart_tx_item(TX_EVENT_LEN);
+    if(waiting > state->tx_data){
+        /* written by others (the console), taken as a single write */
+        used += uart_tx_ring(state->tx_size, waiting - state->tx_data);
+    }
+    uint32_t gap = uart_tx_item((nbytes < chunk) ? nbytes : chunk);
+    for(uint8_t i = 0; i < state->tx_count; i++){
+        uint32_t item = state->tx_pending[(state->tx_first + i) % TX_PENDING_MAX].item;
+        gap = (item > gap) ? item : gap;
+    }
+    if(used + gap >= state->tx_size){
+        return 0;
+    }
+    uint32_t left = state->tx_size - used - gap;
+    uint32_t room = (left / uart_tx_item(chunk)) * chunk;
+    left %= uart_tx_item(chunk);
+    if(left > TX_ITEM_HEADER){
+        room += (left - TX_ITEM_HEADER) & ~3u;
+    }
+    return room;
+}
+
+/**
+ * @brief Accounts a write stored in the transmit ring buffer (with tx_lock held)
+ */
+static void uart_tx_add(uart_port_t uart_num, uint32_t nbytes){
+    uart_state_t *state = &uart_state[uart_num];
+    uint32_t chunk = uart_tx_chunk(state->tx_size);
+    if(state->tx_count == TX_PENDING_MAX){
+        /* the two oldest taken as one: they leave the ring buffer with the second one */
+        uart_tx_write_t *first = &state->tx_pending[state->tx_first];
+        state->tx_first = (state->tx_first + 1) % TX_PENDING_MAX;
+        state->tx_count--;
+        uart_tx_write_t *second = &state->tx_pending[state->tx_first];
+        second->data += first->data;
+        second->ring += first->ring;
+        second->item = (first->item > second->item) ? first->item : second->item;
+    }
+    uart_tx_write_t *write = &state->tx_pending[(state->tx_first + state->tx_count++) % TX_PENDING_MAX];
+    write->data = nbytes;
+    write->ring = uart_tx_ring(state->tx_size, nbytes);
+    write->item = uart_tx_item((nbytes < chunk) ? nbytes : chunk);
+    state->tx_data += nbytes;
+    state->tx_ring += write->ring;
+}
+
+/**
+ * @brief Copies to the transmit ring buffer as many bytes as fit right now, without blocking.
+ * 
+ * @note uart_write_bytes() waits for the IDF tx_mux and for room in the ring buffer with no 
+ * timeout. Every write of this driver holds tx_lock, so the room checked here (uart_tx_room(), 
+ * items included) cannot be taken by another task before the write, and tx_mux is free once 
+ * tx_lock is held.
+ * 
+ * @param ticks Maximum waiting time for another write or flush of the port to finish
+ */
+static uint32_t uart_write_available(uart_port_t uart_num, const uint8_t *data, uint32_t nbytes, TickType_t ticks){
+    uart_state_t *state = &uart_state[uart_num];
+    if((nbytes == 0) || (state->tx_lock == NULL) || (xSemaphoreTake(state->tx_lock, ticks) != pdTRUE)){
+        return 0;
+    }
+    int written = 0;
+    uint32_t room = uart_tx_room(uart_num, nbytes);
+    if(room > 0){
+        written = uart_write_bytes(uart_num, data, (nbytes > room) ? room : nbytes);
+        if(written > 0){
+            uart_tx_add(uart_num, written);
+        }
+    }
+    xSemaphoreGive(state->tx_lock);
+    if(written <= 0){
+        return 0;
+    }
+    __atomic_fetch_add(&state->stats.bytes_out, written, __ATOMIC_RELAXED);
+    uart_check_tx(uart_num);
+    return written;
+}
+
+/**
+ * @brief Line parameters: 8N1, baud rate (up to UART_BAUD_MAX) and flow control
+ */
+static void uart_line_config(uart_config_t *uart_config, const serial_config_t *port_config){
+    uint32_t baud_rate = port_config->baud_rate;
+    if(baud_rate > UART_BAUD_MAX){
+        ESP_LOGW("uart", "%lu baud not supported, %d used", (unsigned long)baud_rate, UART_BAUD_MAX);
+        baud_rate = UART_BAUD_MAX;
+    }
+    uart_hw_flowcontrol_t flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    switch(port_config->flow_ctrl){
+        case UART_FLOW_CTRL_NONE:
+            break;
+        case UART_FLOW_CTRL_RTS:
+            flow_ctrl = UART_HW_FLOWCTRL_RTS;
+            break;
+        case UART_FLOW_CTRL_CTS:
+            flow_ctrl = UART_HW_FLOWCTRL_CTS;
+            break;
+        case UART_FLOW_CTRL_RTS_CTS:
+            flow_ctrl = UART_HW_FLOWCTRL_CTS_RTS;
+            break;
+    }
+    *uart_config = (uart_config_t){
+        .baud_rate = baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = flow_ctrl,
+        .rx_flow_ctrl_thresh = port_config->rts_threshold ? port_config->rts_threshold : RTS_THRESHOLD,
+        /* 80 MHz, enough for UART_BAUD_MAX (16 clocks per bit) */
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+}
+
+/**
+ * @brief Receive interrupt thresholds: the driver gets the FIFO data (UART_DATA event) when 
+ * rx_threshold bytes are in the FIFO, or after rx_timeout idle characters.
+ */
+static void uart_rx_config(uart_port_t uart_num, const serial_config_t *port_config){
+    if(port_config->rx_timeout){
+        uart_set_rx_timeout(uart_num, port_config->rx_timeout);
+    }
+    if(port_config->rx_threshold){
+        uart_set_rx_full_threshold(uart_num, port_config->rx_threshold);
+    }
+}
+
+/**
+ * @brief Discards received data (and the line ends found in it), including the receive stream 
+ * data not viewed yet (the reader skips it, see uart_rx_skip())
+ */
+static void uart_rx_reset(uart_port_t uart_num){
+    uart_flush_input(uart_num);
+    if(uart_state[uart_num].rx_ring != NULL){
+        __atomic_store_n(&uart_state[uart_num].rx_discard, uart_state[uart_num].rx_head, __ATOMIC_RELEASE);
+    }
+    if(uart_state[uart_num].line_func_p != NULL){
+        uart_pattern_queue_reset(uart_num, PATTERN_QUEUE_SIZE);
+        uart_state[uart_num].line_cut = true;
+    }
+    xQueueReset(uart_state[uart_num].queue);
+}
+
+/**
+ * @brief Reads every complete line in the receive buffer and hands it to the line callback.
+ * 
+ * The hardware marks the position of each line end, so lines are read with a single call and 
+ * the task is not woken per byte. Longer lines than UART_LINE_MAX are discarded, and so is the 
+ * rest of a line whose start was discarded by a reset (never handed over as a line).
+ */
+static void uart_read_lines(uart_port_t uart_num){
+    uart_state_t *state = &uart_state[uart_num];
+    int pos;
+    while((pos = uart_pattern_pop_pos(uart_num)) != -1){
+        uint32_t len = pos + 1;             /* line end included */
+        if(state->line_cut || (len > sizeof(state->line))){
+            while(len > 0){
+                uint32_t chunk = (len > UART_LINE_MAX) ? UART_LINE_MAX : len;
+                if(uart_read(uart_num, state->line, chunk, READ_TIMEOUT) <= 0){
                     break;
+                }
+                len -= chunk;
+            }
+            if(!state->line_cut){
+                state->stats.long_lines++;
             }
+            state->line_cut = false;
+            continue;
         }
+        int read = uart_read(uart_num, state->line, len, READ_TIMEOUT);
+        if(read != (int)len){
+            uart_rx_reset(uart_num);
+            return;
+        }
+        len--;
+        if((len > 0) && (state->line[len - 1] == '\r')){
+            len--;
+        }
+        if(len > UART_LINE_MAX){
+            state->stats.long_lines++;
+            continue;
+        }
+        state->line[len] = '\0';
+        state->line_func_p(state->line, len, state->param_p);
     }
 }
 
-static void uart_conn_event_task(void *pvParameters){
+/**
+ * @brief Moves received data from the driver buffer to the receive stream, in contiguous 
+ * chunks, leaving it where UartRxView() hands it to the reader.
+ */
+static void uart_read_stream(uart_port_t uart_num){
+    uart_state_t *state = &uart_state[uart_num];
+    size_t buffered;
+    bool received = false;
+    state->rx_stalled = false;
+    while((uart_get_buffered_data_len(uart_num, &buffered) == ESP_OK) && (buffered > 0)){
+        uint32_t head = state->rx_head;
+        uint32_t free = state->rx_mask + 1 - (head - __atomic_load_n(&state->rx_tail, __ATOMIC_ACQUIRE));
+        if(free == 0){
+            /* UartRxRelease() resumes it (checked again in case it released meanwhile) */
+            __atomic_store_n(&state->rx_stalled, true, __ATOMIC_SEQ_CST);
+            free = state->rx_mask + 1 - (head - __atomic_load_n(&state->rx_tail, __ATOMIC_SEQ_CST));
+            if(free == 0){
+                break;
+            }
+            state->rx_stalled = false;
+        }
+        uint32_t pos = head & state->rx_mask;
+        uint32_t chunk = state->rx_mask + 1 - pos;
+        if(chunk > free){
+            chunk = free;
+        }
+        if(chunk > buffered){
+            chunk = buffered;
+        }
+        int read = uart_read(uart_num, state->rx_ring + pos, chunk, 0);
+        if(read <= 0){
+            break;
+        }
+        __atomic_store_n(&state->rx_head, head + read, __ATOMIC_RELEASE);
+        received = true;
+    }
+    if(received){
+        xSemaphoreGive(state->rx_ready);
+        if(state->func_p != UART_NO_INT){
+            state->func_p(state->param_p);
+        }
+    }
+}
+
+static void uart_event_task(void *pvParameters){
+    uart_port_t uart_num = (uart_port_t)(intptr_t)pvParameters;
+    uart_state_t *state = &uart_state[uart_num];
     uart_event_t event;
-    uart_driver_install(UART_NUM_1, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_conn_queue, 0);
+    size_t buffered;
     while(1){
         //Waiting for UART event.
-        if(xQueueReceive(uart_conn_queue, (void *)&event, (TickType_t)portMAX_DELAY)){
+        if(xQueueReceive(state->queue, (void *)&event, (TickType_t)portMAX_DELAY)){
+            uint16_t depth = uxQueueMessagesWaiting(state->queue) + 1;
+            if(depth > state->stats.queue_peak){
+                state->stats.queue_peak = depth;
+            }
             switch(event.type) {
                 case UART_DATA:
-                    uart_conn_isr_p(uart_conn_user_data);
+                    if(state->rx_ring != NULL){
+                        uart_read_stream(uart_num);
+                    }else if(state->line_func_p == NULL){
+                        state->func_p(state->param_p);
+                    }else if((uart_pattern_get_pos(uart_num) == -1) && 
+                            (uart_get_buffered_data_len(uart_num, &buffered) == ESP_OK) && (buffered > UART_LINE_MAX + 1)){
+                        /* no line end in sight (a whole line and its '\r' may wait for the '\n'): 
+                        the line is too long, counted once however many pieces it arrives in */
+                        if(!state->line_cut){
+                            state->stats.long_lines++;
+                        }
+                        uart_rx_reset(uart_num);
+                    }
                     break;
                 case UART_BREAK:
+                    state->stats.breaks++;
                     break;
                 case UART_BUFFER_FULL:
+                    /* the driver stops reading the FIFO until there is room: the FIFO overflows next, 
+                    unless it is a receive stream being drained */
+                    state->stats.buffer_full++;
+                    if(state->line_func_p != NULL){
+                        /* line end positions are lost: start again with the next line */
+                        uart_rx_reset(uart_num);
+                    }
                     break;
                 case UART_FIFO_OVF:
+                    /* bytes were lost: what is buffered is not contiguous with what comes next */
+                    state->stats.fifo_overflows++;
+                    uart_rx_reset(uart_num);
                     break;
                 case UART_FRAME_ERR:
+                    state->stats.frame_errors++;
                     break;
                 case UART_PARITY_ERR:
+                    state->stats.parity_errors++;
                     break;
                 case UART_DATA_BREAK:
                     break;
                 case UART_PATTERN_DET:
+                    if(state->line_func_p != NULL){
+                        uart_read_lines(uart_num);
+                    }
                     break;
                 case UART_WAKEUP:
                     break;
                 case UART_EVENT_MAX:
                     break;
             }
+            uart_check_rx(uart_num);
         }
     }
 }
 /*==================[external functions definition]==========================*/
 
 void UartInit(serial_config_t *port_config){
-    uart_config_t uart_config = {
-        .baud_rate = port_config->baud_rate,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk = UART_SCLK_DEFAULT,
-    };
-    switch(port_config->port){
-        case UART_PC:
-            uart_param_config(UART_NUM_0, &uart_config);
-            uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
-                uart_pc_isr_p = port_config->func_p;
-                uart_pc_queue = port_config->param_p;
-                xTaskCreate(uart_pc_event_task, "uart_pc_event_task", 2048, NULL, 12, 0);
-            }else{
-                uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
-            }
-            break;
-        case UART_CONNECTOR:
-            uart_param_config(UART_NUM_1, &uart_config);
-            uart_set_pin(UART_NUM_1, UART_CONN_TX, UART_CONN_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
-                uart_conn_isr_p = port_config->func_p;
-                uart_conn_queue = port_config->param_p;
-                xTaskCreate(uart_conn_event_task, "uart_conn_event_task", 2048, NULL, 12, NULL);
-            }else{
-                uart_driver_install(UART_NUM_1, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
-            }
-            break;
+    uart_port_t uart_num = uart_mcu_num(port_config->port);
+    uart_state_t *state = &uart_state[uart_num];
+    uart_config_t uart_config;
+    uart_line_config(&uart_config, port_config);
+    state->baud_rate = uart_config.baud_rate;
+    if(state->tx_lock == NULL){
+        state->tx_lock = xSemaphoreCreateMutex();
+    }
+    if(uart_is_driver_installed(uart_num)){
+        /* already initialized: only the line parameters change */
+        xSemaphoreTake(state->tx_lock, portMAX_DELAY);
+        uart_wait_tx_done(uart_num, portMAX_DELAY);
+        uart_param_config(uart_num, &uart_config);
+        uart_rx_config(uart_num, port_config);
+        xSemaphoreGive(state->tx_lock);
+        return;
+    }
+    uart_param_config(uart_num, &uart_config);
+    const uart_pins_t *pins = port_config->pins;
+    if(pins != NULL){
+        uart_set_pin(uart_num, pins->tx, pins->rx, 
+            pins->rts_used ? (int)pins->rts : UART_PIN_NO_CHANGE, pins->cts_used ? (int)pins->cts : UART_PIN_NO_CHANGE);
+    }else{
+        switch(port_config->port){
+            case UART_PC:
+                uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+                break;
+            case UART_CONNECTOR:
+                uart_set_pin(UART_NUM_1, UART_CONN_TX, UART_CONN_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+                break;
+        }
+    }
+    if((port_config->flow_ctrl != UART_FLOW_CTRL_NONE) && ((pins == NULL) || 
+            (((port_config->flow_ctrl & UART_FLOW_CTRL_RTS) && !pins->rts_used) || 
+            ((port_config->flow_ctrl & UART_FLOW_CTRL_CTS) && !pins->cts_used)))){
+        ESP_LOGW("uart", "flow control without RTS/CTS pins");
+    }
+    uint32_t rx_size = (port_config->rx_buffer_size > UART_FIFO_LEN) ? port_config->rx_buffer_size : RX_BUFFER_SIZE;
+    state->tx_size = (port_config->tx_buffer_size > UART_FIFO_LEN) ? port_config->tx_buffer_size : TX_BUFFER_SIZE;
+    state->tx_first = 0;
+    state->tx_count = 0;
+    state->tx_data = 0;
+    state->tx_ring = 0;
+    state->func_p = port_config->func_p;
+    state->line_func_p = port_config->line_func_p;
+    state->param_p = port_config->param_p;
+    state->rx_ring = NULL;
+    state->line_cut = false;
+    if(port_config->rx_stream != NULL){
+        uint32_t size = port_config->rx_stream_size;
+        if(size & (size - 1)){
+            /* only the largest power of 2 that fits is used */
+            size = 1u << (31 - __builtin_clz(size));
+            ESP_LOGE("uart", "rx_stream_size %lu is not a power of 2, %lu used", 
+                (unsigned long)port_config->rx_stream_size, (unsigned long)size);
+        }
+        if(size >= 2){
+            state->rx_ring = port_config->rx_stream;
+            state->rx_mask = size - 1;
+            state->rx_head = 0;
+            state->rx_tail = 0;
+            state->rx_discard = 0;
+            state->rx_stalled = false;
+            state->rx_ready = xSemaphoreCreateBinary();
+        }else{
+            ESP_LOGE("uart", "rx_stream_size %lu too small, no receive stream (use UartReadBuffer())", 
+                (unsigned long)port_config->rx_stream_size);
+        }
+        state->line_func_p = NULL;
+    }
+    if((state->func_p == UART_NO_INT) && (state->line_func_p == NULL) && (state->rx_ring == NULL)){
+        uart_driver_install(uart_num, rx_size, state->tx_size, 0, NULL, 0);
+        uart_rx_config(uart_num, port_config);
+        return;
+    }
+    /* installed here (not by the task) so the port can be used as soon as UartInit() returns */
+    uart_driver_install(uart_num, rx_size, state->tx_size, EVENT_QUEUE_SIZE, &state->queue, 0);
+    uart_rx_config(uart_num, port_config);
+    if(state->line_func_p != NULL){
+        /* a single character pattern, without idle time requirements */
+        uart_enable_pattern_det_baud_intr(uart_num, port_config->line_end ? port_config->line_end : '\n', 1, 1, 0, 0);
+        uart_pattern_queue_reset(uart_num, PATTERN_QUEUE_SIZE);
     }
+    xTaskCreate(uart_event_task, (uart_num == UART_NUM_0) ? "uart_pc_event_task" : "uart_conn_event_task", 
+        EVENT_TASK_STACK, (void *)(intptr_t)uart_num, 12, NULL);
 }
 
 uint8_t UartReadByte(uart_mcu_port_t port, uint8_t* data){
@@ -150,7 +660,10 @@ uint8_t UartReadByte(uart_mcu_port_t port, uint8_t* data){
                 uart_num = UART_NUM_1;
             break;
     }
-    length = uart_read_bytes(uart_num, data, 1, READ_TIMEOUT);
+    length = uart_read(uart_num, data, 1, READ_TIMEOUT);
+    if(uart_state[uart_num].watermark.func_p != NULL){
+        uart_check_watermark(uart_num, UART_WATERMARK_RX, uart_rx_level(uart_num));
+    }
     if(length > 0){
         return true;
     } else{
@@ -169,7 +682,10 @@ uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t* data, uint16_t nbytes){
                 uart_num = UART_NUM_1;
             break;
     }
-    length = uart_read_bytes(uart_num, data, nbytes, READ_TIMEOUT);
+    length = uart_read(uart_num, data, nbytes, READ_TIMEOUT);
+    if(uart_state[uart_num].watermark.func_p != NULL){
+        uart_check_watermark(uart_num, UART_WATERMARK_RX, uart_rx_level(uart_num));
+    }
     if(length > 0){
         return true;
     } else{
@@ -178,45 +694,174 @@ uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t* data, uint16_t nbytes){
 }
 
 void UartSendByte(uart_mcu_port_t port, const char *data){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-    uart_tx_chars(uart_num, data, 1);
+    UartWriteBlocking(port, data, 1);
 }
 
 void UartSendString(uart_mcu_port_t port, const char *msg){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-	while(*msg != 0){
-        uart_tx_chars(uart_num, msg, 1);
-		msg++;
-	}
+    UartWriteBlocking(port, msg, strlen(msg));
 }
 
 void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
+    UartWriteBlocking(port, data, nbytes);
+}
+
+uint32_t UartRxView(uart_mcu_port_t port, const uint8_t **data, uint32_t timeout_ms){
+    uart_state_t *state = &uart_state[uart_mcu_num(port)];
+    if(state->rx_ring == NULL){
+        return 0;
+    }
+    uint32_t tail = uart_rx_skip(uart_mcu_num(port));
+    uint32_t count = __atomic_load_n(&state->rx_head, __ATOMIC_ACQUIRE) - tail;
+    if((count == 0) && timeout_ms){
+        /* the semaphore may hold a give for data already viewed: wait until the deadline */
+        TickType_t start = xTaskGetTickCount();
+        TickType_t ticks = pdMS_TO_TICKS(timeout_ms) ? pdMS_TO_TICKS(timeout_ms) : 1;
+        TickType_t elapsed;
+        while((count == 0) && ((elapsed = xTaskGetTickCount() - start) < ticks)){
+            xSemaphoreTake(state->rx_ready, ticks - elapsed);
+            tail = uart_rx_skip(uart_mcu_num(port));
+            count = __atomic_load_n(&state->rx_head, __ATOMIC_ACQUIRE) - tail;
+        }
+    }
+    uint32_t pos = tail & state->rx_mask;
+    if(count > state->rx_mask + 1 - pos){
+        /* only up to the end of the storage, the rest in the next view */
+        count = state->rx_mask + 1 - pos;
+    }
+    *data = state->rx_ring + pos;
+    return count;
+}
+
+void UartRxRelease(uart_mcu_port_t port, uint32_t nbytes){
+    uart_port_t uart_num = uart_mcu_num(port);
+    uart_state_t *state = &uart_state[uart_num];
+    if(state->rx_ring == NULL){
+        return;
+    }
+    uint32_t count = __atomic_load_n(&state->rx_head, __ATOMIC_ACQUIRE) - state->rx_tail;
+    if(nbytes > count){
+        nbytes = count;
+    }
+    __atomic_store_n(&state->rx_tail, state->rx_tail + nbytes, __ATOMIC_SEQ_CST);
+    if(nbytes && __atomic_load_n(&state->rx_stalled, __ATOMIC_SEQ_CST)){
+        /* wake the event task to move the data waiting in the driver buffer */
+        uart_event_t event = {.type = UART_DATA};
+        xQueueSend(state->queue, &event, 0);
+    }
+    uart_check_watermark(uart_num, UART_WATERMARK_RX, uart_rx_level(uart_num));
+}
+
+uint32_t UartRxAvailable(uart_mcu_port_t port){
+    uart_state_t *state = &uart_state[uart_mcu_num(port)];
+    if(state->rx_ring == NULL){
+        return 0;
+    }
+    uint32_t tail = uart_rx_skip(uart_mcu_num(port));
+    return __atomic_load_n(&state->rx_head, __ATOMIC_ACQUIRE) - tail;
+}
+
+uint32_t UartWriteBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+    if(nbytes == 0){
+        return 0;
+    }
+    uart_port_t uart_num = uart_mcu_num(port);
+    uart_state_t *state = &uart_state[uart_num];
+    if(state->tx_lock == NULL){
+        return 0;
+    }
+    xSemaphoreTake(state->tx_lock, portMAX_DELAY);
+    uart_tx_update(uart_num);
+    int written = uart_write_bytes(uart_num, data, nbytes);
+    if(written > 0){
+        uart_tx_add(uart_num, written);
+    }
+    xSemaphoreGive(state->tx_lock);
+    if(written <= 0){
+        return 0;
+    }
+    __atomic_fetch_add(&uart_state[uart_num].stats.bytes_out, written, __ATOMIC_RELAXED);
+    uart_check_tx(uart_num);
+    return written;
+}
+
+uint32_t UartWriteNonBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+    return uart_write_available(uart_mcu_num(port), data, nbytes, 0);
+}
+
+uint32_t UartWriteTimeout(uart_mcu_port_t port, const void *data, uint32_t nbytes, uint32_t timeout_ms){
+    uart_port_t uart_num = uart_mcu_num(port);
+    const uint8_t *bytes = data;
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    uint32_t sent = uart_write_available(uart_num, bytes, nbytes, pdMS_TO_TICKS(timeout_ms));
+    while(sent < nbytes){
+        int64_t left = deadline - esp_timer_get_time();
+        if(left <= 0){
             break;
+        }
+        /* sleep while the interrupt drains room for (part of) the rest, at baud / 10 bytes per second */
+        uint32_t chunk = nbytes - sent;
+        if(chunk > uart_state[uart_num].tx_size / 2){
+            chunk = uart_state[uart_num].tx_size / 2;
+        }
+        int64_t wait_us = (int64_t)chunk * UART_FRAME_BITS * 1000000 / (uart_state[uart_num].baud_rate ? uart_state[uart_num].baud_rate : 1);
+        if(wait_us > left){
+            wait_us = left;
+        }
+        TickType_t ticks = pdMS_TO_TICKS(wait_us / 1000);
+        vTaskDelay(ticks ? ticks : 1);
+        left = deadline - esp_timer_get_time();
+        sent += uart_write_available(uart_num, bytes + sent, nbytes - sent, (left > 0) ? pdMS_TO_TICKS(left / 1000) : 0);
+    }
+    return sent;
+}
+
+uint32_t UartTxFree(uart_mcu_port_t port){
+    uart_port_t uart_num = uart_mcu_num(port);
+    uart_state_t *state = &uart_state[uart_num];
+    uint32_t room = 0;
+    uart_check_tx(uart_num);
+    if((state->tx_lock != NULL) && (xSemaphoreTake(state->tx_lock, 0) == pdTRUE)){
+        room = uart_tx_room(uart_num, UINT32_MAX);
+        xSemaphoreGive(state->tx_lock);
+    }
+    return room;
+}
+
+bool UartTxFlush(uart_mcu_port_t port, uint32_t timeout_ms){
+    uart_state_t *state = &uart_state[uart_mcu_num(port)];
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    if((state->tx_lock == NULL) || (xSemaphoreTake(state->tx_lock, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)){
+        return false;
+    }
+    int64_t left = deadline - esp_timer_get_time();
+    bool done = uart_wait_tx_done(uart_mcu_num(port), (left > 0) ? pdMS_TO_TICKS(left / 1000) : 0) == ESP_OK;
+    xSemaphoreGive(state->tx_lock);
+    return done;
+}
+
+void UartGetStats(uart_mcu_port_t port, uart_stats_t *stats){
+    *stats = uart_state[uart_mcu_num(port)].stats;
+}
+
+void UartResetStats(uart_mcu_port_t port){
+    memset(&uart_state[uart_mcu_num(port)].stats, 0, sizeof(uart_stats_t));
+}
+
+void UartSetWatermark(uart_mcu_port_t port, const uart_watermark_config_t *config){
+    uart_state_t *state = &uart_state[uart_mcu_num(port)];
+    /* callback last, so the thresholds are in place when it is enabled */
+    state->watermark.func_p = NULL;
+    state->rx_high = false;
+    state->tx_high = false;
+    if(config == NULL){
+        return;
     }
-    uart_tx_chars(uart_num, data, nbytes);
+    state->watermark.rx_high = config->rx_high;
+    state->watermark.rx_low = config->rx_low;
+    state->watermark.tx_high = config->tx_high;
+    state->watermark.tx_low = config->tx_low;
+    state->watermark.param_p = config->param_p;
+    __atomic_store_n(&state->watermark.func_p, config->func_p, __ATOMIC_RELEASE);
 }
 
 uint8_t* UartItoa(uint32_t val, uint8_t base){
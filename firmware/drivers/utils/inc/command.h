@@ -0,0 +1,145 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Command Command
+ ** @{ */
+
+/** \brief Command line parser: splits a line in arguments and runs the matching command of a table.
+ *
+ * The line is tokenized in place (separators are replaced by '\0' and argv points into the
+ * line), so nothing is copied or allocated. Arguments are separated by spaces or tabs; double
+ * quotes group words into one argument ("hello world"). Command names are case insensitive.
+ *
+ * It fits the line reception of uart_mcu.h (line_func_p), which hands each line in a writable
+ * buffer:
+ *
+ * @code
+ * static bool CmdLed(uint8_t argc, char *argv[], void *param){ ... }
+ * static const command_t commands[] = {
+ *     {"led", CmdLed, 2, 2, "led <1|2|3> <on|off>"},
+ * };
+ * static command_table_t table = {commands, sizeof(commands) / sizeof(commands[0]), NULL};
+ *
+ * void Line(char *line, uint16_t len, void *param){
+ *     command_result_t result = CommandExecute(&table, line);
+ *     if(result != COMMAND_OK && result != COMMAND_EMPTY){
+ *         UartSendString(UART_PC, CommandResultString(result));
+ *     }
+ * }
+ * @endcode
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 21/07/2024 | Document creation		                         						|
+ * | 28/07/2024 | Integer arguments with leading spaces rejected	 						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define COMMAND_MAX_ARGS	8		/*!< Most arguments of a line, command name included */
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Command function
+ *
+ * @param argc Number of arguments (command name included)
+ * @param argv Arguments, argv[0] is the command name
+ * @param param Table parameter
+ * @return true if the command succeeded, false otherwise (invalid argument values)
+ */
+typedef bool (*command_func_t)(uint8_t argc, char *argv[], void *param);
+
+/**
+ * @brief Command
+ */
+typedef struct {
+	const char *name;			/*!< Command name */
+	command_func_t func_p;		/*!< Function */
+	uint8_t min_args;			/*!< Least arguments (command name not included) */
+	uint8_t max_args;			/*!< Most arguments (command name not included) */
+	const char *help;			/*!< Usage (may be NULL) */
+} command_t;
+
+/**
+ * @brief Table of commands
+ */
+typedef struct {
+	const command_t *commands;	/*!< Commands */
+	uint8_t len;				/*!< Number of commands */
+	void *param_p;				/*!< Parameter passed to every command function */
+} command_table_t;
+
+/**
+ * @brief Result of a line
+ */
+typedef enum {
+	COMMAND_OK,					/*!< Command run and succeeded */
+	COMMAND_EMPTY,				/*!< Empty line (or only separators) */
+	COMMAND_UNKNOWN,			/*!< No command with that name */
+	COMMAND_BAD_ARGS,			/*!< Wrong number of arguments (or more than COMMAND_MAX_ARGS) */
+	COMMAND_FAILED,				/*!< Command run and failed */
+} command_result_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Split a line in arguments, in place
+ *
+ * @param line Line ('\0' ended), modified
+ * @param argv Storage for max pointers to the arguments
+ * @param max Most arguments
+ * @return uint8_t Number of arguments, max + 1 if there are more than max
+ */
+uint8_t CommandTokenize(char *line, char *argv[], uint8_t max);
+
+/**
+ * @brief Find a command by name
+ *
+ * @param table Table of commands
+ * @param name Command name (case insensitive)
+ * @return const command_t* Command, NULL if not found
+ */
+const command_t *CommandFind(const command_table_t *table, const char *name);
+
+/**
+ * @brief Tokenize a line and run its command
+ *
+ * @param table Table of commands
+ * @param line Line ('\0' ended), modified
+ * @return command_result_t Result
+ */
+command_result_t CommandExecute(const command_table_t *table, char *line);
+
+/**
+ * @brief Integer argument
+ *
+ * @param arg Argument: decimal, or hexadecimal with "0x", optional sign
+ * @param val Value
+ * @return true if the whole argument is a valid number, false otherwise
+ */
+bool CommandArgInt(const char *arg, int32_t *val);
+
+/**
+ * @brief Short description of a result ("unknown command", ...)
+ *
+ * @param result Result
+ * @return const char* Description
+ */
+const char *CommandResultString(command_result_t result);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef COMMAND_H */
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,195 @@
+#ifndef DDS_H
+#define DDS_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup DDS DDS
+ ** @{ */
+
+/** \brief Direct digital synthesis (DDS) signal generator.
+ *
+ * A 32 bits phase accumulator is advanced by a 32 bits phase step on every sample, so the
+ * frequency resolution is rate / 2^32 Hz (12 uHz at 50 kHz) and the phase never drifts.
+ * Sine and arbitrary waveforms are read from a wavetable with linear interpolation between
+ * entries; triangle, square and sawtooth are computed from the phase. Everything is integer arithmetic, so
+ * DdsNext() can be called from an interrupt for every sample (see AnalogOutputGenerate()).
+ *
+ * The frequency can be swept linearly between two values, once or repeatedly, and the
+ * output is scaled by an amplitude and shifted by an offset (in DAC counts).
+ *
+ * @note Parameters can be changed while the generator is running from an interrupt,
+ * but a change may be seen half applied for one sample.
+ *
+ * @note Square and sawtooth are not band limited: harmonics above rate / 2 alias.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 10/07/2024 | Document creation		                         						|
+ * | 28/07/2024 | 16 bits output (DdsNext16(), DdsFill16())								|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define DDS_SINE_BITS	8		/*!< Sine wavetable size: 2^8 entries (+1 guard entry) */
+#define DDS_TABLE_MAX_BITS 12	/*!< Maximum arbitrary wavetable size: 2^12 entries (+1 guard entry) */
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Available waveforms
+ */
+typedef enum dds_wave {
+	DDS_SINE,				/*!< Sine (interpolated wavetable) */
+	DDS_TRIANGLE,			/*!< Triangle */
+	DDS_SQUARE,				/*!< Square (50 % duty cycle) */
+	DDS_SAWTOOTH,			/*!< Rising sawtooth */
+	DDS_TABLE,				/*!< Arbitrary wavetable (interpolated), see DdsSetTable() */
+} dds_wave_t;
+
+/**
+ * @brief DDS generator structure
+ */
+typedef struct {
+	uint32_t rate;			/*!< Sample rate (Hz) */
+	uint32_t phase;			/*!< Phase accumulator (2^32 = one period) */
+	uint32_t step;			/*!< Phase step per sample */
+	uint64_t sweep_step;	/*!< Phase step during a sweep, with 32 fractional bits (Q32.32) */
+	uint64_t sweep_start;	/*!< Phase step at sweep start (Q32.32) */
+	int64_t sweep_delta;	/*!< Phase step change per sample (Q32.32, 0: no sweep) */
+	uint32_t sweep_len;		/*!< Sweep length (samples) */
+	uint32_t sweep_count;	/*!< Samples left in current sweep */
+	bool sweep_repeat;		/*!< Restart the sweep when it ends (otherwise hold final frequency) */
+	dds_wave_t wave;		/*!< Waveform */
+	const int16_t *table;	/*!< Wavetable (Q15), with a guard entry equal to the first one */
+	uint8_t table_shift;	/*!< 32 - wavetable bits */
+	uint8_t amplitude;		/*!< Peak amplitude (DAC counts) */
+	uint8_t offset;			/*!< Output value for a zero waveform sample (DAC counts) */
+} dds_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief DDS generator initialization. Frequency is 0, amplitude 127 and offset 128 (full scale).
+ *
+ * @param dds Generator to initialize
+ * @param rate Sample rate (Hz) at which DdsNext() will be called
+ * @param wave Waveform (DDS_TABLE requires DdsSetTable())
+ * @return true if rate is valid, false otherwise
+ */
+bool DdsInit(dds_t *dds, uint32_t rate, dds_wave_t wave);
+
+/**
+ * @brief Select the waveform
+ *
+ * @param dds Generator
+ * @param wave Waveform (DDS_TABLE requires DdsSetTable())
+ */
+void DdsSetWave(dds_t *dds, dds_wave_t wave);
+
+/**
+ * @brief Use an arbitrary wavetable (and select DDS_TABLE waveform)
+ *
+ * @param dds Generator
+ * @param table One period of the waveform (Q15), 2^bits entries plus a guard entry equal to the first one.
+ * It is not copied, so it must remain valid while it is being used
+ * @param bits log2 of the number of entries (1 to DDS_TABLE_MAX_BITS)
+ * @return true if bits is valid, false otherwise
+ */
+bool DdsSetTable(dds_t *dds, const int16_t *table, uint8_t bits);
+
+/**
+ * @brief Set output frequency (stops any sweep)
+ *
+ * @param dds Generator
+ * @param freq Frequency (mHz, below rate / 2)
+ */
+void DdsSetFrequency(dds_t *dds, uint32_t freq);
+
+/**
+ * @brief Set output phase
+ *
+ * @param dds Generator
+ * @param phase Phase (2^32 = one period)
+ */
+void DdsSetPhase(dds_t *dds, uint32_t phase);
+
+/**
+ * @brief Set output amplitude and offset
+ *
+ * @note Output is saturated to 0 - 255.
+ *
+ * @param dds Generator
+ * @param amplitude Peak amplitude (DAC counts)
+ * @param offset Output value for a zero waveform sample (DAC counts)
+ */
+void DdsSetAmplitude(dds_t *dds, uint8_t amplitude, uint8_t offset);
+
+/**
+ * @brief Sweep output frequency linearly
+ *
+ * @param dds Generator
+ * @param start Start frequency (mHz)
+ * @param stop Stop frequency (mHz, may be lower than start)
+ * @param samples Sweep length (samples)
+ * @param repeat true to restart from start frequency when the sweep ends, false to hold stop frequency
+ */
+void DdsSweep(dds_t *dds, uint32_t start, uint32_t stop, uint32_t samples, bool repeat);
+
+/**
+ * @brief Next waveform sample, before amplitude and offset
+ *
+ * @param dds Generator
+ * @return int16_t Waveform sample (Q15)
+ */
+int16_t DdsNextRaw(dds_t *dds);
+
+/**
+ * @brief Next output sample
+ *
+ * @param dds Generator (void pointer, so it can be used as AnalogOutputGenerate() callback)
+ * @return uint8_t Output sample (DAC counts)
+ */
+uint8_t DdsNext(void *dds);
+
+/**
+ * @brief Next output sample, with 16 bits (for AnalogOutputGenerate16())
+ *
+ * @note Amplitude and offset are scaled from 8 bits DAC counts (255 is 65535), but the waveform keeps 
+ * the resolution of DdsNextRaw() instead of being rounded to 8 bits.
+ *
+ * @param dds Generator (void pointer, so it can be used as AnalogOutputGenerate16() callback)
+ * @return uint16_t Output sample (0 to 65535)
+ */
+uint16_t DdsNext16(void *dds);
+
+/**
+ * @brief Fill a buffer with output samples (e.g. for AnalogOutputQueue())
+ *
+ * @param dds Generator
+ * @param buffer Output samples (DAC counts)
+ * @param n Number of samples
+ */
+void DdsFill(dds_t *dds, uint8_t *buffer, uint32_t n);
+
+/**
+ * @brief Fill a buffer with 16 bits output samples (e.g. for AnalogOutputQueue16())
+ *
+ * @param dds Generator
+ * @param buffer Output samples (0 to 65535)
+ * @param n Number of samples
+ */
+void DdsFill16(dds_t *dds, uint16_t *buffer, uint32_t n);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef DDS_H */
+
+/*==================[end of file]============================================*/
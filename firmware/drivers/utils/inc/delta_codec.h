@@ -0,0 +1,131 @@
+#ifndef DELTA_CODEC_H
+#define DELTA_CODEC_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup DeltaCodec Delta codec
+ ** @{ */
+
+/** \brief Lossless compression of sample blocks: zigzag deltas, as varints or bit packed.
+ *
+ * Consecutive samples of slow or band limited signals (ECG, distance, temperature, IMU) differ
+ * by much less than their range, so each sample is sent as a residual: the difference with the
+ * previous sample (first order), or with the line through the two previous ones (second order,
+ * 2 * x[i-1] - x[i-2], smaller for smooth oversampled signals). Residuals are zigzag mapped
+ * (small negative values are small values too, see varint.h). A block is:
+ *
+ * | Field        | Bytes    | Description                                                     |
+ * |:-------------|:---------|:----------------------------------------------------------------|
+ * | first        | 1..5     | First sample, zigzag varint                                     |
+ * | groups       | ...      | Residuals of the following samples, in groups of CODEC_GROUP    |
+ *
+ * Each group (the last one can be shorter) starts with a byte:
+ * - 0 to 32: bit width w. The group is w bits per residual, packed least significant bit first,
+ *   padded to a whole byte (width 0: all residuals are 0, no bytes).
+ * - CODEC_GROUP_VARINT: a varint per residual, better when a few residuals are much
+ *   larger than the rest (steps, spikes).
+ * - Plus CODEC_GROUP_ORDER2 for second order residuals. The encoder takes the order that makes
+ *   the group shorter (the sample before the first one of the block is taken equal to it).
+ *
+ * Groups are encoded and decoded with a fixed amount of work per sample and no memory besides
+ * the input and output buffers. The number of samples is not stored: it is sent along the block
+ * (telemetry.h TELEMETRY_PACKED records). Each block starts from its first sample, so a lost
+ * block does not affect the following ones.
+ *
+ * 12 bits ADC signals take from 3 to 7 bits per sample (depending on their noise) instead of 16,
+ * and 3 to 6 bytes as text.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 27/07/2024 | Document creation		                         						|
+ * | 28/07/2024 | First sample encoded in outputs of less than 5 bytes it fits in		|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "varint.h"
+/*==================[macros]=================================================*/
+#define CODEC_GROUP			16		/*!< Differences per group */
+#define CODEC_GROUP_VARINT	0x80	/*!< Group header of varint groups */
+#define CODEC_GROUP_ORDER2	0x40	/*!< Group header flag of second order residuals */
+/** @brief Largest encoded block of n samples (any mode) */
+#define CODEC_MAX_ENCODED(n)	(VARINT_MAX_LEN32 + ((n) + CODEC_GROUP - 1) / CODEC_GROUP * (1 + CODEC_GROUP * VARINT_MAX_LEN32))
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Group encoding
+ */
+typedef enum {
+	CODEC_AUTO,			/*!< The shorter of bit packing and varints, for each group */
+	CODEC_PACKED,		/*!< Bit packing only */
+	CODEC_VARINT,		/*!< Varints only */
+} codec_mode_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Encode a block of unsigned 16 bits samples (as read from the ADC)
+ *
+ * @note Encoding stops at the last whole group that fits in the output: call it again from
+ * the returned sample to encode the rest in other blocks.
+ *
+ * @param x Samples
+ * @param n Number of samples
+ * @param mode Group encoding
+ * @param out Encoded block
+ * @param size Size of out (CODEC_MAX_ENCODED(n) always fits the whole block)
+ * @param len Encoded block length
+ * @return uint32_t Number of samples encoded (0 if not even the first one fits)
+ */
+uint32_t CodecEncodeU16(const uint16_t *x, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len);
+
+/**
+ * @brief Encode a block of signed 32 bits samples (see CodecEncodeU16())
+ *
+ * @note Differences wrap around (modulo 2^32), so any sequence is encoded without loss.
+ *
+ * @param x Samples
+ * @param n Number of samples
+ * @param mode Group encoding
+ * @param out Encoded block
+ * @param size Size of out
+ * @param len Encoded block length
+ * @return uint32_t Number of samples encoded
+ */
+uint32_t CodecEncodeI32(const int32_t *x, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len);
+
+/**
+ * @brief Decode a block of unsigned 16 bits samples
+ *
+ * @param in Encoded block
+ * @param len Encoded block length
+ * @param x Decoded samples
+ * @param n Number of samples of the block
+ * @return true if the block is valid (n samples, using exactly len bytes), false otherwise
+ */
+bool CodecDecodeU16(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t n);
+
+/**
+ * @brief Decode a block of signed 32 bits samples
+ *
+ * @param in Encoded block
+ * @param len Encoded block length
+ * @param x Decoded samples
+ * @param n Number of samples of the block
+ * @return true if the block is valid, false otherwise
+ */
+bool CodecDecodeI32(const uint8_t *in, uint32_t len, int32_t *x, uint32_t n);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef DELTA_CODEC_H */
+
+/*==================[end of file]============================================*/
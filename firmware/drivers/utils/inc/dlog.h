@@ -0,0 +1,158 @@
+#ifndef DLOG_H
+#define DLOG_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Dlog Dlog
+ ** @{ */
+
+/** \brief Deferred logging: messages are sent as a format string id and binary arguments, and
+ * formatted in the PC.
+ *
+ * DLOG_I("adc %u mV, t = %f", mv, t) does not format anything: the format string is placed in
+ * the .logfmt section of the ELF, which is not loaded to the ESP32 (it takes no flash), and the
+ * message is its offset in that section (varint) followed by the arguments:
+ *
+ * | Argument type                     | Encoding                                              |
+ * |:----------------------------------|:------------------------------------------------------|
+ * | Integers up to 32 bits, enums     | Zigzag varint of the value as int32_t (1 to 5 bytes)  |
+ * | long long, unsigned long long     | Zigzag varint of the value as int64_t (1 to 10 bytes) |
+ * | float, double                     | float, little endian (4 bytes)                        |
+ * | char *, const char *              | Length (varint) and characters, no '\0'               |
+ * | void *, const void *              | As a 32 bits integer                                  |
+ *
+ * The message goes through the logger queues (LoggerWriteDeferred()) and, with a telemetry stream
+ * in the logger configuration, is sent as a TELEMETRY_LOG record. tools/telemetry_decoder/log_decoder
+ * reads the format strings from the firmware ELF and prints the messages. Writing a message takes
+ * the encoding (a few instructions per argument) and the queue, with no formatting, and a typical
+ * message takes 10 to 20 bytes in the UART instead of 40 to 80.
+ *
+ * @note Up to DLOG_MAX_ARGS arguments. Other pointer types must be cast to void *. Arguments are
+ * encoded by their C type: the format string conversion only sets how the PC prints them (a %x of
+ * an int32_t prints its bits as unsigned). A message takes up to LOGGER_MSG_LEN bytes: strings are
+ * truncated to fit, and a message whose other arguments do not fit is discarded (counted as dropped,
+ * see LoggerGetStats()).
+ *
+ * @note Format strings are not checked against the arguments by the compiler (as in FmtPrintf()).
+ * The ELF must be the one of the running firmware: the ids change with every build.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 26/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <string.h>
+#include "logger.h"
+#include "varint.h"
+/*==================[macros]=================================================*/
+#define DLOG_MAX_ARGS		8		/*!< Largest number of arguments of a message */
+/** @brief Section of the format strings: not allocated (the text after '#' is an assembler comment) */
+#define DLOG_SECTION		".logfmt,\"\",@progbits #"
+
+/**
+ * @brief Deferred message
+ *
+ * @param level Level (logger_level_t)
+ * @param format Format string literal (printf conversions, see log_decoder)
+ */
+#define DLOG(level, format, ...) do {															\
+	static const char dlog_fmt[] __attribute__((section(DLOG_SECTION), used)) = format;		\
+	uint8_t dlog_buf[LOGGER_MSG_LEN + 1];													\
+	uint8_t *dlog_p = VarintPut32(dlog_buf, (uint32_t)(uintptr_t)dlog_fmt);					\
+	uint8_t *dlog_end = dlog_buf + LOGGER_MSG_LEN;											\
+	(void)dlog_end;																			\
+	DLOG_CAT(DLOG_ARGS_, DLOG_NARGS(__VA_ARGS__))(dlog_p, dlog_end, ##__VA_ARGS__)			\
+	LoggerWriteDeferred((level), dlog_buf, dlog_p - dlog_buf);								\
+} while(0)
+
+#define DLOG_E(format, ...)	DLOG(LOGGER_ERROR, format, ##__VA_ARGS__)	/*!< Deferred error message */
+#define DLOG_W(format, ...)	DLOG(LOGGER_WARN, format, ##__VA_ARGS__)	/*!< Deferred warning message */
+#define DLOG_I(format, ...)	DLOG(LOGGER_INFO, format, ##__VA_ARGS__)	/*!< Deferred information message */
+#define DLOG_D(format, ...)	DLOG(LOGGER_DEBUG, format, ##__VA_ARGS__)	/*!< Deferred debug message */
+
+/** @brief Encodes an argument by its type */
+#define DLOG_PUT(p, end, x) _Generic((x),		\
+	float: DlogPutFloat,						\
+	double: DlogPutFloat,						\
+	char *: DlogPutString,						\
+	const char *: DlogPutString,				\
+	void *: DlogPutPointer,						\
+	const void *: DlogPutPointer,				\
+	long long: DlogPutInt64,					\
+	unsigned long long: DlogPutInt64,			\
+	default: DlogPutInt)((p), (end), (x))
+
+#define DLOG_CAT(a, b)		DLOG_CAT_(a, b)
+#define DLOG_CAT_(a, b)		a##b
+#define DLOG_NARGS(...)		DLOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARGS_(_, a1, a2, a3, a4, a5, a6, a7, a8, n, ...)	n
+#define DLOG_ARGS_0(p, end)
+#define DLOG_ARGS_1(p, end, x)		p = DLOG_PUT(p, end, x);
+#define DLOG_ARGS_2(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_1(p, end, __VA_ARGS__)
+#define DLOG_ARGS_3(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_2(p, end, __VA_ARGS__)
+#define DLOG_ARGS_4(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_3(p, end, __VA_ARGS__)
+#define DLOG_ARGS_5(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_4(p, end, __VA_ARGS__)
+#define DLOG_ARGS_6(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_5(p, end, __VA_ARGS__)
+#define DLOG_ARGS_7(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_6(p, end, __VA_ARGS__)
+#define DLOG_ARGS_8(p, end, x, ...)	p = DLOG_PUT(p, end, x); DLOG_ARGS_7(p, end, __VA_ARGS__)
+
+/*==================[external functions declaration]=========================*/
+/*
+ * Argument encoders, used by DLOG_PUT(). They write up to end (LOGGER_MSG_LEN bytes); an
+ * argument that does not fit sets p past end, so the following ones are skipped and
+ * LoggerWriteDeferred() discards the message. Strings are truncated instead.
+ */
+static inline uint8_t *DlogPutInt(uint8_t *p, uint8_t *end, int32_t value){
+	if(p + VARINT_MAX_LEN32 > end){
+		return end + 1;
+	}
+	return VarintPut32(p, ZigzagEncode32(value));
+}
+
+static inline uint8_t *DlogPutInt64(uint8_t *p, uint8_t *end, int64_t value){
+	if(p + VARINT_MAX_LEN64 > end){
+		return end + 1;
+	}
+	return VarintPut64(p, ZigzagEncode64(value));
+}
+
+static inline uint8_t *DlogPutPointer(uint8_t *p, uint8_t *end, const void *value){
+	return DlogPutInt(p, end, (int32_t)(uintptr_t)value);
+}
+
+static inline uint8_t *DlogPutFloat(uint8_t *p, uint8_t *end, float value){
+	if(p + sizeof(value) > end){
+		return end + 1;
+	}
+	memcpy(p, &value, sizeof(value));
+	return p + sizeof(value);
+}
+
+static inline uint8_t *DlogPutString(uint8_t *p, uint8_t *end, const char *value){
+	if(p >= end){
+		return end + 1;
+	}
+	uint32_t len = strlen(value);
+	if(len > (uint32_t)(end - p - 1)){
+		len = end - p - 1;
+	}
+	/* len is less than LOGGER_MSG_LEN: a single byte varint */
+	*p++ = len;
+	memcpy(p, value, len);
+	return p + len;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef DLOG_H */
+
+/*==================[end of file]============================================*/
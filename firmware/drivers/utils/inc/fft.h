@@ -0,0 +1,156 @@
+#ifndef FFT_H
+#define FFT_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup FFT FFT
+ ** @{ */
+
+/** \brief Fixed-point FFT and Welch power spectral density of ADC blocks.
+ *
+ * - FFT: complex Q15, in place, 16 to FFT_MAX_POINTS points. Decimation in time with
+ *   radix-4 (radix-2²) stages, plus one radix-2 stage when log2(points) is odd. Twiddle
+ *   factors are a constant table (flash). Every radix-2 step scales by 1/2 so it can never
+ *   overflow: the result is the DFT divided by the number of points.
+ * - Windows (Hann, Hamming, Blackman-Harris) in Q15, computed from the twiddle table.
+ * - Welch: blocks of samples, as read from AnalogInputReadContinuous(), are cut in 50 %
+ *   overlapping segments, windowed, transformed and their power spectra averaged.
+ *   The result is the one sided power spectral density in input units (counts² / Hz).
+ *
+ * @note The 1 / 2 scaling of each stage adds about 1 LSB (Q15) of rounding noise per bin.
+ * With 12 bits inputs (shifted to Q15) this noise floor is a few dB above the ADC one for
+ * long FFTs: use shorter segments and more averaging when the noise floor matters.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define FFT_MIN_POINTS		16		/*!< Smallest FFT size */
+#define FFT_MAX_POINTS		2048	/*!< Largest FFT size (twiddle table size) */
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Complex Q15 sample
+ */
+typedef struct {
+	int16_t re;
+	int16_t im;
+} fft_complex_t;
+
+/**
+ * @brief Window functions
+ */
+typedef enum {
+	FFT_WINDOW_RECTANGULAR,		/*!< No window */
+	FFT_WINDOW_HANN,			/*!< General purpose (-31 dB side lobes) */
+	FFT_WINDOW_HAMMING,			/*!< Lower first side lobe (-43 dB) */
+	FFT_WINDOW_BLACKMAN_HARRIS,	/*!< Large dynamic range (-92 dB side lobes) */
+} fft_window_t;
+
+/**
+ * @brief Welch power spectral density estimator
+ */
+typedef struct {
+	uint16_t points;			/*!< Segment (FFT) length */
+	uint16_t fill;				/*!< Samples in the current segment */
+	uint8_t shift;				/*!< Left shift from input samples to Q15 */
+	int32_t bias;				/*!< Mid scale of the input */
+	const int16_t *window;		/*!< Window, points coefficients (Q15) */
+	float window_power;			/*!< Sum of the squared window coefficients (normalized to 1) */
+	int16_t *segment;			/*!< Current segment, points samples (Q15) */
+	fft_complex_t *work;		/*!< FFT work buffer, points complex samples */
+	float *power;				/*!< Accumulated power spectrum, points / 2 + 1 bins */
+	uint32_t segments;			/*!< Segments accumulated */
+} welch_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief In place complex FFT (Q15), scaled by 1 / points
+ *
+ * @param x Samples (natural order in, natural order out)
+ * @param points FFT size (power of 2, FFT_MIN_POINTS to FFT_MAX_POINTS)
+ * @return true if the size is valid, false otherwise
+ */
+bool FftComplex(fft_complex_t *x, uint16_t points);
+
+/**
+ * @brief Window coefficients (Q15)
+ *
+ * @param window Window function
+ * @param coeffs Storage for points coefficients
+ * @param points Window length (power of 2, FFT_MIN_POINTS to FFT_MAX_POINTS)
+ * @return true if parameters are valid, false otherwise
+ */
+bool FftWindow(fft_window_t window, int16_t *coeffs, uint16_t points);
+
+/**
+ * @brief Squared magnitude of FFT bins
+ *
+ * @param x FFT result
+ * @param power Squared magnitudes (Q30)
+ * @param bins Number of bins
+ */
+void FftPower(const fft_complex_t *x, uint32_t *power, uint16_t bins);
+
+/**
+ * @brief Welch estimator initialization
+ *
+ * @param welch Estimator to initialize
+ * @param points Segment (FFT) length
+ * @param window Window coefficients (see FftWindow()), not copied
+ * @param bits Input sample resolution (12 for raw samples, up to 16 for oversampled ones)
+ * @param segment Storage for points samples
+ * @param work Storage for points complex samples
+ * @param power Storage for points / 2 + 1 bins
+ * @return true if parameters are valid, false otherwise
+ */
+bool WelchInit(welch_t *welch, uint16_t points, const int16_t *window, uint8_t bits,
+	int16_t *segment, fft_complex_t *work, float *power);
+
+/**
+ * @brief Discard the accumulated spectrum and the current segment
+ *
+ * @param welch Welch estimator
+ */
+void WelchReset(welch_t *welch);
+
+/**
+ * @brief Add a block of samples (a segment is transformed each points / 2 samples)
+ *
+ * @param welch Welch estimator
+ * @param x Samples
+ * @param n Number of samples
+ * @return uint32_t Number of segments accumulated so far
+ */
+uint32_t WelchPush(welch_t *welch, const uint16_t *x, uint32_t n);
+
+/**
+ * @brief Power spectral density (one sided)
+ *
+ * @note Bin k is at frequency k * sample_frec / points.
+ *
+ * @param welch Welch estimator
+ * @param sample_frec Sample rate (Hz)
+ * @param psd Power spectral density, points / 2 + 1 bins (counts² / Hz)
+ * @return true if at least one segment was accumulated, false otherwise
+ */
+bool WelchGetPsd(const welch_t *welch, float sample_frec, float *psd);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef FFT_H */
+
+/*==================[end of file]============================================*/
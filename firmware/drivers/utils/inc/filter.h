@@ -0,0 +1,239 @@
+#ifndef FILTER_H
+#define FILTER_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Filter Filter
+ ** @{ */
+
+/** \brief Fixed-point streaming filters for blocks of ADC samples.
+ *
+ * Every filter keeps its state between calls, so a signal can be processed block by block
+ * (e.g. as read from AnalogInputReadContinuous()) and the result is the same as filtering
+ * it at once. Blocks of uint16_t samples are filtered in place.
+ *
+ * - FIR with Q15 or Q31 coefficients. The delay line is stored twice (2 * taps samples),
+ *   so the convolution always reads contiguous memory and needs no wrap around checks.
+ * - Biquad cascade (direct form I) with Q30 coefficients and 64 bits accumulation.
+ * - Moving average of any length, updated with a running sum.
+ * - CIC decimator (order 1 to 4, power of 2 decimation), with modular integer arithmetic.
+ *
+ * FIR and biquad filters work on signed samples: the bias (mid scale of the input,
+ * e.g. 2048 for 12 bits raw samples or 32768 for 16 bits oversampled ones) is subtracted
+ * before filtering and added back after it. Outputs are saturated to 0 - 65535.
+ *
+ * @note Coefficients can be designed on a PC with the tools/filter_design program,
+ * which prints them as C arrays in the formats used here.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 13/07/2024 | Document creation		                         						|
+ * | 28/07/2024 | Exact moving average of long windows of 16 bits samples				|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define FILTER_CIC_MAX_ORDER	4	/*!< Maximum CIC filter order */
+#define BIQUAD_FRAC_BITS		8	/*!< Fractional bits of the samples between biquad sections */
+
+/*==================[typedef]================================================*/
+/**
+ * @brief FIR filter with Q15 coefficients
+ */
+typedef struct {
+	const int16_t *coeffs;	/*!< Coefficients (Q15, sum of absolute values below 2 to avoid accumulator overflow) */
+	int16_t *state;			/*!< Delay line, 2 * taps samples */
+	uint16_t taps;			/*!< Number of coefficients */
+	uint16_t pos;			/*!< Position of the newest sample in the delay line */
+	int32_t bias;			/*!< Mid scale of the input, subtracted before filtering */
+} fir_q15_t;
+
+/**
+ * @brief FIR filter with Q31 coefficients
+ */
+typedef struct {
+	const int32_t *coeffs;	/*!< Coefficients (Q31) */
+	int16_t *state;			/*!< Delay line, 2 * taps samples */
+	uint16_t taps;			/*!< Number of coefficients */
+	uint16_t pos;			/*!< Position of the newest sample in the delay line */
+	int32_t bias;			/*!< Mid scale of the input, subtracted before filtering */
+} fir_q31_t;
+
+/**
+ * @brief Biquad section coefficients (Q30): y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2
+ */
+typedef struct {
+	int32_t b0;
+	int32_t b1;
+	int32_t b2;
+	int32_t a1;
+	int32_t a2;
+} biquad_coeffs_t;
+
+/**
+ * @brief Biquad section state (samples with BIQUAD_FRAC_BITS fractional bits)
+ */
+typedef struct {
+	int32_t x1;
+	int32_t x2;
+	int32_t y1;
+	int32_t y2;
+} biquad_state_t;
+
+/**
+ * @brief Biquad cascade filter
+ */
+typedef struct {
+	const biquad_coeffs_t *coeffs;	/*!< Coefficients of each section */
+	biquad_state_t *state;			/*!< State of each section */
+	uint8_t sections;				/*!< Number of sections */
+	int32_t bias;					/*!< Mid scale of the input, subtracted before filtering */
+} biquad_t;
+
+/**
+ * @brief Moving average filter
+ */
+typedef struct {
+	uint16_t *history;		/*!< Last len samples */
+	uint16_t len;			/*!< Window length */
+	uint16_t pos;			/*!< Position of the oldest sample in history */
+	uint32_t sum;			/*!< Sum of the samples in history */
+	uint32_t reciprocal;	/*!< 2^32 / len, rounded up */
+	bool primed;			/*!< History holds valid samples */
+} moving_average_t;
+
+/**
+ * @brief CIC decimator
+ */
+typedef struct {
+	uint8_t order;								/*!< Number of integrator and comb stages */
+	uint8_t shift;								/*!< log2(decimation^order): output scaling */
+	uint16_t decimation;						/*!< Decimation factor (power of 2) */
+	uint16_t count;								/*!< Input samples since last output */
+	uint32_t integrator[FILTER_CIC_MAX_ORDER];	/*!< Integrator stages (modular arithmetic) */
+	uint32_t comb[FILTER_CIC_MAX_ORDER];		/*!< Comb stages delayed values */
+} cic_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief FIR filter (Q15) initialization
+ *
+ * @param fir Filter to initialize
+ * @param coeffs Coefficients (Q15), not copied
+ * @param taps Number of coefficients
+ * @param state Delay line storage of 2 * taps samples
+ * @param bias Mid scale of the input (2048 for 12 bits samples, 32768 for 16 bits samples)
+ * @return true if parameters are valid, false otherwise
+ */
+bool FirQ15Init(fir_q15_t *fir, const int16_t *coeffs, uint16_t taps, int16_t *state, uint16_t bias);
+
+/**
+ * @brief Filter a block of samples in place (FIR Q15)
+ *
+ * @param fir Filter
+ * @param block Samples
+ * @param n Number of samples
+ */
+void FirQ15Process(fir_q15_t *fir, uint16_t *block, uint32_t n);
+
+/**
+ * @brief FIR filter (Q31) initialization
+ *
+ * @param fir Filter to initialize
+ * @param coeffs Coefficients (Q31), not copied
+ * @param taps Number of coefficients
+ * @param state Delay line storage of 2 * taps samples
+ * @param bias Mid scale of the input (2048 for 12 bits samples, 32768 for 16 bits samples)
+ * @return true if parameters are valid, false otherwise
+ */
+bool FirQ31Init(fir_q31_t *fir, const int32_t *coeffs, uint16_t taps, int16_t *state, uint16_t bias);
+
+/**
+ * @brief Filter a block of samples in place (FIR Q31)
+ *
+ * @param fir Filter
+ * @param block Samples
+ * @param n Number of samples
+ */
+void FirQ31Process(fir_q31_t *fir, uint16_t *block, uint32_t n);
+
+/**
+ * @brief Biquad cascade initialization
+ *
+ * @param biquad Filter to initialize
+ * @param coeffs Coefficients of each section (Q30), not copied
+ * @param state State storage, one per section
+ * @param sections Number of sections
+ * @param bias Mid scale of the input (2048 for 12 bits samples, 32768 for 16 bits samples)
+ * @return true if parameters are valid, false otherwise
+ */
+bool BiquadInit(biquad_t *biquad, const biquad_coeffs_t *coeffs, biquad_state_t *state, uint8_t sections, uint16_t bias);
+
+/**
+ * @brief Filter a block of samples in place (biquad cascade)
+ *
+ * @param biquad Filter
+ * @param block Samples
+ * @param n Number of samples
+ */
+void BiquadProcess(biquad_t *biquad, uint16_t *block, uint32_t n);
+
+/**
+ * @brief Moving average initialization
+ *
+ * @note The history is filled with the first sample, so there is no start up transient towards 0.
+ *
+ * @param ma Filter to initialize
+ * @param history Storage for len samples
+ * @param len Window length
+ * @return true if parameters are valid, false otherwise
+ */
+bool MovingAverageInit(moving_average_t *ma, uint16_t *history, uint16_t len);
+
+/**
+ * @brief Filter a block of samples in place (moving average)
+ *
+ * @param ma Filter
+ * @param block Samples
+ * @param n Number of samples
+ */
+void MovingAverageProcess(moving_average_t *ma, uint16_t *block, uint32_t n);
+
+/**
+ * @brief CIC decimator initialization
+ *
+ * @param cic Filter to initialize
+ * @param order Number of stages (1 to FILTER_CIC_MAX_ORDER)
+ * @param decimation Decimation factor (power of 2, 16 + order * log2(decimation) must not exceed 32 bits)
+ * @return true if parameters are valid, false otherwise
+ */
+bool CicInit(cic_t *cic, uint8_t order, uint16_t decimation);
+
+/**
+ * @brief Filter and decimate a block of samples in place (CIC)
+ *
+ * @note Outputs are written at the beginning of the block. Input samples left over
+ * (less than decimation) are kept in the filter state for the next block.
+ *
+ * @param cic Filter
+ * @param block Samples
+ * @param n Number of samples
+ * @return uint32_t Number of output samples
+ */
+uint32_t CicProcess(cic_t *cic, uint16_t *block, uint32_t n);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef FILTER_H */
+
+/*==================[end of file]============================================*/
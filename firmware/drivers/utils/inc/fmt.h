@@ -0,0 +1,128 @@
+#ifndef FMT_H
+#define FMT_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Fmt Fmt
+ ** @{ */
+
+/** \brief Reentrant, allocation free number formatting (integers, fixed point) and a small printf.
+ *
+ * Every function writes into a buffer given by the caller, so tasks can format at the same
+ * time (unlike UartItoa(), which returns a static buffer). Nothing is allocated and no float
+ * arithmetic is used: decimal numbers are fixed point integers, either scaled by a power of 10
+ * (2534 with 2 decimals is "25.34") or binary (Q format, as filter.h and fft.h use).
+ *
+ * Decimal conversion takes two digits per division by 100, so it is several times faster than
+ * newlib sprintf(), which parses locale and float support for every call.
+ *
+ * FmtPrintf() supports:
+ * - Conversions: %d %i %u %x %X %o %b (binary) %c %s %% and %D (fixed point decimal: an int scaled
+ *   by 10^precision, "%.2D" prints 2534 as "25.34").
+ * - Flags '-' (left justify), '0' (zero padding) and '+' (sign), width and precision (also '*').
+ * - Length modifiers 'l' and 'h' (ignored, int is 32 bits) and 'll' (64 bits integers).
+ * Float conversions (%f, %e, %g) are not supported: format scaled integers with %D instead.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdarg.h>
+/*==================[macros]=================================================*/
+#define FMT_INT_MAX_LEN		34		/*!< Longest 32 bits integer string: 32 binary digits, sign and '\0' */
+#define FMT_DECIMALS_MAX	9		/*!< Maximum number of decimals of fixed point numbers */
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Unsigned integer to string
+ *
+ * @param buf Storage for the string (FMT_INT_MAX_LEN bytes, or width + 1 if larger)
+ * @param val Number to be converted
+ * @param base Base (2 to 16)
+ * @param width Minimum number of characters (0: no padding)
+ * @param pad Padding character ('0' or ' '), added on the left
+ * @return uint8_t String length (without '\0'), 0 if base is invalid
+ */
+uint8_t FmtUint(char *buf, uint32_t val, uint8_t base, uint8_t width, char pad);
+
+/**
+ * @brief Signed integer to string
+ *
+ * @note With '0' padding the sign goes before the zeros ("-0042").
+ *
+ * @param buf Storage for the string (FMT_INT_MAX_LEN bytes, or width + 1 if larger)
+ * @param val Number to be converted
+ * @param base Base (2 to 16)
+ * @param width Minimum number of characters (0: no padding)
+ * @param pad Padding character ('0' or ' '), added on the left
+ * @return uint8_t String length (without '\0'), 0 if base is invalid
+ */
+uint8_t FmtInt(char *buf, int32_t val, uint8_t base, uint8_t width, char pad);
+
+/**
+ * @brief Decimal fixed point number to string (value scaled by 10^decimals)
+ *
+ * @note FmtFixed(buf, -505, 2) writes "-5.05".
+ *
+ * @param buf Storage for the string (FMT_INT_MAX_LEN bytes)
+ * @param val Number multiplied by 10^decimals
+ * @param decimals Number of decimals (up to FMT_DECIMALS_MAX)
+ * @return uint8_t String length (without '\0')
+ */
+uint8_t FmtFixed(char *buf, int32_t val, uint8_t decimals);
+
+/**
+ * @brief Binary fixed point number (Q format) to string, rounded to the given decimals
+ *
+ * @note FmtQ(buf, 16384, 15, 3) writes "0.500".
+ *
+ * @param buf Storage for the string (FMT_INT_MAX_LEN bytes)
+ * @param val Number multiplied by 2^frac_bits
+ * @param frac_bits Fractional bits (0 to 31)
+ * @param decimals Number of decimals (up to FMT_DECIMALS_MAX)
+ * @return uint8_t String length (without '\0')
+ */
+uint8_t FmtQ(char *buf, int32_t val, uint8_t frac_bits, uint8_t decimals);
+
+/**
+ * @brief Formatted output to a buffer (printf subset, see above)
+ *
+ * @note It is not declared as printf-like (format attribute), since %D and %b would be warned.
+ *
+ * @param buf Output buffer
+ * @param size Buffer size: output is truncated to size - 1 characters, always ended with '\0'
+ * @param format Format string
+ * @return uint32_t Number of characters written (without '\0')
+ */
+uint32_t FmtPrintf(char *buf, uint32_t size, const char *format, ...);
+
+/**
+ * @brief Formatted output to a buffer, with a variable argument list (see FmtPrintf())
+ *
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @param format Format string
+ * @param args Arguments
+ * @return uint32_t Number of characters written (without '\0')
+ */
+uint32_t FmtVPrintf(char *buf, uint32_t size, const char *format, va_list args);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef FMT_H */
+
+/*==================[end of file]============================================*/
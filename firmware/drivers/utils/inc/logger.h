@@ -0,0 +1,139 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Logger Logger
+ ** @{ */
+
+/** \brief Lossy logging that never blocks the caller: messages are queued per level and sent
+ * to the UART by a low priority task.
+ *
+ * LoggerWrite() formats the message (FmtPrintf() format, see fmt.h) straight into a slot of
+ * the queue of its level, with a timestamp, and returns: it takes a bounded time, never waits
+ * for the UART and can be called from any task or interrupt. The queues are lock-free (a slot is
+ * claimed with an atomic compare and swap), so a preempted writer never holds back another.
+ *
+ * The drain task (lowest priority by default) sends the queued messages, errors first and debug
+ * messages last. When the terminal is slower than the messages, the lower level queues fill
+ * first, so debug messages are dropped before info ones, and so on. Drops are counted per level
+ * and reported with a warning line once the drain task catches up.
+ *
+ * Each line is sent as "[seconds.milliseconds] L: message\r\n", L being E, W, I or D. With a
+ * telemetry stream in the configuration, messages are sent as binary records instead
+ * (TELEMETRY_LOG_TEXT, and TELEMETRY_LOG for the deferred messages of dlog.h), decoded in the PC
+ * by tools/telemetry_decoder.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 25/07/2024 | Document creation		                         						|
+ * | 26/07/2024 | Deferred (binary) messages, telemetry output							|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart_mcu.h"
+#include "telemetry.h"
+/*==================[macros]=================================================*/
+#define LOGGER_MSG_LEN		80		/*!< Longest message (characters), longer ones are truncated */
+
+/** @brief Error message */
+#define LOGGER_E(...)		LoggerWrite(LOGGER_ERROR, __VA_ARGS__)
+/** @brief Warning message */
+#define LOGGER_W(...)		LoggerWrite(LOGGER_WARN, __VA_ARGS__)
+/** @brief Info message */
+#define LOGGER_I(...)		LoggerWrite(LOGGER_INFO, __VA_ARGS__)
+/** @brief Debug message */
+#define LOGGER_D(...)		LoggerWrite(LOGGER_DEBUG, __VA_ARGS__)
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Message levels, by priority
+ */
+typedef enum {
+	LOGGER_ERROR,			/*!< Errors (8 messages queue) */
+	LOGGER_WARN,			/*!< Warnings (8 messages queue) */
+	LOGGER_INFO,			/*!< Information (16 messages queue) */
+	LOGGER_DEBUG,			/*!< Debugging (16 messages queue), dropped first */
+	LOGGER_LEVELS,
+} logger_level_t;
+
+/**
+ * @brief Logger configuration
+ */
+typedef struct {
+	uart_mcu_port_t port;	/*!< Port (initialized with UartInit()) */
+	logger_level_t level;	/*!< Most verbose level logged, higher ones are ignored */
+	uint8_t priority;		/*!< Drain task priority (0: 1, just above idle) */
+	uint16_t period_ms;		/*!< Drain period (0: 20 ms) */
+	telemetry_t *telemetry;	/*!< Telemetry stream for binary output (NULL: text lines to port). Initialized 
+								 with drop_if_full false: the drain task may wait, writers never do */
+} logger_config_t;
+
+/**
+ * @brief Logger counters
+ */
+typedef struct {
+	uint32_t written[LOGGER_LEVELS];	/*!< Messages queued, per level */
+	uint32_t dropped[LOGGER_LEVELS];	/*!< Messages dropped (queue full, or deferred message too long), per level */
+	uint32_t sent;						/*!< Messages sent to the UART */
+} logger_stats_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Logger initialization (starts the drain task)
+ *
+ * @param config Configuration
+ * @return true if initialized, false if already initialized or the task could not be created
+ */
+bool LoggerInit(const logger_config_t *config);
+
+/**
+ * @brief Queue a message (never waits)
+ *
+ * @note Messages written before LoggerInit() are dropped.
+ *
+ * @param level Level
+ * @param format Format string (FmtPrintf())
+ * @return true if queued, false if ignored (level) or dropped (queue full)
+ */
+bool LoggerWrite(logger_level_t level, const char *format, ...);
+
+/**
+ * @brief Queue a deferred message, already encoded (see dlog.h, which calls it)
+ *
+ * @param level Level
+ * @param data Encoded message (format string id and arguments)
+ * @param len Length (up to LOGGER_MSG_LEN bytes, longer messages are dropped and counted as such)
+ * @return true if queued, false if ignored (level) or dropped (queue full or too long)
+ */
+bool LoggerWriteDeferred(logger_level_t level, const void *data, uint8_t len);
+
+/**
+ * @brief Set the most verbose level logged
+ *
+ * @param level Level
+ */
+void LoggerSetLevel(logger_level_t level);
+
+/**
+ * @brief Logger counters
+ *
+ * @param stats Counters
+ */
+void LoggerGetStats(logger_stats_t *stats);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef LOGGER_H */
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,120 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Resampler Resampler
+ ** @{ */
+
+/** \brief Fixed-point polyphase sample rate converter (rational factor up / down).
+ *
+ * Changes the sample rate of a stream by up / down (e.g. 1 / 2 from the 500 Hz ADC to the
+ * 250 Hz DAC), so samples captured at one rate can be displayed or played at another
+ * without dropping or repeating samples and without aliasing. It is equivalent to
+ * upsampling by up, low pass filtering and decimating by down, but only the products that
+ * give output samples are computed: each output uses one phase of the prototype filter
+ * (taps per phase coefficients, taken every up coefficients).
+ *
+ * The stream is processed block by block, keeping state between calls, from arrays or
+ * from ring buffers. As in the filter library, samples are uint16_t around a bias (mid
+ * scale of the input) and coefficients are Q15.
+ *
+ * @note The prototype filter (up * taps per phase coefficients, designed at up times the
+ * input rate, with DC gain up) can be computed with ResamplerDesign() or given by the user.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 14/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ring_buffer.h"
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Polyphase resampler
+ */
+typedef struct {
+	const int16_t *coeffs;	/*!< Prototype filter, up * taps coefficients (Q15) */
+	int16_t *state;			/*!< Delay line, 2 * taps samples */
+	uint16_t up;			/*!< Interpolation factor (L) */
+	uint16_t down;			/*!< Decimation factor (M) */
+	uint16_t taps;			/*!< Coefficients per phase */
+	uint16_t pos;			/*!< Position of the newest sample in the delay line */
+	uint32_t phase;			/*!< Phase of the next output (up means a new input is needed) */
+	int32_t bias;			/*!< Mid scale of the input, subtracted before filtering */
+} resampler_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Windowed sinc (Kaiser) prototype filter design
+ *
+ * @note It uses floating point: call it once at start up (or use a precomputed table).
+ *
+ * @param coeffs Storage for up * taps coefficients (Q15)
+ * @param up Interpolation factor
+ * @param down Decimation factor
+ * @param taps Coefficients per phase
+ * @param cutoff Cutoff frequency, as a fraction of the lowest Nyquist frequency (input or output), e.g. 0.8
+ * @return true if parameters are valid, false otherwise
+ */
+bool ResamplerDesign(int16_t *coeffs, uint16_t up, uint16_t down, uint16_t taps, float cutoff);
+
+/**
+ * @brief Resampler initialization
+ *
+ * @param rs Resampler to initialize
+ * @param coeffs Prototype filter, up * taps coefficients (Q15), not copied
+ * @param up Interpolation factor
+ * @param down Decimation factor
+ * @param taps Coefficients per phase
+ * @param state Delay line storage of 2 * taps samples
+ * @param bias Mid scale of the input (2048 for 12 bits samples, 32768 for 16 bits samples)
+ * @return true if parameters are valid, false otherwise
+ */
+bool ResamplerInit(resampler_t *rs, const int16_t *coeffs, uint16_t up, uint16_t down, uint16_t taps,
+	int16_t *state, uint16_t bias);
+
+/**
+ * @brief Resample a block of samples
+ *
+ * @note Every input sample is consumed: there are at most n * up / down + 1 outputs.
+ *
+ * @param rs Resampler
+ * @param in Input samples
+ * @param n Number of input samples
+ * @param out Output samples
+ * @param max Size of out
+ * @return uint32_t Number of output samples (if max is reached, further outputs are dropped)
+ */
+uint32_t ResamplerProcess(resampler_t *rs, const uint16_t *in, uint32_t n, uint16_t *out, uint32_t max);
+
+/**
+ * @brief Resample from a ring buffer to another
+ *
+ * @note It reads input samples only while the output ring has room, so no sample is lost:
+ * the rest are left in the input ring for the next call.
+ *
+ * @param rs Resampler
+ * @param in Input ring buffer (consumer side)
+ * @param out Output ring buffer (producer side)
+ * @return uint32_t Number of output samples
+ */
+uint32_t ResamplerProcessRing(resampler_t *rs, ring_buffer_t *in, ring_buffer_t *out);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef RESAMPLER_H */
+
+/*==================[end of file]============================================*/
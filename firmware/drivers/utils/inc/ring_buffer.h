@@ -0,0 +1,144 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Ring_Buffer Ring Buffer
+ ** @{ */
+
+/** \brief Lock-free single producer / single consumer ring buffer of samples.
+ *
+ * The producer (usually an ISR) only writes the head index and the consumer
+ * (usually a task) only writes the tail index, so no critical section is needed.
+ * Push and pop are inline so they can be called from IRAM interrupt handlers.
+ *
+ * @note The buffer size must be a power of 2.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 01/07/2024 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Ring buffer structure
+ */
+typedef struct {
+	uint16_t *data;			/*!< Pointer to sample storage */
+	uint32_t mask;			/*!< Storage size - 1 */
+	uint32_t head;			/*!< Free running write index (only modified by producer) */
+	uint32_t tail;			/*!< Free running read index (only modified by consumer) */
+} ring_buffer_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Ring buffer initialization
+ * 
+ * @param ring Ring buffer to initialize
+ * @param storage Sample storage array
+ * @param size Number of elements in storage (power of 2)
+ * @return true if size is valid, false otherwise
+ */
+bool RingBufferInit(ring_buffer_t *ring, uint16_t *storage, uint32_t size);
+
+/**
+ * @brief Discard all stored samples
+ * 
+ * @note Only call it when producer is stopped.
+ * 
+ * @param ring Ring buffer
+ */
+void RingBufferReset(ring_buffer_t *ring);
+
+/**
+ * @brief Number of samples stored
+ * 
+ * @param ring Ring buffer
+ * @return uint32_t Samples available for reading
+ */
+static inline uint32_t RingBufferCount(const ring_buffer_t *ring){
+	return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Number of free places
+ * 
+ * @param ring Ring buffer
+ * @return uint32_t Samples that can be written
+ */
+static inline uint32_t RingBufferFree(const ring_buffer_t *ring){
+	return ring->mask + 1 - RingBufferCount(ring);
+}
+
+/**
+ * @brief Write a single sample (producer side)
+ * 
+ * @param ring Ring buffer
+ * @param value Sample
+ * @return true if stored, false if buffer is full
+ */
+static inline bool RingBufferPush(ring_buffer_t *ring, uint16_t value){
+	uint32_t head = ring->head;
+	if(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask){
+		return false;
+	}
+	ring->data[head & ring->mask] = value;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief Read a single sample (consumer side)
+ * 
+ * @param ring Ring buffer
+ * @param value Pointer where sample will be stored
+ * @return true if read, false if buffer is empty
+ */
+static inline bool RingBufferPop(ring_buffer_t *ring, uint16_t *value){
+	uint32_t tail = ring->tail;
+	if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail){
+		return false;
+	}
+	*value = ring->data[tail & ring->mask];
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief Write multiple samples (producer side)
+ * 
+ * @param ring Ring buffer
+ * @param values Samples to be written
+ * @param n Number of samples
+ * @return uint32_t Number of samples written
+ */
+uint32_t RingBufferWrite(ring_buffer_t *ring, const uint16_t *values, uint32_t n);
+
+/**
+ * @brief Read multiple samples (consumer side)
+ * 
+ * @param ring Ring buffer
+ * @param values Array where samples will be stored
+ * @param n Maximum number of samples to read
+ * @return uint32_t Number of samples read
+ */
+uint32_t RingBufferRead(ring_buffer_t *ring, uint16_t *values, uint32_t n);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef RING_BUFFER_H */
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,344 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Running_Stats Running Stats
+ ** @{ */
+
+/** \brief Incremental statistics of sample streams, with O(1) work per sample and fixed memory.
+ *
+ * - Windowed mean, variance and RMS of the last len samples: exact integer running sums
+ *   (no drift, no matter how long it runs), relative to the first sample to keep them small.
+ * - Windowed minimum and maximum with monotonic deques (amortized O(1): each sample enters
+ *   and leaves each deque once).
+ * - Exponential moving average (EMA), Q16 smoothing factor.
+ * - Quantile (median, percentiles) estimation with the P² algorithm: 5 markers, no history.
+ *
+ * Samples are int32_t, so the same code serves ADC samples, distances, temperatures or
+ * raw weights (HX711). Push functions use integer arithmetic only and are inline, so they
+ * can be called from interrupt handlers, or fed from the blocks read out of ring buffers
+ * (AnalogInputReadContinuous()) with the block versions. Results are computed on request.
+ *
+ * @note The quantile estimator uses float arithmetic (software emulated on the ESP32-C6):
+ * push its samples from a task, not from an interrupt.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 15/07/2024 | Document creation		                         						|
+ * | 28/07/2024 | Quantile estimates without drift on long streams						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define EMA_FRAC_BITS			16		/*!< Fractional bits of the EMA smoothing factor and state */
+/** @brief EMA smoothing factor equivalent to a moving average of n samples: 2 / (n + 1) */
+#define EMA_ALPHA_FROM_LEN(n)	((uint32_t)((2UL << EMA_FRAC_BITS) / ((n) + 1)))
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Windowed mean, variance and RMS
+ */
+typedef struct {
+	int32_t *history;		/*!< Last len samples */
+	uint16_t len;			/*!< Window length */
+	uint16_t count;			/*!< Samples in the window (up to len) */
+	uint16_t pos;			/*!< Position of the oldest sample in history */
+	int32_t ref;			/*!< Reference (first sample): sums are relative to it */
+	int64_t sum;			/*!< Sum of (sample - ref) */
+	uint64_t sum_sq;		/*!< Sum of (sample - ref)^2 */
+} window_stats_t;
+
+/**
+ * @brief Monotonic deque entry
+ */
+typedef struct {
+	int32_t value;			/*!< Sample */
+	uint32_t index;			/*!< Sample number */
+} minmax_entry_t;
+
+/**
+ * @brief Monotonic deque (circular, up to len entries)
+ */
+typedef struct {
+	minmax_entry_t *entry;	/*!< Storage, len entries */
+	uint16_t front;			/*!< Position of the oldest entry */
+	uint16_t size;			/*!< Number of entries */
+} minmax_deque_t;
+
+/**
+ * @brief Windowed minimum and maximum
+ */
+typedef struct {
+	minmax_deque_t min;		/*!< Increasing values: front is the minimum */
+	minmax_deque_t max;		/*!< Decreasing values: front is the maximum */
+	uint16_t len;			/*!< Window length */
+	uint32_t index;			/*!< Number of the next sample */
+} minmax_t;
+
+/**
+ * @brief Exponential moving average: s = s + alpha (x - s)
+ */
+typedef struct {
+	int64_t state;			/*!< Average, with EMA_FRAC_BITS fractional bits */
+	uint32_t alpha;			/*!< Smoothing factor, with EMA_FRAC_BITS fractional bits (1 to 2^EMA_FRAC_BITS) */
+	bool primed;			/*!< A sample has been received (the first one initializes the average) */
+} ema_t;
+
+/**
+ * @brief P² quantile estimator
+ */
+typedef struct {
+	float p;				/*!< Quantile (0 to 1, 0.5 for the median) */
+	float height[5];		/*!< Marker heights */
+	int32_t pos[5];			/*!< Marker positions */
+	float desired[5];		/*!< Desired marker positions */
+	float increment[5];		/*!< Desired positions increment per sample */
+	uint32_t count;			/*!< Number of samples */
+} quantile_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Windowed statistics initialization
+ *
+ * @param ws Statistics to initialize
+ * @param history Storage for len samples
+ * @param len Window length (samples within +-2^24 of the first one)
+ * @return true if parameters are valid, false otherwise
+ */
+bool WindowStatsInit(window_stats_t *ws, int32_t *history, uint16_t len);
+
+/**
+ * @brief Discard all samples
+ *
+ * @param ws Windowed statistics
+ */
+void WindowStatsReset(window_stats_t *ws);
+
+/**
+ * @brief Add a sample (the oldest one leaves the window when it is full)
+ *
+ * @param ws Windowed statistics
+ * @param x Sample
+ */
+static inline void WindowStatsPush(window_stats_t *ws, int32_t x){
+	if(ws->count == 0){
+		ws->ref = x;
+		ws->sum = 0;
+		ws->sum_sq = 0;
+	}
+	int64_t d = (int64_t)x - ws->ref;
+	if(ws->count == ws->len){
+		int64_t old = (int64_t)ws->history[ws->pos] - ws->ref;
+		ws->sum -= old;
+		ws->sum_sq -= (uint64_t)(old * old);
+	}else{
+		ws->count++;
+	}
+	ws->history[ws->pos] = x;
+	if(++ws->pos == ws->len){
+		ws->pos = 0;
+	}
+	ws->sum += d;
+	ws->sum_sq += (uint64_t)(d * d);
+}
+
+/**
+ * @brief Add a block of samples
+ *
+ * @param ws Windowed statistics
+ * @param x Samples
+ * @param n Number of samples
+ */
+void WindowStatsPushBlock(window_stats_t *ws, const uint16_t *x, uint32_t n);
+
+/**
+ * @brief Number of samples in the window
+ *
+ * @param ws Windowed statistics
+ * @return uint16_t Samples (up to the window length)
+ */
+static inline uint16_t WindowStatsCount(const window_stats_t *ws){
+	return ws->count;
+}
+
+/**
+ * @brief Mean of the samples in the window
+ *
+ * @param ws Windowed statistics
+ * @return float Mean (0 if there are no samples)
+ */
+float WindowStatsMean(const window_stats_t *ws);
+
+/**
+ * @brief Variance of the samples in the window (population variance, divided by the count)
+ *
+ * @param ws Windowed statistics
+ * @return float Variance (0 if there are no samples)
+ */
+float WindowStatsVariance(const window_stats_t *ws);
+
+/**
+ * @brief Root mean square of the samples in the window
+ *
+ * @param ws Windowed statistics
+ * @return float RMS (0 if there are no samples)
+ */
+float WindowStatsRms(const window_stats_t *ws);
+
+/**
+ * @brief Windowed minimum and maximum initialization
+ *
+ * @param mm Minimum and maximum to initialize
+ * @param storage Storage for 2 * len deque entries
+ * @param len Window length
+ * @return true if parameters are valid, false otherwise
+ */
+bool MinMaxInit(minmax_t *mm, minmax_entry_t *storage, uint16_t len);
+
+/**
+ * @brief Discard all samples
+ *
+ * @param mm Minimum and maximum
+ */
+void MinMaxReset(minmax_t *mm);
+
+/**
+ * @brief Add a sample (the oldest one leaves the window when it is full)
+ *
+ * @param mm Minimum and maximum
+ * @param x Sample
+ */
+static inline void MinMaxPush(minmax_t *mm, int32_t x){
+	const uint16_t len = mm->len;
+	minmax_deque_t *q[2] = {&mm->min, &mm->max};
+	for(uint8_t k = 0; k < 2; k++){
+		minmax_deque_t *d = q[k];
+		/* drop the entries that can not be the minimum (maximum) any more */
+		while(d->size > 0){
+			uint16_t back = d->front + d->size - 1;
+			back = (back >= len) ? back - len : back;
+			int32_t v = d->entry[back].value;
+			if((k == 0) ? (v < x) : (v > x)){
+				break;
+			}
+			d->size--;
+		}
+		/* drop the front entry if it left the window */
+		if((d->size > 0) && (mm->index - d->entry[d->front].index >= len)){
+			d->front = (d->front + 1 == len) ? 0 : d->front + 1;
+			d->size--;
+		}
+		uint16_t back = d->front + d->size;
+		back = (back >= len) ? back - len : back;
+		d->entry[back].value = x;
+		d->entry[back].index = mm->index;
+		d->size++;
+	}
+	mm->index++;
+}
+
+/**
+ * @brief Add a block of samples
+ *
+ * @param mm Minimum and maximum
+ * @param x Samples
+ * @param n Number of samples
+ */
+void MinMaxPushBlock(minmax_t *mm, const uint16_t *x, uint32_t n);
+
+/**
+ * @brief Minimum of the samples in the window
+ *
+ * @param mm Minimum and maximum
+ * @return int32_t Minimum (0 if there are no samples)
+ */
+static inline int32_t MinMaxMin(const minmax_t *mm){
+	return (mm->min.size > 0) ? mm->min.entry[mm->min.front].value : 0;
+}
+
+/**
+ * @brief Maximum of the samples in the window
+ *
+ * @param mm Minimum and maximum
+ * @return int32_t Maximum (0 if there are no samples)
+ */
+static inline int32_t MinMaxMax(const minmax_t *mm){
+	return (mm->max.size > 0) ? mm->max.entry[mm->max.front].value : 0;
+}
+
+/**
+ * @brief Exponential moving average initialization
+ *
+ * @param ema Average to initialize
+ * @param alpha Smoothing factor with EMA_FRAC_BITS fractional bits (see EMA_ALPHA_FROM_LEN())
+ * @return true if parameters are valid, false otherwise
+ */
+bool EmaInit(ema_t *ema, uint32_t alpha);
+
+/**
+ * @brief Add a sample
+ *
+ * @param ema Exponential moving average
+ * @param x Sample
+ */
+static inline void EmaPush(ema_t *ema, int32_t x){
+	int64_t target = (int64_t)x * (1 << EMA_FRAC_BITS);
+	if(!ema->primed){
+		ema->state = target;
+		ema->primed = true;
+		return;
+	}
+	ema->state += ((target - ema->state) * ema->alpha) / (1 << EMA_FRAC_BITS);
+}
+
+/**
+ * @brief Current average
+ *
+ * @param ema Exponential moving average
+ * @return float Average (0 if there are no samples)
+ */
+float EmaGet(const ema_t *ema);
+
+/**
+ * @brief Quantile estimator initialization
+ *
+ * @param qt Estimator to initialize
+ * @param p Quantile (0 to 1: 0.5 for the median, 0.95 for the 95th percentile)
+ * @return true if parameters are valid, false otherwise
+ */
+bool QuantileInit(quantile_t *qt, float p);
+
+/**
+ * @brief Add a sample (float arithmetic: do not call it from interrupts)
+ *
+ * @param qt Quantile estimator
+ * @param x Sample
+ */
+void QuantilePush(quantile_t *qt, int32_t x);
+
+/**
+ * @brief Current estimate
+ *
+ * @note Exact for the first 5 samples, estimated from then on.
+ *
+ * @param qt Quantile estimator
+ * @return float Quantile estimate (0 if there are no samples)
+ */
+float QuantileGet(const quantile_t *qt);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef RUNNING_STATS_H */
+
+/*==================[end of file]============================================*/
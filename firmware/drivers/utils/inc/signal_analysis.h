@@ -0,0 +1,97 @@
+#ifndef SIGNAL_ANALYSIS_H
+#define SIGNAL_ANALYSIS_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Signal_Analysis Signal Analysis
+ ** @{ */
+
+/** \brief Sine wave analysis of captured signals (gain, offset, SNR, THD, SINAD, delay).
+ *
+ * The fundamental, of known frequency, is found with a least squares sine fit
+ * (3 parameters: amplitude, phase and offset), so the capture does not need to hold
+ * a whole number of periods. Each harmonic is fitted the same way after removing the
+ * fundamental. The residual power gives SINAD, the harmonics THD, and the rest SNR.
+ *
+ * It is plain C with no driver dependencies, so it runs on the board or on a PC
+ * with synthetic signals.
+ *
+ * @note Sines and cosines are computed by rotation, and recomputed every
+ * SIGNAL_TRIG_RESYNC samples to bound the accumulated error.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 12/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define SIGNAL_HARMONICS_MAX	10		/*!< Maximum harmonic analyzed for THD */
+#define SIGNAL_TRIG_RESYNC		256		/*!< Samples between exact sine / cosine evaluations */
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Sine analysis results
+ */
+typedef struct {
+	float amplitude;		/*!< Fundamental peak amplitude (input units) */
+	float phase;			/*!< Fundamental phase at the first sample (rad, sine reference: x = A sin(w n + phase)) */
+	float offset;			/*!< Mean value (input units) */
+	float snr;				/*!< Signal to noise ratio (dB, harmonics excluded) */
+	float thd;				/*!< Total harmonic distortion (dB, relative to the fundamental) */
+	float sinad;			/*!< Signal to noise and distortion ratio (dB) */
+	float enob;				/*!< Effective number of bits, from SINAD */
+} signal_sine_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Analyze a captured sine wave of known frequency
+ *
+ * @param x Samples
+ * @param n Number of samples (at least 3 periods are recommended)
+ * @param freq Fundamental frequency, normalized to the sample rate (cycles per sample, below 0.5)
+ * @param harmonics Highest harmonic included in THD (2 to SIGNAL_HARMONICS_MAX, harmonics above
+ * the Nyquist frequency are skipped)
+ * @param result Analysis results
+ * @return true if the analysis succeeded, false otherwise (invalid parameters or no signal)
+ */
+bool SignalSineAnalysis(const uint16_t *x, uint32_t n, float freq, uint8_t harmonics, signal_sine_t *result);
+
+/**
+ * @brief Least squares sine fit at a known frequency: x = A sin(w n + phase) + offset
+ *
+ * @param x Samples
+ * @param n Number of samples
+ * @param freq Frequency, normalized to the sample rate (cycles per sample)
+ * @param amplitude Fitted peak amplitude
+ * @param phase Fitted phase at the first sample (rad)
+ * @param offset Fitted offset (mean value)
+ * @return true if the fit succeeded, false otherwise
+ */
+bool SignalSineFit(const uint16_t *x, uint32_t n, float freq, float *amplitude, float *phase, float *offset);
+
+/**
+ * @brief Delay between two phases of a sine wave
+ *
+ * @param phase_ref Reference (input) phase (rad)
+ * @param phase Delayed (output) phase (rad)
+ * @param freq Frequency (Hz)
+ * @return float Delay (s), between 0 and one period
+ */
+float SignalPhaseDelay(float phase_ref, float phase, float freq);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef SIGNAL_ANALYSIS_H */
+
+/*==================[end of file]============================================*/
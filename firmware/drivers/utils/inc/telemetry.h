@@ -0,0 +1,216 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Telemetry Telemetry
+ ** @{ */
+
+/** \brief Binary telemetry over UART: typed records in COBS frames with sequence number and CRC-16.
+ *
+ * Values are sent in binary (little endian), so they take a fraction of the bytes of their text
+ * form and need no formatting. Each record is a frame:
+ *
+ * | Field    | Bytes  | Description                                                  |
+ * |:---------|:------:|:-------------------------------------------------------------|
+ * | type     | 1      | Record type (telemetry_type_t, or user types from 0x80)      |
+ * | sequence | 2      | Frame number, per stream: gaps show lost frames              |
+ * | payload  | 0..240 | Record data (see telemetry_type_t)                           |
+ * | crc      | 2      | CRC-16/CCITT-FALSE of type, sequence and payload             |
+ *
+ * The frame is COBS encoded (Consistent Overhead Byte Stuffing: no zero bytes inside, one byte
+ * of overhead every 254) and ended with a zero byte. A receiver that starts in the middle of a
+ * stream, or loses bytes, synchronizes again at the next zero.
+ *
+ * The host decoder (tools/telemetry_decoder) prints, validates and converts the stream to CSV.
+ *
+ * @note This header has no ESP-IDF dependencies: the host decoder includes it to share record
+ * types and limits.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 20/07/2024 | Document creation		                         						|
+ * | 26/07/2024 | Log records (text and deferred, see logger.h and dlog.h)				|
+ * | 27/07/2024 | Compressed sample blocks (TELEMETRY_PACKED, see delta_codec.h)		|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart_mcu.h"
+/*==================[macros]=================================================*/
+#define TELEMETRY_MAX_PAYLOAD	240		/*!< Largest record payload (bytes) */
+#define TELEMETRY_HEADER_LEN	3		/*!< Type and sequence number */
+#define TELEMETRY_CRC_LEN		2
+/** @brief Largest frame before encoding */
+#define TELEMETRY_MAX_RAW		(TELEMETRY_HEADER_LEN + TELEMETRY_MAX_PAYLOAD + TELEMETRY_CRC_LEN)
+/** @brief Largest encoded frame: COBS overhead and zero delimiter */
+#define TELEMETRY_MAX_FRAME		(TELEMETRY_MAX_RAW + TELEMETRY_MAX_RAW / 254 + 2)
+/** @brief Encoded size of n bytes (upper bound) */
+#define COBS_MAX_ENCODED(n)		((n) + (n) / 254 + 1)
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Record types and their payload
+ */
+typedef enum {
+	TELEMETRY_TEXT = 0x01,		/*!< Text (UTF-8, not ended with '\0') */
+	TELEMETRY_U16 = 0x02,		/*!< Channel (1 byte), uint16_t values */
+	TELEMETRY_I16 = 0x03,		/*!< Channel (1 byte), int16_t values */
+	TELEMETRY_I32 = 0x04,		/*!< Channel (1 byte), int32_t values */
+	TELEMETRY_F32 = 0x05,		/*!< Channel (1 byte), float values */
+	TELEMETRY_SAMPLES = 0x06,	/*!< Channel (1 byte), timestamp of the first sample (int64_t, us), sample rate (uint32_t, Hz), uint16_t samples */
+	TELEMETRY_LOG_TEXT = 0x07,	/*!< Log level (1 byte), timestamp (uint32_t, ms), message text */
+	TELEMETRY_LOG = 0x08,		/*!< Log level (1 byte), timestamp (uint32_t, ms), deferred message: format string id (varint) and arguments (see dlog.h) */
+	TELEMETRY_PACKED = 0x09,	/*!< Channel (1 byte), timestamp of the first sample (int64_t, us), sample rate (uint32_t, Hz), number of samples (uint16_t), uint16_t samples encoded with CodecEncodeU16() */
+	TELEMETRY_USER = 0x80,		/*!< First user defined type (payload not interpreted) */
+} telemetry_type_t;
+
+/**
+ * @brief Telemetry stream
+ */
+typedef struct {
+	uart_mcu_port_t port;		/*!< Port the frames are sent through */
+	bool drop_if_full;			/*!< Drop frames that do not fit in the transmit buffer instead of waiting */
+	uint16_t sequence;			/*!< Number of the next frame */
+	uint32_t frames;			/*!< Frames sent */
+	uint32_t dropped;			/*!< Frames dropped (transmit buffer full) */
+	uint32_t bytes;				/*!< Bytes sent (encoded) */
+} telemetry_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, no reflection)
+ *
+ * @param data Bytes
+ * @param n Number of bytes
+ * @param crc Initial value (0xFFFF), or the result of the previous part to chain calls
+ * @return uint16_t CRC
+ */
+uint16_t Crc16(const uint8_t *data, uint32_t n, uint16_t crc);
+
+/**
+ * @brief COBS encoding (the zero delimiter is not added)
+ *
+ * @param in Bytes to encode
+ * @param n Number of bytes
+ * @param out Encoded bytes, COBS_MAX_ENCODED(n) bytes (no zeros)
+ * @return uint32_t Number of encoded bytes
+ */
+uint32_t CobsEncode(const uint8_t *in, uint32_t n, uint8_t *out);
+
+/**
+ * @brief COBS decoding (without the zero delimiter)
+ *
+ * @note Decoding can be done in place (in == out).
+ *
+ * @param in Encoded bytes
+ * @param n Number of encoded bytes
+ * @param out Decoded bytes (up to n - 1)
+ * @return uint32_t Number of decoded bytes, 0 if the input is not valid COBS
+ */
+uint32_t CobsDecode(const uint8_t *in, uint32_t n, uint8_t *out);
+
+/**
+ * @brief Build an encoded frame (header, payload, CRC, COBS and delimiter)
+ *
+ * @param type Record type
+ * @param sequence Frame number
+ * @param payload Record data
+ * @param len Payload length (up to TELEMETRY_MAX_PAYLOAD)
+ * @param frame Storage for TELEMETRY_MAX_FRAME bytes
+ * @return uint16_t Frame length, 0 if the payload is too long
+ */
+uint16_t TelemetryFrame(uint8_t type, uint16_t sequence, const void *payload, uint16_t len, uint8_t *frame);
+
+/**
+ * @brief Telemetry stream initialization (the port must be initialized with UartInit())
+ *
+ * @param tm Stream to initialize
+ * @param port Port the frames are sent through
+ * @param drop_if_full Drop frames that do not fit in the transmit buffer (never wait),
+ * instead of waiting for room
+ */
+void TelemetryInit(telemetry_t *tm, uart_mcu_port_t port, bool drop_if_full);
+
+/**
+ * @brief Send a record
+ *
+ * @note Each frame is written to the UART with a single call, so streams can be shared by tasks.
+ *
+ * @param tm Telemetry stream
+ * @param type Record type
+ * @param payload Record data
+ * @param len Payload length (up to TELEMETRY_MAX_PAYLOAD)
+ * @return true if the frame was sent, false if it was dropped or too long
+ */
+bool TelemetrySend(telemetry_t *tm, uint8_t type, const void *payload, uint16_t len);
+
+/**
+ * @brief Send a text record
+ *
+ * @param tm Telemetry stream
+ * @param text String (truncated to TELEMETRY_MAX_PAYLOAD characters)
+ * @return true if the frame was sent, false otherwise
+ */
+bool TelemetrySendText(telemetry_t *tm, const char *text);
+
+/**
+ * @brief Send a record of values of one channel (TELEMETRY_U16, TELEMETRY_I16, TELEMETRY_I32 or TELEMETRY_F32)
+ *
+ * @param tm Telemetry stream
+ * @param type Record type, sets the size of each value
+ * @param channel Channel number (meaning defined by the application)
+ * @param values Values (little endian, as stored by the ESP32)
+ * @param n Number of values (up to (TELEMETRY_MAX_PAYLOAD - 1) / value size)
+ * @return true if the frame was sent, false otherwise
+ */
+bool TelemetrySendValues(telemetry_t *tm, telemetry_type_t type, uint8_t channel, const void *values, uint16_t n);
+
+/**
+ * @brief Send a block of samples with its timestamp and sample rate (TELEMETRY_SAMPLES)
+ *
+ * @note Fits the blocks read with AnalogInputReadBlock() (analog_block_t timestamp and sample_frec).
+ *
+ * @param tm Telemetry stream
+ * @param channel Channel number
+ * @param timestamp Time of the first sample (us)
+ * @param sample_frec Sample rate (Hz)
+ * @param samples Samples
+ * @param n Number of samples (up to 113)
+ * @return true if the frame was sent, false otherwise
+ */
+bool TelemetrySendSamples(telemetry_t *tm, uint8_t channel, int64_t timestamp, uint32_t sample_frec,
+	const uint16_t *samples, uint16_t n);
+
+/**
+ * @brief Send samples compressed (TELEMETRY_PACKED records, see delta_codec.h)
+ *
+ * @note The samples are split in as many records as needed, each one with the timestamp of its
+ * first sample. Compression takes a fixed number of cycles per sample. Noise like signals (no
+ * correlation between samples) take up to 10 % more bytes than TelemetrySendSamples().
+ *
+ * @param tm Telemetry stream
+ * @param channel Channel number
+ * @param timestamp Time of the first sample (us)
+ * @param sample_frec Sample rate (Hz)
+ * @param samples Samples
+ * @param n Number of samples
+ * @return true if every record was sent, false otherwise
+ */
+bool TelemetrySendPacked(telemetry_t *tm, uint8_t channel, int64_t timestamp, uint32_t sample_frec,
+	const uint16_t *samples, uint32_t n);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef TELEMETRY_H */
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,144 @@
+#ifndef VARINT_H
+#define VARINT_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Utils Utils
+ ** @{ */
+/** \addtogroup Varint Varint
+ ** @{ */
+
+/** \brief Variable length integers (LEB128, as protocol buffers) and zigzag mapping of signed values.
+ *
+ * A varint takes 7 bits per byte, least significant group first, with the high bit set in every
+ * byte but the last: values under 128 take one byte, a 32 bits value up to 5. Zigzag maps signed
+ * values to unsigned ones by magnitude (0, -1, 1, -2, ... to 0, 1, 2, 3, ...), so small negative
+ * values stay short too.
+ *
+ * Functions are inline: they are a few instructions per byte.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 26/07/2024 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stddef.h>
+/*==================[macros]=================================================*/
+#define VARINT_MAX_LEN32	5		/*!< Longest 32 bits varint */
+#define VARINT_MAX_LEN64	10		/*!< Longest 64 bits varint */
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Zigzag mapping of a 32 bits signed value
+ */
+static inline uint32_t ZigzagEncode32(int32_t value){
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Inverse zigzag mapping (32 bits)
+ */
+static inline int32_t ZigzagDecode32(uint32_t value){
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Zigzag mapping of a 64 bits signed value
+ */
+static inline uint64_t ZigzagEncode64(int64_t value){
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/**
+ * @brief Inverse zigzag mapping (64 bits)
+ */
+static inline int64_t ZigzagDecode64(uint64_t value){
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief Write a 32 bits varint
+ *
+ * @param p Output, room for VARINT_MAX_LEN32 bytes
+ * @param value Value
+ * @return uint8_t* Position after the varint
+ */
+static inline uint8_t *VarintPut32(uint8_t *p, uint32_t value){
+	while(value >= 0x80){
+		*p++ = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	*p++ = (uint8_t)value;
+	return p;
+}
+
+/**
+ * @brief Write a 64 bits varint
+ *
+ * @param p Output, room for VARINT_MAX_LEN64 bytes
+ * @param value Value
+ * @return uint8_t* Position after the varint
+ */
+static inline uint8_t *VarintPut64(uint8_t *p, uint64_t value){
+	while(value >= 0x80){
+		*p++ = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	*p++ = (uint8_t)value;
+	return p;
+}
+
+/**
+ * @brief Read a 32 bits varint
+ *
+ * @param p Input
+ * @param end End of the input
+ * @param value Value read
+ * @return const uint8_t* Position after the varint, NULL if it is truncated or too long
+ */
+static inline const uint8_t *VarintGet32(const uint8_t *p, const uint8_t *end, uint32_t *value){
+	uint32_t v = 0;
+	for(uint8_t shift = 0; (p < end) && (shift < 35); shift += 7){
+		uint8_t byte = *p++;
+		v |= (uint32_t)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0){
+			*value = v;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Read a 64 bits varint
+ *
+ * @param p Input
+ * @param end End of the input
+ * @param value Value read
+ * @return const uint8_t* Position after the varint, NULL if it is truncated or too long
+ */
+static inline const uint8_t *VarintGet64(const uint8_t *p, const uint8_t *end, uint64_t *value){
+	uint64_t v = 0;
+	for(uint8_t shift = 0; (p < end) && (shift < 70); shift += 7){
+		uint8_t byte = *p++;
+		v |= (uint64_t)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0){
+			*value = v;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* #ifndef VARINT_H */
+
+/*==================[end of file]============================================*/
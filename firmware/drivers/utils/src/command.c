@@ -0,0 +1,126 @@
+/**
+ * @file command.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "command.h"
+#include <stddef.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <errno.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static bool is_separator(char c);
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static bool is_separator(char c){
+	return (c == ' ') || (c == '\t');
+}
+
+/*==================[external functions definition]==========================*/
+uint8_t CommandTokenize(char *line, char *argv[], uint8_t max){
+	uint8_t argc = 0;
+	char *p = line;
+	while(1){
+		while(is_separator(*p)){
+			p++;
+		}
+		if(*p == '\0'){
+			break;
+		}
+		if(argc == max){
+			return max + 1;
+		}
+		if(*p == '"'){
+			/* quoted: up to the closing quote (or the end of the line) */
+			argv[argc++] = ++p;
+			while((*p != '"') && (*p != '\0')){
+				p++;
+			}
+		}else{
+			argv[argc++] = p;
+			while(!is_separator(*p) && (*p != '\0')){
+				p++;
+			}
+		}
+		if(*p == '\0'){
+			break;
+		}
+		*p++ = '\0';
+	}
+	return argc;
+}
+
+const command_t *CommandFind(const command_table_t *table, const char *name){
+	for(uint8_t i = 0; i < table->len; i++){
+		if(strcasecmp(table->commands[i].name, name) == 0){
+			return &table->commands[i];
+		}
+	}
+	return NULL;
+}
+
+command_result_t CommandExecute(const command_table_t *table, char *line){
+	char *argv[COMMAND_MAX_ARGS];
+	uint8_t argc = CommandTokenize(line, argv, COMMAND_MAX_ARGS);
+	if(argc == 0){
+		return COMMAND_EMPTY;
+	}
+	const command_t *cmd = CommandFind(table, argv[0]);
+	if(cmd == NULL){
+		return COMMAND_UNKNOWN;
+	}
+	if((argc > COMMAND_MAX_ARGS) || (argc - 1 < cmd->min_args) || (argc - 1 > cmd->max_args)){
+		return COMMAND_BAD_ARGS;
+	}
+	return cmd->func_p(argc, argv, table->param_p) ? COMMAND_OK : COMMAND_FAILED;
+}
+
+bool CommandArgInt(const char *arg, int32_t *val){
+	/* base 0 would read a leading zero as octal */
+	const char *digits = ((*arg == '+') || (*arg == '-')) ? arg + 1 : arg;
+	/* strtol() would also skip spaces (a quoted " 5") */
+	if((*digits < '0') || (*digits > '9')){
+		return false;
+	}
+	int base = ((digits[0] == '0') && ((digits[1] == 'x') || (digits[1] == 'X'))) ? 16 : 10;
+	char *end;
+	errno = 0;
+	long v = strtol(arg, &end, base);
+	if((end == arg) || (*end != '\0') || (errno == ERANGE) || (v > INT32_MAX) || (v < INT32_MIN)){
+		return false;
+	}
+	*val = v;
+	return true;
+}
+
+const char *CommandResultString(command_result_t result){
+	switch(result){
+		case COMMAND_OK:
+			return "ok";
+		case COMMAND_EMPTY:
+			return "empty line";
+		case COMMAND_UNKNOWN:
+			return "unknown command";
+		case COMMAND_BAD_ARGS:
+			return "wrong number of arguments";
+		case COMMAND_FAILED:
+			return "command failed";
+	}
+	return "";
+}
+/*==================[end of file]============================================*/
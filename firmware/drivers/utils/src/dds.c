@@ -0,0 +1,199 @@
+/**
+ * @file dds.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "dds.h"
+#include <stddef.h>
+#include <math.h>
+/*==================[macros and definitions]=================================*/
+#define DDS_SINE_SIZE	(1 << DDS_SINE_BITS)
+#define DDS_Q15_MAX		32767
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static uint64_t dds_freq2step(uint32_t freq, uint32_t rate);
+
+/*==================[internal data definition]===============================*/
+static int16_t dds_sine[DDS_SINE_SIZE + 1];		/*!< One sine period (Q15) plus guard entry, built on first init */
+static bool dds_sine_ready = false;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Converts a frequency (mHz) to a phase step with 32 fractional bits (Q32.32): freq * 2^32 / (rate * 1000)
+ */
+static uint64_t dds_freq2step(uint32_t freq, uint32_t rate){
+	uint64_t div = (uint64_t)rate * 1000;
+	uint64_t num = (uint64_t)freq << 32;
+	uint64_t integer = num / div;
+	uint64_t fraction = ((num % div) << 32) / div;
+	return (integer << 32) | fraction;
+}
+
+/*==================[external functions definition]==========================*/
+bool DdsInit(dds_t *dds, uint32_t rate, dds_wave_t wave){
+	if(rate == 0){
+		return false;
+	}
+	if(!dds_sine_ready){
+		for(uint32_t i = 0; i < DDS_SINE_SIZE; i++){
+			dds_sine[i] = lrint(DDS_Q15_MAX * sin(2 * M_PI * i / DDS_SINE_SIZE));
+		}
+		dds_sine[DDS_SINE_SIZE] = dds_sine[0];
+		dds_sine_ready = true;
+	}
+	dds->rate = rate;
+	dds->phase = 0;
+	dds->step = 0;
+	dds->sweep_step = 0;
+	dds->sweep_start = 0;
+	dds->sweep_delta = 0;
+	dds->sweep_len = 0;
+	dds->sweep_count = 0;
+	dds->sweep_repeat = false;
+	dds->table = dds_sine;
+	dds->table_shift = 32 - DDS_SINE_BITS;
+	dds->amplitude = 127;
+	dds->offset = 128;
+	DdsSetWave(dds, wave);
+	return true;
+}
+
+void DdsSetWave(dds_t *dds, dds_wave_t wave){
+	if(wave == DDS_SINE){
+		dds->table = dds_sine;
+		dds->table_shift = 32 - DDS_SINE_BITS;
+	}
+	dds->wave = wave;
+}
+
+bool DdsSetTable(dds_t *dds, const int16_t *table, uint8_t bits){
+	if((table == NULL) || (bits == 0) || (bits > DDS_TABLE_MAX_BITS)){
+		return false;
+	}
+	dds->table = table;
+	dds->table_shift = 32 - bits;
+	dds->wave = DDS_TABLE;
+	return true;
+}
+
+void DdsSetFrequency(dds_t *dds, uint32_t freq){
+	dds->sweep_delta = 0;
+	dds->step = (dds_freq2step(freq, dds->rate) + (1ull << 31)) >> 32;
+}
+
+void DdsSetPhase(dds_t *dds, uint32_t phase){
+	dds->phase = phase;
+}
+
+void DdsSetAmplitude(dds_t *dds, uint8_t amplitude, uint8_t offset){
+	dds->amplitude = amplitude;
+	dds->offset = offset;
+}
+
+void DdsSweep(dds_t *dds, uint32_t start, uint32_t stop, uint32_t samples, bool repeat){
+	uint64_t step_start = dds_freq2step(start, dds->rate);
+	uint64_t step_stop = dds_freq2step(stop, dds->rate);
+	if(samples == 0){
+		DdsSetFrequency(dds, stop);
+		return;
+	}
+	dds->sweep_delta = 0;
+	dds->step = step_start >> 32;
+	dds->sweep_step = step_start;
+	dds->sweep_start = step_start;
+	dds->sweep_len = samples;
+	dds->sweep_count = samples;
+	dds->sweep_repeat = repeat;
+	dds->sweep_delta = ((int64_t)step_stop - (int64_t)step_start) / (int64_t)samples;
+}
+
+int16_t DdsNextRaw(dds_t *dds){
+	uint32_t phase = dds->phase;
+	int32_t value;
+	switch(dds->wave){
+		case DDS_SINE:
+		case DDS_TABLE:{
+			/* linear interpolation between table entries, with 15 bits of the remaining phase */
+			uint32_t index = phase >> dds->table_shift;
+			int32_t fraction = (phase << (32 - dds->table_shift)) >> 17;
+			int32_t a = dds->table[index];
+			int32_t b = dds->table[index + 1];
+			value = a + (((b - a) * fraction) >> 15);
+		}
+		break;
+		case DDS_TRIANGLE:{
+			uint32_t p = phase >> 16;
+			uint32_t t = (p < 0x8000) ? p : (0xFFFF - p);
+			value = 2 * (int32_t)t - DDS_Q15_MAX;
+		}
+		break;
+		case DDS_SQUARE:
+			value = (phase < 0x80000000u) ? DDS_Q15_MAX : -DDS_Q15_MAX;
+		break;
+		case DDS_SAWTOOTH:
+		default:
+			value = (int32_t)(phase >> 16) - 0x8000;
+		break;
+	}
+	dds->phase = phase + dds->step;
+	if(dds->sweep_delta != 0){
+		/* the step changes less than 1 per sample in slow sweeps: keep its fraction apart */
+		dds->sweep_step += dds->sweep_delta;
+		if(--dds->sweep_count == 0){
+			if(dds->sweep_repeat){
+				dds->sweep_step = dds->sweep_start;
+				dds->sweep_count = dds->sweep_len;
+			}else{
+				dds->sweep_delta = 0;
+			}
+		}
+		dds->step = dds->sweep_step >> 32;
+	}
+	return value;
+}
+
+uint8_t DdsNext(void *dds){
+	dds_t *g = dds;
+	int32_t value = g->offset + ((DdsNextRaw(g) * (int32_t)g->amplitude + (1 << 14)) >> 15);
+	if(value < 0){
+		value = 0;
+	}else if(value > 255){
+		value = 255;
+	}
+	return value;
+}
+
+uint16_t DdsNext16(void *dds){
+	dds_t *g = dds;
+	/* 8 bits amplitude and offset times 257: 255 is full scale (amplitude * 257 * 2^15 fits in 31 bits) */
+	int32_t value = g->offset * 257 + ((DdsNextRaw(g) * (int32_t)g->amplitude * 257 + (1 << 14)) >> 15);
+	if(value < 0){
+		value = 0;
+	}else if(value > UINT16_MAX){
+		value = UINT16_MAX;
+	}
+	return value;
+}
+
+void DdsFill(dds_t *dds, uint8_t *buffer, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		buffer[i] = DdsNext(dds);
+	}
+}
+
+void DdsFill16(dds_t *dds, uint16_t *buffer, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		buffer[i] = DdsNext16(dds);
+	}
+}
+/*==================[end of file]============================================*/
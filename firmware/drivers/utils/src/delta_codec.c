@@ -0,0 +1,216 @@
+/**
+ * @file delta_codec.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdbool.h>
+#include "delta_codec.h"
+/*==================[macros and definitions]=================================*/
+#define PACKED_MAX_WIDTH	32
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static uint8_t varint_len(uint32_t value);
+static uint32_t codec_group_size(const uint32_t *zz, uint8_t count, codec_mode_t mode, uint8_t *header);
+static uint8_t *codec_put_group(const uint32_t *zz, uint8_t count, uint8_t header, uint8_t *p);
+static uint32_t codec_encode(const void *x, bool wide, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len);
+static bool codec_decode(const uint8_t *in, uint32_t len, void *x, bool wide, uint32_t n);
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static uint8_t varint_len(uint32_t value){
+	return (value < (1u << 7)) ? 1 : (value < (1u << 14)) ? 2 : (value < (1u << 21)) ? 3 : (value < (1u << 28)) ? 4 : 5;
+}
+
+/**
+ * @brief Encoded size of a group of zigzag residuals (header included), and its header
+ */
+static uint32_t codec_group_size(const uint32_t *zz, uint8_t count, codec_mode_t mode, uint8_t *header){
+	uint32_t bits = 0;
+	uint32_t varint_size = 0;
+	for(uint8_t i = 0; i < count; i++){
+		bits |= zz[i];
+		varint_size += varint_len(zz[i]);
+	}
+	uint8_t width = bits ? 32 - __builtin_clz(bits) : 0;
+	uint32_t packed_size = (count * width + 7) / 8;
+	if((mode == CODEC_VARINT) || ((mode == CODEC_AUTO) && (varint_size < packed_size))){
+		*header = CODEC_GROUP_VARINT;
+		return 1 + varint_size;
+	}
+	*header = width;
+	return 1 + packed_size;
+}
+
+/**
+ * @brief Writes a group of zigzag residuals
+ */
+static uint8_t *codec_put_group(const uint32_t *zz, uint8_t count, uint8_t header, uint8_t *p){
+	*p++ = header;
+	header &= ~CODEC_GROUP_ORDER2;
+	if(header == CODEC_GROUP_VARINT){
+		for(uint8_t i = 0; i < count; i++){
+			p = VarintPut32(p, zz[i]);
+		}
+		return p;
+	}
+	/* bits not written yet are kept in acc (at most 7 + 32) */
+	uint64_t acc = 0;
+	uint8_t acc_bits = 0;
+	for(uint8_t i = 0; i < count; i++){
+		acc |= (uint64_t)zz[i] << acc_bits;
+		acc_bits += header;
+		while(acc_bits >= 8){
+			*p++ = acc;
+			acc >>= 8;
+			acc_bits -= 8;
+		}
+	}
+	if(acc_bits){
+		*p++ = acc;
+	}
+	return p;
+}
+
+/**
+ * @brief Encoder of both sample types: residuals are taken modulo 2^32
+ */
+static uint32_t codec_encode(const void *x, bool wide, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len){
+	const uint16_t *x16 = x;
+	const int32_t *x32 = x;
+	uint8_t *p = out;
+	const uint8_t *end = out + size;
+	*len = 0;
+	if(n == 0){
+		return 0;
+	}
+	/* the sample before the first one is taken equal to it: its second order prediction is the first order one */
+	uint32_t prev = wide ? (uint32_t)x32[0] : x16[0];
+	uint32_t prev2 = prev;
+	if(size < varint_len(ZigzagEncode32(prev))){
+		return 0;
+	}
+	p = VarintPut32(p, ZigzagEncode32(prev));
+	uint32_t done = 1;
+	uint32_t zz1[CODEC_GROUP];
+	uint32_t zz2[CODEC_GROUP];
+	while(done < n){
+		uint8_t count = (n - done < CODEC_GROUP) ? n - done : CODEC_GROUP;
+		uint32_t last = prev;
+		uint32_t last2 = prev2;
+		for(uint8_t i = 0; i < count; i++){
+			uint32_t sample = wide ? (uint32_t)x32[done + i] : x16[done + i];
+			zz1[i] = ZigzagEncode32((int32_t)(sample - last));
+			zz2[i] = ZigzagEncode32((int32_t)(sample - 2 * last + last2));
+			last2 = last;
+			last = sample;
+		}
+		uint8_t header1, header2;
+		uint32_t size1 = codec_group_size(zz1, count, mode, &header1);
+		uint32_t size2 = codec_group_size(zz2, count, mode, &header2);
+		if((uint32_t)(end - p) < ((size2 < size1) ? size2 : size1)){
+			break;
+		}
+		if(size2 < size1){
+			p = codec_put_group(zz2, count, header2 | CODEC_GROUP_ORDER2, p);
+		}else{
+			p = codec_put_group(zz1, count, header1, p);
+		}
+		prev = last;
+		prev2 = last2;
+		done += count;
+	}
+	*len = p - out;
+	return done;
+}
+
+/**
+ * @brief Decoder of both sample types
+ */
+static bool codec_decode(const uint8_t *in, uint32_t len, void *x, bool wide, uint32_t n){
+	uint16_t *x16 = x;
+	int32_t *x32 = x;
+	const uint8_t *p = in;
+	const uint8_t *end = in + len;
+	uint32_t value;
+	if((n == 0) || ((p = VarintGet32(p, end, &value)) == NULL)){
+		return false;
+	}
+	uint32_t prev = ZigzagDecode32(value);
+	uint32_t prev2 = prev;
+	if(wide){
+		x32[0] = prev;
+	}else{
+		x16[0] = prev;
+	}
+	uint32_t done = 1;
+	while(done < n){
+		if(p >= end){
+			return false;
+		}
+		uint8_t count = (n - done < CODEC_GROUP) ? n - done : CODEC_GROUP;
+		bool order2 = *p & CODEC_GROUP_ORDER2;
+		uint8_t width = *p++ & ~CODEC_GROUP_ORDER2;
+		uint64_t acc = 0;
+		uint8_t acc_bits = 0;
+		if((width > PACKED_MAX_WIDTH) && (width != CODEC_GROUP_VARINT)){
+			return false;
+		}
+		if((width <= PACKED_MAX_WIDTH) && ((uint32_t)(end - p) < (count * width + 7u) / 8)){
+			return false;
+		}
+		uint64_t mask = (width <= PACKED_MAX_WIDTH) ? (1ull << width) - 1 : 0;
+		for(uint8_t i = 0; i < count; i++){
+			if(width == CODEC_GROUP_VARINT){
+				if((p = VarintGet32(p, end, &value)) == NULL){
+					return false;
+				}
+			}else{
+				while(acc_bits < width){
+					acc |= (uint64_t)(*p++) << acc_bits;
+					acc_bits += 8;
+				}
+				value = acc & mask;
+				acc >>= width;
+				acc_bits -= width;
+			}
+			uint32_t sample = (order2 ? 2 * prev - prev2 : prev) + ZigzagDecode32(value);
+			prev2 = prev;
+			prev = sample;
+			if(wide){
+				x32[done + i] = sample;
+			}else{
+				x16[done + i] = sample;
+			}
+		}
+		done += count;
+	}
+	return p == end;
+}
+
+/*==================[external functions definition]==========================*/
+uint32_t CodecEncodeU16(const uint16_t *x, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len){
+	return codec_encode(x, false, n, mode, out, size, len);
+}
+
+uint32_t CodecEncodeI32(const int32_t *x, uint32_t n, codec_mode_t mode, uint8_t *out, uint32_t size, uint32_t *len){
+	return codec_encode(x, true, n, mode, out, size, len);
+}
+
+bool CodecDecodeU16(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t n){
+	return codec_decode(in, len, x, false, n);
+}
+
+bool CodecDecodeI32(const uint8_t *in, uint32_t len, int32_t *x, uint32_t n){
+	return codec_decode(in, len, x, true, n);
+}
+/*==================[end of file]============================================*/
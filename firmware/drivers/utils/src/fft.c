@@ -0,0 +1,361 @@
+/**
+ * @file fft.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "fft.h"
+#include <stddef.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define FFT_Q15_ONE		32768
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static int32_t fft_cos(uint32_t index);
+static inline void fft_mul(int32_t ar, int32_t ai, fft_complex_t w, int32_t *re, int32_t *im);
+static void fft_bit_reverse(fft_complex_t *x, uint16_t points);
+
+/*==================[internal data definition]===============================*/
+/**
+ * @brief Twiddle factors W^k = exp(-j 2 pi k / FFT_MAX_POINTS), k = 0 .. FFT_MAX_POINTS / 2 - 1:
+ * {round(32767 cos), round(-32767 sin)}. Const, so it stays in flash.
+ */
+static const fft_complex_t fft_twiddle[FFT_MAX_POINTS / 2] = {
+	{32767, 0}, {32767, -101}, {32766, -201}, {32766, -302}, {32765, -402}, {32763, -503}, {32761, -603}, {32759, -704},
+	{32757, -804}, {32755, -905}, {32752, -1005}, {32748, -1106}, {32745, -1206}, {32741, -1307}, {32737, -1407}, {32732, -1507},
+	{32728, -1608}, {32722, -1708}, {32717, -1809}, {32711, -1909}, {32705, -2009}, {32699, -2110}, {32692, -2210}, {32685, -2310},
+	{32678, -2410}, {32671, -2511}, {32663, -2611}, {32655, -2711}, {32646, -2811}, {32637, -2911}, {32628, -3012}, {32619, -3112},
+	{32609, -3212}, {32599, -3312}, {32589, -3412}, {32578, -3512}, {32567, -3612}, {32556, -3712}, {32545, -3811}, {32533, -3911},
+	{32521, -4011}, {32508, -4111}, {32495, -4210}, {32482, -4310}, {32469, -4410}, {32455, -4509}, {32441, -4609}, {32427, -4708},
+	{32412, -4808}, {32397, -4907}, {32382, -5007}, {32367, -5106}, {32351, -5205}, {32335, -5305}, {32318, -5404}, {32302, -5503},
+	{32285, -5602}, {32267, -5701}, {32250, -5800}, {32232, -5899}, {32213, -5998}, {32195, -6096}, {32176, -6195}, {32157, -6294},
+	{32137, -6393}, {32118, -6491}, {32098, -6590}, {32077, -6688}, {32057, -6786}, {32036, -6885}, {32014, -6983}, {31993, -7081},
+	{31971, -7179}, {31949, -7277}, {31926, -7375}, {31903, -7473}, {31880, -7571}, {31857, -7669}, {31833, -7767}, {31809, -7864},
+	{31785, -7962}, {31760, -8059}, {31736, -8157}, {31710, -8254}, {31685, -8351}, {31659, -8448}, {31633, -8545}, {31607, -8642},
+	{31580, -8739}, {31553, -8836}, {31526, -8933}, {31498, -9030}, {31470, -9126}, {31442, -9223}, {31414, -9319}, {31385, -9416},
+	{31356, -9512}, {31327, -9608}, {31297, -9704}, {31267, -9800}, {31237, -9896}, {31206, -9992}, {31176, -10087}, {31145, -10183},
+	{31113, -10278}, {31082, -10374}, {31050, -10469}, {31017, -10564}, {30985, -10659}, {30952, -10754}, {30919, -10849}, {30885, -10944},
+	{30852, -11039}, {30818, -11133}, {30783, -11228}, {30749, -11322}, {30714, -11417}, {30679, -11511}, {30643, -11605}, {30607, -11699},
+	{30571, -11793}, {30535, -11886}, {30498, -11980}, {30462, -12074}, {30424, -12167}, {30387, -12260}, {30349, -12353}, {30311, -12446},
+	{30273, -12539}, {30234, -12632}, {30195, -12725}, {30156, -12817}, {30117, -12910}, {30077, -13002}, {30037, -13094}, {29997, -13187},
+	{29956, -13279}, {29915, -13370}, {29874, -13462}, {29832, -13554}, {29791, -13645}, {29749, -13736}, {29706, -13828}, {29664, -13919},
+	{29621, -14010}, {29578, -14101}, {29534, -14191}, {29491, -14282}, {29447, -14372}, {29403, -14462}, {29358, -14553}, {29313, -14643},
+	{29268, -14732}, {29223, -14822}, {29177, -14912}, {29131, -15001}, {29085, -15090}, {29039, -15180}, {28992, -15269}, {28945, -15358},
+	{28898, -15446}, {28850, -15535}, {28803, -15623}, {28755, -15712}, {28706, -15800}, {28658, -15888}, {28609, -15976}, {28560, -16063},
+	{28510, -16151}, {28460, -16238}, {28411, -16325}, {28360, -16413}, {28310, -16499}, {28259, -16586}, {28208, -16673}, {28157, -16759},
+	{28105, -16846}, {28053, -16932}, {28001, -17018}, {27949, -17104}, {27896, -17189}, {27843, -17275}, {27790, -17360}, {27737, -17445},
+	{27683, -17530}, {27629, -17615}, {27575, -17700}, {27521, -17784}, {27466, -17869}, {27411, -17953}, {27356, -18037}, {27300, -18121},
+	{27245, -18204}, {27189, -18288}, {27133, -18371}, {27076, -18454}, {27019, -18537}, {26962, -18620}, {26905, -18703}, {26848, -18785},
+	{26790, -18868}, {26732, -18950}, {26674, -19032}, {26615, -19113}, {26556, -19195}, {26497, -19276}, {26438, -19357}, {26378, -19438},
+	{26319, -19519}, {26259, -19600}, {26198, -19680}, {26138, -19761}, {26077, -19841}, {26016, -19921}, {25955, -20000}, {25893, -20080},
+	{25832, -20159}, {25770, -20238}, {25708, -20317}, {25645, -20396}, {25582, -20475}, {25519, -20553}, {25456, -20631}, {25393, -20709},
+	{25329, -20787}, {25265, -20865}, {25201, -20942}, {25137, -21019}, {25072, -21096}, {25007, -21173}, {24942, -21250}, {24877, -21326},
+	{24811, -21403}, {24746, -21479}, {24680, -21554}, {24613, -21630}, {24547, -21705}, {24480, -21781}, {24413, -21856}, {24346, -21930},
+	{24279, -22005}, {24211, -22079}, {24143, -22154}, {24075, -22227}, {24007, -22301}, {23938, -22375}, {23870, -22448}, {23801, -22521},
+	{23731, -22594}, {23662, -22667}, {23592, -22739}, {23522, -22812}, {23452, -22884}, {23382, -22956}, {23311, -23027}, {23241, -23099},
+	{23170, -23170}, {23099, -23241}, {23027, -23311}, {22956, -23382}, {22884, -23452}, {22812, -23522}, {22739, -23592}, {22667, -23662},
+	{22594, -23731}, {22521, -23801}, {22448, -23870}, {22375, -23938}, {22301, -24007}, {22227, -24075}, {22154, -24143}, {22079, -24211},
+	{22005, -24279}, {21930, -24346}, {21856, -24413}, {21781, -24480}, {21705, -24547}, {21630, -24613}, {21554, -24680}, {21479, -24746},
+	{21403, -24811}, {21326, -24877}, {21250, -24942}, {21173, -25007}, {21096, -25072}, {21019, -25137}, {20942, -25201}, {20865, -25265},
+	{20787, -25329}, {20709, -25393}, {20631, -25456}, {20553, -25519}, {20475, -25582}, {20396, -25645}, {20317, -25708}, {20238, -25770},
+	{20159, -25832}, {20080, -25893}, {20000, -25955}, {19921, -26016}, {19841, -26077}, {19761, -26138}, {19680, -26198}, {19600, -26259},
+	{19519, -26319}, {19438, -26378}, {19357, -26438}, {19276, -26497}, {19195, -26556}, {19113, -26615}, {19032, -26674}, {18950, -26732},
+	{18868, -26790}, {18785, -26848}, {18703, -26905}, {18620, -26962}, {18537, -27019}, {18454, -27076}, {18371, -27133}, {18288, -27189},
+	{18204, -27245}, {18121, -27300}, {18037, -27356}, {17953, -27411}, {17869, -27466}, {17784, -27521}, {17700, -27575}, {17615, -27629},
+	{17530, -27683}, {17445, -27737}, {17360, -27790}, {17275, -27843}, {17189, -27896}, {17104, -27949}, {17018, -28001}, {16932, -28053},
+	{16846, -28105}, {16759, -28157}, {16673, -28208}, {16586, -28259}, {16499, -28310}, {16413, -28360}, {16325, -28411}, {16238, -28460},
+	{16151, -28510}, {16063, -28560}, {15976, -28609}, {15888, -28658}, {15800, -28706}, {15712, -28755}, {15623, -28803}, {15535, -28850},
+	{15446, -28898}, {15358, -28945}, {15269, -28992}, {15180, -29039}, {15090, -29085}, {15001, -29131}, {14912, -29177}, {14822, -29223},
+	{14732, -29268}, {14643, -29313}, {14553, -29358}, {14462, -29403}, {14372, -29447}, {14282, -29491}, {14191, -29534}, {14101, -29578},
+	{14010, -29621}, {13919, -29664}, {13828, -29706}, {13736, -29749}, {13645, -29791}, {13554, -29832}, {13462, -29874}, {13370, -29915},
+	{13279, -29956}, {13187, -29997}, {13094, -30037}, {13002, -30077}, {12910, -30117}, {12817, -30156}, {12725, -30195}, {12632, -30234},
+	{12539, -30273}, {12446, -30311}, {12353, -30349}, {12260, -30387}, {12167, -30424}, {12074, -30462}, {11980, -30498}, {11886, -30535},
+	{11793, -30571}, {11699, -30607}, {11605, -30643}, {11511, -30679}, {11417, -30714}, {11322, -30749}, {11228, -30783}, {11133, -30818},
+	{11039, -30852}, {10944, -30885}, {10849, -30919}, {10754, -30952}, {10659, -30985}, {10564, -31017}, {10469, -31050}, {10374, -31082},
+	{10278, -31113}, {10183, -31145}, {10087, -31176}, {9992, -31206}, {9896, -31237}, {9800, -31267}, {9704, -31297}, {9608, -31327},
+	{9512, -31356}, {9416, -31385}, {9319, -31414}, {9223, -31442}, {9126, -31470}, {9030, -31498}, {8933, -31526}, {8836, -31553},
+	{8739, -31580}, {8642, -31607}, {8545, -31633}, {8448, -31659}, {8351, -31685}, {8254, -31710}, {8157, -31736}, {8059, -31760},
+	{7962, -31785}, {7864, -31809}, {7767, -31833}, {7669, -31857}, {7571, -31880}, {7473, -31903}, {7375, -31926}, {7277, -31949},
+	{7179, -31971}, {7081, -31993}, {6983, -32014}, {6885, -32036}, {6786, -32057}, {6688, -32077}, {6590, -32098}, {6491, -32118},
+	{6393, -32137}, {6294, -32157}, {6195, -32176}, {6096, -32195}, {5998, -32213}, {5899, -32232}, {5800, -32250}, {5701, -32267},
+	{5602, -32285}, {5503, -32302}, {5404, -32318}, {5305, -32335}, {5205, -32351}, {5106, -32367}, {5007, -32382}, {4907, -32397},
+	{4808, -32412}, {4708, -32427}, {4609, -32441}, {4509, -32455}, {4410, -32469}, {4310, -32482}, {4210, -32495}, {4111, -32508},
+	{4011, -32521}, {3911, -32533}, {3811, -32545}, {3712, -32556}, {3612, -32567}, {3512, -32578}, {3412, -32589}, {3312, -32599},
+	{3212, -32609}, {3112, -32619}, {3012, -32628}, {2911, -32637}, {2811, -32646}, {2711, -32655}, {2611, -32663}, {2511, -32671},
+	{2410, -32678}, {2310, -32685}, {2210, -32692}, {2110, -32699}, {2009, -32705}, {1909, -32711}, {1809, -32717}, {1708, -32722},
+	{1608, -32728}, {1507, -32732}, {1407, -32737}, {1307, -32741}, {1206, -32745}, {1106, -32748}, {1005, -32752}, {905, -32755},
+	{804, -32757}, {704, -32759}, {603, -32761}, {503, -32763}, {402, -32765}, {302, -32766}, {201, -32766}, {101, -32767},
+	{0, -32767}, {-101, -32767}, {-201, -32766}, {-302, -32766}, {-402, -32765}, {-503, -32763}, {-603, -32761}, {-704, -32759},
+	{-804, -32757}, {-905, -32755}, {-1005, -32752}, {-1106, -32748}, {-1206, -32745}, {-1307, -32741}, {-1407, -32737}, {-1507, -32732},
+	{-1608, -32728}, {-1708, -32722}, {-1809, -32717}, {-1909, -32711}, {-2009, -32705}, {-2110, -32699}, {-2210, -32692}, {-2310, -32685},
+	{-2410, -32678}, {-2511, -32671}, {-2611, -32663}, {-2711, -32655}, {-2811, -32646}, {-2911, -32637}, {-3012, -32628}, {-3112, -32619},
+	{-3212, -32609}, {-3312, -32599}, {-3412, -32589}, {-3512, -32578}, {-3612, -32567}, {-3712, -32556}, {-3811, -32545}, {-3911, -32533},
+	{-4011, -32521}, {-4111, -32508}, {-4210, -32495}, {-4310, -32482}, {-4410, -32469}, {-4509, -32455}, {-4609, -32441}, {-4708, -32427},
+	{-4808, -32412}, {-4907, -32397}, {-5007, -32382}, {-5106, -32367}, {-5205, -32351}, {-5305, -32335}, {-5404, -32318}, {-5503, -32302},
+	{-5602, -32285}, {-5701, -32267}, {-5800, -32250}, {-5899, -32232}, {-5998, -32213}, {-6096, -32195}, {-6195, -32176}, {-6294, -32157},
+	{-6393, -32137}, {-6491, -32118}, {-6590, -32098}, {-6688, -32077}, {-6786, -32057}, {-6885, -32036}, {-6983, -32014}, {-7081, -31993},
+	{-7179, -31971}, {-7277, -31949}, {-7375, -31926}, {-7473, -31903}, {-7571, -31880}, {-7669, -31857}, {-7767, -31833}, {-7864, -31809},
+	{-7962, -31785}, {-8059, -31760}, {-8157, -31736}, {-8254, -31710}, {-8351, -31685}, {-8448, -31659}, {-8545, -31633}, {-8642, -31607},
+	{-8739, -31580}, {-8836, -31553}, {-8933, -31526}, {-9030, -31498}, {-9126, -31470}, {-9223, -31442}, {-9319, -31414}, {-9416, -31385},
+	{-9512, -31356}, {-9608, -31327}, {-9704, -31297}, {-9800, -31267}, {-9896, -31237}, {-9992, -31206}, {-10087, -31176}, {-10183, -31145},
+	{-10278, -31113}, {-10374, -31082}, {-10469, -31050}, {-10564, -31017}, {-10659, -30985}, {-10754, -30952}, {-10849, -30919}, {-10944, -30885},
+	{-11039, -30852}, {-11133, -30818}, {-11228, -30783}, {-11322, -30749}, {-11417, -30714}, {-11511, -30679}, {-11605, -30643}, {-11699, -30607},
+	{-11793, -30571}, {-11886, -30535}, {-11980, -30498}, {-12074, -30462}, {-12167, -30424}, {-12260, -30387}, {-12353, -30349}, {-12446, -30311},
+	{-12539, -30273}, {-12632, -30234}, {-12725, -30195}, {-12817, -30156}, {-12910, -30117}, {-13002, -30077}, {-13094, -30037}, {-13187, -29997},
+	{-13279, -29956}, {-13370, -29915}, {-13462, -29874}, {-13554, -29832}, {-13645, -29791}, {-13736, -29749}, {-13828, -29706}, {-13919, -29664},
+	{-14010, -29621}, {-14101, -29578}, {-14191, -29534}, {-14282, -29491}, {-14372, -29447}, {-14462, -29403}, {-14553, -29358}, {-14643, -29313},
+	{-14732, -29268}, {-14822, -29223}, {-14912, -29177}, {-15001, -29131}, {-15090, -29085}, {-15180, -29039}, {-15269, -28992}, {-15358, -28945},
+	{-15446, -28898}, {-15535, -28850}, {-15623, -28803}, {-15712, -28755}, {-15800, -28706}, {-15888, -28658}, {-15976, -28609}, {-16063, -28560},
+	{-16151, -28510}, {-16238, -28460}, {-16325, -28411}, {-16413, -28360}, {-16499, -28310}, {-16586, -28259}, {-16673, -28208}, {-16759, -28157},
+	{-16846, -28105}, {-16932, -28053}, {-17018, -28001}, {-17104, -27949}, {-17189, -27896}, {-17275, -27843}, {-17360, -27790}, {-17445, -27737},
+	{-17530, -27683}, {-17615, -27629}, {-17700, -27575}, {-17784, -27521}, {-17869, -27466}, {-17953, -27411}, {-18037, -27356}, {-18121, -27300},
+	{-18204, -27245}, {-18288, -27189}, {-18371, -27133}, {-18454, -27076}, {-18537, -27019}, {-18620, -26962}, {-18703, -26905}, {-18785, -26848},
+	{-18868, -26790}, {-18950, -26732}, {-19032, -26674}, {-19113, -26615}, {-19195, -26556}, {-19276, -26497}, {-19357, -26438}, {-19438, -26378},
+	{-19519, -26319}, {-19600, -26259}, {-19680, -26198}, {-19761, -26138}, {-19841, -26077}, {-19921, -26016}, {-20000, -25955}, {-20080, -25893},
+	{-20159, -25832}, {-20238, -25770}, {-20317, -25708}, {-20396, -25645}, {-20475, -25582}, {-20553, -25519}, {-20631, -25456}, {-20709, -25393},
+	{-20787, -25329}, {-20865, -25265}, {-20942, -25201}, {-21019, -25137}, {-21096, -25072}, {-21173, -25007}, {-21250, -24942}, {-21326, -24877},
+	{-21403, -24811}, {-21479, -24746}, {-21554, -24680}, {-21630, -24613}, {-21705, -24547}, {-21781, -24480}, {-21856, -24413}, {-21930, -24346},
+	{-22005, -24279}, {-22079, -24211}, {-22154, -24143}, {-22227, -24075}, {-22301, -24007}, {-22375, -23938}, {-22448, -23870}, {-22521, -23801},
+	{-22594, -23731}, {-22667, -23662}, {-22739, -23592}, {-22812, -23522}, {-22884, -23452}, {-22956, -23382}, {-23027, -23311}, {-23099, -23241},
+	{-23170, -23170}, {-23241, -23099}, {-23311, -23027}, {-23382, -22956}, {-23452, -22884}, {-23522, -22812}, {-23592, -22739}, {-23662, -22667},
+	{-23731, -22594}, {-23801, -22521}, {-23870, -22448}, {-23938, -22375}, {-24007, -22301}, {-24075, -22227}, {-24143, -22154}, {-24211, -22079},
+	{-24279, -22005}, {-24346, -21930}, {-24413, -21856}, {-24480, -21781}, {-24547, -21705}, {-24613, -21630}, {-24680, -21554}, {-24746, -21479},
+	{-24811, -21403}, {-24877, -21326}, {-24942, -21250}, {-25007, -21173}, {-25072, -21096}, {-25137, -21019}, {-25201, -20942}, {-25265, -20865},
+	{-25329, -20787}, {-25393, -20709}, {-25456, -20631}, {-25519, -20553}, {-25582, -20475}, {-25645, -20396}, {-25708, -20317}, {-25770, -20238},
+	{-25832, -20159}, {-25893, -20080}, {-25955, -20000}, {-26016, -19921}, {-26077, -19841}, {-26138, -19761}, {-26198, -19680}, {-26259, -19600},
+	{-26319, -19519}, {-26378, -19438}, {-26438, -19357}, {-26497, -19276}, {-26556, -19195}, {-26615, -19113}, {-26674, -19032}, {-26732, -18950},
+	{-26790, -18868}, {-26848, -18785}, {-26905, -18703}, {-26962, -18620}, {-27019, -18537}, {-27076, -18454}, {-27133, -18371}, {-27189, -18288},
+	{-27245, -18204}, {-27300, -18121}, {-27356, -18037}, {-27411, -17953}, {-27466, -17869}, {-27521, -17784}, {-27575, -17700}, {-27629, -17615},
+	{-27683, -17530}, {-27737, -17445}, {-27790, -17360}, {-27843, -17275}, {-27896, -17189}, {-27949, -17104}, {-28001, -17018}, {-28053, -16932},
+	{-28105, -16846}, {-28157, -16759}, {-28208, -16673}, {-28259, -16586}, {-28310, -16499}, {-28360, -16413}, {-28411, -16325}, {-28460, -16238},
+	{-28510, -16151}, {-28560, -16063}, {-28609, -15976}, {-28658, -15888}, {-28706, -15800}, {-28755, -15712}, {-28803, -15623}, {-28850, -15535},
+	{-28898, -15446}, {-28945, -15358}, {-28992, -15269}, {-29039, -15180}, {-29085, -15090}, {-29131, -15001}, {-29177, -14912}, {-29223, -14822},
+	{-29268, -14732}, {-29313, -14643}, {-29358, -14553}, {-29403, -14462}, {-29447, -14372}, {-29491, -14282}, {-29534, -14191}, {-29578, -14101},
+	{-29621, -14010}, {-29664, -13919}, {-29706, -13828}, {-29749, -13736}, {-29791, -13645}, {-29832, -13554}, {-29874, -13462}, {-29915, -13370},
+	{-29956, -13279}, {-29997, -13187}, {-30037, -13094}, {-30077, -13002}, {-30117, -12910}, {-30156, -12817}, {-30195, -12725}, {-30234, -12632},
+	{-30273, -12539}, {-30311, -12446}, {-30349, -12353}, {-30387, -12260}, {-30424, -12167}, {-30462, -12074}, {-30498, -11980}, {-30535, -11886},
+	{-30571, -11793}, {-30607, -11699}, {-30643, -11605}, {-30679, -11511}, {-30714, -11417}, {-30749, -11322}, {-30783, -11228}, {-30818, -11133},
+	{-30852, -11039}, {-30885, -10944}, {-30919, -10849}, {-30952, -10754}, {-30985, -10659}, {-31017, -10564}, {-31050, -10469}, {-31082, -10374},
+	{-31113, -10278}, {-31145, -10183}, {-31176, -10087}, {-31206, -9992}, {-31237, -9896}, {-31267, -9800}, {-31297, -9704}, {-31327, -9608},
+	{-31356, -9512}, {-31385, -9416}, {-31414, -9319}, {-31442, -9223}, {-31470, -9126}, {-31498, -9030}, {-31526, -8933}, {-31553, -8836},
+	{-31580, -8739}, {-31607, -8642}, {-31633, -8545}, {-31659, -8448}, {-31685, -8351}, {-31710, -8254}, {-31736, -8157}, {-31760, -8059},
+	{-31785, -7962}, {-31809, -7864}, {-31833, -7767}, {-31857, -7669}, {-31880, -7571}, {-31903, -7473}, {-31926, -7375}, {-31949, -7277},
+	{-31971, -7179}, {-31993, -7081}, {-32014, -6983}, {-32036, -6885}, {-32057, -6786}, {-32077, -6688}, {-32098, -6590}, {-32118, -6491},
+	{-32137, -6393}, {-32157, -6294}, {-32176, -6195}, {-32195, -6096}, {-32213, -5998}, {-32232, -5899}, {-32250, -5800}, {-32267, -5701},
+	{-32285, -5602}, {-32302, -5503}, {-32318, -5404}, {-32335, -5305}, {-32351, -5205}, {-32367, -5106}, {-32382, -5007}, {-32397, -4907},
+	{-32412, -4808}, {-32427, -4708}, {-32441, -4609}, {-32455, -4509}, {-32469, -4410}, {-32482, -4310}, {-32495, -4210}, {-32508, -4111},
+	{-32521, -4011}, {-32533, -3911}, {-32545, -3811}, {-32556, -3712}, {-32567, -3612}, {-32578, -3512}, {-32589, -3412}, {-32599, -3312},
+	{-32609, -3212}, {-32619, -3112}, {-32628, -3012}, {-32637, -2911}, {-32646, -2811}, {-32655, -2711}, {-32663, -2611}, {-32671, -2511},
+	{-32678, -2410}, {-32685, -2310}, {-32692, -2210}, {-32699, -2110}, {-32705, -2009}, {-32711, -1909}, {-32717, -1809}, {-32722, -1708},
+	{-32728, -1608}, {-32732, -1507}, {-32737, -1407}, {-32741, -1307}, {-32745, -1206}, {-32748, -1106}, {-32752, -1005}, {-32755, -905},
+	{-32757, -804}, {-32759, -704}, {-32761, -603}, {-32763, -503}, {-32765, -402}, {-32766, -302}, {-32766, -201}, {-32767, -101},
+};
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief cos(2 pi index / FFT_MAX_POINTS) in Q15, from the twiddle table
+ */
+static int32_t fft_cos(uint32_t index){
+	index &= FFT_MAX_POINTS - 1;
+	/* the table holds 32767 for 1, keep the exact value for the windows */
+	if((index & (FFT_MAX_POINTS / 2 - 1)) == 0){
+		return (index == 0) ? FFT_Q15_ONE : -FFT_Q15_ONE;
+	}
+	if(index < FFT_MAX_POINTS / 2){
+		return fft_twiddle[index].re;
+	}
+	return -fft_twiddle[index - FFT_MAX_POINTS / 2].re;
+}
+
+/**
+ * @brief Complex product (a * w) in Q15, rounded
+ */
+static inline void fft_mul(int32_t ar, int32_t ai, fft_complex_t w, int32_t *re, int32_t *im){
+	*re = (ar * w.re - ai * w.im + (1 << 14)) >> 15;
+	*im = (ar * w.im + ai * w.re + (1 << 14)) >> 15;
+}
+
+/**
+ * @brief Bit reversed order permutation (input of the decimation in time stages)
+ */
+static void fft_bit_reverse(fft_complex_t *x, uint16_t points){
+	for(uint32_t i = 1, j = 0; i < points; i++){
+		uint32_t bit = points >> 1;
+		for(; j & bit; bit >>= 1){
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j){
+			fft_complex_t t = x[i];
+			x[i] = x[j];
+			x[j] = t;
+		}
+	}
+}
+
+/*==================[external functions definition]==========================*/
+bool FftComplex(fft_complex_t *x, uint16_t points){
+	if((x == NULL) || (points < FFT_MIN_POINTS) || (points > FFT_MAX_POINTS) || ((points & (points - 1)) != 0)){
+		return false;
+	}
+	fft_bit_reverse(x, points);
+	uint8_t log2_points = 0;
+	while((1U << log2_points) < points){
+		log2_points++;
+	}
+	/* half is the butterfly span: 1 for the first stage */
+	uint32_t half = 1;
+	if(log2_points & 1){
+		/* odd number of stages: one radix-2 stage (W = 1) first */
+		for(uint32_t g = 0; g < points; g += 2){
+			int32_t ar = x[g].re, ai = x[g].im;
+			int32_t br = x[g + 1].re, bi = x[g + 1].im;
+			x[g].re = (ar + br + 1) >> 1;
+			x[g].im = (ai + bi + 1) >> 1;
+			x[g + 1].re = (ar - br + 1) >> 1;
+			x[g + 1].im = (ai - bi + 1) >> 1;
+		}
+		half = 2;
+	}
+	/* radix-2² stages: two radix-2 stages (spans half and 2 half) per pass over the data */
+	for(; half < points; half *= 4){
+		const uint32_t step1 = FFT_MAX_POINTS / (2 * half);
+		const uint32_t step2 = FFT_MAX_POINTS / (4 * half);
+		for(uint32_t g = 0; g < points; g += 4 * half){
+			fft_complex_t *p = &x[g];
+			for(uint32_t j = 0; j < half; j++, p++){
+				int32_t tr, ti;
+				/* first stage: spans half, twiddle W(2 half)^j */
+				fft_complex_t w1 = fft_twiddle[j * step1];
+				fft_mul(p[half].re, p[half].im, w1, &tr, &ti);
+				int32_t ar = (p[0].re + tr) >> 1, ai = (p[0].im + ti + 1) >> 1;
+				int32_t br = (p[0].re - tr) >> 1, bi = (p[0].im - ti + 1) >> 1;
+				fft_mul(p[3 * half].re, p[3 * half].im, w1, &tr, &ti);
+				int32_t cr = (p[2 * half].re + tr) >> 1, ci = (p[2 * half].im + ti + 1) >> 1;
+				int32_t dr = (p[2 * half].re - tr) >> 1, di = (p[2 * half].im - ti + 1) >> 1;
+				/* second stage: spans 2 half, twiddles W(4 half)^j and W(4 half)^(j + half) = -j W(4 half)^j */
+				fft_complex_t w2 = fft_twiddle[j * step2];
+				fft_mul(cr, ci, w2, &tr, &ti);
+				p[0].re = (ar + tr + 1) >> 1;
+				p[0].im = (ai + ti + 1) >> 1;
+				p[2 * half].re = (ar - tr + 1) >> 1;
+				p[2 * half].im = (ai - ti + 1) >> 1;
+				fft_mul(dr, di, w2, &tr, &ti);
+				p[half].re = (br + ti + 1) >> 1;
+				p[half].im = (bi - tr + 1) >> 1;
+				p[3 * half].re = (br - ti + 1) >> 1;
+				p[3 * half].im = (bi + tr + 1) >> 1;
+			}
+		}
+	}
+	return true;
+}
+
+bool FftWindow(fft_window_t window, int16_t *coeffs, uint16_t points){
+	/* a0 - a1 cos(2 pi k / N) + a2 cos(4 pi k / N) - a3 cos(6 pi k / N), coefficients in Q15 */
+	static const int32_t a[][4] = {
+		[FFT_WINDOW_RECTANGULAR] = {FFT_Q15_ONE - 1, 0, 0, 0},
+		[FFT_WINDOW_HANN] = {16384, 16384, 0, 0},
+		[FFT_WINDOW_HAMMING] = {17695, 15073, 0, 0},
+		[FFT_WINDOW_BLACKMAN_HARRIS] = {11755, 16000, 4629, 383},
+	};
+	if((coeffs == NULL) || (window > FFT_WINDOW_BLACKMAN_HARRIS) || (points < FFT_MIN_POINTS)
+		|| (points > FFT_MAX_POINTS) || ((points & (points - 1)) != 0)){
+		return false;
+	}
+	const uint32_t step = FFT_MAX_POINTS / points;
+	for(uint32_t k = 0; k < points; k++){
+		int32_t w = a[window][0] * FFT_Q15_ONE - a[window][1] * fft_cos(k * step)
+			+ a[window][2] * fft_cos(2 * k * step) - a[window][3] * fft_cos(3 * k * step);
+		w = (w + (1 << 14)) >> 15;
+		coeffs[k] = (w > FFT_Q15_ONE - 1) ? FFT_Q15_ONE - 1 : (w < 0) ? 0 : w;
+	}
+	return true;
+}
+
+void FftPower(const fft_complex_t *x, uint32_t *power, uint16_t bins){
+	for(uint16_t k = 0; k < bins; k++){
+		power[k] = (uint32_t)(x[k].re * x[k].re) + (uint32_t)(x[k].im * x[k].im);
+	}
+}
+
+bool WelchInit(welch_t *welch, uint16_t points, const int16_t *window, uint8_t bits,
+	int16_t *segment, fft_complex_t *work, float *power){
+	if((welch == NULL) || (window == NULL) || (segment == NULL) || (work == NULL) || (power == NULL)
+		|| (bits == 0) || (bits > 16) || (points < FFT_MIN_POINTS) || (points > FFT_MAX_POINTS)
+		|| ((points & (points - 1)) != 0)){
+		return false;
+	}
+	welch->points = points;
+	welch->shift = 16 - bits;
+	welch->bias = 1UL << (bits - 1);
+	welch->window = window;
+	welch->segment = segment;
+	welch->work = work;
+	welch->power = power;
+	float sum = 0;
+	for(uint16_t k = 0; k < points; k++){
+		float w = (float)window[k] / FFT_Q15_ONE;
+		sum += w * w;
+	}
+	welch->window_power = sum;
+	WelchReset(welch);
+	return true;
+}
+
+void WelchReset(welch_t *welch){
+	welch->fill = 0;
+	welch->segments = 0;
+	for(uint16_t k = 0; k <= welch->points / 2; k++){
+		welch->power[k] = 0;
+	}
+}
+
+uint32_t WelchPush(welch_t *welch, const uint16_t *x, uint32_t n){
+	const uint16_t points = welch->points;
+	for(uint32_t i = 0; i < n; i++){
+		int32_t s = ((int32_t)x[i] - welch->bias) * (1 << welch->shift);
+		welch->segment[welch->fill++] = (s > INT16_MAX) ? INT16_MAX : (s < INT16_MIN) ? INT16_MIN : s;
+		if(welch->fill < points){
+			continue;
+		}
+		for(uint16_t k = 0; k < points; k++){
+			welch->work[k].re = (welch->segment[k] * welch->window[k] + (1 << 14)) >> 15;
+			welch->work[k].im = 0;
+		}
+		FftComplex(welch->work, points);
+		for(uint16_t k = 0; k <= points / 2; k++){
+			float re = welch->work[k].re, im = welch->work[k].im;
+			welch->power[k] += re * re + im * im;
+		}
+		welch->segments++;
+		/* 50 % overlap: the second half is the start of the next segment */
+		memcpy(welch->segment, &welch->segment[points / 2], points / 2 * sizeof(welch->segment[0]));
+		welch->fill = points / 2;
+	}
+	return welch->segments;
+}
+
+bool WelchGetPsd(const welch_t *welch, float sample_frec, float *psd){
+	if((welch->segments == 0) || (sample_frec <= 0)){
+		return false;
+	}
+	const uint16_t points = welch->points;
+	/* FFT output is DFT / points of samples scaled by 2^shift: back to counts, per Hz, one sided */
+	float counts = (float)points / (1UL << welch->shift);
+	float scale = counts * counts / (sample_frec * welch->window_power * welch->segments);
+	for(uint16_t k = 0; k <= points / 2; k++){
+		psd[k] = welch->power[k] * scale * (((k == 0) || (k == points / 2)) ? 1 : 2);
+	}
+	return true;
+}
+/*==================[end of file]============================================*/
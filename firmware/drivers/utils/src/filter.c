@@ -0,0 +1,279 @@
+/**
+ * @file filter.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @note Inner loops are written for RV32IMAC (no SIMD, single cycle 32 bits MUL, MULH
+ * for the high half of 64 bits products): they walk pointers over contiguous memory,
+ * are unrolled by 4 and keep 32 bits accumulators where the range allows it.
+ */
+
+/*==================[inclusions]=============================================*/
+#include "filter.h"
+#include <stddef.h>
+/*==================[macros and definitions]=================================*/
+#define FILTER_U16_MAX		65535
+#define FILTER_I16_MIN		(-32768)
+#define FILTER_I16_MAX		32767
+#define BIQUAD_COEFF_BITS	30
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static inline uint16_t filter_sat_u16(int32_t value);
+static inline int16_t filter_sat_i16(int32_t value);
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static inline uint16_t filter_sat_u16(int32_t value){
+	if(value < 0){
+		return 0;
+	}
+	if(value > FILTER_U16_MAX){
+		return FILTER_U16_MAX;
+	}
+	return value;
+}
+
+static inline int16_t filter_sat_i16(int32_t value){
+	if(value < FILTER_I16_MIN){
+		return FILTER_I16_MIN;
+	}
+	if(value > FILTER_I16_MAX){
+		return FILTER_I16_MAX;
+	}
+	return value;
+}
+
+/*==================[external functions definition]==========================*/
+bool FirQ15Init(fir_q15_t *fir, const int16_t *coeffs, uint16_t taps, int16_t *state, uint16_t bias){
+	if((fir == NULL) || (coeffs == NULL) || (state == NULL) || (taps == 0) || (taps > UINT16_MAX / 2)){
+		return false;
+	}
+	fir->coeffs = coeffs;
+	fir->state = state;
+	fir->taps = taps;
+	fir->pos = 0;
+	fir->bias = bias;
+	for(uint32_t i = 0; i < 2 * taps; i++){
+		state[i] = 0;
+	}
+	return true;
+}
+
+void FirQ15Process(fir_q15_t *fir, uint16_t *block, uint32_t n){
+	const uint16_t taps = fir->taps;
+	const int32_t bias = fir->bias;
+	int16_t *state = fir->state;
+	uint16_t pos = fir->pos;
+	for(uint32_t i = 0; i < n; i++){
+		/* newest sample first: state[pos .. pos + taps - 1] = x[n], x[n - 1] ... x[n - taps + 1] */
+		pos = (pos == 0) ? taps - 1 : pos - 1;
+		int16_t x = filter_sat_i16((int32_t)block[i] - bias);
+		state[pos] = x;
+		state[pos + taps] = x;
+		const int16_t *h = fir->coeffs;
+		const int16_t *d = &state[pos];
+		int32_t acc = 1 << 14;
+		for(uint16_t k = taps >> 2; k > 0; k--){
+			acc += h[0] * d[0] + h[1] * d[1] + h[2] * d[2] + h[3] * d[3];
+			h += 4;
+			d += 4;
+		}
+		for(uint16_t k = taps & 3; k > 0; k--){
+			acc += *h++ * *d++;
+		}
+		block[i] = filter_sat_u16((acc >> 15) + bias);
+	}
+	fir->pos = pos;
+}
+
+bool FirQ31Init(fir_q31_t *fir, const int32_t *coeffs, uint16_t taps, int16_t *state, uint16_t bias){
+	if((fir == NULL) || (coeffs == NULL) || (state == NULL) || (taps == 0) || (taps > UINT16_MAX / 2)){
+		return false;
+	}
+	fir->coeffs = coeffs;
+	fir->state = state;
+	fir->taps = taps;
+	fir->pos = 0;
+	fir->bias = bias;
+	for(uint32_t i = 0; i < 2 * taps; i++){
+		state[i] = 0;
+	}
+	return true;
+}
+
+void FirQ31Process(fir_q31_t *fir, uint16_t *block, uint32_t n){
+	const uint16_t taps = fir->taps;
+	const int32_t bias = fir->bias;
+	int16_t *state = fir->state;
+	uint16_t pos = fir->pos;
+	for(uint32_t i = 0; i < n; i++){
+		pos = (pos == 0) ? taps - 1 : pos - 1;
+		int16_t x = filter_sat_i16((int32_t)block[i] - bias);
+		state[pos] = x;
+		state[pos + taps] = x;
+		const int32_t *h = fir->coeffs;
+		const int16_t *d = &state[pos];
+		/* each product is a MUL / MULH pair */
+		int64_t acc = (int64_t)1 << 30;
+		for(uint16_t k = taps >> 2; k > 0; k--){
+			acc += (int64_t)h[0] * d[0] + (int64_t)h[1] * d[1] + (int64_t)h[2] * d[2] + (int64_t)h[3] * d[3];
+			h += 4;
+			d += 4;
+		}
+		for(uint16_t k = taps & 3; k > 0; k--){
+			acc += (int64_t)*h++ * *d++;
+		}
+		acc >>= 31;
+		if(acc > FILTER_U16_MAX){
+			acc = FILTER_U16_MAX;
+		}else if(acc < -FILTER_U16_MAX){
+			acc = -FILTER_U16_MAX;
+		}
+		block[i] = filter_sat_u16((int32_t)acc + bias);
+	}
+	fir->pos = pos;
+}
+
+bool BiquadInit(biquad_t *biquad, const biquad_coeffs_t *coeffs, biquad_state_t *state, uint8_t sections, uint16_t bias){
+	if((biquad == NULL) || (coeffs == NULL) || (state == NULL) || (sections == 0)){
+		return false;
+	}
+	biquad->coeffs = coeffs;
+	biquad->state = state;
+	biquad->sections = sections;
+	biquad->bias = bias;
+	for(uint8_t s = 0; s < sections; s++){
+		state[s].x1 = 0;
+		state[s].x2 = 0;
+		state[s].y1 = 0;
+		state[s].y2 = 0;
+	}
+	return true;
+}
+
+void BiquadProcess(biquad_t *biquad, uint16_t *block, uint32_t n){
+	const int32_t bias = biquad->bias;
+	const uint8_t sections = biquad->sections;
+	for(uint32_t i = 0; i < n; i++){
+		int32_t x = ((int32_t)block[i] - bias) * (1 << BIQUAD_FRAC_BITS);
+		const biquad_coeffs_t *c = biquad->coeffs;
+		biquad_state_t *st = biquad->state;
+		for(uint8_t s = sections; s > 0; s--){
+			int64_t acc = (int64_t)1 << (BIQUAD_COEFF_BITS - 1);
+			acc += (int64_t)c->b0 * x + (int64_t)c->b1 * st->x1 + (int64_t)c->b2 * st->x2
+				- (int64_t)c->a1 * st->y1 - (int64_t)c->a2 * st->y2;
+			int32_t y = (int32_t)(acc >> BIQUAD_COEFF_BITS);
+			st->x2 = st->x1;
+			st->x1 = x;
+			st->y2 = st->y1;
+			st->y1 = y;
+			x = y;
+			c++;
+			st++;
+		}
+		block[i] = filter_sat_u16(((x + (1 << (BIQUAD_FRAC_BITS - 1))) >> BIQUAD_FRAC_BITS) + bias);
+	}
+}
+
+bool MovingAverageInit(moving_average_t *ma, uint16_t *history, uint16_t len){
+	if((ma == NULL) || (history == NULL) || (len == 0)){
+		return false;
+	}
+	ma->history = history;
+	ma->len = len;
+	ma->pos = 0;
+	ma->sum = 0;
+	/* ceil(2^32 / len): the division becomes a MULHU */
+	ma->reciprocal = (len > 1) ? (uint32_t)((((uint64_t)1 << 32) + len - 1) / len) : 0;
+	ma->primed = false;
+	return true;
+}
+
+void MovingAverageProcess(moving_average_t *ma, uint16_t *block, uint32_t n){
+	const uint16_t len = ma->len;
+	if((len == 1) || (n == 0)){
+		return;
+	}
+	uint16_t *history = ma->history;
+	uint16_t pos = ma->pos;
+	uint32_t sum = ma->sum;
+	if(!ma->primed){
+		for(uint16_t k = 0; k < len; k++){
+			history[k] = block[0];
+		}
+		sum = (uint32_t)block[0] * len;
+		ma->primed = true;
+	}
+	for(uint32_t i = 0; i < n; i++){
+		uint16_t x = block[i];
+		sum += x - history[pos];
+		history[pos] = x;
+		if(++pos == len){
+			pos = 0;
+		}
+		/* the rounded up reciprocal gives the quotient or one more (long windows of large samples) */
+		uint32_t rounded = sum + len / 2;
+		uint32_t q = ((uint64_t)rounded * ma->reciprocal) >> 32;
+		block[i] = q - (q * len > rounded);
+	}
+	ma->pos = pos;
+	ma->sum = sum;
+}
+
+bool CicInit(cic_t *cic, uint8_t order, uint16_t decimation){
+	if((cic == NULL) || (order == 0) || (order > FILTER_CIC_MAX_ORDER) || (decimation < 2)
+		|| ((decimation & (decimation - 1)) != 0)){
+		return false;
+	}
+	uint8_t log2_dec = 0;
+	while((1U << log2_dec) < decimation){
+		log2_dec++;
+	}
+	/* integrators wrap around: the output word must hold the full gain decimation^order */
+	if(16 + order * log2_dec > 32){
+		return false;
+	}
+	cic->order = order;
+	cic->shift = order * log2_dec;
+	cic->decimation = decimation;
+	cic->count = 0;
+	for(uint8_t s = 0; s < FILTER_CIC_MAX_ORDER; s++){
+		cic->integrator[s] = 0;
+		cic->comb[s] = 0;
+	}
+	return true;
+}
+
+uint32_t CicProcess(cic_t *cic, uint16_t *block, uint32_t n){
+	const uint8_t order = cic->order;
+	uint32_t *integrator = cic->integrator;
+	uint32_t out = 0;
+	for(uint32_t i = 0; i < n; i++){
+		uint32_t v = block[i];
+		for(uint8_t s = 0; s < order; s++){
+			integrator[s] += v;
+			v = integrator[s];
+		}
+		if(++cic->count < cic->decimation){
+			continue;
+		}
+		cic->count = 0;
+		for(uint8_t s = 0; s < order; s++){
+			uint32_t delayed = cic->comb[s];
+			cic->comb[s] = v;
+			v -= delayed;
+		}
+		/* outputs never overtake inputs: out <= i */
+		block[out++] = v >> cic->shift;
+	}
+	return out;
+}
+/*==================[end of file]============================================*/
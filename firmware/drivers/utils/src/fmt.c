@@ -0,0 +1,377 @@
+/**
+ * @file fmt.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "fmt.h"
+#include <stddef.h>
+#include <stdbool.h>
+/*==================[macros and definitions]=================================*/
+#define FMT_TMP_LEN		66		/* 64 binary digits, sign and decimal point */
+
+/**
+ * @brief Output buffer being written by FmtVPrintf()
+ */
+typedef struct {
+	char *pos;				/*!< Next character */
+	char *end;				/*!< Last usable character (reserved for '\0') */
+} fmt_out_t;
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static char *fmt_u32(char *end, uint32_t val, uint8_t base, bool upper);
+static char *fmt_u64(char *end, uint64_t val, uint8_t base, bool upper);
+static char *fmt_fixed(char *end, uint64_t val, uint8_t decimals);
+static uint8_t fmt_copy(char *buf, const char *start, const char *end, bool neg, uint8_t width, char pad);
+static inline void fmt_put(fmt_out_t *out, char c);
+static void fmt_field(fmt_out_t *out, const char *start, uint32_t len, char sign, int32_t width, bool left, bool zero);
+
+/*==================[internal data definition]===============================*/
+/** Two decimal digits per entry, "00" to "99" */
+static const char fmt_digits2[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+static const char fmt_lower[] = "0123456789abcdef";
+static const char fmt_upper[] = "0123456789ABCDEF";
+static const uint32_t fmt_pow10[FMT_DECIMALS_MAX + 1] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Writes the digits of val backwards, ending right before end. Returns the first digit.
+ */
+static char *fmt_u32(char *end, uint32_t val, uint8_t base, bool upper){
+	if(base == 10){
+		/* two digits per division (a multiplication by the inverse of 100) */
+		while(val >= 100){
+			uint32_t q = val / 100;
+			const char *d = &fmt_digits2[2 * (val - q * 100)];
+			*--end = d[1];
+			*--end = d[0];
+			val = q;
+		}
+		if(val >= 10){
+			*--end = fmt_digits2[2 * val + 1];
+			*--end = fmt_digits2[2 * val];
+		}else{
+			*--end = '0' + val;
+		}
+		return end;
+	}
+	const char *digits = upper ? fmt_upper : fmt_lower;
+	if((base & (base - 1)) == 0){
+		/* power of 2 base: shifts and masks */
+		uint8_t shift = (base == 2) ? 1 : (base == 4) ? 2 : (base == 8) ? 3 : 4;
+		do{
+			*--end = digits[val & (base - 1)];
+			val >>= shift;
+		}while(val);
+		return end;
+	}
+	do{
+		*--end = digits[val % base];
+		val /= base;
+	}while(val);
+	return end;
+}
+
+/**
+ * @brief 64 bits version of fmt_u32(): decimal numbers are split in 9 digits chunks.
+ */
+static char *fmt_u64(char *end, uint64_t val, uint8_t base, bool upper){
+	if(val <= UINT32_MAX){
+		return fmt_u32(end, val, base, upper);
+	}
+	if(base == 10){
+		while(val > UINT32_MAX){
+			uint64_t q = val / 1000000000;
+			char *start = fmt_u32(end, val - q * 1000000000, 10, false);
+			while(start > end - 9){
+				*--start = '0';
+			}
+			end = start;
+			val = q;
+		}
+		return fmt_u32(end, val, 10, false);
+	}
+	const char *digits = upper ? fmt_upper : fmt_lower;
+	do{
+		*--end = digits[val % base];
+		val /= base;
+	}while(val);
+	return end;
+}
+
+/**
+ * @brief Writes val / 10^decimals with its decimals backwards (no sign). Returns the first character.
+ */
+static char *fmt_fixed(char *end, uint64_t val, uint8_t decimals){
+	if(decimals == 0){
+		return fmt_u64(end, val, 10, false);
+	}
+	uint64_t integer = val / fmt_pow10[decimals];
+	char *start = fmt_u32(end, val - integer * fmt_pow10[decimals], 10, false);
+	while(start > end - decimals){
+		*--start = '0';
+	}
+	*--start = '.';
+	return fmt_u64(start, integer, 10, false);
+}
+
+/**
+ * @brief Copies the digits to buf with sign and left padding, and ends it with '\0'.
+ */
+static uint8_t fmt_copy(char *buf, const char *start, const char *end, bool neg, uint8_t width, char pad){
+	uint8_t len = (end - start) + neg;
+	char *p = buf;
+	if(neg && (pad == '0')){
+		*p++ = '-';
+	}
+	for(; len < width; width--){
+		*p++ = pad;
+	}
+	if(neg && (pad != '0')){
+		*p++ = '-';
+	}
+	while(start < end){
+		*p++ = *start++;
+	}
+	*p = '\0';
+	return p - buf;
+}
+
+/**
+ * @brief Writes a character if there is room (the rest are dropped)
+ */
+static inline void fmt_put(fmt_out_t *out, char c){
+	if(out->pos < out->end){
+		*out->pos++ = c;
+	}
+}
+
+/**
+ * @brief Writes a field: sign, padding and len characters from start
+ */
+static void fmt_field(fmt_out_t *out, const char *start, uint32_t len, char sign, int32_t width, bool left, bool zero){
+	int32_t padding = width - (int32_t)len - (sign != 0);
+	if(!left && !zero){
+		for(; padding > 0; padding--){
+			fmt_put(out, ' ');
+		}
+	}
+	if(sign){
+		fmt_put(out, sign);
+	}
+	if(!left && zero){
+		for(; padding > 0; padding--){
+			fmt_put(out, '0');
+		}
+	}
+	for(uint32_t i = 0; i < len; i++){
+		fmt_put(out, start[i]);
+	}
+	for(; padding > 0; padding--){
+		fmt_put(out, ' ');
+	}
+}
+
+/*==================[external functions definition]==========================*/
+uint8_t FmtUint(char *buf, uint32_t val, uint8_t base, uint8_t width, char pad){
+	char tmp[FMT_TMP_LEN];
+	if((base < 2) || (base > 16)){
+		buf[0] = '\0';
+		return 0;
+	}
+	char *end = &tmp[FMT_TMP_LEN];
+	return fmt_copy(buf, fmt_u32(end, val, base, false), end, false, width, pad);
+}
+
+uint8_t FmtInt(char *buf, int32_t val, uint8_t base, uint8_t width, char pad){
+	char tmp[FMT_TMP_LEN];
+	if((base < 2) || (base > 16)){
+		buf[0] = '\0';
+		return 0;
+	}
+	char *end = &tmp[FMT_TMP_LEN];
+	uint32_t mag = (val < 0) ? -(uint32_t)val : (uint32_t)val;
+	return fmt_copy(buf, fmt_u32(end, mag, base, false), end, val < 0, width, pad);
+}
+
+uint8_t FmtFixed(char *buf, int32_t val, uint8_t decimals){
+	char tmp[FMT_TMP_LEN];
+	if(decimals > FMT_DECIMALS_MAX){
+		decimals = FMT_DECIMALS_MAX;
+	}
+	char *end = &tmp[FMT_TMP_LEN];
+	uint32_t mag = (val < 0) ? -(uint32_t)val : (uint32_t)val;
+	return fmt_copy(buf, fmt_fixed(end, mag, decimals), end, val < 0, 0, ' ');
+}
+
+uint8_t FmtQ(char *buf, int32_t val, uint8_t frac_bits, uint8_t decimals){
+	char tmp[FMT_TMP_LEN];
+	if(decimals > FMT_DECIMALS_MAX){
+		decimals = FMT_DECIMALS_MAX;
+	}
+	if(frac_bits > 31){
+		frac_bits = 31;
+	}
+	uint32_t mag = (val < 0) ? -(uint32_t)val : (uint32_t)val;
+	/* |val| * 10^decimals / 2^frac_bits, rounded (below 2^61, no overflow) */
+	uint64_t scaled = (uint64_t)mag * fmt_pow10[decimals];
+	if(frac_bits){
+		scaled = (scaled + (1ULL << (frac_bits - 1))) >> frac_bits;
+	}
+	char *end = &tmp[FMT_TMP_LEN];
+	return fmt_copy(buf, fmt_fixed(end, scaled, decimals), end, (val < 0) && (scaled != 0), 0, ' ');
+}
+
+uint32_t FmtPrintf(char *buf, uint32_t size, const char *format, ...){
+	va_list args;
+	va_start(args, format);
+	uint32_t len = FmtVPrintf(buf, size, format, args);
+	va_end(args);
+	return len;
+}
+
+uint32_t FmtVPrintf(char *buf, uint32_t size, const char *format, va_list args){
+	if((buf == NULL) || (size == 0)){
+		return 0;
+	}
+	fmt_out_t out = {.pos = buf, .end = buf + size - 1};
+	char tmp[FMT_TMP_LEN];
+	char *tmp_end = &tmp[FMT_TMP_LEN];
+	const char *f = format;
+	while(*f){
+		if(*f != '%'){
+			fmt_put(&out, *f++);
+			continue;
+		}
+		const char *spec = f++;
+		/* flags */
+		bool left = false, zero = false, plus = false;
+		for(;; f++){
+			if(*f == '-'){
+				left = true;
+			}else if(*f == '0'){
+				zero = true;
+			}else if(*f == '+'){
+				plus = true;
+			}else{
+				break;
+			}
+		}
+		/* width and precision */
+		int32_t width = 0, precision = -1;
+		if(*f == '*'){
+			width = va_arg(args, int);
+			if(width < 0){
+				left = true;
+				width = -width;
+			}
+			f++;
+		}else{
+			while((*f >= '0') && (*f <= '9')){
+				width = width * 10 + (*f++ - '0');
+			}
+		}
+		if(*f == '.'){
+			f++;
+			precision = 0;
+			if(*f == '*'){
+				precision = va_arg(args, int);
+				f++;
+			}else{
+				while((*f >= '0') && (*f <= '9')){
+					precision = precision * 10 + (*f++ - '0');
+				}
+			}
+		}
+		/* length */
+		bool wide = false;
+		while((*f == 'l') || (*f == 'h')){
+			if((f[0] == 'l') && (f[1] == 'l')){
+				wide = true;
+				f++;
+			}
+			f++;
+		}
+		char conv = *f++;
+		char sign = 0;
+		char *start;
+		switch(conv){
+			case 'd':
+			case 'i':
+			case 'D':{
+				int64_t val = wide ? va_arg(args, long long) : va_arg(args, int);
+				uint64_t mag = (val < 0) ? -(uint64_t)val : (uint64_t)val;
+				sign = (val < 0) ? '-' : (plus ? '+' : 0);
+				if(conv == 'D'){
+					start = fmt_fixed(tmp_end, mag, (precision < 0) ? 0 : (precision > FMT_DECIMALS_MAX) ? FMT_DECIMALS_MAX : precision);
+				}else{
+					start = fmt_u64(tmp_end, mag, 10, false);
+				}
+				fmt_field(&out, start, tmp_end - start, sign, width, left, zero);
+				break;
+			}
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+			case 'b':{
+				uint64_t val = wide ? va_arg(args, unsigned long long) : va_arg(args, unsigned int);
+				uint8_t base = (conv == 'u') ? 10 : (conv == 'o') ? 8 : (conv == 'b') ? 2 : 16;
+				start = fmt_u64(tmp_end, val, base, conv == 'X');
+				fmt_field(&out, start, tmp_end - start, 0, width, left, zero);
+				break;
+			}
+			case 'c':
+				tmp[0] = va_arg(args, int);
+				fmt_field(&out, tmp, 1, 0, width, left, false);
+				break;
+			case 's':{
+				const char *s = va_arg(args, const char *);
+				if(s == NULL){
+					s = "(null)";
+				}
+				uint32_t len = 0;
+				while(s[len] && ((precision < 0) || (len < (uint32_t)precision))){
+					len++;
+				}
+				fmt_field(&out, s, len, 0, width, left, false);
+				break;
+			}
+			case '%':
+				fmt_put(&out, '%');
+				break;
+			default:
+				/* not supported (or end of format): written as is, no argument taken */
+				f = (conv == '\0') ? f - 1 : f;
+				while(spec < f){
+					fmt_put(&out, *spec++);
+				}
+				break;
+		}
+	}
+	*out.pos = '\0';
+	return out.pos - buf;
+}
+/*==================[end of file]============================================*/
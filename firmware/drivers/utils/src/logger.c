@@ -0,0 +1,272 @@
+/**
+ * @file logger.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "logger.h"
+#include "fmt.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+/*==================[macros and definitions]=================================*/
+#define LOGGER_ERROR_SLOTS	8
+#define LOGGER_WARN_SLOTS	8
+#define LOGGER_INFO_SLOTS	16
+#define LOGGER_DEBUG_SLOTS	16
+#define LOGGER_LINE_LEN		(LOGGER_MSG_LEN + 24)	/* timestamp, level and line end */
+#define LOGGER_RECORD_HEADER	5						/* level and timestamp of telemetry records */
+#define LOGGER_PERIOD_MS	20
+#define LOGGER_STACK		3072
+
+/**
+ * @brief Queued message
+ */
+typedef struct {
+	uint32_t sequence;				/* position it holds a message for + 1 (see logger_push()) */
+	uint32_t timestamp;				/* ms */
+	bool deferred;					/* text holds an encoded deferred message */
+	uint8_t len;					/* encoded deferred message length */
+	char text[LOGGER_MSG_LEN + 1];
+} logger_slot_t;
+
+/**
+ * @brief Bounded multiple producer, single consumer queue: each slot carries a sequence number
+ * telling whether it is free for a given write position or holds a message for a read position
+ */
+typedef struct {
+	logger_slot_t *slots;
+	uint32_t mask;
+	uint32_t write;					/* next write position (claimed with compare and swap) */
+	uint32_t read;					/* next read position (drain task only) */
+	uint32_t written;
+	uint32_t dropped;
+} logger_queue_t;
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static logger_slot_t *logger_claim(logger_queue_t *queue, uint32_t *pos);
+static void logger_publish(logger_queue_t *queue, logger_slot_t *slot, uint32_t pos);
+static void logger_send(logger_level_t level, uint32_t timestamp, bool deferred, const char *data, uint32_t len);
+static void logger_drain_task(void *pvParameters);
+
+/*==================[internal data definition]===============================*/
+static logger_slot_t error_slots[LOGGER_ERROR_SLOTS];
+static logger_slot_t warn_slots[LOGGER_WARN_SLOTS];
+static logger_slot_t info_slots[LOGGER_INFO_SLOTS];
+static logger_slot_t debug_slots[LOGGER_DEBUG_SLOTS];
+static logger_queue_t logger_queues[LOGGER_LEVELS] = {
+	{.slots = error_slots, .mask = LOGGER_ERROR_SLOTS - 1},
+	{.slots = warn_slots, .mask = LOGGER_WARN_SLOTS - 1},
+	{.slots = info_slots, .mask = LOGGER_INFO_SLOTS - 1},
+	{.slots = debug_slots, .mask = LOGGER_DEBUG_SLOTS - 1},
+};
+static const char logger_letters[LOGGER_LEVELS] = {'E', 'W', 'I', 'D'};
+static bool logger_started = false;
+static logger_level_t logger_level;
+static uart_mcu_port_t logger_port;
+static uint16_t logger_period_ms;
+static uint32_t logger_sent;
+static telemetry_t *logger_telemetry;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Claims the next free slot of a queue
+ *
+ * @return logger_slot_t* Slot (its message is published setting sequence to pos + 1), NULL if full
+ */
+static logger_slot_t *logger_claim(logger_queue_t *queue, uint32_t *pos){
+	uint32_t p = __atomic_load_n(&queue->write, __ATOMIC_RELAXED);
+	while(1){
+		logger_slot_t *slot = &queue->slots[p & queue->mask];
+		int32_t diff = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - p);
+		if(diff == 0){
+			/* free for this position: claim it (on failure p is updated to the current position) */
+			if(__atomic_compare_exchange_n(&queue->write, &p, p + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+				*pos = p;
+				return slot;
+			}
+		}else if(diff < 0){
+			/* still holds the message of the previous lap: full */
+			return NULL;
+		}else{
+			/* claimed by another writer meanwhile */
+			p = __atomic_load_n(&queue->write, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/**
+ * @brief Stamps and publishes a filled slot
+ */
+static void logger_publish(logger_queue_t *queue, logger_slot_t *slot, uint32_t pos){
+	slot->timestamp = esp_timer_get_time() / 1000;
+	__atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&queue->written, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sends a message: a text line, or a telemetry record
+ */
+static void logger_send(logger_level_t level, uint32_t timestamp, bool deferred, const char *data, uint32_t len){
+	uint8_t record[LOGGER_RECORD_HEADER + LOGGER_LINE_LEN];
+	if(logger_telemetry != NULL){
+		record[0] = level;
+		memcpy(&record[1], &timestamp, sizeof(timestamp));
+		memcpy(&record[LOGGER_RECORD_HEADER], data, len);
+		TelemetrySend(logger_telemetry, deferred ? TELEMETRY_LOG : TELEMETRY_LOG_TEXT, record, LOGGER_RECORD_HEADER + len);
+		return;
+	}
+	char *line = (char *)record;
+	if(deferred){
+		/* without the format strings only the id and the arguments can be shown */
+		uint32_t n = FmtPrintf(line, sizeof(record), "[%u.%03u] %c: deferred", timestamp / 1000, timestamp % 1000, 
+			logger_letters[level]);
+		for(uint32_t i = 0; (i < len) && (n + 4 < sizeof(record)); i++){
+			n += FmtPrintf(line + n, sizeof(record) - n, " %02x", (uint8_t)data[i]);
+		}
+		n += FmtPrintf(line + n, sizeof(record) - n, "\r\n");
+		UartWriteBlocking(logger_port, line, n);
+		return;
+	}
+	uint32_t n = FmtPrintf(line, sizeof(record), "[%u.%03u] %c: %s\r\n", timestamp / 1000, timestamp % 1000, 
+		logger_letters[level], data);
+	UartWriteBlocking(logger_port, line, n);
+}
+
+static void logger_drain_task(void *pvParameters){
+	char message[LOGGER_MSG_LEN + 1];
+	uint32_t reported[LOGGER_LEVELS] = {0};
+	while(1){
+		bool idle = true;
+		/* one message at a time, always from the highest priority queue with messages */
+		for(uint8_t level = 0; level < LOGGER_LEVELS; level++){
+			logger_queue_t *queue = &logger_queues[level];
+			logger_slot_t *slot = &queue->slots[queue->read & queue->mask];
+			if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != queue->read + 1){
+				/* empty, or its writer is still formatting */
+				continue;
+			}
+			uint32_t timestamp = slot->timestamp;
+			bool deferred = slot->deferred;
+			uint32_t len = deferred ? slot->len : strlen(slot->text);
+			memcpy(message, slot->text, len + 1);
+			/* slot free for the writers of the next lap */
+			__atomic_store_n(&slot->sequence, queue->read + queue->mask + 1, __ATOMIC_RELEASE);
+			queue->read++;
+			logger_send(level, timestamp, deferred, message, len);
+			logger_sent++;
+			idle = false;
+			break;
+		}
+		if(idle){
+			/* caught up: report what was lost */
+			bool lost = false;
+			uint32_t dropped[LOGGER_LEVELS];
+			for(uint8_t level = 0; level < LOGGER_LEVELS; level++){
+				dropped[level] = __atomic_load_n(&logger_queues[level].dropped, __ATOMIC_RELAXED) - reported[level];
+				lost |= (dropped[level] != 0);
+			}
+			if(lost){
+				uint32_t len = FmtPrintf(message, sizeof(message), "logger dropped E%u W%u I%u D%u", 
+					dropped[LOGGER_ERROR], dropped[LOGGER_WARN], dropped[LOGGER_INFO], dropped[LOGGER_DEBUG]);
+				logger_send(LOGGER_WARN, esp_timer_get_time() / 1000, false, message, len);
+				for(uint8_t level = 0; level < LOGGER_LEVELS; level++){
+					reported[level] += dropped[level];
+				}
+			}
+			vTaskDelay(pdMS_TO_TICKS(logger_period_ms) ? pdMS_TO_TICKS(logger_period_ms) : 1);
+		}
+	}
+}
+
+/*==================[external functions definition]==========================*/
+bool LoggerInit(const logger_config_t *config){
+	if(logger_started || (config == NULL)){
+		return false;
+	}
+	for(uint8_t level = 0; level < LOGGER_LEVELS; level++){
+		logger_queue_t *queue = &logger_queues[level];
+		for(uint32_t i = 0; i <= queue->mask; i++){
+			queue->slots[i].sequence = i;
+		}
+		queue->write = 0;
+		queue->read = 0;
+	}
+	logger_port = config->port;
+	logger_level = config->level;
+	logger_period_ms = config->period_ms ? config->period_ms : LOGGER_PERIOD_MS;
+	logger_telemetry = config->telemetry;
+	if(xTaskCreate(logger_drain_task, "logger", LOGGER_STACK, NULL, config->priority ? config->priority : 1, NULL) != pdPASS){
+		return false;
+	}
+	__atomic_store_n(&logger_started, true, __ATOMIC_RELEASE);
+	return true;
+}
+
+bool LoggerWrite(logger_level_t level, const char *format, ...){
+	if((level >= LOGGER_LEVELS) || (level > logger_level) || !__atomic_load_n(&logger_started, __ATOMIC_ACQUIRE)){
+		return false;
+	}
+	logger_queue_t *queue = &logger_queues[level];
+	uint32_t pos;
+	logger_slot_t *slot = logger_claim(queue, &pos);
+	if(slot == NULL){
+		__atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+		return false;
+	}
+	va_list args;
+	va_start(args, format);
+	FmtVPrintf(slot->text, sizeof(slot->text), format, args);
+	va_end(args);
+	slot->deferred = false;
+	logger_publish(queue, slot, pos);
+	return true;
+}
+
+bool LoggerWriteDeferred(logger_level_t level, const void *data, uint8_t len){
+	if((level >= LOGGER_LEVELS) || (level > logger_level) || !__atomic_load_n(&logger_started, __ATOMIC_ACQUIRE)){
+		return false;
+	}
+	logger_queue_t *queue = &logger_queues[level];
+	if(len > LOGGER_MSG_LEN){
+		/* arguments that did not fit (see dlog.h): lost like a message of a full queue */
+		__atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+		return false;
+	}
+	uint32_t pos;
+	logger_slot_t *slot = logger_claim(queue, &pos);
+	if(slot == NULL){
+		__atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+		return false;
+	}
+	memcpy(slot->text, data, len);
+	slot->len = len;
+	slot->deferred = true;
+	logger_publish(queue, slot, pos);
+	return true;
+}
+
+void LoggerSetLevel(logger_level_t level){
+	logger_level = level;
+}
+
+void LoggerGetStats(logger_stats_t *stats){
+	for(uint8_t level = 0; level < LOGGER_LEVELS; level++){
+		stats->written[level] = logger_queues[level].written;
+		stats->dropped[level] = logger_queues[level].dropped;
+	}
+	stats->sent = logger_sent;
+}
+/*==================[end of file]============================================*/
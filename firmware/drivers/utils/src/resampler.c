@@ -0,0 +1,172 @@
+/**
+ * @file resampler.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-14
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "resampler.h"
+#include <stddef.h>
+#include <math.h>
+/*==================[macros and definitions]=================================*/
+#define RESAMPLER_KAISER_BETA	8.0		/* ~80 dB stop band attenuation */
+#define RESAMPLER_Q15_MAX		32767
+#define RESAMPLER_U16_MAX		65535
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static double resampler_bessel_i0(double x);
+static inline void resampler_push(resampler_t *rs, uint16_t sample);
+static inline uint16_t resampler_output(const resampler_t *rs);
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Zero order modified Bessel function (Kaiser window)
+ */
+static double resampler_bessel_i0(double x){
+	double sum = 1, term = 1;
+	for(uint8_t k = 1; k < 30; k++){
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+/**
+ * @brief Writes an input sample in the delay line (stored twice, newest first, as in filter.c)
+ */
+static inline void resampler_push(resampler_t *rs, uint16_t sample){
+	int32_t x = (int32_t)sample - rs->bias;
+	if(x > INT16_MAX){
+		x = INT16_MAX;
+	}else if(x < INT16_MIN){
+		x = INT16_MIN;
+	}
+	rs->pos = (rs->pos == 0) ? rs->taps - 1 : rs->pos - 1;
+	rs->state[rs->pos] = x;
+	rs->state[rs->pos + rs->taps] = x;
+	rs->phase -= rs->up;
+}
+
+/**
+ * @brief Output sample for the current phase: y = sum(h[phase + k up] x[n - k])
+ */
+static inline uint16_t resampler_output(const resampler_t *rs){
+	const uint32_t stride = rs->up;
+	const int16_t *h = &rs->coeffs[rs->phase];
+	const int16_t *d = &rs->state[rs->pos];
+	int32_t acc = 1 << 14;
+	for(uint16_t k = rs->taps >> 2; k > 0; k--){
+		acc += h[0] * d[0] + h[stride] * d[1] + h[2 * stride] * d[2] + h[3 * stride] * d[3];
+		h += 4 * stride;
+		d += 4;
+	}
+	for(uint16_t k = rs->taps & 3; k > 0; k--){
+		acc += *h * *d++;
+		h += stride;
+	}
+	acc = (acc >> 15) + rs->bias;
+	if(acc < 0){
+		return 0;
+	}
+	if(acc > RESAMPLER_U16_MAX){
+		return RESAMPLER_U16_MAX;
+	}
+	return acc;
+}
+
+/*==================[external functions definition]==========================*/
+bool ResamplerDesign(int16_t *coeffs, uint16_t up, uint16_t down, uint16_t taps, float cutoff){
+	if((coeffs == NULL) || (up == 0) || (down == 0) || (taps == 0) || (cutoff <= 0) || (cutoff > 1)){
+		return false;
+	}
+	uint32_t len = (uint32_t)up * taps;
+	/* cutoff relative to the upsampled rate */
+	double fc = cutoff * 0.5 / ((up > down) ? up : down);
+	double center = (len - 1) / 2.0;
+	double i0_beta = resampler_bessel_i0(RESAMPLER_KAISER_BETA);
+	double sum = 0;
+	/* first pass for the DC gain, second one to scale it to up (each phase adds up to about 1) */
+	for(uint8_t pass = 0; pass < 2; pass++){
+		for(uint32_t i = 0; i < len; i++){
+			double m = i - center;
+			double h = (m == 0) ? 2 * fc : sin(2 * M_PI * fc * m) / (M_PI * m);
+			double r = (len > 1) ? m / center : 0;
+			h *= resampler_bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1 - r * r)) / i0_beta;
+			if(pass == 0){
+				sum += h;
+				continue;
+			}
+			h *= up * RESAMPLER_Q15_MAX / sum;
+			coeffs[i] = (h > RESAMPLER_Q15_MAX) ? RESAMPLER_Q15_MAX : (h < -RESAMPLER_Q15_MAX) ? -RESAMPLER_Q15_MAX : lrint(h);
+		}
+	}
+	return true;
+}
+
+bool ResamplerInit(resampler_t *rs, const int16_t *coeffs, uint16_t up, uint16_t down, uint16_t taps,
+	int16_t *state, uint16_t bias){
+	if((rs == NULL) || (coeffs == NULL) || (state == NULL) || (up == 0) || (down == 0) || (taps == 0)
+		|| (taps > UINT16_MAX / 2)){
+		return false;
+	}
+	rs->coeffs = coeffs;
+	rs->state = state;
+	rs->up = up;
+	rs->down = down;
+	rs->taps = taps;
+	rs->pos = 0;
+	rs->phase = up;
+	rs->bias = bias;
+	for(uint32_t i = 0; i < 2 * taps; i++){
+		state[i] = 0;
+	}
+	return true;
+}
+
+uint32_t ResamplerProcess(resampler_t *rs, const uint16_t *in, uint32_t n, uint16_t *out, uint32_t max){
+	uint32_t count = 0;
+	uint32_t i = 0;
+	while(true){
+		while(rs->phase >= rs->up){
+			if(i == n){
+				return count;
+			}
+			resampler_push(rs, in[i++]);
+		}
+		/* once out is full, outputs are skipped but the time base is kept */
+		if(count < max){
+			out[count++] = resampler_output(rs);
+		}
+		rs->phase += rs->down;
+	}
+}
+
+uint32_t ResamplerProcessRing(resampler_t *rs, ring_buffer_t *in, ring_buffer_t *out){
+	uint32_t count = 0;
+	uint16_t sample;
+	while(true){
+		while(rs->phase >= rs->up){
+			/* only take an input if its output will have room */
+			if((RingBufferFree(out) == 0) || !RingBufferPop(in, &sample)){
+				return count;
+			}
+			resampler_push(rs, sample);
+		}
+		if(!RingBufferPush(out, resampler_output(rs))){
+			return count;
+		}
+		count++;
+		rs->phase += rs->down;
+	}
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,78 @@
+/**
+ * @file ring_buffer.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2024-07-01
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ring_buffer.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+bool RingBufferInit(ring_buffer_t *ring, uint16_t *storage, uint32_t size){
+	if((size == 0) || (size & (size - 1))){
+		return false;
+	}
+	ring->data = storage;
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+	return true;
+}
+
+void RingBufferReset(ring_buffer_t *ring){
+	__atomic_store_n(&ring->tail, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+uint32_t RingBufferWrite(ring_buffer_t *ring, const uint16_t *values, uint32_t n){
+	uint32_t head = ring->head;
+	uint32_t free = ring->mask + 1 - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+	if(n > free){
+		n = free;
+	}
+	/* copy in up to two chunks (before and after wrapping) */
+	uint32_t idx = head & ring->mask;
+	uint32_t first = ring->mask + 1 - idx;
+	if(first > n){
+		first = n;
+	}
+	memcpy(&ring->data[idx], values, first * sizeof(uint16_t));
+	memcpy(ring->data, &values[first], (n - first) * sizeof(uint16_t));
+	__atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+	return n;
+}
+
+uint32_t RingBufferRead(ring_buffer_t *ring, uint16_t *values, uint32_t n){
+	uint32_t tail = ring->tail;
+	uint32_t count = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+	if(n > count){
+		n = count;
+	}
+	uint32_t idx = tail & ring->mask;
+	uint32_t first = ring->mask + 1 - idx;
+	if(first > n){
+		first = n;
+	}
+	memcpy(values, &ring->data[idx], first * sizeof(uint16_t));
+	memcpy(&values[first], ring->data, (n - first) * sizeof(uint16_t));
+	__atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+	return n;
+}
+
+/*==================[end of file]============================================*/
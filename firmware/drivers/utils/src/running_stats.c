@@ -0,0 +1,216 @@
+/**
+ * @file running_stats.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-15
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "running_stats.h"
+#include <stddef.h>
+#include <math.h>
+/*==================[macros and definitions]=================================*/
+#define QUANTILE_MARKERS	5
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+static float quantile_parabolic(const quantile_t *qt, uint8_t i, int8_t s);
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief P² piecewise parabolic prediction of marker i height, moved s (+-1) positions
+ */
+static float quantile_parabolic(const quantile_t *qt, uint8_t i, int8_t s){
+	const float *h = qt->height;
+	const int32_t *n = qt->pos;
+	return h[i] + (float)s / (n[i + 1] - n[i - 1]) * ((n[i] - n[i - 1] + s) * (h[i + 1] - h[i]) / (n[i + 1] - n[i])
+		+ (n[i + 1] - n[i] - s) * (h[i] - h[i - 1]) / (n[i] - n[i - 1]));
+}
+
+/*==================[external functions definition]==========================*/
+bool WindowStatsInit(window_stats_t *ws, int32_t *history, uint16_t len){
+	if((ws == NULL) || (history == NULL) || (len == 0)){
+		return false;
+	}
+	ws->history = history;
+	ws->len = len;
+	WindowStatsReset(ws);
+	return true;
+}
+
+void WindowStatsReset(window_stats_t *ws){
+	ws->count = 0;
+	ws->pos = 0;
+	ws->ref = 0;
+	ws->sum = 0;
+	ws->sum_sq = 0;
+}
+
+void WindowStatsPushBlock(window_stats_t *ws, const uint16_t *x, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		WindowStatsPush(ws, x[i]);
+	}
+}
+
+float WindowStatsMean(const window_stats_t *ws){
+	if(ws->count == 0){
+		return 0;
+	}
+	return ws->ref + (double)ws->sum / ws->count;
+}
+
+float WindowStatsVariance(const window_stats_t *ws){
+	if(ws->count == 0){
+		return 0;
+	}
+	/* sums are relative to the first sample, so there is little cancellation here */
+	double mean = (double)ws->sum / ws->count;
+	double variance = (double)ws->sum_sq / ws->count - mean * mean;
+	return (variance > 0) ? variance : 0;
+}
+
+float WindowStatsRms(const window_stats_t *ws){
+	if(ws->count == 0){
+		return 0;
+	}
+	/* mean of (d + ref)^2 = mean of d^2 + 2 ref mean of d + ref^2 */
+	double ref = ws->ref;
+	double mean_sq = (double)ws->sum_sq / ws->count + 2 * ref * ws->sum / ws->count + ref * ref;
+	return (mean_sq > 0) ? sqrt(mean_sq) : 0;
+}
+
+bool MinMaxInit(minmax_t *mm, minmax_entry_t *storage, uint16_t len){
+	if((mm == NULL) || (storage == NULL) || (len == 0)){
+		return false;
+	}
+	mm->min.entry = storage;
+	mm->max.entry = storage + len;
+	mm->len = len;
+	MinMaxReset(mm);
+	return true;
+}
+
+void MinMaxReset(minmax_t *mm){
+	mm->min.front = 0;
+	mm->min.size = 0;
+	mm->max.front = 0;
+	mm->max.size = 0;
+	mm->index = 0;
+}
+
+void MinMaxPushBlock(minmax_t *mm, const uint16_t *x, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		MinMaxPush(mm, x[i]);
+	}
+}
+
+bool EmaInit(ema_t *ema, uint32_t alpha){
+	if((ema == NULL) || (alpha == 0) || (alpha > (1UL << EMA_FRAC_BITS))){
+		return false;
+	}
+	ema->alpha = alpha;
+	ema->state = 0;
+	ema->primed = false;
+	return true;
+}
+
+float EmaGet(const ema_t *ema){
+	return (float)ema->state / (1 << EMA_FRAC_BITS);
+}
+
+bool QuantileInit(quantile_t *qt, float p){
+	if((qt == NULL) || (p < 0) || (p > 1)){
+		return false;
+	}
+	qt->p = p;
+	qt->count = 0;
+	return true;
+}
+
+void QuantilePush(quantile_t *qt, int32_t x){
+	float *h = qt->height;
+	int32_t *n = qt->pos;
+	/* first samples: kept sorted, they become the initial marker heights */
+	if(qt->count < QUANTILE_MARKERS){
+		uint8_t i = qt->count;
+		while((i > 0) && (h[i - 1] > x)){
+			h[i] = h[i - 1];
+			i--;
+		}
+		h[i] = x;
+		if(++qt->count == QUANTILE_MARKERS){
+			const float p = qt->p;
+			for(uint8_t k = 0; k < QUANTILE_MARKERS; k++){
+				n[k] = k + 1;
+			}
+			qt->desired[0] = 1;
+			qt->desired[1] = 1 + 2 * p;
+			qt->desired[2] = 1 + 4 * p;
+			qt->desired[3] = 3 + 2 * p;
+			qt->desired[4] = 5;
+			qt->increment[0] = 0;
+			qt->increment[1] = p / 2;
+			qt->increment[2] = p;
+			qt->increment[3] = (1 + p) / 2;
+			qt->increment[4] = 1;
+		}
+		return;
+	}
+	/* cell of the new sample, extending the extreme markers if needed */
+	uint8_t k;
+	if(x < h[0]){
+		h[0] = x;
+		k = 0;
+	}else if(x >= h[4]){
+		h[4] = x;
+		k = 3;
+	}else{
+		k = 0;
+		while(x >= h[k + 1]){
+			k++;
+		}
+	}
+	for(uint8_t i = k + 1; i < QUANTILE_MARKERS; i++){
+		n[i]++;
+	}
+	/* desired positions 1 + (samples - 1) increment: computed, not accumulated (float sums drift
+	 * by hundreds of positions after some 10^5 samples) */
+	for(uint8_t i = 0; i < QUANTILE_MARKERS; i++){
+		qt->desired[i] = 1 + (float)qt->count * qt->increment[i];
+	}
+	/* move the middle markers towards their desired positions */
+	for(uint8_t i = 1; i < QUANTILE_MARKERS - 1; i++){
+		float d = qt->desired[i] - n[i];
+		if(((d >= 1) && (n[i + 1] - n[i] > 1)) || ((d <= -1) && (n[i - 1] - n[i] < -1))){
+			int8_t s = (d > 0) ? 1 : -1;
+			float hp = quantile_parabolic(qt, i, s);
+			if((h[i - 1] < hp) && (hp < h[i + 1])){
+				h[i] = hp;
+			}else{
+				/* parabolic prediction out of order: linear one */
+				h[i] += s * (h[i + s] - h[i]) / (n[i + s] - n[i]);
+			}
+			n[i] += s;
+		}
+	}
+	qt->count++;
+}
+
+float QuantileGet(const quantile_t *qt){
+	if(qt->count == 0){
+		return 0;
+	}
+	if(qt->count < QUANTILE_MARKERS){
+		return qt->height[lroundf(qt->p * (qt->count - 1))];
+	}
+	return qt->height[2];
+}
+/*==================[end of file]============================================*/
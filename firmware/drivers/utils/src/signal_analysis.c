@@ -0,0 +1,191 @@
+/**
+ * @file signal_analysis.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2024-07-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "signal_analysis.h"
+#include <stddef.h>
+#include <math.h>
+/*==================[macros and definitions]=================================*/
+#define SIGNAL_MIN_POWER	1e-20		/* Floor for powers in dB ratios */
+/*==================[internal data declaration]==============================*/
+typedef struct {
+	double w;			/* Angular frequency (rad per sample) */
+	double a;			/* Cosine coefficient */
+	double b;			/* Sine coefficient */
+	double c;			/* Constant */
+} signal_component_t;
+/*==================[internal functions declaration]=========================*/
+static bool signal_fit(const uint16_t *x, uint32_t n, double w, const signal_component_t *sub, signal_component_t *fit);
+static double signal_residual(const uint16_t *x, uint32_t n, const signal_component_t *fit);
+static double signal_db(double num, double den);
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Least squares fit of x = a cos(w n) + b sin(w n) + c (3 parameters), 
+ * optionally after subtracting a previously fitted component.
+ * 
+ * @note Normal equations are solved by Gaussian elimination (3 x 3).
+ */
+static bool signal_fit(const uint16_t *x, uint32_t n, double w, const signal_component_t *sub, signal_component_t *fit){
+	double m[3][4] = {{0}};
+	double cw = cos(w), sw = sin(w);
+	double c = 1, s = 0;
+	double sub_cw = 1, sub_sw = 0, sub_c = 1, sub_s = 0;
+	if(sub != NULL){
+		sub_cw = cos(sub->w);
+		sub_sw = sin(sub->w);
+	}
+	for(uint32_t i = 0; i < n; i++){
+		if((i % SIGNAL_TRIG_RESYNC) == 0){
+			c = cos(w * i);
+			s = sin(w * i);
+			if(sub != NULL){
+				sub_c = cos(sub->w * i);
+				sub_s = sin(sub->w * i);
+			}
+		}
+		double y = x[i];
+		if(sub != NULL){
+			y -= sub->a * sub_c + sub->b * sub_s + sub->c;
+			double sub_next = sub_c * sub_cw - sub_s * sub_sw;
+			sub_s = sub_s * sub_cw + sub_c * sub_sw;
+			sub_c = sub_next;
+		}
+		m[0][0] += c * c;
+		m[0][1] += c * s;
+		m[0][2] += c;
+		m[0][3] += y * c;
+		m[1][1] += s * s;
+		m[1][2] += s;
+		m[1][3] += y * s;
+		m[2][3] += y;
+		double c_next = c * cw - s * sw;
+		s = s * cw + c * sw;
+		c = c_next;
+	}
+	m[1][0] = m[0][1];
+	m[2][0] = m[0][2];
+	m[2][1] = m[1][2];
+	m[2][2] = n;
+	for(uint8_t k = 0; k < 3; k++){
+		if(fabs(m[k][k]) < 1e-9 * n){
+			return false;
+		}
+		for(uint8_t r = k + 1; r < 3; r++){
+			double f = m[r][k] / m[k][k];
+			for(uint8_t j = k; j < 4; j++){
+				m[r][j] -= f * m[k][j];
+			}
+		}
+	}
+	fit->c = m[2][3] / m[2][2];
+	fit->b = (m[1][3] - m[1][2] * fit->c) / m[1][1];
+	fit->a = (m[0][3] - m[0][2] * fit->c - m[0][1] * fit->b) / m[0][0];
+	fit->w = w;
+	return true;
+}
+
+/**
+ * @brief Mean squared residual of the samples after subtracting a fitted component
+ */
+static double signal_residual(const uint16_t *x, uint32_t n, const signal_component_t *fit){
+	double cw = cos(fit->w), sw = sin(fit->w);
+	double c = 1, s = 0, sum = 0;
+	for(uint32_t i = 0; i < n; i++){
+		if((i % SIGNAL_TRIG_RESYNC) == 0){
+			c = cos(fit->w * i);
+			s = sin(fit->w * i);
+		}
+		double r = x[i] - (fit->a * c + fit->b * s + fit->c);
+		sum += r * r;
+		double c_next = c * cw - s * sw;
+		s = s * cw + c * sw;
+		c = c_next;
+	}
+	return sum / n;
+}
+
+/**
+ * @brief Power ratio in dB
+ */
+static double signal_db(double num, double den){
+	if(num < SIGNAL_MIN_POWER){
+		num = SIGNAL_MIN_POWER;
+	}
+	if(den < SIGNAL_MIN_POWER){
+		den = SIGNAL_MIN_POWER;
+	}
+	return 10 * log10(num / den);
+}
+
+/*==================[external functions definition]==========================*/
+bool SignalSineFit(const uint16_t *x, uint32_t n, float freq, float *amplitude, float *phase, float *offset){
+	signal_component_t fit;
+	if((x == NULL) || (n < 3) || (freq <= 0) || (freq >= 0.5f)){
+		return false;
+	}
+	if(!signal_fit(x, n, 2 * M_PI * freq, NULL, &fit)){
+		return false;
+	}
+	/* a cos + b sin = A sin(w n + phase), with A sin(phase) = a and A cos(phase) = b */
+	*amplitude = sqrt(fit.a * fit.a + fit.b * fit.b);
+	*phase = atan2(fit.a, fit.b);
+	*offset = fit.c;
+	return true;
+}
+
+bool SignalSineAnalysis(const uint16_t *x, uint32_t n, float freq, uint8_t harmonics, signal_sine_t *result){
+	signal_component_t fundamental, harmonic;
+	if((x == NULL) || (result == NULL) || (n < 3) || (freq <= 0) || (freq >= 0.5f)){
+		return false;
+	}
+	if(harmonics > SIGNAL_HARMONICS_MAX){
+		harmonics = SIGNAL_HARMONICS_MAX;
+	}
+	if(!signal_fit(x, n, 2 * M_PI * freq, NULL, &fundamental)){
+		return false;
+	}
+	double signal = (fundamental.a * fundamental.a + fundamental.b * fundamental.b) / 2;
+	if(signal <= 0){
+		return false;
+	}
+	/* harmonics are fitted on the residual of the fundamental */
+	double distortion = 0;
+	for(uint8_t k = 2; (k <= harmonics) && (k * freq < 0.5f); k++){
+		if(signal_fit(x, n, 2 * M_PI * freq * k, &fundamental, &harmonic)){
+			distortion += (harmonic.a * harmonic.a + harmonic.b * harmonic.b) / 2;
+		}
+	}
+	double residual = signal_residual(x, n, &fundamental);
+	double noise = residual - distortion;
+
+	result->amplitude = sqrt(2 * signal);
+	result->phase = atan2(fundamental.a, fundamental.b);
+	result->offset = fundamental.c;
+	result->snr = signal_db(signal, noise);
+	result->thd = signal_db(distortion, signal);
+	result->sinad = signal_db(signal, residual);
+	result->enob = (result->sinad - 1.76f) / 6.02f;
+	return true;
+}
+
+float SignalPhaseDelay(float phase_ref, float phase, float freq){
+	double d = fmod(phase_ref - phase, 2 * M_PI);
+	if(d < 0){
+		d += 2 * M_PI;
+	}
+	return d / (2 * M_PI * freq);
+}
+/*==================[end of file]============================================*/
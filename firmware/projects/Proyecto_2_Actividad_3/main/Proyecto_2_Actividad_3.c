@@ -9,6 +9,7 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 17/04/2024 | Document creation		                         |
+ * | 21/07/2024 | Comandos por líneas desde la terminal          |
  *
  * @author Guillermina Zaragoza
  *
@@ -26,6 +27,7 @@
 #include "switch.h"
 #include "timer_mcu.h"
 #include "uart_mcu.h"
+#include "command.h"
 /*==================[macros and definitions]=================================*/
 #define REFRESCO_MEDICION 1000000
 #define REFRESCO_DISPLAY 100000
@@ -122,18 +124,43 @@ void Tecla2()
     }
 }
 
-void ControlTeclas()
+static bool ComandoOn(uint8_t argc, char *argv[], void *param)
 {
-    uint8_t letra;
-    UartReadByte(UART_PC, &letra);
-    switch (letra)
+    on = !on;
+    return true;
+}
+
+static bool ComandoHold(uint8_t argc, char *argv[], void *param)
+{
+    hold = !hold;
+    return true;
+}
+
+static bool ComandoEstado(uint8_t argc, char *argv[], void *param)
+{
+    UartSendString(UART_PC, on ? "midiendo" : "apagado");
+    UartSendString(UART_PC, hold ? ", display congelado\r\n" : "\r\n");
+    return true;
+}
+
+static const command_t comandos[] = {
+    {"O", ComandoOn, 0, 0, "O: enciende/apaga la medición"},
+    {"H", ComandoHold, 0, 0, "H: congela/libera el display"},
+    {"estado", ComandoEstado, 0, 0, "estado: informa el estado de la medición"},
+};
+
+static const command_table_t tabla_comandos = {comandos, sizeof(comandos) / sizeof(comandos[0]), NULL};
+
+/**
+ * @brief Función invocada por cada línea recibida desde la terminal (un comando)
+ */
+void ControlTeclas(char *linea, uint16_t largo, void *param)
+{
+    command_result_t resultado = CommandExecute(&tabla_comandos, linea);
+    if ((resultado != COMMAND_OK) && (resultado != COMMAND_EMPTY))
     {
-    case 'O':
-        on = !on;
-        break;
-    case 'H':
-        hold = !hold;
-        break;
+        UartSendString(UART_PC, CommandResultString(resultado));
+        UartSendString(UART_PC, "\r\n");
     }
 }
 /*==================[external functions definition]==========================*/
@@ -164,8 +191,9 @@ void app_main(void)
     serial_config_t terminal_PC = {
         .port = UART_PC,
         .baud_rate = 115200,
-        .func_p = &ControlTeclas,
-        .param_p = NULL};
+        .func_p = UART_NO_INT,
+        .param_p = NULL,
+        .line_func_p = ControlTeclas};
     UartInit(&terminal_PC);
 
     /*Interrupciones de teclas*/
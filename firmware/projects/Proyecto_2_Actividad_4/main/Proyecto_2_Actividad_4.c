@@ -9,6 +9,8 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 24/04/2024 | Document creation		                         |
+ * | 09/07/2024 | Señal de ECG reproducida desde la interrupción del timer del DAC |
+ * | 14/07/2024 | Señal adquirida convertida a la frecuencia del DAC (remuestreo polifásico) |
  *
  * @author Guillermina Zaragoza
  *
@@ -23,14 +25,23 @@
 #include "timer_mcu.h"
 #include "uart_mcu.h"
 #include "analog_io_mcu.h"
+#include "resampler.h"
 /*==================[macros and definitions]=================================*/
-#define TIEMPO_MUESTREO_AD 2000 // fm = 500 Hz --> Tm AD = 2000 us
-#define TIEMPO_MUESTREO_DA 4000 // fm = 250 Hz --> Tm DA = 4000 us
+#define FRECUENCIA_MUESTREO_AD 500 // fm = 500 Hz --> Tm AD = 2000 us
+#define BLOQUE_AD 25 // Muestras leídas por la tarea en cada notificación (cada 50 ms)
+#define FRECUENCIA_MUESTREO_DA 250 // fm = 250 Hz --> Tm DA = 4000 us
 #define BUFFER_SIZE 231
+#define REMUESTREO_SUBIDA 1 // 500 Hz * 1 / 2 = 250 Hz
+#define REMUESTREO_BAJADA 2
+#define REMUESTREO_COEF 16 // Coeficientes por fase del filtro anti-alias
+#define REMUESTREO_CORTE 0.8f // Frecuencia de corte: 0.8 * 125 Hz = 100 Hz
 /*==================[internal data definition]===============================*/
-TaskHandle_t ConversorDA_handle = NULL;
 TaskHandle_t ConversorAD_handle = NULL;
-uint16_t datosAD;
+uint16_t datosAD[BLOQUE_AD];
+uint16_t datosRemuestreados[BLOQUE_AD * REMUESTREO_SUBIDA / REMUESTREO_BAJADA + 1];
+int16_t coefRemuestreo[REMUESTREO_SUBIDA * REMUESTREO_COEF];
+int16_t estadoRemuestreo[2 * REMUESTREO_COEF];
+resampler_t remuestreo;
 const char ecg[BUFFER_SIZE] = {
     76, 77, 78, 77, 79, 86, 81, 76, 84, 93, 85, 80,
     89, 95, 89, 85, 93, 98, 94, 88, 98, 105, 96, 91,
@@ -52,34 +63,15 @@ const char ecg[BUFFER_SIZE] = {
 };
 /*==================[internal functions declaration]=========================*/
 /**
- * @brief Función invocada en la interrupción del timer conversionAD
+ * @brief Función invocada desde la interrupción del timer del ADC cada BLOQUE_AD muestras
  */
-void FuncTimerConversorDA()
-{
-    vTaskNotifyGiveFromISR(ConversorDA_handle, pdFALSE); /* Envía una notificación a la tarea asociada a medir */
-}
-
-void FuncTimerConversorAD()
+void FuncBloqueConversorAD()
 {
     vTaskNotifyGiveFromISR(ConversorAD_handle, pdFALSE); /* Envía una notificación a la tarea asociada a medir */
 }
 
-static void ConversorDA_Task()
-{
-    uint8_t i = 0;
-    while (true)
-    {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        AnalogOutputWrite(ecg[i]);
-        i++;
-
-        if (i == (BUFFER_SIZE-1))
-            i = 0;
-    }
-}
-
-void EscribirEnMonitor(){
-    UartSendString(UART_PC, (char*)UartItoa(datosAD, 10));
+void EscribirEnMonitor(uint16_t dato){
+    UartSendString(UART_PC, (char*)UartItoa(dato, 10));
     UartSendString(UART_PC, "\r");
 }
 
@@ -88,28 +80,23 @@ static void ConversorAD_Task()
     while (true)
     {
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        AnalogInputReadSingle(CH1, &datosAD);
-        EscribirEnMonitor();
+        /* Las muestras se leen en la interrupción del timer; la tarea sólo vacía el buffer por bloques.
+           Si se juntaron varias notificaciones (la UART demora) hay más de un bloque: se lee hasta vaciarlo */
+        uint16_t n;
+        while ((n = AnalogInputReadContinuous(CH1, datosAD, BLOQUE_AD)) > 0)
+        {
+            /* Se envían a la frecuencia del DAC, para comparar muestra a muestra con el ECG generado */
+            uint32_t m = ResamplerProcess(&remuestreo, datosAD, n, datosRemuestreados, sizeof(datosRemuestreados) / sizeof(datosRemuestreados[0]));
+            for (uint32_t i = 0; i < m; i++)
+            {
+                EscribirEnMonitor(datosRemuestreados[i]);
+            }
+        }
     }
 }
 /*==================[external functions definition]==========================*/
 void app_main(void)
 {
-    /*Inicializacion del timer conversion DA*/
-    timer_config_t timer_conversor_DA = {
-        .timer = TIMER_A,
-        .period = TIEMPO_MUESTREO_DA, // los timers trabajan en microsegundos
-        .func_p = FuncTimerConversorDA,
-        .param_p = NULL};
-    TimerInit(&timer_conversor_DA);
-
-    timer_config_t timer_conversor_AD = {
-        .timer = TIMER_B,
-        .period = TIEMPO_MUESTREO_AD, // los timers trabajan en microsegundos
-        .func_p = FuncTimerConversorAD,
-        .param_p = NULL};
-    TimerInit(&timer_conversor_AD);
-
     /*Inicializacion de terminal PC*/
     serial_config_t terminal_PC = {
         .port = UART_PC,
@@ -118,22 +105,27 @@ void app_main(void)
         .param_p = NULL};
     UartInit(&terminal_PC);
 
-    /*Inicializacion entrada analogica*/
+    /*Inicializacion entrada analogica: muestreo desde la interrupción del TIMER_B*/
     analog_input_config_t conv_AD = {
         .input = CH1,
-        .mode = ADC_SINGLE,
-        .func_p = NULL,
+        .mode = ADC_TIMED,
+        .func_p = FuncBloqueConversorAD,
         .param_p = NULL,
-        .sample_frec = 0};
+        .sample_frec = FRECUENCIA_MUESTREO_AD,
+        .block_size = BLOQUE_AD,
+        .timer = TIMER_B};
     AnalogInputInit(&conv_AD);
 
     AnalogOutputInit();
 
+    /* Remuestreo de 500 Hz a 250 Hz con filtro anti-alias (muestras de 12 bits, centradas en 2048) */
+    ResamplerDesign(coefRemuestreo, REMUESTREO_SUBIDA, REMUESTREO_BAJADA, REMUESTREO_COEF, REMUESTREO_CORTE);
+    ResamplerInit(&remuestreo, coefRemuestreo, REMUESTREO_SUBIDA, REMUESTREO_BAJADA, REMUESTREO_COEF, estadoRemuestreo, 2048);
+
     /* Creacion de tareas */
-    xTaskCreate(&ConversorDA_Task, "Conversor DA", 1024, NULL, 5, &ConversorDA_handle);
     xTaskCreate(&ConversorAD_Task, "Conversor AD", 4096, NULL, 5, &ConversorAD_handle);
 
-    /* Inicio del conteo de timers */
-    TimerStart(timer_conversor_DA.timer);
-    TimerStart(timer_conversor_AD.timer);
+    /* Inicio de la conversión AD y de la reproducción del ECG (en bucle, desde la interrupción del timer del DAC) */
+    AnalogStartContinuous(CH1);
+    AnalogOutputPlay((const uint8_t *)ecg, BUFFER_SIZE, FRECUENCIA_MUESTREO_DA, true);
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 15/05/2024 | Document creation		                         |
+ * | 19/07/2024 | Telemetría con FmtPrintf (sin sprintf de floats) |
  *
  * @author Guillermina Zaragoza (guillerminazf@gmail.com)
  *
@@ -34,6 +35,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <math.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -44,6 +46,7 @@
 #include "ble_mcu.h"
 #include "ws2812b.h"
 #include "Si7007.h"
+#include "fmt.h"
 /*==================[macros and definitions]=================================*/
 #define TIMER_HyT 5000000 // los timers trabajan en [us]
 
@@ -54,6 +57,8 @@
 #define UH_ALTO 80.0 // Umbral alto de humedad [%]
 
 #define NUM_LEDS 20
+
+#define LARGO_CADENA 24 // Largo de las cadenas de telemetría ("*T-12.34\n*" y similares)
 /*==================[internal data definition]===============================*/
 bool encendido = false;
 
@@ -108,9 +113,9 @@ void leerDatos(uint8_t *data, uint8_t length)
             tiempoIdealMS = tiempoIdeal * 1000; // paso a milisegundos el dato leido
             tiempoLED = tiempoIdealMS / NUM_LEDS;
 
-            char cadena_tiempo[128];
-            strcpy(cadena_tiempo, "");
-            sprintf(cadena_tiempo, "*d%.2f\r\n*", tiempoIdeal);
+            /* los valores se envían en centésimas, con 2 decimales (%.2D) */
+            char cadena_tiempo[LARGO_CADENA];
+            FmtPrintf(cadena_tiempo, sizeof(cadena_tiempo), "*d%.2D\r\n*", (int)lroundf(tiempoIdeal * 100));
             BleSendString(cadena_tiempo);
 
             tiempoIdeal = 0;
@@ -142,14 +147,12 @@ static void MedirHyT_Task()
             humedad = Si7007MeasureHumidity();
             printf("Temperatura: %.2f°C \nHumedad: %.2f%%\n\n", temperatura, humedad);
 
-            char cadena_temp[128];
-            strcpy(cadena_temp, "");
-            sprintf(cadena_temp, "*T%.2f\n*", temperatura);
+            char cadena_temp[LARGO_CADENA];
+            FmtPrintf(cadena_temp, sizeof(cadena_temp), "*T%.2D\n*", (int)lroundf(temperatura * 100));
             BleSendString(cadena_temp);
 
-            char cadena_hum[128];
-            strcpy(cadena_hum, "");
-            sprintf(cadena_hum, "*H%.2f\n*", humedad);
+            char cadena_hum[LARGO_CADENA];
+            FmtPrintf(cadena_hum, sizeof(cadena_hum), "*H%.2D\n*", (int)lroundf(humedad * 100));
             BleSendString(cadena_hum);
         }
     }
@@ -214,19 +217,16 @@ static void ControlHyT_Task()
             printf("Velocidad en la vuelta: %.5f m/s\n\n", velocidad);
 
             /* Mostrar los datos por la aplicación */
-            char cadena_vel[128];
-            strcpy(cadena_vel, "");
-            sprintf(cadena_vel, "*V%.2f\n*", velocidad);
+            char cadena_vel[LARGO_CADENA];
+            FmtPrintf(cadena_vel, sizeof(cadena_vel), "*V%.2D\n*", (int)lroundf(velocidad * 100));
             BleSendString(cadena_vel);
 
-            char cadena_tiempoProm[128];
-            strcpy(cadena_tiempoProm, "");
-            sprintf(cadena_tiempoProm, "*P%.2f\n*", tiempoProm);
+            char cadena_tiempoProm[LARGO_CADENA];
+            FmtPrintf(cadena_tiempoProm, sizeof(cadena_tiempoProm), "*P%.2D\n*", (int)lroundf(tiempoProm * 100));
             BleSendString(cadena_tiempoProm);
 
-            char cadena_tiempoTotal[128];
-            strcpy(cadena_tiempoTotal, "");
-            sprintf(cadena_tiempoTotal, "*R%.2f\n*", tiempoTotal);
+            char cadena_tiempoTotal[LARGO_CADENA];
+            FmtPrintf(cadena_tiempoTotal, sizeof(cadena_tiempoTotal), "*R%.2D\n*", (int)lroundf(tiempoTotal * 100));
             BleSendString(cadena_tiempoTotal);
         }
     }
@@ -19,6 +19,10 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 18/06/2024 | Document creation		                         |
+ * | 03/07/2024 | Termopila leída con sobremuestreo (16 bits)     |
+ * | 08/07/2024 | Alarma por monitor de umbral del ADC            |
+ * | 15/07/2024 | Promedio de temperatura con ventana deslizante (running_stats) |
+ * | 25/07/2024 | Mensajes por logger: la tarea de medición no espera a la UART |
  *
  * @author Guillermina Zaragoza (guillerminazf@gmail.com)
  *
@@ -34,6 +38,8 @@
 #include "uart_mcu.h"
 #include "hc_sr04.h"
 #include "led.h"
+#include "running_stats.h"
+#include "logger.h"
 /*==================[macros and definitions]=================================*/
 #define TIEMPO_MEDICION_PRESENCIA 1000	// 1000 ms = 1 s
 #define TIEMPO_MEDICION_TEMPERATURA 100 // 100 ms entre cada medicion
@@ -42,12 +48,23 @@
 #define DISTANCIA_MINIMA 8				// Distanciam mínima del rango de medición
 #define DISTANCIA_MAXIMA 12				// Distancia máxima del rango de medición
 #define DISTANCIA_NUEVA_MEDICION 140	// Distancia límite. Se toman nuevas medidas
-#define TEMPERATURA_MAXIMA 37.5			// Temperatura para la cual se prende la alarma
+#define TEMPERATURA_ALARMA 37.5			// Temperatura para la cual se prende la alarma
+#define HISTERESIS_ALARMA 0.5			// 0.5°C de histéresis para que la alarma no oscile
+#define SOBREMUESTREO 4					// Sobremuestreo 4^4 = 256 muestras --> 16 bits
+#define FRECUENCIA_MUESTREO 20480		// 20480 Hz / 256 = 80 muestras de 16 bits por segundo
+#define MUESTRAS_TEMPERATURA 16			// Máximo de muestras leídas en cada medicion (8 cada 100 ms)
+#define VENTANA_TEMPERATURA 80			// Muestras promediadas: el último segundo
+/* Umbrales del monitor en mV: inversa de la conversión temperatura = Vin * TEMPERATURA_MAXIMA / VREF */
+#define UMBRAL_ALARMA_MV ((uint16_t)(TEMPERATURA_ALARMA * VREF / TEMPERATURA_MAXIMA))		// 2475 mV
+#define HISTERESIS_ALARMA_MV ((uint16_t)(HISTERESIS_ALARMA * VREF / TEMPERATURA_MAXIMA))	// 33 mV
 /*==================[internal data definition]===============================*/
 float distancia = 0;			// Almacena la distancia medida por el sensor ultrasónico
 float temperatura = 0;			// Almacena la temperatura medida por la termopila
-float promedio_temperatura = 0; // Almacena el promedio de 10 muestras de temperatura
+float promedio_temperatura = 0; // Almacena el promedio de temperatura del último segundo
 float Vin = 0;					// Tensión de entrada de la señal analógica
+uint16_t muestras[MUESTRAS_TEMPERATURA]; // Muestras sobremuestreadas de la termopila
+int32_t historia_temperatura[VENTANA_TEMPERATURA]; // Ventana del promedio deslizante
+window_stats_t ventana_temperatura;	 // Promedio deslizante (suma acumulada, sin recorrer la ventana)
 /*==================[internal functions declaration]=========================*/
 /**
  * @brief Tarea que mide la distancia a intervalos regulares (de 1 segundo)
@@ -89,13 +106,11 @@ static void MedirDistanciaTask(void *pvParameter)
 
 /**
  * @brief Función que escribe los datos de temperatura promedio y distancia y los envía al monitor de la PC por UART
+ * 		  (a través del logger: no espera a que se transmitan, si la UART no da abasto se descartan)
  */
 void EscribirEnMonitor()
 {
-	UartSendString(UART_PC, (char *)UartItoa(promedio_temperatura, 10)); // Envía el valor promediado de la temperatura por UART al monitor de PC
-	UartSendString(UART_PC, "°C persona a ");							 // Convierte promedio_temperatura a una cadena de caracteres
-	UartSendString(UART_PC, (char *)UartItoa(distancia, 10));			 // Escribe la distancia
-	UartSendString(UART_PC, " cm\r\n");									 // Escribe cm y caracteres de salto de línea
+	LOGGER_I("%u°C persona a %u cm", (unsigned)promedio_temperatura, (unsigned)distancia);
 }
 
 /**
@@ -106,19 +121,20 @@ static void MedirTemperaturaTask(void *pvParameter)
 {
 	while (true)
 	{
+		/* Lee las muestras de 16 bits acumuladas desde la última medición (se descartan si no hay nadie en rango) */
+		uint16_t n = AnalogInputReadContinuous(CH1, muestras, MUESTRAS_TEMPERATURA);
+
 		/* Si está dentro del rango */
-		if ((distancia > DISTANCIA_MINIMA) & (distancia < DISTANCIA_MAXIMA))
+		if ((distancia > DISTANCIA_MINIMA) & (distancia < DISTANCIA_MAXIMA) && (n > 0))
 		{
-			/* Lee el valor de la entrada analógica CH1 (en mV) y lo almacena en Vin */
-			AnalogInputReadSingle(CH1, &Vin);
-			for (int i = 0; i < 10; i++)
-			{
-				/*Sumar las 10 temperaturas*/
-				temperatura += Vin * TEMPERATURA_MAXIMA / VREF;
-				// 3.3V representan 50°C
-				// Vin representa a temp °C --> temp =  Vin * 50°C / 3.3V
-			}
-			promedio_temperatura = temperatura / 10; // Calculo promedio
+			/* Agrega las muestras nuevas a la ventana (las más viejas salen solas) */
+			WindowStatsPushBlock(&ventana_temperatura, muestras, n);
+			/* Convierte el promedio de las muestras a mV y lo almacena en Vin */
+			Vin = AnalogOversampled2uV(WindowStatsMean(&ventana_temperatura) + 0.5f, SOBREMUESTREO) / 1000.0;
+			temperatura = Vin * TEMPERATURA_MAXIMA / VREF;
+			// 3.3V representan 50°C
+			// Vin representa a temp °C --> temp =  Vin * 50°C / 3.3V
+			promedio_temperatura = temperatura;
 			EscribirEnMonitor();					 // Llamo a la función para que escriba en monitor
 		}
 
@@ -127,6 +143,7 @@ static void MedirTemperaturaTask(void *pvParameter)
 		{
 			temperatura = 0; 						// Vuelvo a inicializar en 0 para otro ciclo de lectura
 			promedio_temperatura = 0;
+			WindowStatsReset(&ventana_temperatura);	// El promedio de la próxima persona empieza de cero
 		}
 
 		vTaskDelay(pdMS_TO_TICKS(TIEMPO_MEDICION_TEMPERATURA)); // Cada 'TIEMPO_MEDICION_TEMPERATURA' milisegundos
@@ -134,18 +151,21 @@ static void MedirTemperaturaTask(void *pvParameter)
 }
 
 /**
- * @brief función que prende una alarma si la temperatura se excede de un límite. Controlada mediante un GPIO
+ * @brief Función invocada por el monitor del ADC cuando la temperatura cruza el umbral de 37.5°C.
+ * 		  Prende o apaga la alarma (GPIO_9) sin necesidad de consultar la temperatura.
  */
-void EncenderAlarma()
+void AlarmaTemperatura(void *param, bool encima)
 {
-	/* Si la temperatura promedio está por debajo de 37.5°C */
-	if (promedio_temperatura < TEMPERATURA_MAXIMA)
+	/* Si la temperatura está por encima de 37.5°C */
+	if (encima)
 	{
-		GPIOOff(GPIO_9); /* La alarma no se prende --> GPIO_9 en 0*/
+		GPIOOn(GPIO_9); /* La alarma se prende --> GPIO_9 en 1 */
 	}
-	/* Si la temperatura está por encima de 37.5°C */
+	/* Si la temperatura bajó de 37°C */
 	else
-		GPIOOn(GPIO_9); /* La alarma se prende --> GPIO_9 en 1 */
+	{
+		GPIOOff(GPIO_9); /* La alarma no se prende --> GPIO_9 en 0*/
+	}
 }
 /*==================[external functions definition]==========================*/
 void app_main(void)
@@ -164,14 +184,35 @@ void app_main(void)
 		.param_p = NULL};
 	UartInit(&terminal_PC);
 
-	/*Inicializacion entrada analogica*/
+	/*Inicializacion del logger: envía los mensajes desde una tarea de baja prioridad*/
+	logger_config_t logger = {
+		.port = UART_PC,
+		.level = LOGGER_INFO,
+		.priority = 0,
+		.period_ms = 0};
+	LoggerInit(&logger);
+
+	/*Inicializacion entrada analogica: conversión continua con sobremuestreo para bajar el ruido de la termopila*/
 	analog_input_config_t conv_AD = {
 		.input = CH1,
-		.mode = ADC_SINGLE,
+		.mode = ADC_CONTINUOUS,
 		.func_p = NULL,
 		.param_p = NULL,
-		.sample_frec = 0};
+		.sample_frec = FRECUENCIA_MUESTREO,
+		.oversampling = SOBREMUESTREO,
+		.dither = true};
 	AnalogInputInit(&conv_AD);
+	WindowStatsInit(&ventana_temperatura, historia_temperatura, VENTANA_TEMPERATURA);
+
+	/*Alarma: el monitor del ADC avisa cuando la tensión cruza el umbral (con histéresis)*/
+	analog_monitor_config_t alarma = {
+		.input = CH1,
+		.high_threshold = UMBRAL_ALARMA_MV,
+		.low_threshold = UMBRAL_ALARMA_MV - HISTERESIS_ALARMA_MV,
+		.func_p = AlarmaTemperatura,
+		.param_p = NULL};
+	AnalogMonitorInit(&alarma);
+	AnalogStartContinuous(CH1);
 
 	// Creación de tareas
 	xTaskCreate(&MedirDistanciaTask, "Medir la distancia", 1024, NULL, 5, NULL);
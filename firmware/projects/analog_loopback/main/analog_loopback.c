@@ -0,0 +1,133 @@
+/*! @mainpage Analog loopback
+ *
+ * @section genDesc General Description
+ *
+ * Characterizes the DAC -> ADC analog chain: the DAC generates sines (DDS) of known amplitude
+ * and offset, the ADC captures them in sync (timestamped blocks, same time base) and the board
+ * computes gain, offset, SNR, THD, SINAD and latency for each frequency. Results are sent to the
+ * PC through the serial monitor, one CSV line per frequency.
+ *
+ * @section hardConn Hardware Connection
+ *
+ * |    Peripheral  |   ESP32   	|
+ * |:--------------:|:--------------|
+ * | 	DAC	 	| 	GPIO_0 -> RC low pass filter -> CH1	|
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 12/07/2024 | Document creation		                         |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "analog_io_mcu.h"
+#include "dds.h"
+#include "signal_analysis.h"
+/*==================[macros and definitions]=================================*/
+#define SAMPLE_FREC		5000		/* DAC and ADC sample rate (Hz) */
+#define N_SAMPLES		2048		/* Samples analyzed per frequency */
+#define DAC_AMPLITUDE	100			/* DAC counts (peak) */
+#define DAC_OFFSET		128			/* DAC counts */
+#define DAC_FULL_SCALE	3300.0f		/* mV for 256 DAC counts */
+#define HARMONICS		5			/* Highest harmonic included in THD */
+#define SETTLING_TIME	200			/* ms, for the filter to settle after a frequency change */
+#define READ_PERIOD		10			/* ms between buffer reads */
+/*==================[internal data definition]===============================*/
+static const uint32_t test_freq[] = {10, 20, 50, 100, 200, 500, 1000};	/* Hz */
+static uint16_t samples[N_SAMPLES];
+static dds_t dds;
+/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Captures N_SAMPLES contiguous samples of CH1 (restarting on any gap)
+ *
+ * @return int64_t Time of the first sample (us)
+ */
+static int64_t Capture(void){
+	analog_block_t block;
+	uint32_t first_index = 0;
+	int64_t first_time = 0;
+	uint16_t count = 0;
+	/* discard old samples */
+	while(AnalogInputReadContinuous(CH1, samples, N_SAMPLES) > 0){
+	}
+	while(count < N_SAMPLES){
+		uint16_t n = AnalogInputReadBlock(CH1, &block, &samples[count], N_SAMPLES - count);
+		if(n == 0){
+			vTaskDelay(pdMS_TO_TICKS(READ_PERIOD));
+			continue;
+		}
+		if(count == 0){
+			first_index = block.index;
+			first_time = block.timestamp;
+		}else if(block.index != first_index + count){
+			/* samples dropped: start again from this block */
+			memmove(samples, &samples[count], n * sizeof(samples[0]));
+			count = 0;
+			first_index = block.index;
+			first_time = block.timestamp;
+		}
+		count += n;
+	}
+	return first_time;
+}
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	analog_input_config_t adc = {
+		.input = CH1,
+		.mode = ADC_TIMED,
+		.sample_frec = SAMPLE_FREC,
+		.timer = TIMER_B,
+	};
+	AnalogInputInit(&adc);
+	AnalogOutputInit();
+	DdsInit(&dds, SAMPLE_FREC, DDS_SINE);
+	DdsSetAmplitude(&dds, DAC_AMPLITUDE, DAC_OFFSET);
+	AnalogStartContinuous(CH1);
+
+	const float expected_amplitude = DAC_FULL_SCALE * DAC_AMPLITUDE / 256;
+	const float expected_offset = DAC_FULL_SCALE * DAC_OFFSET / 256;
+	printf("\n===== Analog loopback: %d Hz, %d samples =====\n", SAMPLE_FREC, N_SAMPLES);
+	printf("freq_hz,gain,gain_db,offset_mv,snr_db,thd_db,sinad_db,enob,latency_us\n");
+
+	for(uint8_t i = 0; i < sizeof(test_freq) / sizeof(test_freq[0]); i++){
+		float freq = test_freq[i];
+		AnalogOutputStop();
+		DdsSetPhase(&dds, 0);
+		DdsSetFrequency(&dds, test_freq[i] * 1000);
+		/* DDS sample k (phase 2 pi f k / fs) is written on timer alarm k + 1 */
+		int64_t dac_start = esp_timer_get_time() + 1000000 / SAMPLE_FREC;
+		AnalogOutputGenerate16(SAMPLE_FREC, DdsNext16, &dds);
+		vTaskDelay(pdMS_TO_TICKS(SETTLING_TIME));
+
+		int64_t adc_start = Capture();
+		AnalogRaw2mVBatch(samples, samples, N_SAMPLES);
+		signal_sine_t result;
+		if(!SignalSineAnalysis(samples, N_SAMPLES, freq / SAMPLE_FREC, HARMONICS, &result)){
+			printf("%" PRIu32 ",,,,,,,,\n", test_freq[i]);
+			continue;
+		}
+		/* DAC phase at the first ADC sample, from the shared time base */
+		double cycles = freq * (adc_start - dac_start) / 1e6;
+		float dac_phase = 2 * M_PI * (cycles - floor(cycles));
+		float latency = SignalPhaseDelay(dac_phase, result.phase, freq);
+		float gain = result.amplitude / expected_amplitude;
+		printf("%" PRIu32 ",%.4f,%.2f,%.1f,%.1f,%.1f,%.1f,%.2f,%.0f\n", test_freq[i], gain, 20 * log10f(gain),
+			result.offset - expected_offset, result.snr, result.thd, result.sinad, result.enob, latency * 1e6f);
+	}
+	AnalogOutputStop();
+	AnalogStopContinuous(CH1);
+	printf("===== Done =====\n");
+}
+/*==================[end of file]============================================*/
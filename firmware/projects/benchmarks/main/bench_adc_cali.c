@@ -0,0 +1,96 @@
+/**
+ * @file bench_adc_cali.c
+ * @brief ADC calibration benchmark: compares adc_cali_raw_to_voltage against
+ * the driver lookup table (AnalogRaw2mV / AnalogRaw2mVBatch), in speed and accuracy.
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "benchmarks.h"
+#include "analog_io_mcu.h"
+#include "esp_adc/adc_cali_scheme.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	1024
+#define RAW_VALUES	4096
+/*==================[internal data definition]===============================*/
+static uint16_t raw[N_SAMPLES];
+static uint16_t mv[N_SAMPLES];
+/*==================[internal functions declaration]=========================*/
+
+/*==================[external functions definition]==========================*/
+void BenchAdcCalibration(void){
+	const analog_atten_t atten[] = {ANALOG_ATTEN_0DB, ANALOG_ATTEN_2_5DB, ANALOG_ATTEN_6DB, ANALOG_ATTEN_12DB};
+	const adc_atten_t idf_atten[] = {ADC_ATTEN_DB_0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_11};
+	const char *atten_name[] = {"0 dB", "2.5 dB", "6 dB", "12 dB"};
+	analog_input_config_t config = {
+		.input = CH1,
+		.mode = ADC_SINGLE,
+	};
+	AnalogInputInit(&config);
+	printf("--- ADC calibration ---\n");
+
+	for(uint16_t i = 0; i < N_SAMPLES; i++){
+		raw[i] = rand() % RAW_VALUES;
+	}
+
+	for(uint8_t a = 0; a < sizeof(atten) / sizeof(atten[0]); a++){
+		uint32_t start = BENCH_CYCLES();
+		AnalogSetAttenuation(atten[a]);
+		uint32_t build = BENCH_CYCLES() - start;
+
+		adc_cali_handle_t cali;
+		adc_cali_curve_fitting_config_t cali_config = {
+			.unit_id = ADC_UNIT_1,
+			.atten = idf_atten[a],
+			.bitwidth = ADC_BITWIDTH_12,
+		};
+		adc_cali_create_scheme_curve_fitting(&cali_config, &cali);
+
+		/* accuracy: every raw value, table vs IDF */
+		int max_err = 0;
+		uint16_t mismatches = 0;
+		for(int r = 0; r < RAW_VALUES; r++){
+			int volt;
+			adc_cali_raw_to_voltage(cali, r, &volt);
+			int err = abs(volt - AnalogRaw2mV(r));
+			if(err > 0){
+				mismatches++;
+			}
+			if(err > max_err){
+				max_err = err;
+			}
+		}
+
+		/* speed */
+		start = BENCH_CYCLES();
+		for(uint16_t i = 0; i < N_SAMPLES; i++){
+			int volt;
+			adc_cali_raw_to_voltage(cali, raw[i], &volt);
+			mv[i] = volt;
+		}
+		uint32_t idf = BENCH_CYCLES() - start;
+
+		start = BENCH_CYCLES();
+		for(uint16_t i = 0; i < N_SAMPLES; i++){
+			mv[i] = AnalogRaw2mV(raw[i]);
+		}
+		uint32_t single = BENCH_CYCLES() - start;
+
+		start = BENCH_CYCLES();
+		AnalogRaw2mVBatch(raw, mv, N_SAMPLES);
+		uint32_t batch = BENCH_CYCLES() - start;
+
+		adc_cali_delete_scheme_curve_fitting(cali);
+
+		printf("atten %s: table build %lu cycles, max error %d mV (%u mismatches)\n", 
+			atten_name[a], build, max_err, mismatches);
+		printf("  cycles/sample: IDF %lu.%02lu, AnalogRaw2mV %lu.%02lu, AnalogRaw2mVBatch %lu.%02lu\n",
+			idf / N_SAMPLES, (idf % N_SAMPLES) * 100 / N_SAMPLES,
+			single / N_SAMPLES, (single % N_SAMPLES) * 100 / N_SAMPLES,
+			batch / N_SAMPLES, (batch % N_SAMPLES) * 100 / N_SAMPLES);
+	}
+	AnalogSetAttenuation(ANALOG_ATTEN_12DB);
+}
+/*==================[end of file]============================================*/
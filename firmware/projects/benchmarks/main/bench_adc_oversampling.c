@@ -0,0 +1,64 @@
+/**
+ * @file bench_adc_oversampling.c
+ * @brief ADC oversampling benchmark: noise and effective number of bits (ENOB) 
+ * of CH1 for each oversampling exponent, with and without dither.
+ * 
+ * @note Connect a steady DC voltage (e.g. a resistive divider) to CH1. ENOB is estimated from 
+ * the noise as bits - log2(sigma * sqrt(12)), sigma measured in LSB of the output resolution.
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "benchmarks.h"
+#include "analog_io_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES		256
+#define SAMPLE_FREC		40000	/* per channel ADC rate, output rate = SAMPLE_FREC / 4^n */
+/*==================[internal data definition]===============================*/
+static uint16_t samples[N_SAMPLES];
+/*==================[internal functions declaration]=========================*/
+static void acquire(uint8_t oversampling, bool dither){
+	analog_input_config_t config = {
+		.input = CH1,
+		.mode = ADC_CONTINUOUS,
+		.sample_frec = SAMPLE_FREC,
+		.oversampling = oversampling,
+		.dither = dither,
+	};
+	AnalogInputInit(&config);
+	AnalogStartContinuous(CH1);
+	uint16_t n = 0;
+	while(n < N_SAMPLES){
+		vTaskDelay(pdMS_TO_TICKS(10));
+		n += AnalogInputReadContinuous(CH1, &samples[n], N_SAMPLES - n);
+	}
+	AnalogStopContinuous(CH1);
+}
+/*==================[external functions definition]==========================*/
+void BenchAdcOversampling(void){
+	printf("--- ADC oversampling (CH1, %d samples) ---\n", N_SAMPLES);
+	for(uint8_t d = 0; d < 2; d++){
+		for(uint8_t n = 0; n <= ADC_OVERSAMPLING_MAX; n++){
+			acquire(n, d);
+			int64_t sum = 0, sum2 = 0;
+			for(uint16_t i = 0; i < N_SAMPLES; i++){
+				sum += samples[i];
+				sum2 += (int64_t)samples[i] * samples[i];
+			}
+			double mean = (double)sum / N_SAMPLES;
+			double sigma = sqrt((double)sum2 / N_SAMPLES - mean * mean);
+			uint8_t bits = 12 + n;
+			/* noise floor is quantization noise (1/sqrt(12) LSB) when sigma is below it */
+			double enob = (sigma * sqrt(12) > 1.0) ? bits - log2(sigma * sqrt(12)) : bits;
+			printf("n=%u (%3u x, %2u bits, %5lu Hz) dither=%u: mean %.1f mV, sigma %.2f LSB (%.1f uV), ENOB %.2f\n",
+				n, 1 << (2 * n), bits, (uint32_t)(SAMPLE_FREC >> (2 * n)), d,
+				AnalogOversampled2uV((uint16_t)mean, n) / 1000.0,
+				sigma, sigma * 3300000.0 / (1 << bits), enob);
+		}
+	}
+}
+/*==================[end of file]============================================*/
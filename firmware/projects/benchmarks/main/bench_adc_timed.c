@@ -0,0 +1,153 @@
+/**
+ * @file bench_adc_timed.c
+ * @brief Timer paced ADC benchmark: CPU load and sampling jitter of a task woken
+ * for every sample (timer ISR + task notification + AnalogInputReadSingle) against 
+ * ADC_TIMED mode (one-shot read in the timer ISR, task drains blocks).
+ * 
+ * @note CPU load is estimated with a lowest priority task that counts loops: 
+ * load = 1 - loops / loops without sampling. Jitter is measured on the sample 
+ * instants (task design) or on the block callbacks (ISR design).
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "benchmarks.h"
+#include "analog_io_mcu.h"
+#include "timer_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define SAMPLE_FREC		2000	/* Hz */
+#define BLOCK_SIZE		50		/* samples per block in ADC_TIMED mode */
+#define MEASURE_TIME	1000	/* ms */
+/*==================[internal data definition]===============================*/
+typedef struct {
+	int64_t last;
+	uint32_t n;
+	int64_t min, max;
+	double sum, sum2;
+} jitter_t;
+
+static volatile uint32_t load_count;
+static TaskHandle_t load_handle = NULL;
+static TaskHandle_t task_handle = NULL;
+static TaskHandle_t block_handle = NULL;
+static jitter_t jitter;
+static uint16_t block[BLOCK_SIZE];
+/*==================[internal functions declaration]=========================*/
+static void jitter_reset(void){
+	jitter.last = 0;
+	jitter.n = 0;
+	jitter.min = INT64_MAX;
+	jitter.max = INT64_MIN;
+	jitter.sum = 0;
+	jitter.sum2 = 0;
+}
+
+static void jitter_add(int64_t t){
+	if(jitter.last != 0){
+		int64_t d = t - jitter.last;
+		jitter.min = (d < jitter.min) ? d : jitter.min;
+		jitter.max = (d > jitter.max) ? d : jitter.max;
+		jitter.sum += d;
+		jitter.sum2 += (double)d * d;
+		jitter.n++;
+	}
+	jitter.last = t;
+}
+
+static void jitter_print(const char *name, uint32_t loops, uint32_t base){
+	double mean = jitter.sum / jitter.n;
+	double sigma = sqrt(jitter.sum2 / jitter.n - mean * mean);
+	printf("%s: CPU load %.2f %%, period %.1f us (min %lld, max %lld, sigma %.2f us)\n",
+		name, 100.0 * (1.0 - (double)loops / base), mean, jitter.min, jitter.max, sigma);
+}
+
+static void LoadTask(void *param){
+	while(true){
+		load_count++;
+	}
+}
+
+static uint32_t measure_load(void){
+	load_count = 0;
+	vTaskDelay(pdMS_TO_TICKS(MEASURE_TIME));
+	return load_count;
+}
+
+/* task per sample design */
+static void TimerPerSample(void *param){
+	vTaskNotifyGiveFromISR(task_handle, pdFALSE);
+}
+
+static void SampleTask(void *param){
+	uint16_t value;
+	while(true){
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		AnalogInputReadSingle(CH1, &value);
+		jitter_add(esp_timer_get_time());
+	}
+}
+
+/* ISR paced design */
+static void BlockReady(void *param){
+	jitter_add(esp_timer_get_time());
+	vTaskNotifyGiveFromISR(block_handle, pdFALSE);
+}
+
+static void BlockTask(void *param){
+	while(true){
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		AnalogInputReadContinuous(CH1, block, BLOCK_SIZE);
+	}
+}
+/*==================[external functions definition]==========================*/
+void BenchAdcTimed(void){
+	printf("--- ADC timed sampling (%d Hz) ---\n", SAMPLE_FREC);
+	xTaskCreate(&LoadTask, "load", 1024, NULL, 1, &load_handle);
+	uint32_t base = measure_load();
+
+	/* task per sample */
+	analog_input_config_t single = {
+		.input = CH1,
+		.mode = ADC_SINGLE,
+	};
+	AnalogInputInit(&single);
+	xTaskCreate(&SampleTask, "sample", 2048, NULL, 5, &task_handle);
+	timer_config_t timer = {
+		.timer = TIMER_A,
+		.period = 1000000 / SAMPLE_FREC,
+		.func_p = TimerPerSample,
+		.param_p = NULL,
+	};
+	TimerInit(&timer);
+	jitter_reset();
+	TimerStart(TIMER_A);
+	uint32_t loops = measure_load();
+	TimerStop(TIMER_A);
+	jitter_print("task per sample ", loops, base);
+
+	/* ISR paced, blocks of BLOCK_SIZE */
+	xTaskCreate(&BlockTask, "block", 2048, NULL, 5, &block_handle);
+	analog_input_config_t timed = {
+		.input = CH1,
+		.mode = ADC_TIMED,
+		.func_p = BlockReady,
+		.sample_frec = SAMPLE_FREC,
+		.block_size = BLOCK_SIZE,
+		.timer = TIMER_B,
+	};
+	AnalogInputInit(&timed);
+	jitter_reset();
+	AnalogStartContinuous(CH1);
+	loops = measure_load();
+	AnalogStopContinuous(CH1);
+	/* block callback period is BLOCK_SIZE sample periods */
+	jitter_print("ISR paced blocks", loops, base);
+
+	vTaskDelete(load_handle);
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,50 @@
+/**
+ * @file bench_codec.c
+ * @brief Delta codec benchmark: CPU cycles per sample of encoding (each group mode) and decoding,
+ * and bits per sample, for a 12 bits sine with noise (band limited signal, as ECG or IMU) and
+ * a noisy step signal (as distance).
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "benchmarks.h"
+#include "delta_codec.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	1024
+/*==================[internal data definition]===============================*/
+static uint16_t samples[N_SAMPLES];
+static uint16_t decoded[N_SAMPLES];
+static uint8_t encoded[CODEC_MAX_ENCODED(N_SAMPLES)];
+static const char *mode_names[] = {"auto", "packed", "varint"};
+/*==================[internal functions declaration]=========================*/
+static void bench_signal(const char *name){
+	for(uint8_t mode = CODEC_AUTO; mode <= CODEC_VARINT; mode++){
+		uint32_t len;
+		uint32_t start = BENCH_CYCLES();
+		CodecEncodeU16(samples, N_SAMPLES, mode, encoded, sizeof(encoded), &len);
+		uint32_t encode = BENCH_CYCLES() - start;
+		start = BENCH_CYCLES();
+		bool ok = CodecDecodeU16(encoded, len, decoded, N_SAMPLES);
+		uint32_t decode = BENCH_CYCLES() - start;
+		printf("%-10s %-6s encode: %3lu cycles/sample, decode: %3lu cycles/sample, %5.2f bits/sample (%.1fx)%s\n",
+			name, mode_names[mode], (unsigned long)(encode / N_SAMPLES), (unsigned long)(decode / N_SAMPLES),
+			8.0f * len / N_SAMPLES, 16.0f * N_SAMPLES / (8.0f * len), ok ? "" : " DECODING ERROR");
+	}
+}
+
+/*==================[external functions definition]==========================*/
+void BenchCodec(void){
+	printf("--- Delta codec (%d samples of 16 bits) ---\n", N_SAMPLES);
+	for(uint16_t i = 0; i < N_SAMPLES; i++){
+		samples[i] = 2048 + 1500 * sinf(2 * M_PI * i / 200) + rand() % 5;
+	}
+	bench_signal("sine");
+	for(uint16_t i = 0; i < N_SAMPLES; i++){
+		samples[i] = 1000 + (i / 128) * 150 + rand() % 3;
+	}
+	bench_signal("steps");
+}
+/*==================[end of file]============================================*/
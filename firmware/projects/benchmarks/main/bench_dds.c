@@ -0,0 +1,56 @@
+/**
+ * @file bench_dds.c
+ * @brief DDS generator benchmark: CPU cycles per sample of DdsNext() for each waveform,
+ * and of DdsFill() (buffer for AnalogOutputQueue()) with and without a frequency sweep.
+ * 
+ * @note The cycles per sample (plus the timer ISR overhead) can be given to the host 
+ * model in tools/dds_model to estimate the CPU load of AnalogOutputGenerate().
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include "benchmarks.h"
+#include "dds.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	1024
+#define RATE		50000	/* Hz */
+/*==================[internal data definition]===============================*/
+static uint8_t buffer[N_SAMPLES];
+static volatile uint32_t sink;
+/*==================[internal functions declaration]=========================*/
+
+/*==================[external functions definition]==========================*/
+void BenchDds(void){
+	const dds_wave_t wave[] = {DDS_SINE, DDS_TRIANGLE, DDS_SQUARE, DDS_SAWTOOTH};
+	const char *wave_name[] = {"sine", "triangle", "square", "sawtooth"};
+	dds_t dds;
+	printf("--- DDS generator (%d Hz) ---\n", RATE);
+
+	for(uint8_t w = 0; w < sizeof(wave) / sizeof(wave[0]); w++){
+		DdsInit(&dds, RATE, wave[w]);
+		DdsSetFrequency(&dds, 1234567);
+		uint32_t acc = 0;
+		uint32_t start = BENCH_CYCLES();
+		for(uint16_t i = 0; i < N_SAMPLES; i++){
+			acc += DdsNext(&dds);
+		}
+		uint32_t cycles = BENCH_CYCLES() - start;
+		sink = acc;
+		printf("DdsNext %-9s: %.1f cycles/sample\n", wave_name[w], (float)cycles / N_SAMPLES);
+	}
+
+	DdsInit(&dds, RATE, DDS_SINE);
+	DdsSetFrequency(&dds, 1234567);
+	uint32_t start = BENCH_CYCLES();
+	DdsFill(&dds, buffer, N_SAMPLES);
+	uint32_t fill = BENCH_CYCLES() - start;
+
+	DdsSweep(&dds, 100000, 20000000, RATE, true);
+	start = BENCH_CYCLES();
+	DdsFill(&dds, buffer, N_SAMPLES);
+	uint32_t sweep = BENCH_CYCLES() - start;
+	printf("DdsFill sine: %.1f cycles/sample, with sweep: %.1f cycles/sample\n",
+		(float)fill / N_SAMPLES, (float)sweep / N_SAMPLES);
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,50 @@
+/**
+ * @file bench_fft.c
+ * @brief Fixed-point FFT benchmark: CPU cycles of FftComplex() from 256 to 2048 points,
+ * and of a whole Welch segment (window, FFT and power accumulation).
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "benchmarks.h"
+#include "fft.h"
+/*==================[macros and definitions]=================================*/
+#define MAX_POINTS	2048
+/*==================[internal data definition]===============================*/
+static fft_complex_t data[MAX_POINTS];
+static int16_t window[MAX_POINTS];
+static int16_t segment[MAX_POINTS];
+static float power[MAX_POINTS / 2 + 1];
+static uint16_t samples[MAX_POINTS];
+/*==================[internal functions declaration]=========================*/
+
+/*==================[external functions definition]==========================*/
+void BenchFft(void){
+	printf("--- Fixed-point FFT ---\n");
+	for(uint16_t points = 256; points <= MAX_POINTS; points *= 2){
+		for(uint16_t i = 0; i < points; i++){
+			data[i].re = (rand() % 32768) - 16384;
+			data[i].im = 0;
+		}
+		uint32_t start = BENCH_CYCLES();
+		FftComplex(data, points);
+		uint32_t fft = BENCH_CYCLES() - start;
+
+		welch_t welch;
+		FftWindow(FFT_WINDOW_HANN, window, points);
+		WelchInit(&welch, points, window, 12, segment, data, power);
+		for(uint16_t i = 0; i < points; i++){
+			samples[i] = rand() % 4096;
+		}
+		/* the first points - 1 samples only fill the segment, the last one transforms it */
+		WelchPush(&welch, samples, points - 1);
+		start = BENCH_CYCLES();
+		WelchPush(&welch, &samples[points - 1], 1);
+		uint32_t segment_cycles = BENCH_CYCLES() - start;
+		printf("FFT %4d points: %lu cycles (%.1f /point), Welch segment: %lu cycles\n", points,
+			(unsigned long)fft, (float)fft / points, (unsigned long)segment_cycles);
+	}
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,101 @@
+/**
+ * @file bench_filter.c
+ * @brief Fixed-point filters benchmark: CPU cycles per sample and per tap (FIR) or per
+ * section (biquad) for blocks of ADC samples, and cycles per sample of the moving average
+ * and CIC decimator.
+ *
+ * @note Coefficients are not meaningful here (cost does not depend on them): real ones
+ * are designed with tools/filter_design.
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "benchmarks.h"
+#include "filter.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES		512
+#define MAX_TAPS		64
+#define MAX_SECTIONS	4
+#define MA_LEN			32
+#define BIAS			2048
+/*==================[internal data definition]===============================*/
+static uint16_t block[N_SAMPLES];
+static int16_t coeffs_q15[MAX_TAPS];
+static int32_t coeffs_q31[MAX_TAPS];
+static int16_t fir_state[2 * MAX_TAPS];
+static biquad_coeffs_t biquad_coeffs[MAX_SECTIONS];
+static biquad_state_t biquad_state[MAX_SECTIONS];
+static uint16_t ma_history[MA_LEN];
+/*==================[internal functions declaration]=========================*/
+static void fill_block(void);
+
+/*==================[internal functions definition]==========================*/
+/* random 12 bits samples */
+static void fill_block(void){
+	for(uint16_t i = 0; i < N_SAMPLES; i++){
+		block[i] = rand() % 4096;
+	}
+}
+/*==================[external functions definition]==========================*/
+void BenchFilter(void){
+	const uint16_t taps[] = {8, 16, 32, 64};
+	uint32_t start, cycles;
+	printf("--- Fixed-point filters (%d samples blocks) ---\n", N_SAMPLES);
+
+	for(uint8_t k = 0; k < MAX_TAPS; k++){
+		coeffs_q15[k] = 32768 / (2 * MAX_TAPS);
+		coeffs_q31[k] = INT32_MAX / (2 * MAX_TAPS);
+	}
+	for(uint8_t t = 0; t < sizeof(taps) / sizeof(taps[0]); t++){
+		fir_q15_t q15;
+		fir_q31_t q31;
+		FirQ15Init(&q15, coeffs_q15, taps[t], fir_state, BIAS);
+		fill_block();
+		start = BENCH_CYCLES();
+		FirQ15Process(&q15, block, N_SAMPLES);
+		uint32_t cycles_q15 = BENCH_CYCLES() - start;
+		FirQ31Init(&q31, coeffs_q31, taps[t], fir_state, BIAS);
+		fill_block();
+		start = BENCH_CYCLES();
+		FirQ31Process(&q31, block, N_SAMPLES);
+		uint32_t cycles_q31 = BENCH_CYCLES() - start;
+		printf("FIR %2d taps: Q15 %.1f cycles/sample (%.2f /tap), Q31 %.1f cycles/sample (%.2f /tap)\n", taps[t],
+			(float)cycles_q15 / N_SAMPLES, (float)cycles_q15 / N_SAMPLES / taps[t],
+			(float)cycles_q31 / N_SAMPLES, (float)cycles_q31 / N_SAMPLES / taps[t]);
+	}
+
+	for(uint8_t s = 0; s < MAX_SECTIONS; s++){
+		biquad_coeffs[s] = (biquad_coeffs_t){1 << 28, 1 << 29, 1 << 28, -(1 << 30), 1 << 28};
+	}
+	for(uint8_t sections = 1; sections <= MAX_SECTIONS; sections++){
+		biquad_t biquad;
+		BiquadInit(&biquad, biquad_coeffs, biquad_state, sections, BIAS);
+		fill_block();
+		start = BENCH_CYCLES();
+		BiquadProcess(&biquad, block, N_SAMPLES);
+		cycles = BENCH_CYCLES() - start;
+		printf("Biquad %d sections: %.1f cycles/sample (%.1f /section)\n", sections,
+			(float)cycles / N_SAMPLES, (float)cycles / N_SAMPLES / sections);
+	}
+
+	moving_average_t ma;
+	MovingAverageInit(&ma, ma_history, MA_LEN);
+	fill_block();
+	start = BENCH_CYCLES();
+	MovingAverageProcess(&ma, block, N_SAMPLES);
+	cycles = BENCH_CYCLES() - start;
+	printf("Moving average (%d): %.1f cycles/sample\n", MA_LEN, (float)cycles / N_SAMPLES);
+
+	for(uint8_t order = 1; order <= FILTER_CIC_MAX_ORDER; order++){
+		cic_t cic;
+		CicInit(&cic, order, 16);
+		fill_block();
+		start = BENCH_CYCLES();
+		CicProcess(&cic, block, N_SAMPLES);
+		cycles = BENCH_CYCLES() - start;
+		printf("CIC order %d, decimation 16: %.1f cycles/input sample\n", order, (float)cycles / N_SAMPLES);
+	}
+}
+/*==================[end of file]============================================*/
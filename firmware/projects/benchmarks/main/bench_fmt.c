@@ -0,0 +1,87 @@
+/**
+ * @file bench_fmt.c
+ * @brief Number formatting benchmark: CPU cycles of the fmt.h functions against newlib snprintf(), 
+ * for integers, hexadecimal numbers and telemetry fields with 2 decimals (a fixed point integer 
+ * with %.2D against a float with %.2f).
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "benchmarks.h"
+#include "fmt.h"
+/*==================[macros and definitions]=================================*/
+#define N_VALUES	256
+#define BUF_LEN		32
+/*==================[internal data definition]===============================*/
+static int32_t values[N_VALUES];
+static char buf[BUF_LEN];
+/*==================[internal functions declaration]=========================*/
+static void print_result(const char *name, uint32_t fmt, uint32_t newlib){
+	printf("%-28s fmt: %5lu cycles, snprintf: %6lu cycles (%.1fx)\n", name, (unsigned long)(fmt / N_VALUES),
+		(unsigned long)(newlib / N_VALUES), (float)newlib / (fmt ? fmt : 1));
+}
+
+/*==================[external functions definition]==========================*/
+void BenchFmt(void){
+	printf("--- Number formatting (cycles per call) ---\n");
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		values[i] = (int32_t)((rand() << 8) ^ rand()) % 1000000;
+	}
+	uint32_t start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		FmtInt(buf, values[i], 10, 0, ' ');
+	}
+	uint32_t fmt = BENCH_CYCLES() - start;
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		snprintf(buf, BUF_LEN, "%ld", (long)values[i]);
+	}
+	print_result("FmtInt / %ld", fmt, BENCH_CYCLES() - start);
+
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		FmtUint(buf, values[i], 16, 8, '0');
+	}
+	fmt = BENCH_CYCLES() - start;
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		snprintf(buf, BUF_LEN, "%08lx", (unsigned long)values[i]);
+	}
+	print_result("FmtUint hex / %08lx", fmt, BENCH_CYCLES() - start);
+
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		FmtFixed(buf, values[i], 2);
+	}
+	fmt = BENCH_CYCLES() - start;
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		snprintf(buf, BUF_LEN, "%.2f", values[i] / 100.0f);
+	}
+	print_result("FmtFixed / %.2f", fmt, BENCH_CYCLES() - start);
+
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		FmtPrintf(buf, BUF_LEN, "*T%.2D\n*", values[i]);
+	}
+	fmt = BENCH_CYCLES() - start;
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		snprintf(buf, BUF_LEN, "*T%.2f\n*", values[i] / 100.0f);
+	}
+	print_result("FmtPrintf %.2D / %.2f", fmt, BENCH_CYCLES() - start);
+
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		FmtPrintf(buf, BUF_LEN, "distancia: %d cm\r\n", values[i]);
+	}
+	fmt = BENCH_CYCLES() - start;
+	start = BENCH_CYCLES();
+	for(uint16_t i = 0; i < N_VALUES; i++){
+		snprintf(buf, BUF_LEN, "distancia: %ld cm\r\n", (long)values[i]);
+	}
+	print_result("FmtPrintf %d / %ld", fmt, BENCH_CYCLES() - start);
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,82 @@
+/**
+ * @file bench_log.c
+ * @brief Logging benchmark: CPU cycles per call and bytes sent per message of a logger text 
+ * message (LoggerWrite(), formatted in the ESP32) against the same deferred message (DLOG_I(), 
+ * formatted in the PC by tools/telemetry_decoder/log_decoder).
+ * 
+ * @note Both are sent as telemetry records through UART_CONNECTOR (TX, GPIO18, does not need to be
+ * connected). Messages are written in batches that fit in the logger queue, so none is dropped.
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "benchmarks.h"
+#include "uart_mcu.h"
+#include "telemetry.h"
+#include "logger.h"
+#include "dlog.h"
+/*==================[macros and definitions]=================================*/
+#define N_BATCHES		16
+#define BATCH_LEN		8		/* messages per batch (INFO queue: 16 slots) */
+#define DRAIN_MS		100		/* time for the logger to send a batch */
+/*==================[internal data definition]===============================*/
+static telemetry_t log_stream;
+static uint32_t mv[BATCH_LEN];
+static int32_t temp[BATCH_LEN];
+/*==================[internal functions declaration]=========================*/
+static void print_result(const char *name, uint32_t cycles, uint32_t bytes){
+	printf("%-22s %5lu cycles per call, %3lu bytes per message\n", name, 
+		(unsigned long)(cycles / (N_BATCHES * BATCH_LEN)), (unsigned long)(bytes / (N_BATCHES * BATCH_LEN)));
+}
+
+/*==================[external functions definition]==========================*/
+void BenchLog(void){
+	printf("--- Logging (text vs. deferred) ---\n");
+	serial_config_t config = {
+		.port = UART_CONNECTOR,
+		.baud_rate = 921600,
+		.func_p = UART_NO_INT,
+		.param_p = NULL,
+	};
+	UartInit(&config);
+	TelemetryInit(&log_stream, UART_CONNECTOR, false);
+	logger_config_t logger = {
+		.port = UART_CONNECTOR,
+		.level = LOGGER_INFO,
+		.telemetry = &log_stream,
+	};
+	LoggerInit(&logger);
+	for(uint8_t i = 0; i < BATCH_LEN; i++){
+		mv[i] = rand() % 3300;
+		temp[i] = rand() % 5000;
+	}
+
+	uint32_t cycles = 0;
+	uint32_t bytes = log_stream.bytes;
+	for(uint8_t b = 0; b < N_BATCHES; b++){
+		uint32_t start = BENCH_CYCLES();
+		for(uint8_t i = 0; i < BATCH_LEN; i++){
+			LOGGER_I("adc %u mV, t = %.2D C, estado %s", mv[i], temp[i], "ok");
+		}
+		cycles += BENCH_CYCLES() - start;
+		vTaskDelay(pdMS_TO_TICKS(DRAIN_MS));
+	}
+	print_result("LoggerWrite (text)", cycles, log_stream.bytes - bytes);
+
+	cycles = 0;
+	bytes = log_stream.bytes;
+	for(uint8_t b = 0; b < N_BATCHES; b++){
+		uint32_t start = BENCH_CYCLES();
+		for(uint8_t i = 0; i < BATCH_LEN; i++){
+			DLOG_I("adc %u mV, t = %.2D C, estado %s", mv[i], temp[i], "ok");
+		}
+		cycles += BENCH_CYCLES() - start;
+		vTaskDelay(pdMS_TO_TICKS(DRAIN_MS));
+	}
+	print_result("DLOG_I (deferred)", cycles, log_stream.bytes - bytes);
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,98 @@
+/**
+ * @file bench_uart.c
+ * @brief UART transmit benchmark, on UART_CONNECTOR at 115200, 921600 and 5000000 baud: bytes accepted 
+ * and CPU time of the old byte by byte FIFO writes (uart_tx_chars()), and throughput and CPU 
+ * time of the buffered blocking, non-blocking and timeout writes.
+ * 
+ * @note UART_CONNECTOR TX (GPIO18) does not need to be connected. Throughput is measured from the 
+ * first write until the line is idle, and compared with the 8N1 line rate (baud / 10 bytes per second).
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include "driver/uart.h"
+#include "esp_timer.h"
+#include "benchmarks.h"
+#include "uart_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define MSG_LEN			8192	/* bytes per test */
+#define CHUNK_LEN		64		/* bytes per write (telemetry line size) */
+#define TIMEOUT_MS		10
+/*==================[internal data definition]===============================*/
+static const uint32_t baud_rates[] = {115200, 921600, UART_BAUD_MAX};
+static char msg[MSG_LEN];
+/*==================[internal functions declaration]=========================*/
+static void print_result(const char *name, uint32_t accepted, uint32_t cycles, int64_t elapsed, uint32_t baud){
+	float rate = (elapsed > 0) ? accepted * 1e6f / elapsed : 0;
+	printf("%-14s %5lu/%d bytes, %7lu cycles in calls (%.1f /byte), %6.0f bytes/s (%.0f %% of line rate)\n", name,
+		(unsigned long)accepted, MSG_LEN, (unsigned long)cycles, (float)cycles / (accepted ? accepted : 1),
+		rate, 100 * rate / (baud / 10));
+}
+
+/*==================[external functions definition]==========================*/
+void BenchUart(void){
+	printf("--- UART transmit ---\n");
+	for(uint32_t i = 0; i < MSG_LEN; i++){
+		msg[i] = 'A' + (i % 26);
+	}
+	for(uint8_t b = 0; b < sizeof(baud_rates) / sizeof(baud_rates[0]); b++){
+		uint32_t baud = baud_rates[b];
+		serial_config_t config = {
+			.port = UART_CONNECTOR,
+			.baud_rate = baud,
+			.func_p = UART_NO_INT,
+			.param_p = NULL,
+		};
+		UartInit(&config);
+		printf("%lu baud:\n", (unsigned long)baud);
+
+		/* old path: one FIFO write per byte, bytes that do not fit are lost */
+		uint32_t accepted = 0;
+		int64_t t0 = esp_timer_get_time();
+		uint32_t start = BENCH_CYCLES();
+		for(uint32_t i = 0; i < MSG_LEN; i++){
+			accepted += uart_tx_chars(UART_NUM_1, &msg[i], 1);
+		}
+		uint32_t cycles = BENCH_CYCLES() - start;
+		UartTxFlush(UART_CONNECTOR, 10000);
+		print_result("uart_tx_chars", accepted, cycles, esp_timer_get_time() - t0, baud);
+
+		/* blocking: every byte, the call waits for room */
+		accepted = 0;
+		cycles = 0;
+		t0 = esp_timer_get_time();
+		for(uint32_t i = 0; i < MSG_LEN; i += CHUNK_LEN){
+			start = BENCH_CYCLES();
+			accepted += UartWriteBlocking(UART_CONNECTOR, &msg[i], CHUNK_LEN);
+			cycles += BENCH_CYCLES() - start;
+		}
+		UartTxFlush(UART_CONNECTOR, 10000);
+		print_result("blocking", accepted, cycles, esp_timer_get_time() - t0, baud);
+
+		/* non-blocking: what fits in the buffer, never waits */
+		accepted = 0;
+		cycles = 0;
+		t0 = esp_timer_get_time();
+		for(uint32_t i = 0; i < MSG_LEN; i += CHUNK_LEN){
+			start = BENCH_CYCLES();
+			accepted += UartWriteNonBlocking(UART_CONNECTOR, &msg[i], CHUNK_LEN);
+			cycles += BENCH_CYCLES() - start;
+		}
+		UartTxFlush(UART_CONNECTOR, 10000);
+		print_result("non-blocking", accepted, cycles, esp_timer_get_time() - t0, baud);
+
+		/* timeout: waits for room up to TIMEOUT_MS per write */
+		accepted = 0;
+		cycles = 0;
+		t0 = esp_timer_get_time();
+		for(uint32_t i = 0; i < MSG_LEN; i += CHUNK_LEN){
+			start = BENCH_CYCLES();
+			accepted += UartWriteTimeout(UART_CONNECTOR, &msg[i], CHUNK_LEN, TIMEOUT_MS);
+			cycles += BENCH_CYCLES() - start;
+		}
+		UartTxFlush(UART_CONNECTOR, 10000);
+		print_result("timeout 10 ms", accepted, cycles, esp_timer_get_time() - t0, baud);
+	}
+}
+/*==================[end of file]============================================*/
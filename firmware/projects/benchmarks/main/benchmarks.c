@@ -0,0 +1,42 @@
+/*! @mainpage Benchmarks
+ *
+ * @section genDesc General Description
+ *
+ * Runs every driver benchmark in sequence and prints the results through the serial monitor.
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 02/07/2024 | Document creation		                         |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include "benchmarks.h"
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	printf("\n===== Benchmarks =====\n");
+	BenchAdcCalibration();
+	BenchAdcOversampling();
+	BenchAdcTimed();
+	BenchDds();
+	BenchFilter();
+	BenchFft();
+	BenchUart();
+	BenchFmt();
+	BenchCodec();
+	BenchLog();
+	printf("===== Done =====\n");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,64 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+/**
+ * @file benchmarks.h
+ * @brief Benchmarks declaration. Each one is implemented in its own bench_*.c file.
+ */
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include "esp_cpu.h"
+/*==================[macros]=================================================*/
+#define BENCH_CYCLES()	esp_cpu_get_cycle_count()	/*!< CPU cycle counter */
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief ADC calibration: IDF call vs. lookup table, and table accuracy
+ */
+void BenchAdcCalibration(void);
+
+/**
+ * @brief ADC oversampling: noise and ENOB for each oversampling exponent
+ */
+void BenchAdcOversampling(void);
+
+/**
+ * @brief Timer paced ADC: task per sample vs. ADC_TIMED mode (CPU load and jitter)
+ */
+void BenchAdcTimed(void);
+
+/**
+ * @brief DDS generator: CPU cycles per sample for each waveform and with frequency sweep
+ */
+void BenchDds(void);
+
+/**
+ * @brief Fixed-point filters: CPU cycles per sample per tap (FIR), per section (biquad), moving average and CIC
+ */
+void BenchFilter(void);
+
+/**
+ * @brief Fixed-point FFT: CPU cycles from 256 to 2048 points and per Welch segment
+ */
+void BenchFft(void);
+
+/**
+ * @brief UART transmit: bytes accepted, CPU time and throughput of each write flavour at 115200 and 921600 baud
+ */
+void BenchUart(void);
+
+/**
+ * @brief Number formatting: CPU cycles of fmt.h functions against newlib snprintf()
+ */
+void BenchFmt(void);
+
+/**
+ * @brief Logging: CPU cycles and bytes per message of logger text messages against deferred ones (dlog.h)
+ */
+void BenchLog(void);
+
+/**
+ * @brief Delta codec: CPU cycles per sample of encoding and decoding, and bits per sample
+ */
+void BenchCodec(void);
+
+#endif /* BENCHMARKS_H */
+/*==================[end of file]============================================*/
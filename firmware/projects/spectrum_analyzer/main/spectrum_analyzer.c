@@ -0,0 +1,88 @@
+/*! @mainpage Spectrum analyzer
+ *
+ * @section genDesc General Description
+ *
+ * Estimates the power spectral density of the signal in CH1 (Welch method: 50 % overlapped
+ * segments, Hann window, fixed-point FFT) and sends it to the PC through the serial monitor,
+ * one CSV table per estimate, to be plotted on the PC (ECG noise, mains pickup, vibrations).
+ *
+ * @section hardConn Hardware Connection
+ *
+ * |    Peripheral  |   ESP32   	|
+ * |:--------------:|:--------------|
+ * | 	Signal	 	| 	CH1		|
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 16/07/2024 | Document creation		                         |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "analog_io_mcu.h"
+#include "fft.h"
+/*==================[macros and definitions]=================================*/
+#define SAMPLE_FREC		1000		/* Hz: 1.95 Hz resolution with 512 points */
+#define POINTS			512			/* FFT (segment) length */
+#define SEGMENTS		16			/* Segments averaged per estimate (about 4 s) */
+#define BLOCK_SIZE		128			/* Samples read each time */
+#define READ_PERIOD		50			/* ms between buffer reads */
+#define PSD_FLOOR		1e-12f		/* Floor for the dB conversion */
+/*==================[internal data definition]===============================*/
+static uint16_t block[BLOCK_SIZE];
+static int16_t window[POINTS];
+static int16_t segment[POINTS];
+static fft_complex_t work[POINTS];
+static float power[POINTS / 2 + 1];
+static float psd[POINTS / 2 + 1];
+static welch_t welch;
+/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Sends the spectrum as a CSV table: frequency (Hz) and PSD (dB counts² / Hz)
+ */
+static void ExportPsd(uint32_t estimate){
+	printf("# spectrum %" PRIu32 " fs=%d points=%d segments=%d\n", estimate, SAMPLE_FREC, POINTS, SEGMENTS);
+	printf("freq_hz,psd_db\n");
+	for(uint16_t k = 0; k <= POINTS / 2; k++){
+		printf("%.2f,%.1f\n", (float)k * SAMPLE_FREC / POINTS, 10 * log10f(psd[k] + PSD_FLOOR));
+	}
+	printf("# end\n");
+}
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	analog_input_config_t adc = {
+		.input = CH1,
+		.mode = ADC_TIMED,
+		.sample_frec = SAMPLE_FREC,
+		.timer = TIMER_B,
+	};
+	AnalogInputInit(&adc);
+	FftWindow(FFT_WINDOW_HANN, window, POINTS);
+	WelchInit(&welch, POINTS, window, 12, segment, work, power);
+	AnalogStartContinuous(CH1);
+
+	uint32_t estimate = 0;
+	while(true){
+		uint16_t n = AnalogInputReadContinuous(CH1, block, BLOCK_SIZE);
+		if(n == 0){
+			vTaskDelay(pdMS_TO_TICKS(READ_PERIOD));
+			continue;
+		}
+		if(WelchPush(&welch, block, n) >= SEGMENTS){
+			WelchGetPsd(&welch, SAMPLE_FREC, psd);
+			ExportPsd(estimate++);
+			WelchReset(&welch);
+		}
+	}
+}
+/*==================[end of file]============================================*/
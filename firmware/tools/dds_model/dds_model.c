@@ -0,0 +1,158 @@
+/**
+ * @file dds_model.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host model of the DDS generator (drivers/utils/src/dds.c, compiled unchanged):
+ * spectral purity of the Q15 waveform and of the 8 bits DAC samples, and CPU cost.
+ *
+ * Spectral purity is measured on N samples with a Blackman-Harris window:
+ * SFDR (fundamental against the largest spur) and SINAD / ENOB (fundamental against
+ * everything else). The CPU cost is measured in ns per sample on the host; with the
+ * cycles per sample measured on the board (benchmarks project, bench_dds.c) it
+ * estimates the CPU load of AnalogOutputGenerate() at each sample rate.
+ *
+ * Usage: dds_model [cycles per sample on target]
+ *
+ * @version 0.1
+ * @date 2024-07-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "dds.h"
+/*==================[macros and definitions]=================================*/
+#define N_BITS		14
+#define N			(1 << N_BITS)		/* FFT size */
+#define RATE		50000				/* Hz */
+#define LOBE		6					/* window main lobe half width (bins) */
+#define CPU_FREC	160000000.0			/* ESP32-C6 CPU clock (Hz) */
+#define COST_SAMPLES 10000000
+/*==================[internal data definition]===============================*/
+static double re[N], im[N], power[N / 2];
+static volatile uint32_t sink;
+/*==================[internal functions definition]==========================*/
+static void fft(double *x, double *y){
+	for(uint32_t i = 1, j = 0; i < N; i++){
+		uint32_t bit = N >> 1;
+		for(; j & bit; bit >>= 1){
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j){
+			double t = x[i]; x[i] = x[j]; x[j] = t;
+			t = y[i]; y[i] = y[j]; y[j] = t;
+		}
+	}
+	for(uint32_t len = 2; len <= N; len <<= 1){
+		double a = -2 * M_PI / len;
+		for(uint32_t i = 0; i < N; i += len){
+			for(uint32_t k = 0; k < len / 2; k++){
+				double wr = cos(a * k), wi = sin(a * k);
+				uint32_t p = i + k, q = i + k + len / 2;
+				double tr = x[q] * wr - y[q] * wi;
+				double ti = x[q] * wi + y[q] * wr;
+				x[q] = x[p] - tr; y[q] = y[p] - ti;
+				x[p] += tr; y[p] += ti;
+			}
+		}
+	}
+}
+
+/* windows the samples in re[], and computes SFDR and SINAD (dB) around bin 'fund' */
+static void analyze(double fund, double *sfdr, double *sinad){
+	for(uint32_t i = 0; i < N; i++){
+		double w = 0.35875 - 0.48829 * cos(2 * M_PI * i / N) + 0.14128 * cos(4 * M_PI * i / N)
+			- 0.01168 * cos(6 * M_PI * i / N);
+		re[i] *= w;
+		im[i] = 0;
+	}
+	fft(re, im);
+	for(uint32_t i = 0; i < N / 2; i++){
+		power[i] = re[i] * re[i] + im[i] * im[i];
+	}
+	int32_t f = lround(fund);
+	double signal = 0, noise = 0, spur = 0;
+	for(int32_t i = LOBE; i < N / 2; i++){
+		if(abs(i - f) <= LOBE){
+			signal += power[i];
+		}else{
+			noise += power[i];
+			/* largest spur: peak bin outside the fundamental lobe */
+			spur = (power[i] > spur) ? power[i] : spur;
+		}
+	}
+	double peak = 0;
+	for(int32_t i = f - LOBE; i <= f + LOBE; i++){
+		peak = (power[i] > peak) ? power[i] : peak;
+	}
+	*sfdr = 10 * log10(peak / spur);
+	*sinad = 10 * log10(signal / noise);
+}
+
+static void purity(const char *name, dds_wave_t wave, uint32_t freq){
+	dds_t raw, dac;
+	double sfdr_raw, sinad_raw, sfdr_dac, sinad_dac;
+	DdsInit(&raw, RATE, wave);
+	DdsSetFrequency(&raw, freq);
+	dac = raw;
+	for(uint32_t i = 0; i < N; i++){
+		re[i] = DdsNextRaw(&raw);
+	}
+	analyze((double)freq / 1000 * N / RATE, &sfdr_raw, &sinad_raw);
+	for(uint32_t i = 0; i < N; i++){
+		re[i] = DdsNext(&dac) - 128.0;
+	}
+	analyze((double)freq / 1000 * N / RATE, &sfdr_dac, &sinad_dac);
+	printf("%-9s %10.3f Hz | Q15: SFDR %6.1f dB, SINAD %6.1f dB (ENOB %5.2f) | DAC: SFDR %5.1f dB, SINAD %5.1f dB (ENOB %4.2f)\n",
+		name, freq / 1000.0, sfdr_raw, sinad_raw, (sinad_raw - 1.76) / 6.02,
+		sfdr_dac, sinad_dac, (sinad_dac - 1.76) / 6.02);
+}
+
+static double cost(dds_wave_t wave){
+	dds_t dds;
+	struct timespec t0, t1;
+	uint32_t acc = 0;
+	DdsInit(&dds, RATE, wave);
+	DdsSetFrequency(&dds, 1234567);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(uint32_t i = 0; i < COST_SAMPLES; i++){
+		acc += DdsNext(&dds);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sink = acc;
+	return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / COST_SAMPLES;
+}
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	printf("DDS model: %d Hz sample rate, %d points FFT (Blackman-Harris)\n\n", RATE, N);
+
+	/* triangle, square and sawtooth are exact functions of the phase: only the sine is measured */
+	printf("Spectral purity (sine)\n");
+	purity("sine", DDS_SINE, 1000000);
+	purity("sine", DDS_SINE, 1234567);
+	purity("sine", DDS_SINE, 7777777);
+	purity("sine", DDS_SINE, 19999999);
+
+	printf("\nCPU cost (host, per sample)\n");
+	const char *names[] = {"sine", "triangle", "square", "sawtooth"};
+	for(dds_wave_t w = DDS_SINE; w <= DDS_SAWTOOTH; w++){
+		printf("%-9s %6.2f ns\n", names[w], cost(w));
+	}
+
+	if(argc > 1){
+		double cycles = atof(argv[1]);
+		printf("\nESP32-C6 load for %.0f cycles per sample (generator + timer ISR)\n", cycles);
+		const uint32_t rates[] = {1000, 10000, 20000, 50000};
+		for(uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++){
+			printf("%6lu Hz: %5.1f %%\n", (unsigned long)rates[i], 100.0 * cycles * rates[i] / CPU_FREC);
+		}
+	}
+	return 0;
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,349 @@
+/**
+ * @file filter_design.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host coefficient design for the fixed-point filters in drivers/utils (filter.h).
+ *
+ * Prints the coefficients as C arrays ready to paste in a project, and checks the design
+ * by running sines through the fixed-point filters (drivers/utils/src/filter.c, compiled
+ * unchanged): the measured gain is printed next to the ideal (floating point) response.
+ *
+ * Usage:
+ *   filter_design fir <lowpass|highpass> <taps> <fs> <fc> [hamming|blackman|kaiser <beta>]
+ *   filter_design fir <bandpass|bandstop> <taps> <fs> <f1> <f2> [hamming|blackman|kaiser <beta>]
+ *   filter_design biquad <lowpass|highpass> <order> <fs> <fc>      (Butterworth)
+ *   filter_design biquad <bandpass|notch> <fs> <f0> <Q>
+ *
+ * @version 0.1
+ * @date 2024-07-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "filter.h"
+/*==================[macros and definitions]=================================*/
+#define MAX_TAPS		1024
+#define MAX_SECTIONS	8
+#define TEST_SAMPLES	8192
+#define TEST_AMPLITUDE	1000.0		/* ADC counts (12 bits input, bias 2048) */
+#define TEST_BIAS		2048
+#define TEST_POINTS		9
+/*==================[internal data definition]===============================*/
+typedef enum {
+	LOWPASS,
+	HIGHPASS,
+	BANDPASS,
+	BANDSTOP,
+} band_t;
+
+static double fir[MAX_TAPS];
+static int16_t fir_q15[MAX_TAPS];
+static int32_t fir_q31[MAX_TAPS];
+static int16_t fir_state[2 * MAX_TAPS];
+static double sos[MAX_SECTIONS][5];			/* b0, b1, b2, a1, a2 */
+static biquad_coeffs_t sos_q30[MAX_SECTIONS];
+static biquad_state_t sos_state[MAX_SECTIONS];
+static uint8_t sections;
+static uint16_t signal[TEST_SAMPLES];
+/*==================[internal functions definition]==========================*/
+static void usage(void){
+	fprintf(stderr, "usage:\n"
+		"  filter_design fir <lowpass|highpass> <taps> <fs> <fc> [hamming|blackman|kaiser <beta>]\n"
+		"  filter_design fir <bandpass|bandstop> <taps> <fs> <f1> <f2> [hamming|blackman|kaiser <beta>]\n"
+		"  filter_design biquad <lowpass|highpass> <order> <fs> <fc>\n"
+		"  filter_design biquad <bandpass|notch> <fs> <f0> <Q>\n");
+	exit(1);
+}
+
+static band_t parse_band(const char *s){
+	if(strcmp(s, "lowpass") == 0) return LOWPASS;
+	if(strcmp(s, "highpass") == 0) return HIGHPASS;
+	if(strcmp(s, "bandpass") == 0) return BANDPASS;
+	if((strcmp(s, "bandstop") == 0) || (strcmp(s, "notch") == 0)) return BANDSTOP;
+	usage();
+	return LOWPASS;
+}
+
+/* zero order modified Bessel function, for the Kaiser window */
+static double bessel_i0(double x){
+	double sum = 1, term = 1;
+	for(int k = 1; k < 50; k++){
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static double sinc_lowpass(double fc, double m){
+	return (m == 0) ? 2 * fc : sin(2 * M_PI * fc * m) / (M_PI * m);
+}
+
+/* ideal (floating point) response magnitude at normalized frequency f */
+static double fir_response(uint16_t taps, double f){
+	double re = 0, im = 0;
+	for(uint16_t k = 0; k < taps; k++){
+		re += fir[k] * cos(2 * M_PI * f * k);
+		im -= fir[k] * sin(2 * M_PI * f * k);
+	}
+	return hypot(re, im);
+}
+
+static double sos_response(double f){
+	double gain = 1;
+	for(uint8_t s = 0; s < sections; s++){
+		double w = 2 * M_PI * f;
+		double nr = sos[s][0] + sos[s][1] * cos(w) + sos[s][2] * cos(2 * w);
+		double ni = -sos[s][1] * sin(w) - sos[s][2] * sin(2 * w);
+		double dr = 1 + sos[s][3] * cos(w) + sos[s][4] * cos(2 * w);
+		double di = -sos[s][3] * sin(w) - sos[s][4] * sin(2 * w);
+		gain *= hypot(nr, ni) / hypot(dr, di);
+	}
+	return gain;
+}
+
+/* sine at normalized frequency f, ADC counts around TEST_BIAS */
+static void make_sine(double f){
+	for(uint32_t i = 0; i < TEST_SAMPLES; i++){
+		signal[i] = lrint(TEST_BIAS + TEST_AMPLITUDE * sin(2 * M_PI * f * i));
+	}
+}
+
+/* amplitude of the frequency f component in the second half of signal[] (after the transient) */
+static double measure(double f){
+	double a = 0, b = 0;
+	uint32_t n = TEST_SAMPLES / 2;
+	for(uint32_t i = n; i < TEST_SAMPLES; i++){
+		a += (signal[i] - (double)TEST_BIAS) * cos(2 * M_PI * f * i);
+		b += (signal[i] - (double)TEST_BIAS) * sin(2 * M_PI * f * i);
+	}
+	return 2 * hypot(a, b) / n;
+}
+
+/* gains below half a LSB of the test sine are shown as such */
+static void print_gain(double gain){
+	if(gain < 0.5 / TEST_AMPLITUDE){
+		printf(" | %11s", "< 1/2 LSB");
+	}else{
+		printf(" | %8.2f dB", 20 * log10(gain));
+	}
+}
+
+static void print_db(double fs, double f, double ideal, double q1, double q2){
+	printf("%10.2f Hz | %8.2f dB", f * fs, 20 * log10(ideal + 1e-12));
+	print_gain(q1);
+	if(q2 >= 0){
+		print_gain(q2);
+	}
+	printf("\n");
+}
+
+static void design_fir(int argc, char *argv[]){
+	if(argc < 6){
+		usage();
+	}
+	band_t band = parse_band(argv[2]);
+	uint16_t taps = atoi(argv[3]);
+	double fs = atof(argv[4]);
+	double f1 = atof(argv[5]) / fs, f2 = 0;
+	int arg = 6;
+	if((band == BANDPASS) || (band == BANDSTOP)){
+		if(argc < 7){
+			usage();
+		}
+		f2 = atof(argv[6]) / fs;
+		arg = 7;
+	}
+	if((taps < 3) || (taps > MAX_TAPS) || (f1 <= 0) || (f1 >= 0.5) || (f2 < 0) || (f2 >= 0.5)){
+		usage();
+	}
+	if(((band == HIGHPASS) || (band == BANDSTOP)) && ((taps % 2) == 0)){
+		taps++;
+		fprintf(stderr, "highpass / bandstop need an odd number of taps: using %d\n", taps);
+	}
+	const char *window = (argc > arg) ? argv[arg] : "hamming";
+	double beta = (argc > arg + 1) ? atof(argv[arg + 1]) : 6;
+
+	double center = (taps - 1) / 2.0;
+	for(uint16_t k = 0; k < taps; k++){
+		double m = k - center;
+		double h;
+		switch(band){
+		case LOWPASS:
+			h = sinc_lowpass(f1, m);
+			break;
+		case HIGHPASS:
+			h = ((m == 0) ? 1 : 0) - sinc_lowpass(f1, m);
+			break;
+		case BANDPASS:
+			h = sinc_lowpass(f2, m) - sinc_lowpass(f1, m);
+			break;
+		default:
+			h = ((m == 0) ? 1 : 0) - sinc_lowpass(f2, m) + sinc_lowpass(f1, m);
+			break;
+		}
+		double w, x = 2 * M_PI * k / (taps - 1);
+		if(strcmp(window, "blackman") == 0){
+			w = 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x);
+		}else if(strcmp(window, "kaiser") == 0){
+			double r = m / center;
+			w = bessel_i0(beta * sqrt(1 - r * r)) / bessel_i0(beta);
+		}else{
+			w = 0.54 - 0.46 * cos(x);
+		}
+		fir[k] = h * w;
+	}
+	/* unity gain in the pass band */
+	double pass = (band == LOWPASS) || (band == BANDSTOP) ? 0 : (band == HIGHPASS) ? 0.5 : (f1 + f2) / 2;
+	double gain = fir_response(taps, pass);
+	double abs_sum = 0;
+	for(uint16_t k = 0; k < taps; k++){
+		fir[k] /= gain;
+		abs_sum += fabs(fir[k]);
+		/* Q15 and Q31 can not hold 1.0 */
+		fir_q15[k] = lrint(fmax(fmin(fir[k] * 32768, 32767), -32768));
+		fir_q31[k] = llrint(fmax(fmin(fir[k] * 2147483648.0, 2147483647.0), -2147483648.0));
+	}
+
+	printf("/* %s FIR, %d taps, fs = %g Hz, %s window */\n", argv[2], taps, fs, window);
+	printf("static const int16_t fir_coeffs_q15[%d] = {", taps);
+	for(uint16_t k = 0; k < taps; k++){
+		printf("%s%d,", (k % 12) ? " " : "\n\t", fir_q15[k]);
+	}
+	printf("\n};\n");
+	printf("static const int32_t fir_coeffs_q31[%d] = {", taps);
+	for(uint16_t k = 0; k < taps; k++){
+		printf("%s%ld,", (k % 6) ? " " : "\n\t", (long)fir_q31[k]);
+	}
+	printf("\n};\n");
+	if(abs_sum > 1){
+		printf("/* sum of |h| = %.3f > 1: outputs may saturate with full scale inputs */\n", abs_sum);
+	}
+
+	printf("\n%13s | %11s | %11s | %11s\n", "frequency", "ideal", "Q15", "Q31");
+	for(uint8_t p = 0; p < TEST_POINTS; p++){
+		double f = (0.5 * p + 0.25) / TEST_POINTS;
+		fir_q15_t q15;
+		fir_q31_t q31;
+		FirQ15Init(&q15, fir_q15, taps, fir_state, TEST_BIAS);
+		make_sine(f);
+		FirQ15Process(&q15, signal, TEST_SAMPLES);
+		double g15 = measure(f) / TEST_AMPLITUDE;
+		FirQ31Init(&q31, fir_q31, taps, fir_state, TEST_BIAS);
+		make_sine(f);
+		FirQ31Process(&q31, signal, TEST_SAMPLES);
+		double g31 = measure(f) / TEST_AMPLITUDE;
+		print_db(fs, f, fir_response(taps, f), g15, g31);
+	}
+}
+
+/* bilinear transform of a first order section, as a biquad (b2 = a2 = 0) */
+static void first_order(double k, band_t band, double *c){
+	c[0] = (band == LOWPASS) ? k / (1 + k) : 1 / (1 + k);
+	c[1] = (band == LOWPASS) ? c[0] : -c[0];
+	c[2] = 0;
+	c[3] = (k - 1) / (k + 1);
+	c[4] = 0;
+}
+
+/* RBJ audio EQ cookbook biquad */
+static void second_order(double w0, double q, band_t band, double *c){
+	double alpha = sin(w0) / (2 * q), cw = cos(w0);
+	double a0 = 1 + alpha;
+	switch(band){
+	case LOWPASS:
+		c[0] = (1 - cw) / 2; c[1] = 1 - cw; c[2] = (1 - cw) / 2;
+		break;
+	case HIGHPASS:
+		c[0] = (1 + cw) / 2; c[1] = -(1 + cw); c[2] = (1 + cw) / 2;
+		break;
+	case BANDPASS:
+		c[0] = alpha; c[1] = 0; c[2] = -alpha;
+		break;
+	default:
+		c[0] = 1; c[1] = -2 * cw; c[2] = 1;
+		break;
+	}
+	c[3] = -2 * cw;
+	c[4] = 1 - alpha;
+	for(uint8_t i = 0; i < 5; i++){
+		c[i] /= a0;
+	}
+}
+
+static void design_biquad(int argc, char *argv[]){
+	if(argc < 6){
+		usage();
+	}
+	band_t band = parse_band(argv[2]);
+	double fs, f0;
+	if((band == LOWPASS) || (band == HIGHPASS)){
+		uint8_t order = atoi(argv[3]);
+		fs = atof(argv[4]);
+		f0 = atof(argv[5]) / fs;
+		if((order == 0) || (order > 2 * MAX_SECTIONS) || (f0 <= 0) || (f0 >= 0.5)){
+			usage();
+		}
+		/* Butterworth: pole pairs with Q = 1 / (2 cos(theta)), plus a first order section if odd */
+		sections = 0;
+		for(uint8_t k = 0; k < order / 2; k++){
+			double theta = M_PI * (2 * k + 1) / (2 * order);
+			second_order(2 * M_PI * f0, 1 / (2 * cos(theta)), band, sos[sections++]);
+		}
+		if(order % 2){
+			first_order(tan(M_PI * f0), band, sos[sections++]);
+		}
+		printf("/* %s Butterworth, order %d, fs = %g Hz, fc = %g Hz */\n", argv[2], order, fs, f0 * fs);
+	}else{
+		fs = atof(argv[3]);
+		f0 = atof(argv[4]) / fs;
+		double q = atof(argv[5]);
+		if((f0 <= 0) || (f0 >= 0.5) || (q <= 0)){
+			usage();
+		}
+		sections = 1;
+		second_order(2 * M_PI * f0, q, band, sos[0]);
+		printf("/* %s, fs = %g Hz, f0 = %g Hz, Q = %g */\n", argv[2], fs, f0 * fs, q);
+	}
+
+	printf("static const biquad_coeffs_t biquad_coeffs[%d] = {\n", sections);
+	for(uint8_t s = 0; s < sections; s++){
+		int32_t *q30 = &sos_q30[s].b0;
+		printf("\t{");
+		for(uint8_t i = 0; i < 5; i++){
+			q30[i] = lrint(sos[s][i] * (1 << 30));
+			printf("%ld%s", (long)q30[i], (i < 4) ? ", " : "},\n");
+		}
+	}
+	printf("};\n");
+
+	printf("\n%13s | %11s | %11s\n", "frequency", "ideal", "Q30");
+	for(uint8_t p = 0; p < TEST_POINTS; p++){
+		double f = (0.5 * p + 0.25) / TEST_POINTS;
+		biquad_t biquad;
+		BiquadInit(&biquad, sos_q30, sos_state, sections, TEST_BIAS);
+		make_sine(f);
+		BiquadProcess(&biquad, signal, TEST_SAMPLES);
+		print_db(fs, f, sos_response(f), measure(f) / TEST_AMPLITUDE, -1);
+	}
+}
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	if(argc < 2){
+		usage();
+	}
+	if(strcmp(argv[1], "fir") == 0){
+		design_fir(argc, argv);
+	}else if(strcmp(argv[1], "biquad") == 0){
+		design_biquad(argc, argv);
+	}else{
+		usage();
+	}
+	return 0;
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,15 @@
+/**
+ * @file esp_err.h
+ * @brief Host stub: ESP-IDF error codes
+ */
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK				0
+#define ESP_FAIL			-1
+#define ESP_ERR_TIMEOUT		0x107
+
+#endif /* ESP_ERR_H */
@@ -0,0 +1,14 @@
+/**
+ * @file esp_log.h
+ * @brief Host stub: ESP-IDF logging, kept by the simulation to be checked (see idf_sim.h)
+ */
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+void SimLog(char level, const char *tag, const char *format, ...);
+
+#define ESP_LOGE(tag, ...)	SimLog('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...)	SimLog('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...)	SimLog('I', tag, __VA_ARGS__)
+
+#endif /* ESP_LOG_H */
@@ -0,0 +1,11 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stub: ESP-IDF microseconds time (see idf_sim.h)
+ */
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif /* ESP_TIMER_H */
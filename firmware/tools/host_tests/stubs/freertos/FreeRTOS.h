@@ -0,0 +1,24 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stub: the FreeRTOS types and macros used by the drivers (see idf_sim.h)
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdTRUE				1
+#define pdFALSE				0
+#define pdPASS				pdTRUE
+#define pdFAIL				pdFALSE
+#define errQUEUE_FULL		0
+#define portMAX_DELAY		((TickType_t)0xffffffff)
+#define portTICK_PERIOD_MS	1
+#define pdMS_TO_TICKS(ms)	((TickType_t)(ms))
+
+#endif /* FREERTOS_H */
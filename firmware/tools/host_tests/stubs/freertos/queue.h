@@ -0,0 +1,17 @@
+/**
+ * @file queue.h
+ * @brief Host stub: FreeRTOS queues (see idf_sim.h)
+ */
+#ifndef QUEUE_H
+#define QUEUE_H
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif /* QUEUE_H */
@@ -0,0 +1,16 @@
+/**
+ * @file semphr.h
+ * @brief Host stub: FreeRTOS semaphores, queues of no items (see idf_sim.h)
+ */
+#ifndef SEMPHR_H
+#define SEMPHR_H
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+#endif /* SEMPHR_H */
@@ -0,0 +1,17 @@
+/**
+ * @file task.h
+ * @brief Host stub: FreeRTOS tasks (see idf_sim.h)
+ */
+#ifndef TASK_H
+#define TASK_H
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *param);
+
+BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *param,
+	UBaseType_t priority, TaskHandle_t *handle);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+
+#endif /* TASK_H */
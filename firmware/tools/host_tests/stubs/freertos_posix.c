@@ -0,0 +1,66 @@
+/**
+ * @file freertos_posix.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief FreeRTOS task and ESP-IDF timer functions on POSIX threads, for the tests of lock-free
+ * code that must run on real concurrent tasks (idf_sim.c runs them one at a time): each task is
+ * a thread, delays sleep and the time is the monotonic clock since the start.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <time.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data definition]===============================*/
+static int64_t posix_start_us = -1;
+
+/*==================[internal functions definition]==========================*/
+static int64_t posix_now_us(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/*==================[external functions definition]==========================*/
+BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *param,
+	UBaseType_t priority, TaskHandle_t *handle){
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, (void *(*)(void *))func, param) != 0){
+		return pdFAIL;
+	}
+	pthread_detach(thread);
+	if(handle != NULL){
+		*handle = NULL;
+	}
+	return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks){
+	struct timespec delay = {.tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L};
+	nanosleep(&delay, NULL);
+}
+
+TickType_t xTaskGetTickCount(void){
+	return esp_timer_get_time() / 1000;
+}
+
+int64_t esp_timer_get_time(void){
+	int64_t start = __atomic_load_n(&posix_start_us, __ATOMIC_RELAXED);
+	if(start < 0){
+		int64_t expected = -1;
+		start = posix_now_us();
+		if(!__atomic_compare_exchange_n(&posix_start_us, &expected, start, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+			start = expected;
+		}
+	}
+	return posix_now_us() - start;
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,498 @@
+/**
+ * @file idf_sim.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Deterministic simulation of the ESP-IDF and FreeRTOS functions used by the drivers
+ * (see idf_sim.h)
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "idf_sim.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define SIM_TASKS			8
+#define SIM_LOG_LEN			256
+#define SIM_TX_HEADER		8		/*!< Header of each item of the transmit ring buffer (NOSPLIT) */
+#define SIM_TX_EVENT_LEN	12		/*!< uart_tx_data_t item that starts each uart_write_bytes() */
+
+/**
+ * @brief Queue (semaphores are queues of items of size 0, only their count is used)
+ */
+struct sim_queue {
+	uint8_t *items;
+	uint32_t item_size;
+	uint32_t length;
+	uint32_t first;
+	uint32_t count;
+};
+
+/**
+ * @brief Task created by xTaskCreate()
+ */
+struct sim_task {
+	TaskFunction_t func;
+	void *param;
+};
+
+/**
+ * @brief Item of the transmit ring buffer
+ */
+typedef struct {
+	uint32_t start;				/*!< Ring offset of the item */
+	uint32_t end;				/*!< Ring offset after the item (header, data and alignment) */
+	uint32_t data;				/*!< Data bytes not sent yet (0: uart_tx_data_t item) */
+} sim_item_t;
+
+/**
+ * @brief UART driver of a port
+ */
+typedef struct {
+	bool installed;
+	uint8_t *rx;				/*!< Receive buffer, rx_count bytes from rx[0] */
+	uint32_t rx_size;
+	uint32_t rx_count;
+	uint8_t *tx;				/*!< Data of the transmit ring buffer items, tx_count bytes from tx[0] */
+	uint32_t tx_size;
+	uint32_t tx_count;
+	sim_item_t *items;			/*!< Items of the transmit ring buffer, item_count from items[item_first] */
+	uint32_t item_max;
+	uint32_t item_first;
+	uint32_t item_count;
+	uint32_t ring_read;			/*!< Ring offset of the oldest item (free space ends there) */
+	uint32_t ring_write;		/*!< Ring offset after the newest item */
+	uint32_t tx_waits;			/*!< Writes that waited for room */
+	QueueHandle_t queue;
+	bool pattern_on;
+	char pattern;
+	uint32_t baud_rate;
+	uint8_t line[SIM_LINE_CAPTURE];
+	uint32_t line_count;
+} sim_uart_t;
+
+/*==================[internal data definition]===============================*/
+static int64_t sim_time_us;
+static struct sim_task sim_tasks[SIM_TASKS];
+static uint32_t sim_task_count;
+static bool sim_in_task;
+static jmp_buf sim_block;
+static sim_uart_t sim_uart[UART_NUM_MAX];
+static uint32_t sim_log_count[128];
+static char sim_last_log[SIM_LOG_LEN];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief A task waits for something that only another task or the test can give: it is left
+ * (it starts again from the top on the next SimRunTasks()). From the test, it is a bug.
+ */
+static void sim_block_task(const char *what){
+	if(sim_in_task){
+		longjmp(sim_block, 1);
+	}
+	fprintf(stderr, "idf_sim: %s would block forever\n", what);
+	abort();
+}
+
+static void sim_uart_send(sim_uart_t *uart, uint32_t n){
+	if(n > uart->tx_count){
+		n = uart->tx_count;
+	}
+	for(uint32_t i = 0; i < n; i++, uart->line_count++){
+		if(uart->line_count < SIM_LINE_CAPTURE){
+			uart->line[uart->line_count] = uart->tx[i];
+		}
+	}
+	memmove(uart->tx, uart->tx + n, uart->tx_count - n);
+	uart->tx_count -= n;
+	/* the interrupt returns each item when all its data is in the FIFO (uart_tx_data_t at once) */
+	while(uart->item_count > 0){
+		sim_item_t *item = &uart->items[uart->item_first];
+		uint32_t taken = (n < item->data) ? n : item->data;
+		item->data -= taken;
+		n -= taken;
+		if(item->data > 0){
+			break;
+		}
+		uart->item_first = (uart->item_first + 1) % uart->item_max;
+		uart->item_count--;
+		/* the space left at the end by an item that wrapped is free again with the item before it */
+		uart->ring_read = uart->item_count ? uart->items[uart->item_first].start : item->end;
+	}
+}
+
+/**
+ * @brief Stores an item where xRingbufferSend() of a NOSPLIT ring buffer would: after the
+ * newest one, or at the start of the buffer if it does not fit before the end
+ * @return bool false if there is no room for it now
+ */
+static bool sim_tx_place(sim_uart_t *uart, uint32_t len, bool event){
+	uint32_t size = SIM_TX_HEADER + ((len + 3) & ~3u);
+	uint32_t start;
+	if((uart->item_count == 0) || (uart->ring_write > uart->ring_read)){
+		if(size <= uart->tx_size - uart->ring_write){
+			start = uart->ring_write;
+		}else if(size <= uart->ring_read){
+			start = 0;
+		}else{
+			return false;
+		}
+	}else if(size <= uart->ring_read - uart->ring_write){
+		start = uart->ring_write;
+	}else{
+		return false;
+	}
+	sim_item_t *item = &uart->items[(uart->item_first + uart->item_count++) % uart->item_max];
+	item->start = start;
+	item->end = start + size;
+	item->data = event ? 0 : len;
+	if(uart->item_count == 1){
+		uart->ring_read = start;
+	}
+	uart->ring_write = item->end;
+	return true;
+}
+
+/**
+ * @brief xRingbufferSend(..., portMAX_DELAY): the line drains until the item fits
+ * @return bool true if it had to wait
+ */
+static bool sim_tx_put(sim_uart_t *uart, const uint8_t *data, uint32_t len){
+	bool waited = false;
+	while(!sim_tx_place(uart, len, data == NULL)){
+		waited = true;
+		sim_uart_send(uart, 1);
+	}
+	if(data != NULL){
+		memcpy(uart->tx + uart->tx_count, data, len);
+		uart->tx_count += len;
+	}
+	return waited;
+}
+
+/*==================[external functions definition]==========================*/
+/* ------------------------------ simulation ------------------------------ */
+void SimReset(void){
+	for(int i = 0; i < UART_NUM_MAX; i++){
+		free(sim_uart[i].rx);
+		free(sim_uart[i].tx);
+		free(sim_uart[i].items);
+		memset(&sim_uart[i], 0, sizeof(sim_uart_t));
+	}
+	sim_task_count = 0;
+}
+
+void SimRunTasks(void){
+	for(uint32_t i = 0; i < sim_task_count; i++){
+		sim_in_task = true;
+		if(setjmp(sim_block) == 0){
+			sim_tasks[i].func(sim_tasks[i].param);
+		}
+		sim_in_task = false;
+	}
+}
+
+void SimAdvanceMs(uint32_t ms){
+	sim_time_us += (int64_t)ms * 1000;
+	for(int i = 0; i < UART_NUM_MAX; i++){
+		if(sim_uart[i].installed){
+			/* 10 bits per byte (8N1) */
+			sim_uart_send(&sim_uart[i], (uint64_t)sim_uart[i].baud_rate * ms / 10000);
+		}
+	}
+}
+
+uint32_t SimUartReceive(uart_port_t uart_num, const void *data, uint32_t n){
+	sim_uart_t *uart = &sim_uart[uart_num];
+	uint32_t kept = uart->rx_size - uart->rx_count;
+	kept = (n < kept) ? n : kept;
+	memcpy(uart->rx + uart->rx_count, data, kept);
+	uart->rx_count += kept;
+	if(kept){
+		SimUartEvent(uart_num, UART_DATA);
+		if(uart->pattern_on && memchr(data, uart->pattern, kept)){
+			SimUartEvent(uart_num, UART_PATTERN_DET);
+		}
+	}
+	if(kept < n){
+		SimUartEvent(uart_num, UART_BUFFER_FULL);
+	}
+	return kept;
+}
+
+bool SimUartEvent(uart_port_t uart_num, uart_event_type_t type){
+	uart_event_t event = {.type = type, .size = sim_uart[uart_num].rx_count};
+	if(sim_uart[uart_num].queue == NULL){
+		return false;
+	}
+	return xQueueSend(sim_uart[uart_num].queue, &event, 0) == pdTRUE;
+}
+
+uint32_t SimUartBuffered(uart_port_t uart_num){
+	return sim_uart[uart_num].rx_count;
+}
+
+uint32_t SimUartSend(uart_port_t uart_num, uint32_t n){
+	uint32_t before = sim_uart[uart_num].tx_count;
+	sim_uart_send(&sim_uart[uart_num], n);
+	return before - sim_uart[uart_num].tx_count;
+}
+
+uint32_t SimUartTxPending(uart_port_t uart_num){
+	return sim_uart[uart_num].tx_count;
+}
+
+uint32_t SimUartTxWaits(uart_port_t uart_num){
+	return sim_uart[uart_num].tx_waits;
+}
+
+uint32_t SimUartLine(uart_port_t uart_num, const uint8_t **data){
+	*data = sim_uart[uart_num].line;
+	return sim_uart[uart_num].line_count;
+}
+
+uint32_t SimLogCount(char level){
+	return sim_log_count[level & 0x7f];
+}
+
+const char *SimLastLog(void){
+	return sim_last_log;
+}
+
+void SimLog(char level, const char *tag, const char *format, ...){
+	va_list args;
+	int len = snprintf(sim_last_log, SIM_LOG_LEN, "%c (%s): ", level, tag);
+	va_start(args, format);
+	vsnprintf(sim_last_log + len, SIM_LOG_LEN - len, format, args);
+	va_end(args);
+	sim_log_count[level & 0x7f]++;
+}
+
+/* ------------------------------- FreeRTOS ------------------------------- */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size){
+	QueueHandle_t queue = calloc(1, sizeof(struct sim_queue));
+	queue->items = calloc(length, item_size ? item_size : 1);
+	queue->item_size = item_size;
+	queue->length = length;
+	return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks){
+	if(queue->count == queue->length){
+		return errQUEUE_FULL;
+	}
+	uint32_t pos = (queue->first + queue->count) % queue->length;
+	memcpy(queue->items + pos * queue->item_size, item, queue->item_size);
+	queue->count++;
+	return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks){
+	if(queue->count == 0){
+		if(ticks == portMAX_DELAY){
+			sim_block_task("xQueueReceive()");
+		}
+		SimAdvanceMs(ticks);
+		return pdFALSE;
+	}
+	memcpy(item, queue->items + queue->first * queue->item_size, queue->item_size);
+	queue->first = (queue->first + 1) % queue->length;
+	queue->count--;
+	return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue){
+	return queue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue){
+	if(queue != NULL){
+		queue->first = 0;
+		queue->count = 0;
+	}
+	return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void){
+	SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+	mutex->count = 1;
+	return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void){
+	return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks){
+	if(semaphore->count == 0){
+		if(ticks == portMAX_DELAY){
+			sim_block_task("xSemaphoreTake()");
+		}
+		SimAdvanceMs(ticks);
+		return pdFALSE;
+	}
+	semaphore->count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore){
+	if(semaphore->count == semaphore->length){
+		return pdFALSE;
+	}
+	semaphore->count++;
+	return pdTRUE;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *param,
+	UBaseType_t priority, TaskHandle_t *handle){
+	if(sim_task_count == SIM_TASKS){
+		return pdFAIL;
+	}
+	sim_tasks[sim_task_count] = (struct sim_task){.func = func, .param = param};
+	if(handle != NULL){
+		*handle = &sim_tasks[sim_task_count];
+	}
+	sim_task_count++;
+	return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks){
+	if(sim_in_task){
+		sim_block_task("vTaskDelay()");
+	}
+	SimAdvanceMs(ticks);
+}
+
+TickType_t xTaskGetTickCount(void){
+	return sim_time_us / 1000;
+}
+
+int64_t esp_timer_get_time(void){
+	return sim_time_us;
+}
+
+/* ------------------------------ UART driver ----------------------------- */
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+	QueueHandle_t *queue, int intr_flags){
+	sim_uart_t *uart = &sim_uart[uart_num];
+	if(uart->installed){
+		return ESP_FAIL;
+	}
+	uart->rx = malloc(rx_buffer_size);
+	uart->rx_size = rx_buffer_size;
+	uart->tx = malloc(tx_buffer_size);
+	uart->tx_size = tx_buffer_size;
+	/* the smallest item takes a header and 4 bytes */
+	uart->item_max = tx_buffer_size / (SIM_TX_HEADER + 4) + 1;
+	uart->items = malloc(uart->item_max * sizeof(sim_item_t));
+	if(queue != NULL){
+		uart->queue = xQueueCreate(queue_size, sizeof(uart_event_t));
+		*queue = uart->queue;
+	}
+	uart->installed = true;
+	return ESP_OK;
+}
+
+bool uart_is_driver_installed(uart_port_t uart_num){
+	return sim_uart[uart_num].installed;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *config){
+	sim_uart[uart_num].baud_rate = config->baud_rate;
+	return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx, int rx, int rts, int cts){
+	return ESP_OK;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t uart_num, uint8_t threshold){
+	return ESP_OK;
+}
+
+esp_err_t uart_set_rx_full_threshold(uart_port_t uart_num, int threshold){
+	return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks){
+	sim_uart_t *uart = &sim_uart[uart_num];
+	if(length > uart->rx_count){
+		length = uart->rx_count;
+	}
+	memcpy(buf, uart->rx, length);
+	memmove(uart->rx, uart->rx + length, uart->rx_count - length);
+	uart->rx_count -= length;
+	return length;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size){
+	sim_uart_t *uart = &sim_uart[uart_num];
+	const uint8_t *data = src;
+	/* as uart_tx_all(): an item with the size, then the data in items of up to half the largest
+	item (xRingbufferGetMaxItemSize() of a NOSPLIT ring buffer) */
+	uint32_t chunk = ((((uart->tx_size / 2) + 3) & ~3u) - SIM_TX_HEADER) / 2;
+	if(size == 0){
+		return 0;
+	}
+	bool waited = sim_tx_put(uart, NULL, SIM_TX_EVENT_LEN);
+	for(size_t done = 0; done < size; done += chunk){
+		waited |= sim_tx_put(uart, data + done, (size - done < chunk) ? size - done : chunk);
+	}
+	uart->tx_waits += waited;
+	return size;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks){
+	sim_uart_send(&sim_uart[uart_num], sim_uart[uart_num].tx_count);
+	return ESP_OK;
+}
+
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size){
+	/* data bytes, as the IDF driver: item headers and wasted space are not counted */
+	*size = sim_uart[uart_num].tx_size - sim_uart[uart_num].tx_count;
+	return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size){
+	*size = sim_uart[uart_num].rx_count;
+	return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num){
+	sim_uart[uart_num].rx_count = 0;
+	return ESP_OK;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t uart_num, char pattern_chr, uint8_t chr_num,
+	int chr_tout, int post_idle, int pre_idle){
+	sim_uart[uart_num].pattern_on = true;
+	sim_uart[uart_num].pattern = pattern_chr;
+	return ESP_OK;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t uart_num, int queue_length){
+	return ESP_OK;
+}
+
+int uart_pattern_pop_pos(uart_port_t uart_num){
+	/* the hardware records each position as it arrives: here it is found in the buffer */
+	sim_uart_t *uart = &sim_uart[uart_num];
+	const uint8_t *p = memchr(uart->rx, uart->pattern, uart->rx_count);
+	return (uart->pattern_on && (p != NULL)) ? p - uart->rx : -1;
+}
+
+int uart_pattern_get_pos(uart_port_t uart_num){
+	return uart_pattern_pop_pos(uart_num);
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,97 @@
+/**
+ * @file idf_sim.h
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Deterministic simulation of the ESP-IDF and FreeRTOS functions used by the drivers, so
+ * drivers/microcontroller sources compile and run on the PC unchanged:
+ * - Time only moves when the test (or a wait that would block) moves it.
+ * - Tasks run when the test calls SimRunTasks(), each one until it blocks (waits on an empty
+ *   queue or semaphore, or delays). Then it is left (longjmp) and started again from the top
+ *   the next time, which is the same for the usual "while(1){ wait; process; }" task.
+ * - The UART driver has a receive buffer fed by SimUartReceive(), which queues the events the
+ *   IDF driver would (data, buffer full, pattern detected), and a transmit buffer drained to
+ *   the "line" by SimUartSend() and by delays at the configured baud rate. The transmit buffer
+ *   is a NOSPLIT ring buffer of the items uart_write_bytes() stores (each with its header and
+ *   alignment, none split at the end), while its free size counts data bytes only: a write
+ *   without room for its items waits, and is counted by SimUartTxWaits().
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef IDF_SIM_H
+#define IDF_SIM_H
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include "driver/uart.h"
+/*==================[macros]=================================================*/
+#define SIM_LINE_CAPTURE	65536	/*!< Bytes kept of those sent on the line */
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Uninstalls the UART drivers and forgets the tasks (drivers can be initialized again)
+ */
+void SimReset(void);
+
+/**
+ * @brief Runs every task until it blocks
+ */
+void SimRunTasks(void);
+
+/**
+ * @brief Moves the time forward (transmit buffers drain at their baud rate meanwhile)
+ */
+void SimAdvanceMs(uint32_t ms);
+
+/**
+ * @brief Bytes arriving to a port: as many as fit in the driver receive buffer are kept
+ * @return uint32_t Bytes kept (the rest are lost, UART_BUFFER_FULL is queued)
+ */
+uint32_t SimUartReceive(uart_port_t uart_num, const void *data, uint32_t n);
+
+/**
+ * @brief Queues a driver event (errors, overflows) for the port event task
+ * @return bool false if the event queue is full (the event is lost, as in the IDF driver)
+ */
+bool SimUartEvent(uart_port_t uart_num, uart_event_type_t type);
+
+/**
+ * @brief Bytes in the driver receive buffer
+ */
+uint32_t SimUartBuffered(uart_port_t uart_num);
+
+/**
+ * @brief Sends up to n bytes of the transmit buffer on the line
+ * @return uint32_t Bytes sent
+ */
+uint32_t SimUartSend(uart_port_t uart_num, uint32_t n);
+
+/**
+ * @brief Bytes waiting in the transmit buffer
+ */
+uint32_t SimUartTxPending(uart_port_t uart_num);
+
+/**
+ * @brief Writes (uart_write_bytes()) that had to wait for the line to drain room for their items
+ */
+uint32_t SimUartTxWaits(uart_port_t uart_num);
+
+/**
+ * @brief Bytes sent on the line since the driver was installed (the first SIM_LINE_CAPTURE are kept)
+ */
+uint32_t SimUartLine(uart_port_t uart_num, const uint8_t **data);
+
+/**
+ * @brief Number of ESP_LOGx messages of a level ('E', 'W', 'I') since the start
+ */
+uint32_t SimLogCount(char level);
+
+/**
+ * @brief Last ESP_LOGx message
+ */
+const char *SimLastLog(void);
+
+#endif /* IDF_SIM_H */
+/*==================[end of file]============================================*/
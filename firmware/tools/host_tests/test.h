@@ -0,0 +1,74 @@
+/**
+ * @file test.h
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Checks of the host tests: a failed check is printed and the test goes on, so a run
+ * shows every failure. TEST_END() sets the exit code.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef TEST_H
+#define TEST_H
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+/*==================[macros]=================================================*/
+static unsigned test_failures;
+
+/** @brief Checks a condition */
+#define CHECK(cond) do {																	\
+	if(!(cond)){																			\
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);			\
+		test_failures++;																	\
+	}																						\
+} while(0)
+
+/** @brief Checks that |a - b| <= tol, printing both values if not */
+#define CHECK_NEAR(a, b, tol) do {															\
+	double test_a = (a), test_b = (b);														\
+	if(!(fabs(test_a - test_b) <= (tol))){													\
+		fprintf(stderr, "%s:%d: check failed: %s = %g, %s = %g (tolerance %g)\n",			\
+			__FILE__, __LINE__, #a, test_a, #b, test_b, (double)(tol));						\
+		test_failures++;																	\
+	}																						\
+} while(0)
+
+/** @brief Result of the test: return value of main() */
+#define TEST_END(name) (test_failures ? (fprintf(stderr, "%s: %u checks failed\n", (name), test_failures), 1) : \
+	(printf("%s: ok\n", (name)), 0))
+
+/*==================[external functions definition]==========================*/
+/**
+ * @brief Pseudo random numbers (xorshift32): the same sequence on every PC
+ */
+static inline uint32_t TestRandom(void){
+	static uint32_t state = 2463534242u;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/**
+ * @brief Uniform random number in [0, 1)
+ */
+static inline double TestUniform(void){
+	return (TestRandom() >> 8) * (1.0 / (1u << 24));
+}
+
+/**
+ * @brief Normal random number (mean 0, standard deviation 1)
+ */
+static inline double TestGauss(void){
+	double u = (TestRandom() >> 8) * (1.0 / (1u << 24)) + 1.0 / (1u << 25);
+	double v = TestUniform();
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+#endif /* TEST_H */
+/*==================[end of file]============================================*/
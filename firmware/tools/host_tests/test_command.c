@@ -0,0 +1,156 @@
+/**
+ * @file test_command.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of command.c: tokenizing (separators, quotes, too many arguments), command lookup,
+ * argument count checks, results of the command functions and integer arguments.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "test.h"
+#include "command.h"
+/*==================[macros and definitions]=================================*/
+#define LINE_LEN	128
+
+/*==================[internal data definition]===============================*/
+static char line[LINE_LEN];
+static uint8_t last_argc;
+static char last_argv[COMMAND_MAX_ARGS][LINE_LEN];
+static void *last_param;
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Command that keeps a copy of its arguments
+ */
+static bool cmd_echo(uint8_t argc, char *argv[], void *param){
+	last_argc = argc;
+	for(uint8_t i = 0; i < argc; i++){
+		strcpy(last_argv[i], argv[i]);
+	}
+	last_param = param;
+	return true;
+}
+
+/**
+ * @brief Command of one integer argument: fails if it is not a number
+ */
+static bool cmd_num(uint8_t argc, char *argv[], void *param){
+	int32_t val;
+	last_argc = argc;
+	return CommandArgInt(argv[1], &val);
+}
+
+static const command_t commands[] = {
+	{"echo", cmd_echo, 0, COMMAND_MAX_ARGS - 1, NULL},
+	{"num", cmd_num, 1, 1, "num <n>"},
+	{"Led", cmd_echo, 2, 2, "led <1|2|3> <on|off>"},
+};
+static int table_param;
+static const command_table_t table = {commands, sizeof(commands) / sizeof(commands[0]), &table_param};
+
+/**
+ * @brief Runs a copy of text (the line is modified)
+ */
+static command_result_t execute(const char *text){
+	strcpy(line, text);
+	last_argc = 0;
+	return CommandExecute(&table, line);
+}
+
+static void test_tokenize(void){
+	char *argv[4];
+	strcpy(line, "  ECHO a  \"b c\"\td ");
+	CHECK(CommandTokenize(line, argv, 4) == 4);
+	CHECK(!strcmp(argv[0], "ECHO") && !strcmp(argv[1], "a") && !strcmp(argv[2], "b c") && !strcmp(argv[3], "d"));
+	/* in place: the arguments point into the line */
+	CHECK((argv[0] == &line[2]) && (argv[2] == &line[11]));
+	/* quotes: empty argument, unterminated quote up to the end of the line */
+	strcpy(line, "x \"\" \"open quote y");
+	CHECK(CommandTokenize(line, argv, 4) == 3);
+	CHECK(!strcmp(argv[1], "") && !strcmp(argv[2], "open quote y"));
+	/* quotes glued to a word are part of it */
+	strcpy(line, "ab\"c d");
+	CHECK(CommandTokenize(line, argv, 4) == 2);
+	CHECK(!strcmp(argv[0], "ab\"c") && !strcmp(argv[1], "d"));
+	/* more than max arguments */
+	strcpy(line, "1 2 3 4 5");
+	CHECK(CommandTokenize(line, argv, 4) == 5);
+	strcpy(line, "1 2 3 4   ");
+	CHECK(CommandTokenize(line, argv, 4) == 4);
+	strcpy(line, " \t ");
+	CHECK(CommandTokenize(line, argv, 4) == 0);
+	line[0] = '\0';
+	CHECK(CommandTokenize(line, argv, 4) == 0);
+}
+
+static void test_execute(void){
+	CHECK(execute("  ECHO a  \"b c\"\td ") == COMMAND_OK);
+	CHECK(last_argc == 4);
+	CHECK(!strcmp(last_argv[0], "ECHO") && !strcmp(last_argv[2], "b c"));
+	CHECK(last_param == &table_param);
+	CHECK(execute("") == COMMAND_EMPTY);
+	CHECK(execute("   \t") == COMMAND_EMPTY);
+	CHECK(execute("foo 1") == COMMAND_UNKNOWN);
+	CHECK(execute("ech") == COMMAND_UNKNOWN);
+	/* case insensitive, both ways */
+	CHECK(execute("led 1 on") == COMMAND_OK);
+	CHECK(execute("LED 1 on") == COMMAND_OK);
+	CHECK(CommandFind(&table, "lEd") == &commands[2]);
+	CHECK(CommandFind(&table, "le") == NULL);
+	/* argument count: checked before the command runs */
+	CHECK(execute("led 1") == COMMAND_BAD_ARGS);
+	CHECK(execute("led 1 on now") == COMMAND_BAD_ARGS);
+	CHECK(execute("num") == COMMAND_BAD_ARGS);
+	CHECK(last_argc == 0);
+	CHECK(execute("echo 1 2 3 4 5 6 7") == COMMAND_OK);
+	CHECK(last_argc == COMMAND_MAX_ARGS);
+	CHECK(execute("echo 1 2 3 4 5 6 7 8") == COMMAND_BAD_ARGS);
+	/* the command result */
+	CHECK(execute("num -0x1F") == COMMAND_OK);
+	CHECK(execute("num 12a") == COMMAND_FAILED);
+	CHECK(last_argc == 2);
+	CHECK(!strcmp(CommandResultString(COMMAND_UNKNOWN), "unknown command"));
+	CHECK(!strcmp(CommandResultString(COMMAND_BAD_ARGS), "wrong number of arguments"));
+}
+
+static void test_arg_int(void){
+	const struct {
+		const char *arg;
+		bool valid;
+		int32_t val;
+	} cases[] = {
+		{"0", true, 0}, {"42", true, 42}, {"-42", true, -42}, {"+7", true, 7},
+		/* decimal even with a leading zero (not octal) */
+		{"010", true, 10}, {"-0010", true, -10},
+		{"0x1F", true, 31}, {"0XfF", true, 255}, {"-0x1F", true, -31}, {"0x7FFFFFFF", true, INT32_MAX},
+		{"2147483647", true, INT32_MAX}, {"-2147483648", true, INT32_MIN},
+		{"2147483648", false, 0}, {"-2147483649", false, 0}, {"99999999999", false, 0}, {"0x80000000", false, 0},
+		{"", false, 0}, {"-", false, 0}, {"0x", false, 0}, {"12a", false, 0}, {"1 2", false, 0},
+		{"+-5", false, 0}, {"0x-5", false, 0}, {"1.5", false, 0}, {" 5", false, 0}, {"5 ", false, 0},
+	};
+	for(unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+		int32_t val = 12345;
+		bool valid = CommandArgInt(cases[i].arg, &val);
+		if((valid != cases[i].valid) || (valid && (val != cases[i].val))){
+			fprintf(stderr, "CommandArgInt(\"%s\"): %d, %d\n", cases[i].arg, valid, val);
+		}
+		CHECK(valid == cases[i].valid);
+		/* the value is only written for valid arguments */
+		CHECK(val == (valid ? cases[i].val : 12345));
+	}
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_tokenize();
+	test_execute();
+	test_arg_int();
+	return TEST_END("command");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,209 @@
+/**
+ * @file test_delta_codec.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of delta_codec.c: blocks of synthetic signals (ECG, sine, steps, spikes, noise and
+ * the 16 and 32 bits extremes) decoded unchanged in every mode, whole and split in small blocks,
+ * never longer than CODEC_MAX_ENCODED(), and truncated or random blocks rejected or decoded
+ * without reading or writing past the buffers.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "delta_codec.h"
+/*==================[macros and definitions]=================================*/
+#define N			4096
+#define BLOCK_SIZE	210		/*!< Encoded block of a TELEMETRY_PACKED record */
+#define N_RANDOM	100000
+
+/*==================[internal data definition]===============================*/
+static uint16_t x[N], y[N];
+static int32_t a[N], b[N];
+static uint8_t out[CODEC_MAX_ENCODED(N) + 1];
+static const char *const mode_names[] = {"auto", "packed", "varint"};
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief x decoded unchanged in every mode, whole and in BLOCK_SIZE bytes blocks
+ *
+ * @return Bits per sample of the whole block in CODEC_AUTO
+ */
+static double round_trip_u16(const char *name){
+	uint32_t lengths[3];
+	for(codec_mode_t mode = CODEC_AUTO; mode <= CODEC_VARINT; mode++){
+		uint32_t len;
+		out[CODEC_MAX_ENCODED(N)] = 0xA5;
+		CHECK(CodecEncodeU16(x, N, mode, out, CODEC_MAX_ENCODED(N), &len) == N);
+		CHECK(len <= CODEC_MAX_ENCODED(N));
+		CHECK(out[CODEC_MAX_ENCODED(N)] == 0xA5);
+		memset(y, 0, sizeof(y));
+		CHECK(CodecDecodeU16(out, len, y, N));
+		if(memcmp(x, y, sizeof(x)) != 0){
+			fprintf(stderr, "%s, %s: decoded samples differ\n", name, mode_names[mode]);
+			test_failures++;
+		}
+		/* a block one byte shorter or longer is not valid */
+		CHECK(!CodecDecodeU16(out, len - 1, y, N));
+		CHECK(!CodecDecodeU16(out, len + 1, y, N));
+		lengths[mode] = len;
+		/* in blocks, as TelemetrySendPacked() does: whole groups in each one */
+		memset(y, 0, sizeof(y));
+		uint32_t done = 0;
+		while(done < N){
+			uint32_t block_len;
+			uint32_t count = CodecEncodeU16(&x[done], N - done, mode, out, BLOCK_SIZE, &block_len);
+			CHECK((count > 0) && (block_len <= BLOCK_SIZE));
+			CHECK((count % CODEC_GROUP == 1) || (done + count == N));
+			CHECK(CodecDecodeU16(out, block_len, &y[done], count));
+			if(count == 0){
+				break;
+			}
+			done += count;
+		}
+		if(memcmp(x, y, sizeof(x)) != 0){
+			fprintf(stderr, "%s, %s: samples decoded from blocks differ\n", name, mode_names[mode]);
+			test_failures++;
+		}
+	}
+	/* each group takes the shorter encoding */
+	CHECK(lengths[CODEC_AUTO] <= lengths[CODEC_PACKED]);
+	CHECK(lengths[CODEC_AUTO] <= lengths[CODEC_VARINT]);
+	return 8.0 * lengths[CODEC_AUTO] / N;
+}
+
+static void round_trip_i32(const char *name){
+	for(codec_mode_t mode = CODEC_AUTO; mode <= CODEC_VARINT; mode++){
+		uint32_t len;
+		CHECK(CodecEncodeI32(a, N, mode, out, CODEC_MAX_ENCODED(N), &len) == N);
+		CHECK(len <= CODEC_MAX_ENCODED(N));
+		memset(b, 0, sizeof(b));
+		CHECK(CodecDecodeI32(out, len, b, N));
+		if(memcmp(a, b, sizeof(a)) != 0){
+			fprintf(stderr, "%s, %s: decoded samples differ\n", name, mode_names[mode]);
+			test_failures++;
+		}
+	}
+}
+
+/**
+ * @brief 12 bits signals: compressed below the given bits per sample
+ */
+static void test_signals(void){
+	/* ECG at 500 Hz: baseline wander, QRS complex and T wave, with noise */
+	for(int i = 0; i < N; i++){
+		double t = i / 500.0, phase = fmod(t, 0.8);
+		x[i] = 2048 + 60 * sin(2 * M_PI * 1.2 * t) + 900 * exp(-pow((phase - 0.3) / 0.012, 2))
+			- 150 * exp(-pow((phase - 0.33) / 0.01, 2)) + 120 * exp(-pow((phase - 0.55) / 0.04, 2))
+			+ 3 * TestGauss();
+	}
+	CHECK(round_trip_u16("ecg") < 6.0);
+	/* oversampled sine: second order residuals */
+	for(int i = 0; i < N; i++){
+		x[i] = 2048 + 1500 * sin(2 * M_PI * i / 200.0);
+	}
+	CHECK(round_trip_u16("sine") < 3.0);
+	/* distance: steps */
+	for(int i = 0; i < N; i++){
+		x[i] = 1000 + (i / 300) * 137 % 800 + TestRandom() % 3;
+	}
+	CHECK(round_trip_u16("steps") < 4.0);
+	/* ramp with spikes: varint groups */
+	for(int i = 0; i < N; i++){
+		x[i] = i * 7 + ((i % 50 == 0) ? 3000 : 0);
+	}
+	CHECK(round_trip_u16("spikes") < 6.0);
+	for(int i = 0; i < N; i++){
+		x[i] = 1234;
+	}
+	CHECK(round_trip_u16("constant") < 0.6);
+	/* no correlation: at most 10 % more than the 16 bits samples */
+	for(int i = 0; i < N; i++){
+		x[i] = TestRandom() & 0xFFF;
+	}
+	CHECK(round_trip_u16("noise 12 bits") < 16.0 * 1.1);
+	for(int i = 0; i < N; i++){
+		x[i] = TestRandom();
+	}
+	CHECK(round_trip_u16("noise 16 bits") < 16.0 * 1.1);
+}
+
+/**
+ * @brief Largest differences: 16 bits full scale and 32 bits wrap around
+ */
+static void test_extremes(void){
+	for(int i = 0; i < N; i++){
+		x[i] = (i & 1) ? 0 : 0xFFFF;
+	}
+	round_trip_u16("u16 0, 65535");
+	for(int i = 0; i < N; i++){
+		a[i] = (i & 1) ? INT32_MIN : INT32_MAX - (int32_t)(TestRandom() % 5);
+	}
+	round_trip_i32("i32 min, max");
+	for(int i = 0; i < N; i++){
+		a[i] = (TestRandom() & 1) ? (int32_t)TestRandom() : (int32_t)(TestRandom() >> (TestRandom() % 32));
+	}
+	round_trip_i32("i32 random");
+}
+
+/**
+ * @brief Blocks of every length up to a few groups, and outputs too small for the first sample
+ */
+static void test_short_blocks(void){
+	for(int i = 0; i < N; i++){
+		x[i] = 2048 + 40 * TestGauss();
+	}
+	for(uint32_t n = 1; n <= 4 * CODEC_GROUP + 1; n++){
+		for(codec_mode_t mode = CODEC_AUTO; mode <= CODEC_VARINT; mode++){
+			uint32_t len;
+			CHECK(CodecEncodeU16(x, n, mode, out, sizeof(out), &len) == n);
+			CHECK(len <= CODEC_MAX_ENCODED(n));
+			memset(y, 0, sizeof(y));
+			CHECK(CodecDecodeU16(out, len, y, n));
+			CHECK(memcmp(x, y, n * sizeof(x[0])) == 0);
+			CHECK(!CodecDecodeU16(out, len - 1, y, n));
+		}
+	}
+	/* 0xFFFF: 3 bytes varint */
+	uint32_t len = 1;
+	x[0] = 0xFFFF;
+	CHECK(CodecEncodeU16(x, 1, CODEC_AUTO, out, 2, &len) == 0);
+	CHECK(CodecEncodeU16(x, 1, CODEC_AUTO, out, 3, &len) == 1);
+	CHECK(len == 3);
+}
+
+/**
+ * @brief Random blocks: decoded or rejected, never writing more than n samples
+ */
+static void test_random_blocks(void){
+	uint32_t accepted = 0;
+	for(int k = 0; k < N_RANDOM; k++){
+		uint8_t in[64];
+		uint32_t len = TestRandom() % sizeof(in);
+		uint32_t n = 1 + TestRandom() % 200;
+		for(uint32_t i = 0; i < len; i++){
+			in[i] = TestRandom();
+		}
+		b[n] = 0x5A5A5A5A;
+		accepted += CodecDecodeI32(in, len, b, n);
+		CHECK(b[n] == 0x5A5A5A5A);
+	}
+	/* almost every random block is invalid somewhere */
+	CHECK(accepted < N_RANDOM / 100);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_signals();
+	test_extremes();
+	test_short_blocks();
+	test_random_blocks();
+	return TEST_END("delta_codec");
+}
+/*==================[end of file]============================================*/
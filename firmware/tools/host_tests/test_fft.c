@@ -0,0 +1,226 @@
+/**
+ * @file test_fft.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of fft.c: the fixed point FFT of every size against a double precision DFT, the
+ * windows against their formulas, and the Welch estimator against the known power and noise
+ * density of synthetic ADC signals.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdlib.h>
+#include "test.h"
+#include "fft.h"
+/*==================[macros and definitions]=================================*/
+#define SAMPLE_FREC		1000.0
+#define N_ADC			100000
+
+/*==================[internal data definition]===============================*/
+static fft_complex_t x[FFT_MAX_POINTS];
+static double re[FFT_MAX_POINTS], im[FFT_MAX_POINTS];
+static int16_t window[FFT_MAX_POINTS], segment[FFT_MAX_POINTS];
+static fft_complex_t work[FFT_MAX_POINTS];
+static float power[FFT_MAX_POINTS / 2 + 1], psd[FFT_MAX_POINTS / 2 + 1], psd2[FFT_MAX_POINTS / 2 + 1];
+static uint16_t adc[N_ADC];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief FFT of x (loaded from re, im) against the DFT / points in double: largest and RMS error (LSB)
+ */
+static void dft_error(uint16_t points, double *max_error, double *rms_error){
+	for(uint16_t i = 0; i < points; i++){
+		x[i].re = re[i];
+		x[i].im = im[i];
+	}
+	CHECK(FftComplex(x, points));
+	*max_error = 0;
+	*rms_error = 0;
+	for(uint16_t k = 0; k < points; k++){
+		double sr = 0, si = 0;
+		for(uint16_t i = 0; i < points; i++){
+			double a = -2 * M_PI * (double)((uint32_t)k * i % points) / points;
+			sr += re[i] * cos(a) - im[i] * sin(a);
+			si += re[i] * sin(a) + im[i] * cos(a);
+		}
+		double e = hypot(x[k].re - sr / points, x[k].im - si / points);
+		*max_error = fmax(*max_error, e);
+		*rms_error += e * e;
+	}
+	*rms_error = sqrt(*rms_error / points);
+}
+
+static void test_fft(void){
+	for(uint32_t points = FFT_MIN_POINTS; points <= FFT_MAX_POINTS; points *= 2){
+		double max_error, rms_error;
+		/* random full scale inputs */
+		for(uint32_t i = 0; i < points; i++){
+			re[i] = (int16_t)TestRandom();
+			im[i] = (int16_t)TestRandom();
+		}
+		dft_error(points, &max_error, &rms_error);
+		if(max_error > 4){
+			fprintf(stderr, "%u points FFT: error %.2f LSB (rms %.2f)\n", points, max_error, rms_error);
+		}
+		/* about 1 LSB of rounding noise per bin */
+		CHECK_NEAR(max_error, 0, 4);
+		CHECK_NEAR(rms_error, 0, 1.2);
+		/* the largest inputs at DC and at the Nyquist frequency: no overflow. The unit twiddle is
+		 * 32767 (that is what keeps the butterflies in range): a gain of 1 - 2^-15 per stage */
+		uint8_t stages = 0;
+		while((1U << stages) < points){
+			stages++;
+		}
+		for(uint32_t i = 0; i < points; i++){
+			re[i] = (i % 2) ? -32768 : 32767;
+			im[i] = -32768;
+		}
+		dft_error(points, &max_error, &rms_error);
+		CHECK_NEAR(max_error, 0, 1 + stages);
+		/* a complex tone in bin 3: one bin of amplitude 16000 */
+		for(uint32_t i = 0; i < points; i++){
+			re[i] = lrint(16000 * cos(2 * M_PI * 3 * i / points));
+			im[i] = lrint(16000 * sin(2 * M_PI * 3 * i / points));
+		}
+		dft_error(points, &max_error, &rms_error);
+		CHECK_NEAR(max_error, 0, 4);
+		CHECK_NEAR(x[3].re, 16000, 4);
+		uint32_t power_q30[FFT_MIN_POINTS];
+		FftPower(x, power_q30, FFT_MIN_POINTS);
+		CHECK(power_q30[3] == (uint32_t)(x[3].re * x[3].re + x[3].im * x[3].im));
+		CHECK(power_q30[5] < 100);
+	}
+	CHECK(!FftComplex(x, 8));
+	CHECK(!FftComplex(x, 4096));
+	CHECK(!FftComplex(x, 100));
+}
+
+static void test_windows(void){
+	const double a[][4] = {
+		[FFT_WINDOW_RECTANGULAR] = {1, 0, 0, 0},
+		[FFT_WINDOW_HANN] = {0.5, 0.5, 0, 0},
+		[FFT_WINDOW_HAMMING] = {0.54, 0.46, 0, 0},
+		[FFT_WINDOW_BLACKMAN_HARRIS] = {0.35875, 0.48829, 0.14128, 0.01168},
+	};
+	const uint16_t sizes[] = {FFT_MIN_POINTS, 256, FFT_MAX_POINTS};
+	for(int w = FFT_WINDOW_RECTANGULAR; w <= FFT_WINDOW_BLACKMAN_HARRIS; w++){
+		for(unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+			uint16_t points = sizes[s];
+			CHECK(FftWindow(w, window, points));
+			double max_error = 0;
+			for(uint16_t k = 0; k < points; k++){
+				/* periodic windows (the DFT ones): w[points] would equal w[0] */
+				double t = 2 * M_PI * k / points;
+				double ref = a[w][0] - a[w][1] * cos(t) + a[w][2] * cos(2 * t) - a[w][3] * cos(3 * t);
+				max_error = fmax(max_error, fabs(window[k] - fmin(ref * 32768, 32767)));
+			}
+			/* coefficients rounded to Q15, cosines from the twiddle table */
+			CHECK_NEAR(max_error, 0, 3);
+		}
+	}
+	CHECK(!FftWindow(FFT_WINDOW_HANN, window, 100));
+	CHECK(!FftWindow(FFT_WINDOW_BLACKMAN_HARRIS + 1, window, 256));
+}
+
+/**
+ * @brief ADC signal: mid scale, sine of amplitude a counts at f Hz and gaussian noise of sigma counts
+ */
+static void adc_signal(uint8_t bits, double a, double f, double sigma){
+	for(int i = 0; i < N_ADC; i++){
+		adc[i] = lrint((1 << (bits - 1)) + a * sin(2 * M_PI * f * i / SAMPLE_FREC) + sigma * TestGauss());
+	}
+}
+
+/**
+ * @brief Welch PSD of adc[] pushed in blocks of block samples
+ */
+static uint32_t welch(uint16_t points, fft_window_t w, uint8_t bits, uint32_t block, float *out){
+	welch_t welch;
+	CHECK(FftWindow(w, window, points));
+	CHECK(WelchInit(&welch, points, window, bits, segment, work, power));
+	CHECK(!WelchGetPsd(&welch, SAMPLE_FREC, out));
+	for(uint32_t i = 0; i < N_ADC; i += block){
+		WelchPush(&welch, &adc[i], (N_ADC - i < block) ? N_ADC - i : block);
+	}
+	CHECK(WelchGetPsd(&welch, SAMPLE_FREC, out));
+	return welch.segments;
+}
+
+/**
+ * @brief Mean noise density of a PSD, away from DC and the tone at bin k_tone
+ */
+static double noise_density(const float *p, uint16_t points, int k_tone){
+	double sum = 0;
+	int bins = 0;
+	for(int k = 3; k < points / 2; k++){
+		if(abs(k - k_tone) > 4){
+			sum += p[k];
+			bins++;
+		}
+	}
+	return sum / bins;
+}
+
+static void test_welch(void){
+	const uint16_t points = 256;
+	const double a = 10000, f = 50, sigma = 400;
+	/* 16 bits samples: about 230 LSB² of noise per bin, the FFT rounding (about 1 LSB²) is negligible */
+	adc_signal(16, a, f, sigma);
+	uint32_t segments = welch(points, FFT_WINDOW_HANN, 16, 100, psd);
+	/* 50 % overlap */
+	CHECK(segments == (N_ADC - points) / (points / 2) + 1);
+	double total = 0;
+	int peak = 0;
+	for(int k = 0; k <= points / 2; k++){
+		total += psd[k] * SAMPLE_FREC / points;
+		peak = (psd[k] > psd[peak]) ? k : peak;
+	}
+	/* Parseval: power of the sine plus the noise (the window is normalized out) */
+	CHECK_NEAR(total, a * a / 2 + sigma * sigma, 0.002 * (a * a / 2 + sigma * sigma));
+	CHECK(peak == lrint(f * points / SAMPLE_FREC));
+	CHECK_NEAR(noise_density(psd, points, peak), 2 * sigma * sigma / SAMPLE_FREC, 0.1 * 2 * sigma * sigma / SAMPLE_FREC);
+
+	/* the same PSD whatever the length of the blocks pushed */
+	welch(points, FFT_WINDOW_HANN, 16, 7, psd2);
+	uint32_t mismatches = 0;
+	for(int k = 0; k <= points / 2; k++){
+		mismatches += psd[k] != psd2[k];
+	}
+	CHECK(mismatches == 0);
+
+	/* 12 bits samples of 1 count of noise (0.4 LSB² per bin): the FFT rounding lifts the noise
+	 * floor a few dB, as documented in fft.h */
+	adc_signal(12, 1000, f, 1);
+	welch(points, FFT_WINDOW_HANN, 12, 100, psd);
+	double expected = 2 * (1 + 1.0 / 12) / SAMPLE_FREC;
+	double floor_db = 10 * log10(noise_density(psd, points, peak) / expected);
+	CHECK((floor_db > 3) && (floor_db < 10));
+	/* a tone between bins: 5 bins away, Hann still leaks about -60 dB, Blackman-Harris is down
+	 * at the FFT rounding floor (about -70 dB at this amplitude) */
+	adc_signal(16, 20000, 51.3, 0);
+	peak = lrint(51.3 * points / SAMPLE_FREC);
+	welch(points, FFT_WINDOW_HANN, 16, 100, psd);
+	CHECK(10 * log10(psd[peak + 5] / psd[peak]) > -62);
+	CHECK(10 * log10(psd[peak - 5] / psd[peak]) > -62);
+	welch(points, FFT_WINDOW_BLACKMAN_HARRIS, 16, 100, psd);
+	CHECK(10 * log10(psd[peak + 5] / psd[peak]) < -66);
+	CHECK(10 * log10(psd[peak - 5] / psd[peak]) < -66);
+
+	welch_t welch;
+	CHECK(!WelchInit(&welch, 100, window, 12, segment, work, power));
+	CHECK(!WelchInit(&welch, points, window, 17, segment, work, power));
+	CHECK(!WelchInit(&welch, points, NULL, 12, segment, work, power));
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_fft();
+	test_windows();
+	test_welch();
+	return TEST_END("fft");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,315 @@
+/**
+ * @file test_filter.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of filter.c against direct (double or 64 bits) implementations of each filter:
+ * FIR Q15 and Q31, biquad cascade, moving average and CIC decimator. Every filter is also run
+ * in blocks of odd lengths, which must give the same output as the whole signal at once.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "test.h"
+#include "filter.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	6000
+#define BLOCK		37			/* length of the blocks the signal is split in */
+#define FIR_TAPS	31
+
+/*==================[internal data definition]===============================*/
+static uint16_t input[N_SAMPLES];
+static uint16_t whole[N_SAMPLES];
+static uint16_t split[N_SAMPLES];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Random samples of bits bits
+ */
+static void random_input(uint8_t bits){
+	for(int i = 0; i < N_SAMPLES; i++){
+		input[i] = TestRandom() >> (32 - bits);
+	}
+	memcpy(whole, input, sizeof(input));
+	memcpy(split, input, sizeof(input));
+}
+
+static double clamp_u16(double value){
+	return (value < 0) ? 0 : (value > 65535) ? 65535 : value;
+}
+
+/**
+ * @brief Low pass FIR (windowed sinc, cut off at fc cycles per sample), scaled to a DC gain of one
+ */
+static void lowpass(double *h, int taps, double fc){
+	double sum = 0;
+	for(int k = 0; k < taps; k++){
+		double m = k - (taps - 1) / 2.0;
+		double sinc = (m == 0) ? 2 * fc : sin(2 * M_PI * fc * m) / (M_PI * m);
+		h[k] = sinc * (0.54 - 0.46 * cos(2 * M_PI * k / (taps - 1)));
+		sum += h[k];
+	}
+	for(int k = 0; k < taps; k++){
+		h[k] /= sum;
+	}
+}
+
+static void test_fir_q15(void){
+	double hd[FIR_TAPS];
+	int16_t h[FIR_TAPS];
+	int16_t state_whole[2 * FIR_TAPS], state_split[2 * FIR_TAPS];
+	fir_q15_t fir_whole, fir_split;
+	lowpass(hd, FIR_TAPS, 0.1);
+	for(int k = 0; k < FIR_TAPS; k++){
+		h[k] = lround(hd[k] * 32768);
+	}
+	random_input(12);
+	CHECK(FirQ15Init(&fir_whole, h, FIR_TAPS, state_whole, 2048));
+	CHECK(FirQ15Init(&fir_split, h, FIR_TAPS, state_split, 2048));
+	FirQ15Process(&fir_whole, whole, N_SAMPLES);
+	for(int i = 0; i < N_SAMPLES; i += BLOCK){
+		FirQ15Process(&fir_split, &split[i], (N_SAMPLES - i < BLOCK) ? N_SAMPLES - i : BLOCK);
+	}
+	double max_error = 0;
+	for(int i = 0; i < N_SAMPLES; i++){
+		double y = 0;
+		for(int k = 0; (k < FIR_TAPS) && (k <= i); k++){
+			y += h[k] / 32768.0 * ((int)input[i - k] - 2048);
+		}
+		max_error = fmax(max_error, fabs(whole[i] - clamp_u16(y + 2048)));
+		CHECK(whole[i] == split[i]);
+	}
+	/* rounded to the nearest integer */
+	CHECK_NEAR(max_error, 0, 0.5 + 1e-9);
+	/* DC: a constant input comes out unchanged after the delay line is filled */
+	for(int i = 0; i < N_SAMPLES; i++){
+		whole[i] = 3000;
+	}
+	CHECK(FirQ15Init(&fir_whole, h, FIR_TAPS, state_whole, 2048));
+	FirQ15Process(&fir_whole, whole, N_SAMPLES);
+	CHECK_NEAR(whole[N_SAMPLES - 1], 3000, 1);
+	/* gain of two: saturated at both ends of the range */
+	const int16_t gain[2] = {32767, 32767};
+	int16_t state[4];
+	uint16_t extremes[4] = {0, 0, 65535, 65535};
+	CHECK(FirQ15Init(&fir_whole, gain, 2, state, 32768));
+	FirQ15Process(&fir_whole, extremes, 4);
+	CHECK(extremes[0] == 1);			/* gain 32767 / 32768: not saturated */
+	CHECK(extremes[1] == 0);
+	CHECK(extremes[2] == 32767);
+	CHECK(extremes[3] == 65535);
+	CHECK(!FirQ15Init(&fir_whole, h, 0, state_whole, 2048));
+	CHECK(!FirQ15Init(&fir_whole, NULL, FIR_TAPS, state_whole, 2048));
+}
+
+static void test_fir_q31(void){
+	double hd[FIR_TAPS];
+	int32_t h[FIR_TAPS];
+	int16_t state_whole[2 * FIR_TAPS], state_split[2 * FIR_TAPS];
+	fir_q31_t fir_whole, fir_split;
+	lowpass(hd, FIR_TAPS, 0.02);
+	for(int k = 0; k < FIR_TAPS; k++){
+		h[k] = lround(hd[k] * 2147483648.0);
+	}
+	random_input(16);
+	CHECK(FirQ31Init(&fir_whole, h, FIR_TAPS, state_whole, 32768));
+	CHECK(FirQ31Init(&fir_split, h, FIR_TAPS, state_split, 32768));
+	FirQ31Process(&fir_whole, whole, N_SAMPLES);
+	for(int i = 0; i < N_SAMPLES; i += BLOCK){
+		FirQ31Process(&fir_split, &split[i], (N_SAMPLES - i < BLOCK) ? N_SAMPLES - i : BLOCK);
+	}
+	double max_error = 0;
+	for(int i = 0; i < N_SAMPLES; i++){
+		double y = 0;
+		for(int k = 0; (k < FIR_TAPS) && (k <= i); k++){
+			y += h[k] / 2147483648.0 * ((int)input[i - k] - 32768);
+		}
+		max_error = fmax(max_error, fabs(whole[i] - clamp_u16(y + 32768)));
+		CHECK(whole[i] == split[i]);
+	}
+	CHECK_NEAR(max_error, 0, 0.5 + 1e-9);
+}
+
+/**
+ * @brief Second order Butterworth low pass section (bilinear transform) in Q30
+ */
+static biquad_coeffs_t butterworth(double fc, double q){
+	double k = tan(M_PI * fc);
+	double norm = 1 / (1 + k / q + k * k);
+	double scale = 1 << 30;
+	biquad_coeffs_t c = {
+		.b0 = lround(k * k * norm * scale),
+		.b1 = lround(2 * k * k * norm * scale),
+		.b2 = lround(k * k * norm * scale),
+		.a1 = lround(2 * (k * k - 1) * norm * scale),
+		.a2 = lround((1 - k / q + k * k) * norm * scale),
+	};
+	return c;
+}
+
+static void test_biquad(void){
+	/* fourth order Butterworth: two sections */
+	const biquad_coeffs_t c[2] = {butterworth(0.05, 0.5412), butterworth(0.05, 1.3066)};
+	biquad_state_t state_whole[2], state_split[2];
+	biquad_t bq_whole, bq_split;
+	random_input(12);
+	CHECK(BiquadInit(&bq_whole, c, state_whole, 2, 2048));
+	CHECK(BiquadInit(&bq_split, c, state_split, 2, 2048));
+	BiquadProcess(&bq_whole, whole, N_SAMPLES);
+	for(int i = 0; i < N_SAMPLES; i += BLOCK){
+		BiquadProcess(&bq_split, &split[i], (N_SAMPLES - i < BLOCK) ? N_SAMPLES - i : BLOCK);
+	}
+	/* reference: the same (quantized) coefficients in double precision */
+	double st[2][4] = {{0}};
+	double max_error = 0;
+	for(int i = 0; i < N_SAMPLES; i++){
+		double x = (int)input[i] - 2048;
+		for(int s = 0; s < 2; s++){
+			double y = (c[s].b0 * x + c[s].b1 * st[s][0] + c[s].b2 * st[s][1] - c[s].a1 * st[s][2] - c[s].a2 * st[s][3]) / (1 << 30);
+			st[s][1] = st[s][0];
+			st[s][0] = x;
+			st[s][3] = st[s][2];
+			st[s][2] = y;
+			x = y;
+		}
+		max_error = fmax(max_error, fabs(whole[i] - clamp_u16(x + 2048)));
+		CHECK(whole[i] == split[i]);
+	}
+	/* rounding of the intermediate samples to BIQUAD_FRAC_BITS: well below one code */
+	CHECK_NEAR(max_error, 0, 1);
+	/* unit DC gain */
+	for(int i = 0; i < N_SAMPLES; i++){
+		whole[i] = 4000;
+	}
+	CHECK(BiquadInit(&bq_whole, c, state_whole, 2, 2048));
+	BiquadProcess(&bq_whole, whole, N_SAMPLES);
+	CHECK_NEAR(whole[N_SAMPLES - 1], 4000, 1);
+	CHECK(!BiquadInit(&bq_whole, c, state_whole, 0, 2048));
+}
+
+static void test_moving_average(void){
+	static uint16_t history_whole[1000], history_split[1000];
+	const uint16_t lengths[] = {1, 2, 3, 10, 64, 100, 255};
+	const uint8_t bits[] = {12, 16};
+	for(unsigned b = 0; b < sizeof(bits); b++){
+		for(unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++){
+			uint16_t len = lengths[l];
+			moving_average_t ma_whole, ma_split;
+			random_input(bits[b]);
+			CHECK(MovingAverageInit(&ma_whole, history_whole, len));
+			CHECK(MovingAverageInit(&ma_split, history_split, len));
+			MovingAverageProcess(&ma_whole, whole, N_SAMPLES);
+			for(int i = 0; i < N_SAMPLES; i += BLOCK){
+				MovingAverageProcess(&ma_split, &split[i], (N_SAMPLES - i < BLOCK) ? N_SAMPLES - i : BLOCK);
+			}
+			uint32_t bad = 0;
+			for(int i = 0; i < N_SAMPLES; i++){
+				/* the history starts filled with the first sample, rounded to the nearest integer */
+				uint64_t sum = 0;
+				for(int k = 0; k < len; k++){
+					sum += input[(i - k < 0) ? 0 : i - k];
+				}
+				uint16_t expected = (sum + len / 2) / len;
+				bad += (whole[i] != expected) || (split[i] != expected);
+			}
+			if(bad){
+				fprintf(stderr, "moving average of %u samples of %u bits: %u wrong outputs\n", len, bits[b], bad);
+			}
+			CHECK(bad == 0);
+		}
+	}
+	/* long windows of samples near full scale: largest sums */
+	static uint16_t history_long[65535];
+	const uint16_t long_lengths[] = {1000, 4000, 65535};
+	for(unsigned l = 0; l < sizeof(long_lengths) / sizeof(long_lengths[0]); l++){
+		uint16_t len = long_lengths[l];
+		moving_average_t ma;
+		for(int i = 0; i < N_SAMPLES; i++){
+			input[i] = whole[i] = 65535 - (TestRandom() & 1);
+		}
+		CHECK(MovingAverageInit(&ma, history_long, len));
+		MovingAverageProcess(&ma, whole, N_SAMPLES);
+		uint64_t sum = (uint64_t)input[0] * len;
+		uint32_t bad = 0;
+		for(int i = 0; i < N_SAMPLES; i++){
+			sum += input[i] - ((i >= len) ? input[i - len] : input[0]);
+			bad += whole[i] != (sum + len / 2) / len;
+		}
+		if(bad){
+			fprintf(stderr, "moving average of %u samples: %u wrong outputs\n", len, bad);
+		}
+		CHECK(bad == 0);
+	}
+	moving_average_t ma;
+	CHECK(!MovingAverageInit(&ma, history_whole, 0));
+}
+
+static void test_cic(void){
+	const uint8_t orders[] = {1, 2, 3, 4};
+	const uint16_t decimations[] = {2, 8, 16};
+	for(unsigned o = 0; o < sizeof(orders); o++){
+		for(unsigned d = 0; d < sizeof(decimations) / sizeof(decimations[0]); d++){
+			uint8_t order = orders[o];
+			uint16_t dec = decimations[d];
+			cic_t cic_whole, cic_split;
+			random_input(16);
+			CHECK(CicInit(&cic_whole, order, dec));
+			CHECK(CicInit(&cic_split, order, dec));
+			uint32_t n_whole = CicProcess(&cic_whole, whole, N_SAMPLES);
+			uint32_t n_split = 0;
+			for(int i = 0; i < N_SAMPLES; i += BLOCK){
+				/* outputs are written at the beginning of each block */
+				uint32_t n = CicProcess(&cic_split, &split[i], (N_SAMPLES - i < BLOCK) ? N_SAMPLES - i : BLOCK);
+				memmove(&split[n_split], &split[i], n * sizeof(split[0]));
+				n_split += n;
+			}
+			CHECK(n_whole == N_SAMPLES / dec);
+			CHECK(n_split == n_whole);
+			/* reference: order cascaded moving sums of dec samples, one of every dec, over the gain */
+			static uint64_t stage[FILTER_CIC_MAX_ORDER + 1][N_SAMPLES];
+			for(int i = 0; i < N_SAMPLES; i++){
+				stage[0][i] = input[i];
+			}
+			for(int s = 1; s <= order; s++){
+				uint64_t sum = 0;
+				for(int i = 0; i < N_SAMPLES; i++){
+					sum += stage[s - 1][i] - ((i >= dec) ? stage[s - 1][i - dec] : 0);
+					stage[s][i] = sum;
+				}
+			}
+			uint32_t bad = 0;
+			for(uint32_t m = 0; m < n_whole; m++){
+				uint16_t expected = stage[order][(m + 1) * dec - 1] / (uint64_t)pow(dec, order);
+				bad += (whole[m] != expected) || (split[m] != expected);
+			}
+			CHECK(bad == 0);
+		}
+	}
+	/* full scale DC comes out unchanged */
+	cic_t cic;
+	for(int i = 0; i < N_SAMPLES; i++){
+		whole[i] = 65535;
+	}
+	CHECK(CicInit(&cic, 4, 16));
+	uint32_t n = CicProcess(&cic, whole, N_SAMPLES);
+	CHECK(whole[n - 1] == 65535);
+	CHECK(!CicInit(&cic, 4, 32));			/* 16 + 4 * 5 bits */
+	CHECK(!CicInit(&cic, 2, 12));
+	CHECK(!CicInit(&cic, 0, 16));
+	CHECK(!CicInit(&cic, FILTER_CIC_MAX_ORDER + 1, 2));
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_fir_q15();
+	test_fir_q31();
+	test_biquad();
+	test_moving_average();
+	test_cic();
+	return TEST_END("filter");
+}
+/*==================[end of file]============================================*/
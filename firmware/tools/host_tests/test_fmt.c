@@ -0,0 +1,277 @@
+/**
+ * @file test_fmt.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of fmt.c against the C library: every supported conversion, flag, width and
+ * length modifier with random arguments is compared with snprintf(), %D and %b with their
+ * definitions, and the truncated output with the prefix of the whole one for every buffer size.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "test.h"
+#include "fmt.h"
+/*==================[macros and definitions]=================================*/
+#define N_RANDOM	20000
+#define BUF_LEN		128
+
+/*==================[internal data definition]===============================*/
+static char buf[BUF_LEN], ref[BUF_LEN];
+static uint32_t mismatches;
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Random 32 bits value of random magnitude (small numbers are as likely as large ones)
+ */
+static uint32_t random_value(void){
+	return TestRandom() >> (TestRandom() % 32);
+}
+
+/**
+ * @brief Counts (and prints the first few) differences between buf and ref
+ */
+static void compare(const char *format, uint32_t len){
+	if((strcmp(buf, ref) != 0) || (len != strlen(ref))){
+		if(mismatches++ < 10){
+			fprintf(stderr, "\"%s\": \"%s\" (%u), expected \"%s\"\n", format, buf, len, ref);
+		}
+	}
+}
+
+/**
+ * @brief Random format: flags, width and, sometimes, '*' width
+ */
+static void random_spec(char *spec, const char *length, char conv, bool star){
+	char *p = spec;
+	*p++ = '%';
+	if(TestRandom() % 3 == 0){
+		*p++ = '-';
+	}
+	if(TestRandom() % 3 == 0){
+		*p++ = '0';
+	}
+	if((TestRandom() % 3 == 0) && ((conv == 'd') || (conv == 'i'))){
+		*p++ = '+';
+	}
+	if(star){
+		*p++ = '*';
+	}else if(TestRandom() % 2){
+		p += sprintf(p, "%u", TestRandom() % 25);
+	}
+	p += sprintf(p, "%s%c", length, conv);
+}
+
+static void test_integers(void){
+	const char convs[] = "diuxXo";
+	char spec[16];
+	mismatches = 0;
+	for(int n = 0; n < N_RANDOM; n++){
+		char conv = convs[TestRandom() % (sizeof(convs) - 1)];
+		bool wide = TestRandom() % 4 == 0;
+		bool star = TestRandom() % 8 == 0;
+		random_spec(spec, wide ? "ll" : "", conv, star);
+		int width = (int)(TestRandom() % 41) - 20;
+		uint32_t len;
+		if(wide){
+			long long v = ((uint64_t)random_value() << 32) | TestRandom();
+			v = (TestRandom() % 2) ? v >> (TestRandom() % 64) : v;
+			if(star){
+				len = FmtPrintf(buf, BUF_LEN, spec, width, v);
+				snprintf(ref, BUF_LEN, spec, width, v);
+			}else{
+				len = FmtPrintf(buf, BUF_LEN, spec, v);
+				snprintf(ref, BUF_LEN, spec, v);
+			}
+		}else{
+			int v = (TestRandom() % 2) ? -(int)random_value() : (int)random_value();
+			if(star){
+				len = FmtPrintf(buf, BUF_LEN, spec, width, v);
+				snprintf(ref, BUF_LEN, spec, width, v);
+			}else{
+				len = FmtPrintf(buf, BUF_LEN, spec, v);
+				snprintf(ref, BUF_LEN, spec, v);
+			}
+		}
+		compare(spec, len);
+	}
+	/* 'l' and 'h' are ignored (int is 32 bits in the firmware) */
+	FmtPrintf(buf, BUF_LEN, "%ld %hu %lx %hhd", -5, 7u, 0xabcu, 300);
+	strcpy(ref, "-5 7 abc 300");
+	compare("%ld", strlen(buf));
+	/* the limits */
+	FmtPrintf(buf, BUF_LEN, "%d %u %x %lld %llu", INT32_MIN, UINT32_MAX, UINT32_MAX, INT64_MIN, UINT64_MAX);
+	snprintf(ref, BUF_LEN, "%d %u %x %lld %llu", INT32_MIN, UINT32_MAX, UINT32_MAX, (long long)INT64_MIN, (unsigned long long)UINT64_MAX);
+	compare("limits", strlen(buf));
+	CHECK(mismatches == 0);
+}
+
+static void test_text(void){
+	const char *words[] = {"", "a", "ESP-EDU", "una cadena bastante larga"};
+	char spec[16];
+	mismatches = 0;
+	for(int n = 0; n < N_RANDOM / 10; n++){
+		const char *s = words[TestRandom() % 4];
+		char *p = spec;
+		*p++ = '%';
+		if(TestRandom() % 2){
+			*p++ = '-';
+		}
+		if(TestRandom() % 2){
+			p += sprintf(p, "%u", TestRandom() % 30);
+		}
+		if(TestRandom() % 2){
+			p += sprintf(p, ".%u", TestRandom() % 10);
+		}
+		strcpy(p, (n % 2) ? "s" : "c");
+		uint32_t len;
+		if(n % 2){
+			len = FmtPrintf(buf, BUF_LEN, spec, s);
+			snprintf(ref, BUF_LEN, spec, s);
+		}else{
+			/* precision means nothing for %c */
+			strcpy(strchr(spec, '.') ? strchr(spec, '.') : p, "c");
+			len = FmtPrintf(buf, BUF_LEN, spec, 'A' + n % 26);
+			snprintf(ref, BUF_LEN, spec, 'A' + n % 26);
+		}
+		compare(spec, len);
+	}
+	FmtPrintf(buf, BUF_LEN, "100%% %s", NULL);
+	strcpy(ref, "100% (null)");
+	compare("%% %s", strlen(buf));
+	/* not supported conversions are copied, and take no argument */
+	FmtPrintf(buf, BUF_LEN, "%f %5.2e %d%", 7);
+	strcpy(ref, "%f %5.2e 7%");
+	compare("%f", strlen(buf));
+	CHECK(mismatches == 0);
+}
+
+static void test_fixed(void){
+	char spec[16];
+	mismatches = 0;
+	for(int n = 0; n < N_RANDOM; n++){
+		int32_t v = (TestRandom() % 2) ? -(int32_t)random_value() : (int32_t)random_value();
+		uint8_t decimals = TestRandom() % (FMT_DECIMALS_MAX + 1);
+		uint32_t mag = (v < 0) ? -(uint32_t)v : (uint32_t)v;
+		uint32_t pow10 = 1;
+		for(uint8_t i = 0; i < decimals; i++){
+			pow10 *= 10;
+		}
+		/* the definition: integer part, point and the remainder with all its digits */
+		char number[32];
+		if(decimals){
+			sprintf(number, "%s%" PRIu32 ".%0*" PRIu32, (v < 0) ? "-" : "", mag / pow10, decimals, mag % pow10);
+		}else{
+			sprintf(number, "%" PRId32, v);
+		}
+		uint8_t len8 = FmtFixed(buf, v, decimals);
+		strcpy(ref, number);
+		compare("FmtFixed", len8);
+		/* %D takes the number of decimals from the precision */
+		int width = TestRandom() % 20;
+		sprintf(spec, "%%%s%d.%uD", (TestRandom() % 2) ? "-" : "", width, decimals);
+		uint32_t len = FmtPrintf(buf, BUF_LEN, spec, v);
+		snprintf(ref, BUF_LEN, (spec[1] == '-') ? "%-*s" : "%*s", width, number);
+		compare(spec, len);
+	}
+	/* Q format: against the double value (exact below 2^53), rounded by the C library */
+	for(int n = 0; n < N_RANDOM; n++){
+		int32_t v = (TestRandom() % 2) ? -(int32_t)random_value() : (int32_t)random_value();
+		uint8_t frac_bits = TestRandom() % 32;
+		uint8_t decimals = TestRandom() % 7;
+		uint32_t mag = (v < 0) ? -(uint32_t)v : (uint32_t)v;
+		uint64_t pow10 = 1;
+		for(uint8_t i = 0; i < decimals; i++){
+			pow10 *= 10;
+		}
+		/* ties: FmtQ() rounds them up, the C library to even */
+		if(frac_bits && ((mag * pow10) % (1ULL << frac_bits) == (1ULL << (frac_bits - 1)))){
+			continue;
+		}
+		uint8_t len8 = FmtQ(buf, v, frac_bits, decimals);
+		snprintf(ref, BUF_LEN, "%.*f", decimals, ldexp(v, -frac_bits));
+		/* no negative zero */
+		if((ref[0] == '-') && (strspn(ref + 1, "0.") == strlen(ref + 1))){
+			memmove(ref, ref + 1, strlen(ref));
+		}
+		compare("FmtQ", len8);
+	}
+	CHECK(mismatches == 0);
+	CHECK(FmtFixed(buf, -505, 2) == 5 && !strcmp(buf, "-5.05"));
+	CHECK(FmtQ(buf, 16384, 15, 3) == 5 && !strcmp(buf, "0.500"));
+	/* more decimals than supported: FMT_DECIMALS_MAX */
+	FmtPrintf(buf, BUF_LEN, "%.12D", 1);
+	CHECK(!strcmp(buf, "0.000000001"));
+}
+
+static void test_bases(void){
+	char bits[FMT_INT_MAX_LEN];
+	mismatches = 0;
+	for(int n = 0; n < N_RANDOM; n++){
+		uint32_t v = random_value();
+		uint8_t width = TestRandom() % 40;
+		char pad = (TestRandom() % 2) ? '0' : ' ';
+		/* %b: the binary digits */
+		char *p = &bits[FMT_INT_MAX_LEN - 1];
+		*p = '\0';
+		uint32_t u = v;
+		do{
+			*--p = '0' + (u & 1);
+			u >>= 1;
+		}while(u);
+		uint32_t len = FmtPrintf(buf, BUF_LEN, "%b", v);
+		strcpy(ref, p);
+		compare("%b", len);
+		/* FmtUint() and FmtInt(): the same as %*u, %0*u and %*d, %0*d */
+		uint8_t len8 = FmtUint(buf, v, 10, width, pad);
+		snprintf(ref, BUF_LEN, (pad == '0') ? "%0*u" : "%*u", width, v);
+		compare("FmtUint", len8);
+		len8 = FmtUint(buf, v, 16, width, pad);
+		snprintf(ref, BUF_LEN, (pad == '0') ? "%0*x" : "%*x", width, v);
+		compare("FmtUint 16", len8);
+		len8 = FmtInt(buf, -(int32_t)v, 10, width, pad);
+		snprintf(ref, BUF_LEN, (pad == '0') ? "%0*d" : "%*d", width, -(int32_t)v);
+		compare("FmtInt", len8);
+	}
+	CHECK(mismatches == 0);
+	CHECK(FmtUint(buf, 35, 36, 0, ' ') == 0 && buf[0] == '\0');
+	CHECK(FmtInt(buf, 5, 1, 0, ' ') == 0);
+	CHECK(FmtUint(buf, 2147483647, 7, 0, ' ') == 12 && !strcmp(buf, "104134211161"));
+}
+
+static void test_truncation(void){
+	const char *format = "t=%08.3D ms, id %-6x|%s|%+d";
+	char whole[BUF_LEN];
+	uint32_t total = FmtPrintf(whole, BUF_LEN, format, 123456, 0xbeef, "ok", 42);
+	CHECK(!strcmp(whole, "t=0123.456 ms, id beef  |ok|+42"));
+	mismatches = 0;
+	for(uint32_t size = 1; size <= total + 2; size++){
+		memset(buf, 'X', BUF_LEN);
+		uint32_t len = FmtPrintf(buf, size, format, 123456, 0xbeef, "ok", 42);
+		uint32_t expected = (size - 1 < total) ? size - 1 : total;
+		/* the first size - 1 characters, '\0' and nothing written after it */
+		mismatches += (len != expected) || (strncmp(buf, whole, expected) != 0) || (buf[expected] != '\0')
+			|| (buf[expected + 1] != 'X');
+	}
+	CHECK(mismatches == 0);
+	buf[0] = 'X';
+	CHECK(FmtPrintf(buf, 0, "abc") == 0 && buf[0] == 'X');
+	CHECK(FmtPrintf(NULL, 10, "abc") == 0);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_integers();
+	test_text();
+	test_fixed();
+	test_bases();
+	test_truncation();
+	return TEST_END("fmt");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,312 @@
+/**
+ * @file test_logger.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of logger.c with real threads (stubs/freertos_posix.c): line format, truncation,
+ * deferred messages, level filter, drain order by priority and drop reports with the drain task
+ * held, and many writer threads at once against the lock-free queues (every message sent is
+ * intact, sent once and in order, and every one written is either sent or counted as dropped).
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "test.h"
+#include "freertos/task.h"
+#include "logger.h"
+/*==================[macros and definitions]=================================*/
+#define N_THREADS	8
+#define N_MESSAGES	20000		/*!< Per thread, levels in turn */
+#define N_LINES		128			/*!< Lines kept (while recording) */
+#define LINE_LEN	128
+#define WAIT_MS		5000		/*!< Longest wait for the drain task */
+
+/*==================[internal data definition]===============================*/
+static pthread_mutex_t uart_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t uart_cond = PTHREAD_COND_INITIALIZER;
+static bool gate_closed;			/*!< The UART holds the drain task */
+static bool drain_waiting;			/*!< The drain task is held */
+static bool recording;
+static char lines[N_LINES][LINE_LEN];
+static uint32_t n_lines;			/*!< Lines sent (all, recorded or not) */
+static uint32_t bad_lines;			/*!< Lines of the writer threads that do not parse */
+static uint32_t reported[LOGGER_LEVELS];	/*!< Drops in the "logger dropped" lines */
+static uint8_t seen[LOGGER_LEVELS][N_THREADS][N_MESSAGES];
+static int32_t last_seen[LOGGER_LEVELS][N_THREADS];
+static uint32_t out_of_order;
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Parses a line of the writer threads ("t<thread> m<message> payload") or a drop report
+ */
+static void parse_line(const char *line){
+	uint32_t s, ms, d[LOGGER_LEVELS];
+	char letter, end[8];
+	int thread, k, n = 0;
+	if(sscanf(line, "[%u.%3u] W: logger dropped E%u W%u I%u D%u", &s, &ms, &d[0], &d[1], &d[2], &d[3]) == 6){
+		for(int level = 0; level < LOGGER_LEVELS; level++){
+			reported[level] += d[level];
+		}
+		return;
+	}
+	if((sscanf(line, "[%u.%3u] %c: t%d m%d payload%n%7s", &s, &ms, &letter, &thread, &k, &n, end) != 5) ||
+			(strcmp(line + n, "\r\n") != 0) || !strchr("EWID", letter) || (thread < 0) || (thread >= N_THREADS) ||
+			(k < 0) || (k >= N_MESSAGES)){
+		bad_lines++;
+		return;
+	}
+	int level = strchr("EWID", letter) - "EWID";
+	if(level != k % LOGGER_LEVELS){
+		bad_lines++;
+	}
+	seen[level][thread][k]++;
+	/* the messages of a writer leave its level queue in the order it wrote them */
+	out_of_order += (k <= last_seen[level][thread]);
+	last_seen[level][thread] = k;
+}
+
+/**
+ * @brief Waits (with a limit) until n lines were sent
+ */
+static bool wait_lines(uint32_t n){
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += WAIT_MS / 1000;
+	pthread_mutex_lock(&uart_mutex);
+	while((n_lines < n) && (pthread_cond_timedwait(&uart_cond, &uart_mutex, &deadline) == 0)){
+	}
+	bool done = n_lines >= n;
+	pthread_mutex_unlock(&uart_mutex);
+	return done;
+}
+
+/**
+ * @brief Waits until the drain task is idle: no more lines for a few drain periods
+ */
+static void wait_idle(void){
+	uint32_t before, now;
+	pthread_mutex_lock(&uart_mutex);
+	now = n_lines;
+	do{
+		before = now;
+		pthread_mutex_unlock(&uart_mutex);
+		vTaskDelay(50);
+		pthread_mutex_lock(&uart_mutex);
+		now = n_lines;
+	}while(now != before);
+	pthread_mutex_unlock(&uart_mutex);
+}
+
+static void start_recording(void){
+	wait_idle();
+	pthread_mutex_lock(&uart_mutex);
+	recording = true;
+	n_lines = 0;
+	pthread_mutex_unlock(&uart_mutex);
+}
+
+static void *writer_thread(void *param){
+	int thread = (intptr_t)param;
+	const struct timespec pause = {.tv_nsec = 20000};
+	for(int k = 0; k < N_MESSAGES; k++){
+		LoggerWrite(k % LOGGER_LEVELS, "t%d m%d %s", thread, k, "payload");
+		/* bursts, so the drain task keeps up with part of them: the queues wrap many times */
+		if(k % 8 == 7){
+			nanosleep(&pause, NULL);
+		}
+	}
+	return NULL;
+}
+
+static void test_format(void){
+	char text[LOGGER_MSG_LEN + 40];
+	uint32_t s, ms;
+	int n = 0;
+	start_recording();
+	CHECK(LOGGER_E("hola %d", 5));
+	memset(text, 'x', sizeof(text) - 1);
+	text[sizeof(text) - 1] = '\0';
+	CHECK(LOGGER_W("%s", text));
+	const uint8_t deferred[] = {0x01, 0x02, 0xab};
+	CHECK(LoggerWriteDeferred(LOGGER_INFO, deferred, sizeof(deferred)));
+	CHECK(wait_lines(3));
+	CHECK(sscanf(lines[0], "[%u.%3u] E: hola 5\r\n%n", &s, &ms, &n) == 2);
+	CHECK((n == strlen(lines[0])) && (lines[0][strchr(lines[0], '.') - lines[0] + 4] == ']'));
+	/* truncated to LOGGER_MSG_LEN characters */
+	const char *msg = strstr(lines[1], "W: ");
+	CHECK(msg && (strspn(msg + 3, "x") == LOGGER_MSG_LEN) && !strcmp(msg + 3 + LOGGER_MSG_LEN, "\r\n"));
+	/* deferred messages as text: the encoded bytes */
+	CHECK(strstr(lines[2], "] I: deferred 01 02 ab\r\n"));
+	/* too long deferred message: dropped, and counted */
+	logger_stats_t before, after;
+	uint8_t data[LOGGER_MSG_LEN + 1] = {0};
+	LoggerGetStats(&before);
+	CHECK(!LoggerWriteDeferred(LOGGER_DEBUG, data, sizeof(data)));
+	CHECK(LoggerWriteDeferred(LOGGER_DEBUG, data, LOGGER_MSG_LEN));
+	LoggerGetStats(&after);
+	CHECK(after.dropped[LOGGER_DEBUG] == before.dropped[LOGGER_DEBUG] + 1);
+	CHECK(after.written[LOGGER_DEBUG] == before.written[LOGGER_DEBUG] + 1);
+	CHECK(wait_lines(5));
+	CHECK(strstr(lines[4], "] W: logger dropped E0 W0 I0 D1\r\n"));
+}
+
+static void test_level(void){
+	logger_stats_t before, after;
+	LoggerGetStats(&before);
+	LoggerSetLevel(LOGGER_INFO);
+	CHECK(!LOGGER_D("debug"));
+	CHECK(LOGGER_I("info"));
+	LoggerSetLevel(LOGGER_ERROR);
+	CHECK(!LOGGER_W("warn"));
+	CHECK(!LoggerWriteDeferred(LOGGER_WARN, "x", 1));
+	CHECK(LOGGER_E("error"));
+	CHECK(!LoggerWrite(LOGGER_LEVELS, "none"));
+	LoggerSetLevel(LOGGER_DEBUG);
+	LoggerGetStats(&after);
+	/* ignored messages are not drops */
+	for(int level = 0; level < LOGGER_LEVELS; level++){
+		CHECK(after.dropped[level] == before.dropped[level]);
+	}
+	CHECK(after.written[LOGGER_INFO] == before.written[LOGGER_INFO] + 1);
+	CHECK(after.written[LOGGER_ERROR] == before.written[LOGGER_ERROR] + 1);
+	CHECK(after.written[LOGGER_DEBUG] == before.written[LOGGER_DEBUG]);
+}
+
+/**
+ * @brief The drain task held by the UART while every queue overflows: errors are sent first and
+ * debug messages last, each level in order, then the drops are reported
+ */
+static void test_priority(void){
+	const uint32_t capacity[LOGGER_LEVELS] = {8, 8, 16, 16};
+	logger_stats_t before, after;
+	start_recording();
+	pthread_mutex_lock(&uart_mutex);
+	gate_closed = true;
+	pthread_mutex_unlock(&uart_mutex);
+	CHECK(LOGGER_D("held"));
+	/* until the drain task is in the UART with it (its slot is free again) */
+	pthread_mutex_lock(&uart_mutex);
+	while(!drain_waiting){
+		pthread_cond_wait(&uart_cond, &uart_mutex);
+	}
+	pthread_mutex_unlock(&uart_mutex);
+	LoggerGetStats(&before);
+	for(int level = LOGGER_DEBUG; level >= LOGGER_ERROR; level--){
+		for(uint32_t k = 0; k < capacity[level] + 3; k++){
+			CHECK(LoggerWrite(level, "m%u", k) == (k < capacity[level]));
+		}
+	}
+	LoggerGetStats(&after);
+	for(int level = 0; level < LOGGER_LEVELS; level++){
+		CHECK(after.written[level] - before.written[level] == capacity[level]);
+		CHECK(after.dropped[level] - before.dropped[level] == 3);
+	}
+	pthread_mutex_lock(&uart_mutex);
+	gate_closed = false;
+	pthread_cond_broadcast(&uart_cond);
+	pthread_mutex_unlock(&uart_mutex);
+	CHECK(wait_lines(1 + 48 + 1));
+	uint32_t line = 1;
+	for(int level = 0; level < LOGGER_LEVELS; level++){
+		for(uint32_t k = 0; k < capacity[level]; k++, line++){
+			char expected[32];
+			sprintf(expected, "] %c: m%u\r\n", "EWID"[level], k);
+			CHECK(strstr(lines[line], expected) != NULL);
+		}
+	}
+	CHECK(strstr(lines[line], "] W: logger dropped E3 W3 I3 D3\r\n"));
+}
+
+static void test_threads(void){
+	pthread_t threads[N_THREADS];
+	logger_stats_t before, after;
+	wait_idle();
+	pthread_mutex_lock(&uart_mutex);
+	recording = false;
+	memset(reported, 0, sizeof(reported));
+	memset(last_seen, 0xff, sizeof(last_seen));
+	pthread_mutex_unlock(&uart_mutex);
+	LoggerGetStats(&before);
+	for(intptr_t i = 0; i < N_THREADS; i++){
+		pthread_create(&threads[i], NULL, writer_thread, (void *)i);
+	}
+	for(int i = 0; i < N_THREADS; i++){
+		pthread_join(threads[i], NULL);
+	}
+	wait_idle();
+	LoggerGetStats(&after);
+	uint32_t dropped = 0;
+	pthread_mutex_lock(&uart_mutex);
+	for(int level = 0; level < LOGGER_LEVELS; level++){
+		uint32_t received = 0, duplicated = 0;
+		for(int thread = 0; thread < N_THREADS; thread++){
+			for(int k = 0; k < N_MESSAGES; k++){
+				received += seen[level][thread][k];
+				duplicated += seen[level][thread][k] > 1;
+			}
+		}
+		uint32_t written = after.written[level] - before.written[level];
+		dropped += after.dropped[level] - before.dropped[level];
+		CHECK(duplicated == 0);
+		CHECK(received == written);
+		CHECK(written + after.dropped[level] - before.dropped[level] == N_THREADS * N_MESSAGES / LOGGER_LEVELS);
+		/* reported once the drain task caught up */
+		CHECK(reported[level] == after.dropped[level] - before.dropped[level]);
+	}
+	CHECK(bad_lines == 0);
+	CHECK(out_of_order == 0);
+	CHECK(after.sent - before.sent == N_THREADS * N_MESSAGES - dropped);
+	pthread_mutex_unlock(&uart_mutex);
+}
+
+/*==================[external functions definition]==========================*/
+uint32_t UartWriteBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+	pthread_mutex_lock(&uart_mutex);
+	while(gate_closed){
+		drain_waiting = true;
+		pthread_cond_broadcast(&uart_cond);
+		pthread_cond_wait(&uart_cond, &uart_mutex);
+	}
+	drain_waiting = false;
+	char line[LINE_LEN];
+	nbytes = (nbytes < LINE_LEN) ? nbytes : LINE_LEN - 1;
+	memcpy(line, data, nbytes);
+	line[nbytes] = '\0';
+	if(recording){
+		if(n_lines < N_LINES){
+			strcpy(lines[n_lines], line);
+		}
+	}else{
+		parse_line(line);
+	}
+	n_lines++;
+	pthread_cond_broadcast(&uart_cond);
+	pthread_mutex_unlock(&uart_mutex);
+	return nbytes;
+}
+
+bool TelemetrySend(telemetry_t *tm, uint8_t type, const void *payload, uint16_t len){
+	/* not used: text output */
+	return false;
+}
+
+int main(void){
+	logger_config_t config = {.port = UART_PC, .level = LOGGER_DEBUG, .period_ms = 1};
+	/* before LoggerInit(): dropped, not counted */
+	CHECK(!LOGGER_E("early"));
+	CHECK(LoggerInit(&config));
+	CHECK(!LoggerInit(&config));
+	test_format();
+	test_level();
+	test_priority();
+	test_threads();
+	return TEST_END("logger");
+}
+/*==================[end of file]============================================*/
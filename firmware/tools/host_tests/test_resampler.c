@@ -0,0 +1,170 @@
+/**
+ * @file test_resampler.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of resampler.c against double precision references, for several up / down factors:
+ * - The same Q15 prototype filter applied in double to the zero stuffed input: the outputs must
+ *   be its rounding (0.5 LSB).
+ * - The ideal resampled signal (a sine evaluated at the output times, delayed by the filter):
+ *   bounded by the passband ripple of ResamplerDesign().
+ * - Tones above the output Nyquist frequency rejected (no aliasing).
+ * - The same outputs from blocks of odd lengths and from ring buffers drained slowly.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test.h"
+#include "resampler.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	6000
+#define MAX_OUT		(4 * N_SAMPLES)
+#define MAX_COEFFS	4096
+#define MAX_TAPS	32
+#define BIAS		2048
+#define AMPLITUDE	1500.0
+
+/*==================[internal data definition]===============================*/
+static uint16_t in[N_SAMPLES];
+static uint16_t out[MAX_OUT], out_blocks[MAX_OUT], out_ring[MAX_OUT];
+static uint16_t ring_in_storage[8192], ring_out_storage[256];
+static int16_t coeffs[MAX_COEFFS];
+static int16_t state[3][2 * MAX_TAPS];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Output m of the Q15 filter in double: zero stuffed input (up), filtered, decimated (down)
+ */
+static double exact_output(uint32_t m, uint16_t up, uint16_t down, uint16_t taps){
+	int64_t t = (int64_t)m * down;
+	double acc = 0;
+	for(int64_t j = t % up; (j < (int64_t)up * taps) && (j <= t); j += up){
+		acc += coeffs[j] / 32768.0 * ((int)in[(t - j) / up] - BIAS);
+	}
+	return acc + BIAS;
+}
+
+/**
+ * @brief Amplitude of the tone of frequency f (cycles per sample) in the second half of x
+ */
+static double tone_amplitude(const uint16_t *x, uint32_t n, double f){
+	double re = 0, im = 0;
+	for(uint32_t i = n / 2; i < n; i++){
+		re += ((int)x[i] - BIAS) * cos(2 * M_PI * f * i);
+		im += ((int)x[i] - BIAS) * sin(2 * M_PI * f * i);
+	}
+	return 2 * hypot(re, im) / (n - n / 2);
+}
+
+/**
+ * @brief Resamples a sine of frequency f (cycles per input sample) and checks the outputs
+ *
+ * @param ideal_error Bound of the error against the ideal resampled sine (LSB), 0 to skip
+ * the check (tones out of the passband)
+ * @return double Gain of the tone (output amplitude over input amplitude)
+ */
+static double run(uint16_t up, uint16_t down, uint16_t taps, double f, double ideal_error){
+	resampler_t rs, rs_blocks, rs_ring;
+	for(int i = 0; i < N_SAMPLES; i++){
+		in[i] = lrint(BIAS + AMPLITUDE * sin(2 * M_PI * f * i));
+	}
+	CHECK(ResamplerDesign(coeffs, up, down, taps, 0.8f));
+	CHECK(ResamplerInit(&rs, coeffs, up, down, taps, state[0], BIAS));
+	CHECK(ResamplerInit(&rs_blocks, coeffs, up, down, taps, state[1], BIAS));
+	CHECK(ResamplerInit(&rs_ring, coeffs, up, down, taps, state[2], BIAS));
+
+	uint32_t n = ResamplerProcess(&rs, in, N_SAMPLES, out, MAX_OUT);
+	/* one output every down / up inputs: outputs at times m down / up < N_SAMPLES */
+	CHECK(n == ((uint64_t)N_SAMPLES * up + down - 1) / down);
+
+	uint32_t n_blocks = 0;
+	for(uint32_t i = 0; i < N_SAMPLES; i += 37){
+		uint32_t len = (N_SAMPLES - i < 37) ? N_SAMPLES - i : 37;
+		n_blocks += ResamplerProcess(&rs_blocks, &in[i], len, &out_blocks[n_blocks], MAX_OUT - n_blocks);
+	}
+	CHECK(n_blocks == n);
+
+	/* ring buffers: input written in chunks, output read slower than it is produced */
+	ring_buffer_t ring_in, ring_out;
+	CHECK(RingBufferInit(&ring_in, ring_in_storage, 8192));
+	CHECK(RingBufferInit(&ring_out, ring_out_storage, 256));
+	uint32_t n_ring = 0, fed = 0;
+	for(uint32_t round = 0; (round < 100000) && (n_ring < n); round++){
+		if(fed < N_SAMPLES){
+			fed += RingBufferWrite(&ring_in, &in[fed], (N_SAMPLES - fed < 100) ? N_SAMPLES - fed : 100);
+		}
+		ResamplerProcessRing(&rs_ring, &ring_in, &ring_out);
+		n_ring += RingBufferRead(&ring_out, &out_ring[n_ring], (n - n_ring < 50) ? n - n_ring : 50);
+	}
+	CHECK(n_ring == n);
+
+	double max_exact = 0, max_ideal = 0;
+	uint32_t mismatches = 0;
+	/* group delay of the prototype filter, in input samples */
+	double delay = (up * taps - 1) / (2.0 * up);
+	for(uint32_t m = 0; m < n; m++){
+		max_exact = fmax(max_exact, fabs(out[m] - exact_output(m, up, down, taps)));
+		mismatches += (out[m] != out_blocks[m]) || (out[m] != out_ring[m]);
+		double t = (double)m * down / up - delay;
+		if(t > taps){
+			/* after the start up transient */
+			max_ideal = fmax(max_ideal, fabs(out[m] - (BIAS + AMPLITUDE * sin(2 * M_PI * f * t))));
+		}
+	}
+	CHECK_NEAR(max_exact, 0, 0.5 + 1e-9);
+	CHECK(mismatches == 0);
+	if(ideal_error > 0){
+		CHECK_NEAR(max_ideal, 0, ideal_error);
+	}
+	return tone_amplitude(out, n, f * down / up) / AMPLITUDE;
+}
+
+static void test_factors(void){
+	/* 500 Hz ADC to 250 Hz DAC: a 25 Hz tone passes, a 200 Hz one would alias to 50 Hz */
+	CHECK_NEAR(run(1, 2, 16, 0.05, 4), 1, 0.005);
+	CHECK_NEAR(run(1, 2, 16, 0.4, 0), 0, 1e-3);
+	/* interpolation */
+	CHECK_NEAR(run(2, 1, 8, 0.1, 4), 1, 0.005);
+	CHECK_NEAR(run(4, 1, 16, 0.05, 4), 1, 0.005);
+	/* rational factors */
+	CHECK_NEAR(run(3, 2, 12, 0.1, 4), 1, 0.005);
+	CHECK_NEAR(run(147, 160, 16, 0.05, 4), 1, 0.005);
+	CHECK_NEAR(run(2, 3, 16, 0.45, 0), 0, 1e-3);
+}
+
+static void test_limits(void){
+	resampler_t rs;
+	/* a full output buffer drops outputs but keeps the time base */
+	for(int i = 0; i < N_SAMPLES; i++){
+		in[i] = BIAS + (i % 100) * 10;
+	}
+	CHECK(ResamplerDesign(coeffs, 3, 2, 12, 0.8f));
+	CHECK(ResamplerInit(&rs, coeffs, 3, 2, 12, state[0], BIAS));
+	CHECK(ResamplerProcess(&rs, in, 100, out, 10) == 10);
+	CHECK(ResamplerProcess(&rs, &in[100], 100, &out[10], MAX_OUT) == 150);
+	CHECK(ResamplerInit(&rs, coeffs, 3, 2, 12, state[1], BIAS));
+	CHECK(ResamplerProcess(&rs, in, 200, out_blocks, MAX_OUT) == 300);
+	uint32_t mismatches = 0;
+	for(int m = 150; m < 300; m++){
+		mismatches += out[m - 140] != out_blocks[m];
+	}
+	CHECK(mismatches == 0);
+
+	CHECK(!ResamplerDesign(coeffs, 0, 2, 12, 0.8f));
+	CHECK(!ResamplerDesign(coeffs, 2, 2, 12, 0));
+	CHECK(!ResamplerDesign(coeffs, 2, 2, 12, 1.5f));
+	CHECK(!ResamplerInit(&rs, coeffs, 3, 0, 12, state[0], BIAS));
+	CHECK(!ResamplerInit(&rs, coeffs, 3, 2, 0, state[0], BIAS));
+	CHECK(!ResamplerInit(&rs, NULL, 3, 2, 12, state[0], BIAS));
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_factors();
+	test_limits();
+	return TEST_END("resampler");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,238 @@
+/**
+ * @file test_running_stats.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of running_stats.c against brute force: after every sample, the windowed mean,
+ * variance, RMS, minimum and maximum are computed again from the whole window, the EMA is
+ * followed in double precision and the P² quantiles are compared with the exact ones of the
+ * sorted stream.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdlib.h>
+#include "test.h"
+#include "running_stats.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	40000
+#define MAX_WINDOW	256
+#define N_QUANTILE	200000
+
+/*==================[internal data definition]===============================*/
+static int32_t x[N_SAMPLES];
+static uint16_t x16[N_SAMPLES];
+static int32_t history[MAX_WINDOW];
+static minmax_entry_t deques[2 * MAX_WINDOW];
+static int32_t sorted[N_QUANTILE];
+
+/*==================[internal functions definition]==========================*/
+static int compare(const void *a, const void *b){
+	int32_t d = *(const int32_t *)a - *(const int32_t *)b;
+	return (d > 0) - (d < 0);
+}
+
+/**
+ * @brief Raw weights of a load cell (HX711, 24 bits): large offset, slow drift and noise
+ */
+static void load_cell(void){
+	for(int i = 0; i < N_SAMPLES; i++){
+		x[i] = 8000000 + lrint(3000 * sin(i * 0.001)) + (int32_t)(TestRandom() % 2001) - 1000;
+	}
+}
+
+/**
+ * @brief Compares the windowed statistics with the window recomputed after every sample
+ */
+static void check_windows(uint16_t len){
+	window_stats_t ws;
+	minmax_t mm;
+	CHECK(WindowStatsInit(&ws, history, len));
+	CHECK(MinMaxInit(&mm, deques, len));
+	double max_mean = 0, max_var = 0, max_rms = 0;
+	uint32_t minmax_bad = 0, count_bad = 0;
+	for(int i = 0; i < N_SAMPLES; i++){
+		WindowStatsPush(&ws, x[i]);
+		MinMaxPush(&mm, x[i]);
+		int first = (i + 1 > len) ? i + 1 - len : 0;
+		int n = i + 1 - first;
+		double mean = 0, sum_sq = 0, var = 0;
+		int32_t min = x[first], max = x[first];
+		for(int j = first; j <= i; j++){
+			mean += x[j];
+			sum_sq += (double)x[j] * x[j];
+			min = (x[j] < min) ? x[j] : min;
+			max = (x[j] > max) ? x[j] : max;
+		}
+		mean /= n;
+		for(int j = first; j <= i; j++){
+			var += (x[j] - mean) * (x[j] - mean);
+		}
+		var /= n;
+		/* results are float: relative errors of a few float epsilons */
+		max_mean = fmax(max_mean, fabs(WindowStatsMean(&ws) - mean) / (fabs(mean) + 1));
+		max_var = fmax(max_var, fabs(WindowStatsVariance(&ws) - var) / (var + 1));
+		max_rms = fmax(max_rms, fabs(WindowStatsRms(&ws) - sqrt(sum_sq / n)) / sqrt(sum_sq / n));
+		minmax_bad += (MinMaxMin(&mm) != min) || (MinMaxMax(&mm) != max);
+		count_bad += WindowStatsCount(&ws) != n;
+	}
+	if(minmax_bad){
+		fprintf(stderr, "window of %u samples: %u wrong minimum / maximum\n", len, minmax_bad);
+	}
+	CHECK(minmax_bad == 0);
+	CHECK(count_bad == 0);
+	CHECK_NEAR(max_mean, 0, 2e-7);
+	CHECK_NEAR(max_var, 0, 1e-6);
+	CHECK_NEAR(max_rms, 0, 2e-7);
+}
+
+static void test_window(void){
+	const uint16_t lengths[] = {1, 2, 7, 100, MAX_WINDOW};
+	load_cell();
+	for(unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++){
+		check_windows(lengths[l]);
+	}
+	/* negative samples, and monotonic ramps (the worst case of the deques) */
+	for(int i = 0; i < N_SAMPLES; i++){
+		x[i] = (i < N_SAMPLES / 2) ? -3 * i : 3 * i - 4 * N_SAMPLES;
+	}
+	check_windows(100);
+	/* steps of almost 2^24 from the first sample */
+	for(int i = 0; i < N_SAMPLES; i++){
+		x[i] = ((i / 500) % 2) ? 8000000 : -8000000 + (int32_t)(TestRandom() % 100);
+	}
+	check_windows(50);
+}
+
+static void test_blocks(void){
+	window_stats_t ws, ws_block;
+	minmax_t mm, mm_block;
+	static int32_t history_block[MAX_WINDOW];
+	static minmax_entry_t deques_block[2 * MAX_WINDOW];
+	for(int i = 0; i < N_SAMPLES; i++){
+		x16[i] = TestRandom() >> 20;
+	}
+	CHECK(WindowStatsInit(&ws, history, 64));
+	CHECK(WindowStatsInit(&ws_block, history_block, 64));
+	CHECK(MinMaxInit(&mm, deques, 64));
+	CHECK(MinMaxInit(&mm_block, deques_block, 64));
+	uint32_t bad = 0;
+	for(int i = 0; i < N_SAMPLES; i += 37){
+		int n = (N_SAMPLES - i < 37) ? N_SAMPLES - i : 37;
+		for(int j = i; j < i + n; j++){
+			WindowStatsPush(&ws, x16[j]);
+			MinMaxPush(&mm, x16[j]);
+		}
+		WindowStatsPushBlock(&ws_block, &x16[i], n);
+		MinMaxPushBlock(&mm_block, &x16[i], n);
+		bad += (WindowStatsMean(&ws) != WindowStatsMean(&ws_block)) || (WindowStatsVariance(&ws) != WindowStatsVariance(&ws_block));
+		bad += (MinMaxMin(&mm) != MinMaxMin(&mm_block)) || (MinMaxMax(&mm) != MinMaxMax(&mm_block));
+	}
+	CHECK(bad == 0);
+	/* reset: as new */
+	WindowStatsReset(&ws);
+	MinMaxReset(&mm);
+	CHECK(WindowStatsCount(&ws) == 0);
+	CHECK(WindowStatsMean(&ws) == 0);
+	CHECK(MinMaxMin(&mm) == 0);
+	WindowStatsPush(&ws, -5);
+	MinMaxPush(&mm, -5);
+	CHECK(WindowStatsMean(&ws) == -5);
+	CHECK(WindowStatsVariance(&ws) == 0);
+	CHECK((MinMaxMin(&mm) == -5) && (MinMaxMax(&mm) == -5));
+	CHECK(!WindowStatsInit(&ws, history, 0));
+	CHECK(!MinMaxInit(&mm, NULL, 10));
+}
+
+static void test_ema(void){
+	const uint32_t lengths[] = {1, 4, 19, 1000};
+	load_cell();
+	for(unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++){
+		ema_t ema;
+		uint32_t alpha = EMA_ALPHA_FROM_LEN(lengths[l]);
+		CHECK(EmaInit(&ema, alpha));
+		CHECK(EmaGet(&ema) == 0);
+		double ref = 0, max_error = 0;
+		for(int i = 0; i < N_SAMPLES; i++){
+			EmaPush(&ema, x[i]);
+			ref = (i == 0) ? x[i] : ref + alpha / 65536.0 * (x[i] - ref);
+			max_error = fmax(max_error, fabs(EmaGet(&ema) - ref));
+		}
+		/* float result (0.5 near 8e6), and the truncation of each update (2^-16 / alpha) */
+		CHECK_NEAR(max_error, 0, 0.5 + 65536.0 / alpha / 65536.0);
+	}
+	/* alpha of one: the last sample */
+	ema_t ema;
+	CHECK(EmaInit(&ema, 1 << EMA_FRAC_BITS));
+	EmaPush(&ema, 10);
+	EmaPush(&ema, -7);
+	CHECK(EmaGet(&ema) == -7);
+	CHECK(!EmaInit(&ema, 0));
+	CHECK(!EmaInit(&ema, (1 << EMA_FRAC_BITS) + 1));
+}
+
+/**
+ * @brief P² estimate against the exact quantile of n samples (sorted copy)
+ */
+static void check_quantiles(uint32_t n, int32_t range){
+	const float ps[] = {0.05f, 0.25f, 0.5f, 0.9f, 0.99f};
+	for(unsigned k = 0; k < sizeof(ps) / sizeof(ps[0]); k++){
+		quantile_t qt;
+		CHECK(QuantileInit(&qt, ps[k]));
+		for(uint32_t i = 0; i < n; i++){
+			QuantilePush(&qt, sorted[i]);
+		}
+		int32_t *copy = malloc(n * sizeof(int32_t));
+		for(uint32_t i = 0; i < n; i++){
+			copy[i] = sorted[i];
+		}
+		qsort(copy, n, sizeof(int32_t), compare);
+		double exact = copy[(uint32_t)lround(ps[k] * (n - 1))];
+		free(copy);
+		/* 0.2 % of the range of the samples */
+		CHECK_NEAR(QuantileGet(&qt), exact, 0.002 * range);
+	}
+}
+
+static void test_quantile(void){
+	/* uniform, normal and exponential streams (sorted[] holds them in arrival order) */
+	for(int i = 0; i < N_QUANTILE; i++){
+		sorted[i] = TestRandom() % 5000;
+	}
+	check_quantiles(N_QUANTILE, 5000);
+	for(int i = 0; i < N_QUANTILE; i++){
+		sorted[i] = lrint(2000 + 300 * TestGauss());
+	}
+	check_quantiles(N_QUANTILE, 2400);
+	for(int i = 0; i < N_QUANTILE; i++){
+		sorted[i] = lrint(-1000 * log(1 - TestUniform()));
+	}
+	check_quantiles(N_QUANTILE, 5000);
+	/* exact for the first samples */
+	quantile_t qt;
+	CHECK(QuantileInit(&qt, 0.5f));
+	CHECK(QuantileGet(&qt) == 0);
+	QuantilePush(&qt, 7);
+	CHECK(QuantileGet(&qt) == 7);
+	QuantilePush(&qt, 3);
+	QuantilePush(&qt, 5);
+	CHECK(QuantileGet(&qt) == 5);
+	QuantilePush(&qt, -1);
+	QuantilePush(&qt, 100);
+	CHECK(QuantileGet(&qt) == 5);
+	CHECK(!QuantileInit(&qt, 1.5f));
+	CHECK(!QuantileInit(&qt, -0.1f));
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_window();
+	test_blocks();
+	test_ema();
+	test_quantile();
+	return TEST_END("running_stats");
+}
+/*==================[end of file]============================================*/
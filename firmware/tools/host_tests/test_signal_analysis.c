@@ -0,0 +1,131 @@
+/**
+ * @file test_signal_analysis.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of signal_analysis.c with synthetic captures: sine fit of a non whole number of
+ * periods, SNR, THD and SINAD of known harmonics and noise, ENOB of ideal quantizers and the
+ * delay between two fitted phases.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test.h"
+#include "signal_analysis.h"
+/*==================[macros and definitions]=================================*/
+#define N_SAMPLES	4096
+#define FREQ		0.01234		/* 50.5 periods */
+
+/*==================[internal data definition]===============================*/
+static uint16_t x[N_SAMPLES];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Fills x with offset + amplitude sin(w n + phase) + harmonics 2 and 3 + noise, rounded
+ * to multiples of q (an ideal quantizer of q codes per step)
+ */
+static void sine(double amplitude, double phase, double offset, double h2, double h3, double noise, double q){
+	for(int i = 0; i < N_SAMPLES; i++){
+		double w = 2 * M_PI * FREQ * i;
+		double v = offset + amplitude * sin(w + phase) + h2 * sin(2 * w) + h3 * sin(3 * w + 1) + noise * TestGauss();
+		v = q * round(v / q);
+		x[i] = (v < 0) ? 0 : (v > 4095) ? 4095 : v;
+	}
+}
+
+static void test_fit(void){
+	float amplitude, phase, offset;
+	sine(1500, 0.7, 2048, 0, 0, 0, 1);
+	CHECK(SignalSineFit(x, N_SAMPLES, FREQ, &amplitude, &phase, &offset));
+	CHECK_NEAR(amplitude, 1500, 0.05);
+	CHECK_NEAR(phase, 0.7, 1e-4);
+	CHECK_NEAR(offset, 2048, 0.05);
+	/* a phase on the other side of +-pi */
+	sine(1000, -3.0, 1500, 0, 0, 0, 1);
+	CHECK(SignalSineFit(x, N_SAMPLES, FREQ, &amplitude, &phase, &offset));
+	CHECK_NEAR(amplitude, 1000, 0.05);
+	CHECK_NEAR(phase, -3.0, 1e-4);
+	CHECK_NEAR(offset, 1500, 0.05);
+	/* less than one period */
+	CHECK(SignalSineFit(x, 60, FREQ, &amplitude, &phase, &offset));
+	CHECK_NEAR(amplitude, 1000, 1);
+}
+
+static void test_distortion(void){
+	const double a = 1000, h2 = 10, h3 = 5, sigma = 2;
+	signal_sine_t r;
+	sine(a, 0.7, 2000, h2, h3, sigma, 1);
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, FREQ, 5, &r));
+	double s = a * a / 2;
+	double d = (h2 * h2 + h3 * h3) / 2;
+	double n = sigma * sigma + 1.0 / 12;		/* noise and quantization */
+	CHECK_NEAR(r.amplitude, a, 0.2);
+	CHECK_NEAR(r.offset, 2000, 0.2);
+	CHECK_NEAR(r.snr, 10 * log10(s / n), 0.3);
+	CHECK_NEAR(r.thd, 10 * log10(d / s), 0.3);
+	CHECK_NEAR(r.sinad, 10 * log10(s / (n + d)), 0.3);
+	CHECK_NEAR(r.enob, (r.sinad - 1.76) / 6.02, 1e-3);
+	/* only the second harmonic included in THD: the third one counts as noise */
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, FREQ, 2, &r));
+	CHECK_NEAR(r.thd, 10 * log10(h2 * h2 / 2 / s), 0.3);
+	CHECK_NEAR(r.snr, 10 * log10(s / (n + h3 * h3 / 2)), 0.3);
+}
+
+static void test_enob(void){
+	signal_sine_t r;
+	/* full scale sine through ideal 12 and 8 bits quantizers */
+	sine(2047, 0.3, 2047.5, 0, 0, 0, 1);
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, FREQ, 5, &r));
+	CHECK_NEAR(r.enob, 12, 0.1);
+	sine(2047, 0.3, 2047.5, 0, 0, 0, 16);
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, FREQ, 5, &r));
+	CHECK_NEAR(r.enob, 8, 0.1);
+	/* half scale: one bit less */
+	sine(1023, 0.3, 2047.5, 0, 0, 0, 1);
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, FREQ, 5, &r));
+	CHECK_NEAR(r.enob, 11, 0.1);
+}
+
+static void test_delay(void){
+	float a_in, ph_in, off_in, a_out, ph_out, off_out;
+	const double delay = 7.3;			/* samples */
+	sine(1500, 0.2, 2048, 0, 0, 0, 1);
+	CHECK(SignalSineFit(x, N_SAMPLES, FREQ, &a_in, &ph_in, &off_in));
+	sine(900, 0.2 - 2 * M_PI * FREQ * delay, 1800, 0, 0, 0, 1);
+	CHECK(SignalSineFit(x, N_SAMPLES, FREQ, &a_out, &ph_out, &off_out));
+	/* sample rate 1 Hz: the delay in samples */
+	CHECK_NEAR(SignalPhaseDelay(ph_in, ph_out, FREQ), delay, 1e-3);
+	CHECK_NEAR(a_out / a_in, 0.6, 1e-4);
+	CHECK_NEAR(SignalPhaseDelay(0.5, 0.5 - 2 * M_PI * 100 * 0.001, 100), 0.001, 1e-7);
+	/* phases wrapped around: the delay is still between 0 and one period */
+	CHECK_NEAR(SignalPhaseDelay(-3, 3, 10), (2 * M_PI - 6) / (2 * M_PI * 10), 1e-6);
+	CHECK_NEAR(SignalPhaseDelay(1, 1, 10), 0, 1e-9);
+}
+
+static void test_invalid(void){
+	signal_sine_t r;
+	float amplitude, phase, offset;
+	sine(1000, 0, 2000, 0, 0, 0, 1);
+	CHECK(!SignalSineAnalysis(x, 2, FREQ, 5, &r));
+	CHECK(!SignalSineAnalysis(x, N_SAMPLES, 0, 5, &r));
+	CHECK(!SignalSineAnalysis(x, N_SAMPLES, 0.5, 5, &r));
+	CHECK(!SignalSineAnalysis(NULL, N_SAMPLES, FREQ, 5, &r));
+	CHECK(!SignalSineAnalysis(x, N_SAMPLES, FREQ, 5, NULL));
+	CHECK(!SignalSineFit(x, N_SAMPLES, -0.1, &amplitude, &phase, &offset));
+	/* harmonics above the limit or the Nyquist frequency are skipped */
+	CHECK(SignalSineAnalysis(x, N_SAMPLES, 0.2, 200, &r));
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	test_fit();
+	test_distortion();
+	test_enob();
+	test_delay();
+	test_invalid();
+	return TEST_END("signal_analysis");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,307 @@
+/**
+ * @file test_uart_stats.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of the port counters and watermarks of uart_mcu.c, on the simulated IDF driver
+ * (stubs/idf_sim.h): bytes in and out, reception errors, peak backlogs, recovery from RX FIFO
+ * overflows by bytes, lines longer than UART_LINE_MAX, and watermark crossings reported once.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "test.h"
+#include "idf_sim.h"
+#include "uart_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define PORT		UART_CONNECTOR
+#define UART_NUM	UART_NUM_1
+#define TX_SIZE		1024
+#define MAX_CALLS	16
+
+/*==================[internal data definition]===============================*/
+static uint8_t source[4096];
+static uint8_t storage[1024];
+static uint32_t data_calls;
+static char lines[4][UART_LINE_MAX + 1];
+static uint32_t n_lines;
+/** Watermark crossings, in order: 'R'/'r' receive high/low, 'T'/'t' transmit high/low */
+static char calls[MAX_CALLS + 1];
+static uint32_t n_calls;
+
+/*==================[internal functions definition]==========================*/
+static void on_data(void *param){
+	data_calls++;
+}
+
+static void on_line(char *line, uint16_t len, void *param){
+	if(n_lines < 4){
+		memcpy(lines[n_lines], line, len + 1);
+	}
+	n_lines++;
+}
+
+static void on_watermark(uart_mcu_port_t port, uart_watermark_t buffer, bool high, void *param){
+	CHECK(port == PORT);
+	CHECK(param == calls);
+	if(n_calls < MAX_CALLS){
+		calls[n_calls] = (buffer == UART_WATERMARK_RX) ? (high ? 'R' : 'r') : (high ? 'T' : 't');
+	}
+	calls[++n_calls < MAX_CALLS ? n_calls : MAX_CALLS] = '\0';
+}
+
+/**
+ * @brief Port initialized for reception by bytes (on_data), by lines (on_line) or in a receive
+ * stream, with no watermarks and the counters cleared
+ */
+static void port_init(uart_line_func_t line_func, bool stream){
+	SimReset();
+	serial_config_t config = {
+		.port = PORT,
+		.baud_rate = 115200,
+		.func_p = on_data,
+		.line_func_p = line_func,
+		.rx_stream = stream ? storage : NULL,
+		.rx_stream_size = sizeof(storage),
+		.rx_buffer_size = 1024,
+		.tx_buffer_size = TX_SIZE,
+	};
+	UartInit(&config);
+	UartSetWatermark(PORT, NULL);
+	UartResetStats(PORT);
+	data_calls = 0;
+	n_lines = 0;
+	n_calls = 0;
+	calls[0] = '\0';
+}
+
+static void test_counters(void){
+	uint8_t buf[256];
+	uart_stats_t stats;
+	port_init(NULL, false);
+	SimUartReceive(UART_NUM, source, 200);
+	SimRunTasks();
+	CHECK(data_calls == 1);
+	CHECK(UartReadBuffer(PORT, buf, 150));
+	CHECK(!memcmp(buf, source, 150));
+	CHECK(UartReadByte(PORT, buf));
+	CHECK(buf[0] == source[150]);
+	CHECK(UartWriteNonBlocking(PORT, "hola", 4) == 4);
+	UartSendString(PORT, "chau\r\n");
+	SimUartEvent(UART_NUM, UART_FRAME_ERR);
+	SimUartEvent(UART_NUM, UART_FRAME_ERR);
+	SimUartEvent(UART_NUM, UART_PARITY_ERR);
+	SimUartEvent(UART_NUM, UART_BREAK);
+	SimUartEvent(UART_NUM, UART_BUFFER_FULL);
+	SimRunTasks();
+	UartGetStats(PORT, &stats);
+	CHECK(stats.bytes_in == 151);
+	CHECK(stats.bytes_out == 10);
+	CHECK(stats.frame_errors == 2);
+	CHECK(stats.parity_errors == 1);
+	CHECK(stats.breaks == 1);
+	CHECK(stats.buffer_full == 1);
+	CHECK(stats.fifo_overflows == 0);
+	CHECK(stats.long_lines == 0);
+	/* the events waiting at once, and the most bytes not read */
+	CHECK(stats.queue_peak == 5);
+	CHECK(stats.rx_peak == 200);
+	/* what was sent reaches the line */
+	const uint8_t *line;
+	SimAdvanceMs(10);
+	CHECK(SimUartLine(UART_NUM, &line) == 10);
+	CHECK(!memcmp(line, "holachau\r\n", 10));
+	UartResetStats(PORT);
+	UartGetStats(PORT, &stats);
+	CHECK((stats.bytes_in == 0) && (stats.frame_errors == 0) && (stats.queue_peak == 0) && (stats.rx_peak == 0));
+}
+
+static void test_overflow_bytes(void){
+	uint8_t buf[256];
+	uart_stats_t stats;
+	port_init(NULL, false);
+	/* bytes not read when the FIFO overflows are discarded: the next read is the new data */
+	SimUartReceive(UART_NUM, source, 100);
+	SimUartEvent(UART_NUM, UART_FIFO_OVF);
+	SimRunTasks();
+	CHECK(SimUartBuffered(UART_NUM) == 0);
+	SimUartReceive(UART_NUM, source + 1000, 20);
+	SimRunTasks();
+	memset(buf, 0, sizeof(buf));
+	CHECK(UartReadBuffer(PORT, buf, sizeof(buf)));
+	CHECK(!memcmp(buf, source + 1000, 20) && (buf[20] == 0));
+	UartGetStats(PORT, &stats);
+	CHECK(stats.fifo_overflows == 1);
+	CHECK(stats.bytes_in == 20);
+	/* in a receive stream too, and its peak counts the stream and the driver buffer */
+	port_init(NULL, true);
+	SimUartReceive(UART_NUM, source, 1024);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, source + 1024, 300);
+	SimRunTasks();
+	UartGetStats(PORT, &stats);
+	CHECK(stats.rx_peak == 1324);
+	SimUartEvent(UART_NUM, UART_FIFO_OVF);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 0);
+	CHECK(SimUartBuffered(UART_NUM) == 0);
+}
+
+static void test_lines(void){
+	char text[UART_LINE_MAX * 3];
+	uart_stats_t stats;
+	port_init(on_line, false);
+	SimUartReceive(UART_NUM, "led 1 on\r\nled 2 off\n", 20);
+	SimRunTasks();
+	CHECK(n_lines == 2);
+	CHECK(!strcmp(lines[0], "led 1 on") && !strcmp(lines[1], "led 2 off"));
+	/* the longest line, and a longer one received whole: discarded */
+	memset(text, 'a', sizeof(text));
+	text[UART_LINE_MAX] = '\n';
+	text[UART_LINE_MAX + 1 + 200] = '\n';
+	SimUartReceive(UART_NUM, text, UART_LINE_MAX + 1 + 201);
+	SimUartReceive(UART_NUM, "next\n", 5);
+	SimRunTasks();
+	CHECK(n_lines == 4);
+	CHECK(strlen(lines[2]) == UART_LINE_MAX);
+	CHECK(!strcmp(lines[3], "next"));
+	/* a longer one received in pieces: no part of it is delivered as a line */
+	n_lines = 0;
+	memset(text, 'a', sizeof(text));
+	SimUartReceive(UART_NUM, text, 150);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, text, 50);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, "\nnext\n", 6);
+	SimRunTasks();
+	CHECK(n_lines == 1);
+	CHECK(!strcmp(lines[0], "next"));
+	/* the longest line ended by "\r\n" waits for its '\n' */
+	n_lines = 0;
+	text[UART_LINE_MAX] = '\r';
+	SimUartReceive(UART_NUM, text, UART_LINE_MAX + 1);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, "\n", 1);
+	SimRunTasks();
+	CHECK(n_lines == 1);
+	CHECK(strlen(lines[0]) == UART_LINE_MAX);
+	UartGetStats(PORT, &stats);
+	CHECK(stats.long_lines == 2);
+	/* overflow in the middle of a line: its rest is not a line either */
+	n_lines = 0;
+	SimUartReceive(UART_NUM, "led 1 o", 7);
+	SimUartEvent(UART_NUM, UART_FIFO_OVF);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, "n\nled 2 on\n", 11);
+	SimRunTasks();
+	CHECK(n_lines == 1);
+	CHECK(!strcmp(lines[0], "led 2 on"));
+	UartGetStats(PORT, &stats);
+	CHECK(stats.long_lines == 2);
+	CHECK(stats.fifo_overflows == 1);
+}
+
+static void test_rx_watermark(void){
+	uint8_t buf[256];
+	uart_watermark_config_t wm = {.rx_high = 300, .rx_low = 100, .func_p = on_watermark, .param_p = calls};
+	port_init(NULL, false);
+	UartSetWatermark(PORT, &wm);
+	SimUartReceive(UART_NUM, source, 299);
+	SimRunTasks();
+	CHECK(n_calls == 0);
+	/* reported once on the way up, however high it goes */
+	SimUartReceive(UART_NUM, source, 1);
+	SimRunTasks();
+	SimUartReceive(UART_NUM, source, 200);
+	SimRunTasks();
+	CHECK(!strcmp(calls, "R"));
+	/* between the watermarks: nothing; at the low one: once */
+	UartReadBuffer(PORT, buf, 250);
+	CHECK(!strcmp(calls, "R"));
+	UartReadBuffer(PORT, buf, 150);
+	CHECK(!strcmp(calls, "Rr"));
+	UartReadBuffer(PORT, buf, 50);
+	SimUartReceive(UART_NUM, source, 150);
+	SimRunTasks();
+	CHECK(!strcmp(calls, "Rr"));
+	SimUartReceive(UART_NUM, source, 200);
+	SimRunTasks();
+	CHECK(!strcmp(calls, "RrR"));
+	/* disabled: no more calls, and enabled again from low */
+	UartSetWatermark(PORT, NULL);
+	UartReadBuffer(PORT, buf, 250);
+	UartReadBuffer(PORT, buf, 250);
+	CHECK(n_calls == 3);
+	UartSetWatermark(PORT, &wm);
+	SimUartReceive(UART_NUM, source, 300);
+	SimRunTasks();
+	CHECK(!strcmp(calls, "RrRR"));
+	/* in a receive stream, released views lower it */
+	const uint8_t *view;
+	port_init(NULL, true);
+	UartSetWatermark(PORT, &wm);
+	SimUartReceive(UART_NUM, source, 400);
+	SimRunTasks();
+	CHECK(!strcmp(calls, "R"));
+	CHECK(UartRxView(PORT, &view, 0) == 400);
+	UartRxRelease(PORT, 299);
+	CHECK(!strcmp(calls, "R"));
+	UartRxRelease(PORT, 1);
+	CHECK(!strcmp(calls, "Rr"));
+}
+
+static void test_tx_watermark(void){
+	uart_watermark_config_t wm = {.tx_high = 600, .tx_low = 200, .func_p = on_watermark, .param_p = calls};
+	port_init(NULL, false);
+	UartSetWatermark(PORT, &wm);
+	/* the receive backlog is not watched (rx_high 0) */
+	SimUartReceive(UART_NUM, source, 1000);
+	SimRunTasks();
+	uint32_t room = UartTxFree(PORT);
+	CHECK((room > TX_SIZE / 2) && (room < TX_SIZE));
+	CHECK(UartWriteNonBlocking(PORT, source, 599) == 599);
+	CHECK(n_calls == 0);
+	/* full: only what fits is taken (less than the free data bytes: item headers) */
+	room = UartTxFree(PORT);
+	CHECK((room > 0) && (room < TX_SIZE - 599));
+	CHECK(UartWriteNonBlocking(PORT, source, 1000) == room);
+	CHECK(!strcmp(calls, "T"));
+	CHECK(UartTxFree(PORT) == 0);
+	CHECK(UartWriteNonBlocking(PORT, source, 1000) == 0);
+	CHECK(SimUartTxWaits(UART_NUM) == 0);
+	CHECK(!strcmp(calls, "T"));
+	/* drained by the line: reported when a write or UartTxFree() sees it */
+	SimUartSend(UART_NUM, SimUartTxPending(UART_NUM) - 201);
+	UartTxFree(PORT);
+	CHECK(!strcmp(calls, "T"));
+	SimUartSend(UART_NUM, 1);
+	CHECK(SimUartTxPending(UART_NUM) == 200);
+	UartTxFree(PORT);
+	CHECK(!strcmp(calls, "Tt"));
+	UartTxFree(PORT);
+	CHECK(!strcmp(calls, "Tt"));
+	/* a blocking write above it is reported too */
+	UartWriteBlocking(PORT, source, 500);
+	CHECK(!strcmp(calls, "TtT"));
+	uart_stats_t stats;
+	UartGetStats(PORT, &stats);
+	CHECK(stats.bytes_out == 599 + room + 500);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	for(uint32_t i = 0; i < sizeof(source); i++){
+		source[i] = TestRandom();
+	}
+	test_counters();
+	test_overflow_bytes();
+	test_lines();
+	test_rx_watermark();
+	test_tx_watermark();
+	return TEST_END("uart_stats");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,252 @@
+/**
+ * @file test_uart_stream.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of the receive stream of uart_mcu.c, on the simulated IDF driver (stubs/idf_sim.h):
+ * views and their wrap around, the stream full with data waiting in the driver, random arrivals
+ * and reads against the sent bytes, RX FIFO overflows (views never join bytes across the gap)
+ * and stream sizes that are not a power of 2.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "test.h"
+#include "idf_sim.h"
+#include "freertos/task.h"
+#include "uart_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define PORT		UART_CONNECTOR
+#define UART_NUM	UART_NUM_1
+#define N_SOURCE	300000
+#define MAX_GAPS	1000
+
+/*==================[internal data definition]===============================*/
+static uint8_t source[N_SOURCE];
+static uint8_t storage[4096];
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Port initialized with a receive stream of size bytes (and a driver buffer of rx_buffer_size)
+ */
+static void stream_init(uint32_t size, uint32_t rx_buffer_size){
+	SimReset();
+	serial_config_t config = {
+		.port = PORT,
+		.baud_rate = 921600,
+		.func_p = UART_NO_INT,
+		.rx_stream = storage,
+		.rx_stream_size = size,
+		.rx_buffer_size = rx_buffer_size,
+	};
+	UartInit(&config);
+	UartResetStats(PORT);
+}
+
+static void test_views(void){
+	const uint8_t *view;
+	stream_init(64, 256);
+	CHECK(UartRxView(PORT, &view, 0) == 0);
+	CHECK(SimUartReceive(UART_NUM, source, 50) == 50);
+	/* moved to the stream by the event task */
+	CHECK(UartRxAvailable(PORT) == 0);
+	SimRunTasks();
+	CHECK(SimUartBuffered(UART_NUM) == 0);
+	CHECK(UartRxAvailable(PORT) == 50);
+	CHECK(UartRxView(PORT, &view, 0) == 50);
+	CHECK((view == storage) && !memcmp(view, source, 50));
+	/* partial release: the rest is viewed again */
+	UartRxRelease(PORT, 30);
+	CHECK(UartRxView(PORT, &view, 0) == 20);
+	CHECK(view == &storage[30]);
+	/* wrap around: the view ends at the end of the storage */
+	SimUartReceive(UART_NUM, source + 50, 40);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 60);
+	CHECK(UartRxView(PORT, &view, 0) == 34);
+	CHECK(!memcmp(view, source + 30, 34));
+	UartRxRelease(PORT, 34);
+	CHECK(UartRxView(PORT, &view, 0) == 26);
+	CHECK((view == storage) && !memcmp(view, source + 64, 26));
+	/* more than available: only what there is */
+	UartRxRelease(PORT, 1000);
+	CHECK(UartRxAvailable(PORT) == 0);
+	uart_stats_t stats;
+	UartGetStats(PORT, &stats);
+	CHECK(stats.bytes_in == 90);
+	/* waiting for data that does not come: the whole timeout */
+	TickType_t start = xTaskGetTickCount();
+	CHECK(UartRxView(PORT, &view, 50) == 0);
+	CHECK(xTaskGetTickCount() - start == 50);
+}
+
+static void test_full(void){
+	const uint8_t *view;
+	stream_init(256, 512);
+	/* more than the stream holds: the rest waits in the driver buffer, the rest of that is lost */
+	CHECK(SimUartReceive(UART_NUM, source, 600) == 512);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 256);
+	CHECK(SimUartBuffered(UART_NUM) == 256);
+	/* a release wakes the event task to move more */
+	CHECK(UartRxView(PORT, &view, 0) == 256);
+	UartRxRelease(PORT, 100);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 256);
+	CHECK(SimUartBuffered(UART_NUM) == 156);
+	uint32_t read = 100;
+	while(UartRxAvailable(PORT)){
+		uint32_t n = UartRxView(PORT, &view, 0);
+		n = (n > 37) ? 37 : n;
+		CHECK(!memcmp(view, source + read, n));
+		read += n;
+		UartRxRelease(PORT, n);
+		SimRunTasks();
+	}
+	CHECK(read == 512);
+	uart_stats_t stats;
+	UartGetStats(PORT, &stats);
+	CHECK(stats.bytes_in == 512);
+	CHECK(stats.buffer_full == 1);
+	CHECK(stats.fifo_overflows == 0);
+}
+
+/**
+ * @brief Random arrivals, reads and overflows (bytes lost and UART_FIFO_OVF)
+ *
+ * Every view must be contiguous source bytes, starting where the last one ended or at the first
+ * byte received after a gap, and never with bytes received before the last overflow.
+ */
+static void test_random(void){
+	static uint32_t gaps[MAX_GAPS];
+	uint32_t n_gaps = 0, sent = 0, expected = 0, first_valid = 0, overflows = 0, joined = 0, viewed = 0;
+	stream_init(4096, 1024);
+	while((sent < N_SOURCE) || UartRxAvailable(PORT) || SimUartBuffered(UART_NUM)){
+		/* arrivals, up to the room in the driver buffer */
+		if((sent < N_SOURCE) && (TestRandom() % 2)){
+			uint32_t n = TestRandom() % 700;
+			uint32_t room = 1024 - SimUartBuffered(UART_NUM);
+			n = (n > room) ? room : n;
+			n = (n > N_SOURCE - sent) ? N_SOURCE - sent : n;
+			sent += SimUartReceive(UART_NUM, source + sent, n);
+		}
+		if((sent < N_SOURCE - 1000) && (n_gaps < MAX_GAPS) && (TestRandom() % 100 == 0)){
+			/* bytes lost in the FIFO: what comes next is not contiguous */
+			sent += 1 + TestRandom() % 500;
+			gaps[n_gaps++] = sent;
+			SimUartEvent(UART_NUM, UART_FIFO_OVF);
+			SimRunTasks();
+			first_valid = sent;
+			overflows++;
+		}
+		if(TestRandom() % 3 == 0){
+			SimRunTasks();
+		}
+		/* reads of random lengths */
+		const uint8_t *view;
+		uint32_t n = UartRxView(PORT, &view, 0);
+		if(n == 0){
+			SimRunTasks();
+			continue;
+		}
+		uint32_t take = 1 + TestRandom() % n;
+		uint32_t start = expected;
+		for(uint32_t g = 0; (g < n_gaps) && memcmp(view, source + start, take); g++){
+			start = (gaps[g] > expected) ? gaps[g] : start;
+		}
+		joined += (start + take > N_SOURCE) || memcmp(view, source + start, take) || (start < first_valid);
+		expected = start + take;
+		viewed += take;
+		UartRxRelease(PORT, take);
+	}
+	if(joined){
+		fprintf(stderr, "%u views with bytes across a gap or from before an overflow\n", joined);
+	}
+	CHECK(joined == 0);
+	CHECK(overflows > 10);
+	uart_stats_t stats;
+	UartGetStats(PORT, &stats);
+	CHECK(stats.fifo_overflows == overflows);
+	/* the bytes read from the driver, viewed or discarded after an overflow */
+	CHECK(stats.bytes_in >= viewed);
+	CHECK(stats.bytes_in <= sent);
+}
+
+static void test_held_view(void){
+	const uint8_t *view;
+	stream_init(1024, 256);
+	SimUartReceive(UART_NUM, source, 200);
+	SimRunTasks();
+	CHECK(UartRxView(PORT, &view, 0) == 200);
+	/* overflow while the reader holds a view: what it did not release is discarded */
+	SimUartEvent(UART_NUM, UART_FIFO_OVF);
+	SimRunTasks();
+	UartRxRelease(PORT, 50);
+	CHECK(UartRxAvailable(PORT) == 0);
+	SimUartReceive(UART_NUM, source + 1000, 100);
+	SimRunTasks();
+	CHECK(UartRxView(PORT, &view, 0) == 100);
+	CHECK(!memcmp(view, source + 1000, 100));
+	/* data still in the driver buffer at the overflow is discarded too */
+	UartRxRelease(PORT, 100);
+	SimUartReceive(UART_NUM, source, 80);
+	SimUartEvent(UART_NUM, UART_FIFO_OVF);
+	SimUartReceive(UART_NUM, source + 2000, 30);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 0);
+	SimUartReceive(UART_NUM, source + 3000, 10);
+	SimRunTasks();
+	CHECK(UartRxView(PORT, &view, 0) == 10);
+	CHECK(!memcmp(view, source + 3000, 10));
+}
+
+static void test_sizes(void){
+	const uint8_t *view;
+	/* not a power of 2: the largest that fits, reported */
+	uint32_t errors = SimLogCount('E');
+	stream_init(1000, 2048);
+	CHECK(SimLogCount('E') == errors + 1);
+	CHECK(strstr(SimLastLog(), "1000") && strstr(SimLastLog(), "512"));
+	SimUartReceive(UART_NUM, source, 1000);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 512);
+	CHECK(UartRxView(PORT, &view, 0) == 512);
+	CHECK(!memcmp(view, source, 512));
+	UartRxRelease(PORT, 512);
+	SimRunTasks();
+	CHECK(UartRxView(PORT, &view, 0) == 488);
+	CHECK((view == storage) && !memcmp(view, source + 512, 488));
+	/* too small: no stream */
+	stream_init(1, 256);
+	CHECK(SimLogCount('E') == errors + 2);
+	CHECK(strstr(SimLastLog(), "too small"));
+	SimUartReceive(UART_NUM, source, 10);
+	SimRunTasks();
+	CHECK(UartRxView(PORT, &view, 0) == 0);
+	CHECK(UartRxAvailable(PORT) == 0);
+	/* powers of 2 are used whole, silently */
+	stream_init(2, 256);
+	stream_init(4096, 256);
+	CHECK(SimLogCount('E') == errors + 2);
+	SimUartReceive(UART_NUM, source, 256);
+	SimRunTasks();
+	CHECK(UartRxAvailable(PORT) == 256);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	for(int i = 0; i < N_SOURCE; i++){
+		source[i] = TestRandom();
+	}
+	test_views();
+	test_full();
+	test_random();
+	test_held_view();
+	test_sizes();
+	return TEST_END("uart_stream");
+}
+/*==================[end of file]============================================*/
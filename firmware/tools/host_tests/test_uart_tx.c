@@ -0,0 +1,148 @@
+/**
+ * @file test_uart_tx.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Test of the transmit room of uart_mcu.c, on the simulated IDF driver (stubs/idf_sim.h),
+ * whose ring buffer stores the items of uart_write_bytes() as the IDF one (headers, alignment,
+ * no item split at the end): non-blocking writes and the room UartTxFree() reports never make
+ * the driver wait, with writes of every size (many small ones, chunks and the whole buffer)
+ * mixed with blocking writes, and the line gets every accepted byte in order.
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "test.h"
+#include "idf_sim.h"
+#include "uart_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define PORT		UART_CONNECTOR
+#define UART_NUM	UART_NUM_1
+
+/*==================[internal data definition]===============================*/
+static uint8_t source[16384];
+static uint8_t sent[SIM_LINE_CAPTURE];
+static uint32_t n_sent;
+
+/*==================[internal functions definition]==========================*/
+static void port_init(uint32_t tx_size){
+	SimReset();
+	serial_config_t config = {.port = PORT, .baud_rate = 115200, .func_p = UART_NO_INT, .tx_buffer_size = tx_size};
+	UartInit(&config);
+	n_sent = 0;
+}
+
+/**
+ * @brief Writes from a random position of source, keeping what is accepted
+ */
+static uint32_t write(uint32_t n, bool blocking){
+	uint32_t from = TestRandom() % (sizeof(source) - n);
+	uint32_t accepted = blocking ? UartWriteBlocking(PORT, &source[from], n) : UartWriteNonBlocking(PORT, &source[from], n);
+	CHECK(accepted <= n);
+	if(n_sent < sizeof(sent)){
+		memcpy(&sent[n_sent], &source[from], (accepted < sizeof(sent) - n_sent) ? accepted : sizeof(sent) - n_sent);
+	}
+	n_sent += accepted;
+	return accepted;
+}
+
+/**
+ * @brief Every byte accepted reached the line, in order
+ */
+static void check_line(void){
+	const uint8_t *line;
+	CHECK(UartTxFlush(PORT, 1000));
+	CHECK(SimUartLine(UART_NUM, &line) == n_sent);
+	CHECK(memcmp(line, sent, (n_sent < sizeof(sent)) ? n_sent : sizeof(sent)) == 0);
+}
+
+/**
+ * @brief Many small writes: each one takes two items, far more than its data
+ */
+static void test_small_writes(uint32_t tx_size){
+	port_init(tx_size);
+	uint32_t writes = 0;
+	while((writes < tx_size) && (write(1 + writes % 3, false) > 0)){
+		writes++;
+	}
+	CHECK((writes > tx_size / 64) && (writes < tx_size));
+	CHECK(UartTxFree(PORT) == 0);
+	CHECK(SimUartTxWaits(UART_NUM) == 0);
+	/* room again once they are sent */
+	SimUartSend(UART_NUM, SimUartTxPending(UART_NUM));
+	CHECK(UartTxFree(PORT) > tx_size / 2);
+	check_line();
+}
+
+/**
+ * @brief The room of an empty buffer, in a single write and in the largest writes that fit
+ */
+static void test_whole_buffer(uint32_t tx_size){
+	port_init(tx_size);
+	uint32_t room = UartTxFree(PORT);
+	/* headers, alignment and room for a chunk that does not fit at the end */
+	CHECK((room > tx_size / 2) && (room < tx_size));
+	CHECK(write(tx_size, false) == room);
+	CHECK(UartTxFree(PORT) == 0);
+	CHECK(SimUartTxWaits(UART_NUM) == 0);
+	for(int k = 0; k < 50; k++){
+		SimUartSend(UART_NUM, TestRandom() % (tx_size / 2));
+		room = UartTxFree(PORT);
+		CHECK(write(room + 1, false) == room);
+	}
+	CHECK(SimUartTxWaits(UART_NUM) == 0);
+	check_line();
+}
+
+/**
+ * @brief Random writes of every kind and random line drains
+ */
+static void test_random(uint32_t tx_size){
+	port_init(tx_size);
+	uint32_t blocking_waits = 0;
+	while(n_sent < sizeof(sent) - 2 * tx_size){
+		uint32_t n = 1 + (TestRandom() >> (TestRandom() % 32)) % (2 * tx_size);
+		switch(TestRandom() % 8){
+			case 0:{
+				/* a blocking write may wait: not counted */
+				uint32_t before = SimUartTxWaits(UART_NUM);
+				CHECK(write(n, true) == n);
+				blocking_waits += SimUartTxWaits(UART_NUM) - before;
+				break;
+			}
+			case 1:{
+				uint32_t room = UartTxFree(PORT);
+				CHECK(write((n < room) ? n : room, false) == ((n < room) ? n : room));
+				break;
+			}
+			case 2:
+			case 3:
+				SimUartSend(UART_NUM, TestRandom() % tx_size);
+				break;
+			default:
+				write(n, false);
+				break;
+		}
+	}
+	CHECK(SimUartTxWaits(UART_NUM) == blocking_waits);
+	check_line();
+}
+
+/*==================[external functions definition]==========================*/
+int main(void){
+	for(uint32_t i = 0; i < sizeof(source); i++){
+		source[i] = TestRandom();
+	}
+	const uint32_t sizes[] = {256, 1000, 2048, 4096};
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+		test_small_writes(sizes[i]);
+		test_whole_buffer(sizes[i]);
+		test_random(sizes[i]);
+	}
+	return TEST_END("uart_tx");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,24 @@
+# Deferred log round trip (ctest dlog_round_trip), run with cmake -P:
+#   -DTEST_DLOG=<test_dlog> -DLOG_DECODER=<log_decoder> -DWORK_DIR=<directory for the files>
+# test_dlog writes the telemetry its DLOG messages produce and the lines expected from them:
+# log_decoder, given test_dlog itself as the firmware ELF, must print exactly those lines.
+set(capture ${WORK_DIR}/dlog_capture.bin)
+set(expected ${WORK_DIR}/dlog_expected.txt)
+set(decoded ${WORK_DIR}/dlog_decoded.txt)
+
+execute_process(COMMAND ${TEST_DLOG} ${capture} ${expected} RESULT_VARIABLE result)
+if(result)
+	message(FATAL_ERROR "test_dlog failed (${result})")
+endif()
+execute_process(COMMAND ${LOG_DECODER} ${TEST_DLOG} ${capture} OUTPUT_FILE ${decoded}
+	ERROR_VARIABLE counters RESULT_VARIABLE result)
+message(STATUS "log_decoder: ${counters}")
+if(result)
+	message(FATAL_ERROR "log_decoder failed (${result}): errors, lost frames or unknown format ids")
+endif()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${decoded} ${expected} RESULT_VARIABLE different)
+if(different)
+	file(READ ${decoded} decoded_text)
+	file(READ ${expected} expected_text)
+	message(FATAL_ERROR "decoded messages differ\n${decoded_text}expected\n${expected_text}")
+endif()
@@ -0,0 +1,344 @@
+/**
+ * @file log_decoder.cpp
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Prints the log messages of a telemetry stream, formatting the deferred ones
+ * (drivers/utils/inc/dlog.h) with the format strings of the firmware ELF.
+ *
+ * The format strings are read from the .logfmt section of the ELF (not loaded to the ESP32):
+ * the id of a message is the offset of its format string in that section. Arguments are
+ * decoded following the format string conversions, as the firmware encoded them by type:
+ * - %d %i %u %x %X %o %c %b and %p: 32 bits zigzag varint (64 bits with ll or j)
+ * - %f %e %g %a: float
+ * - %s: length (varint) and characters
+ * - %D: fixed point decimal, as FmtPrintf() ("%.2D" prints 2534 as "25.34")
+ *
+ * Usage:
+ *   log_decoder firmware.elf [file]
+ *
+ * @version 0.1
+ * @date 2024-07-26
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "telemetry_decoder.hpp"
+extern "C" {
+#include "varint.h"
+}
+
+/*==================[macros and definitions]=================================*/
+namespace {
+
+constexpr size_t LOG_HEADER_LEN = 5;		/* level and timestamp */
+const char LOG_LETTERS[] = "EWID";
+
+template <typename T>
+T readLe(const uint8_t *p){
+	T value;
+	std::memcpy(&value, p, sizeof(T));
+	return value;
+}
+
+/**
+ * @brief Reads the contents of a section of an ELF file (32 or 64 bits, little endian)
+ */
+bool readElfSection(const char *path, const char *name, std::vector<char> &contents){
+	FILE *f = std::fopen(path, "rb");
+	if(f == nullptr){
+		std::perror(path);
+		return false;
+	}
+	std::vector<uint8_t> elf;
+	uint8_t buf[4096];
+	size_t n;
+	while((n = std::fread(buf, 1, sizeof(buf), f)) > 0){
+		elf.insert(elf.end(), buf, buf + n);
+	}
+	std::fclose(f);
+	if((elf.size() < 64) || std::memcmp(elf.data(), "\x7f" "ELF", 4) || (elf[5] != 1)){
+		std::fprintf(stderr, "%s: not a little endian ELF file\n", path);
+		return false;
+	}
+	bool elf64 = (elf[4] == 2);
+	uint64_t shoff = elf64 ? readLe<uint64_t>(&elf[0x28]) : readLe<uint32_t>(&elf[0x20]);
+	uint16_t shentsize = readLe<uint16_t>(&elf[elf64 ? 0x3A : 0x2E]);
+	uint16_t shnum = readLe<uint16_t>(&elf[elf64 ? 0x3C : 0x30]);
+	uint16_t shstrndx = readLe<uint16_t>(&elf[elf64 ? 0x3E : 0x32]);
+	if((shstrndx >= shnum) || (shoff + static_cast<uint64_t>(shnum) * shentsize > elf.size())){
+		std::fprintf(stderr, "%s: bad section table\n", path);
+		return false;
+	}
+	/* name, offset and size of a section header */
+	auto section = [&](uint16_t i, uint32_t &sh_name, uint64_t &offset, uint64_t &size){
+		const uint8_t *sh = &elf[shoff + static_cast<uint64_t>(i) * shentsize];
+		sh_name = readLe<uint32_t>(sh);
+		offset = elf64 ? readLe<uint64_t>(sh + 0x18) : readLe<uint32_t>(sh + 0x10);
+		size = elf64 ? readLe<uint64_t>(sh + 0x20) : readLe<uint32_t>(sh + 0x14);
+		return offset + size <= elf.size();
+	};
+	uint32_t sh_name;
+	uint64_t names, names_size, offset, size;
+	if(!section(shstrndx, sh_name, names, names_size)){
+		return false;
+	}
+	for(uint16_t i = 0; i < shnum; i++){
+		if(section(i, sh_name, offset, size) && (sh_name < names_size) &&
+				(std::strncmp(reinterpret_cast<const char *>(&elf[names + sh_name]), name, names_size - sh_name) == 0)){
+			contents.assign(elf.begin() + offset, elf.begin() + offset + size);
+			return true;
+		}
+	}
+	std::fprintf(stderr, "%s: no %s section (no DLOG messages in this firmware?)\n", path, name);
+	return false;
+}
+
+/**
+ * @brief Formats a deferred message: format string conversions filled with the encoded arguments
+ */
+std::string formatMessage(const char *format, const uint8_t *p, const uint8_t *end){
+	std::string out;
+	char text[128];
+	bool missing = false;
+	auto getInt = [&](bool wide, int64_t &value){
+		if(wide){
+			uint64_t v;
+			const uint8_t *next = VarintGet64(p, end, &v);
+			if(next == nullptr){
+				return false;
+			}
+			p = next;
+			value = ZigzagDecode64(v);
+		}else{
+			uint32_t v;
+			const uint8_t *next = VarintGet32(p, end, &v);
+			if(next == nullptr){
+				return false;
+			}
+			p = next;
+			value = ZigzagDecode32(v);
+		}
+		return true;
+	};
+	while(*format != '\0'){
+		if(*format != '%'){
+			out += *format++;
+			continue;
+		}
+		const char *start = format++;
+		if(*format == '%'){
+			out += '%';
+			format++;
+			continue;
+		}
+		/* flags, width and precision are passed on to snprintf; '*' takes an argument */
+		std::string spec = "%";
+		int precision = -1;
+		while(std::strchr("-+ #0", *format) != nullptr && *format != '\0'){
+			spec += *format++;
+		}
+		for(int part = 0; part < 2; part++){
+			if(part == 1){
+				if(*format != '.'){
+					break;
+				}
+				spec += *format++;
+				precision = 0;
+			}
+			if(*format == '*'){
+				int64_t value;
+				if(missing || !getInt(false, value)){
+					missing = true;
+					value = 0;
+				}
+				spec += std::to_string(value);
+				if(part == 1){
+					precision = static_cast<int>(value);
+				}
+				format++;
+			}
+			while((*format >= '0') && (*format <= '9')){
+				if(part == 1){
+					precision = precision * 10 + (*format - '0');
+				}
+				spec += *format++;
+			}
+		}
+		/* length modifiers: only 64 bits integers change the encoding */
+		int shorts = 0;
+		bool wide = false;
+		while(std::strchr("hlLjzt", *format) != nullptr && *format != '\0'){
+			if(*format == 'h'){
+				shorts++;
+			}else if((*format == 'j') || ((*format == 'l') && (format[1] == 'l'))){
+				wide = true;
+			}
+			format += ((*format == 'l') && (format[1] == 'l')) ? 2 : 1;
+		}
+		char conversion = *format;
+		if(conversion == '\0'){
+			out.append(start);
+			break;
+		}
+		format++;
+		if(missing){
+			out += "<?>";
+			continue;
+		}
+		text[0] = '\0';
+		switch(conversion){
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+			case 'c':
+			case 'b':
+			case 'p':
+			case 'D':{
+				int64_t value;
+				if(!getInt(wide, value)){
+					missing = true;
+					break;
+				}
+				if(shorts == 1){
+					value = ((conversion == 'd') || (conversion == 'i')) ? static_cast<int16_t>(value) : static_cast<uint16_t>(value);
+				}else if(shorts >= 2){
+					value = ((conversion == 'd') || (conversion == 'i')) ? static_cast<int8_t>(value) : static_cast<uint8_t>(value);
+				}
+				uint64_t bits = wide ? static_cast<uint64_t>(value) : static_cast<uint32_t>(value);
+				if(conversion == 'd' || conversion == 'i'){
+					std::snprintf(text, sizeof(text), (spec + "lld").c_str(), static_cast<long long>(value));
+				}else if(conversion == 'c'){
+					std::snprintf(text, sizeof(text), (spec + "c").c_str(), static_cast<int>(value));
+				}else if(conversion == 'p'){
+					std::snprintf(text, sizeof(text), "0x%08llx", static_cast<unsigned long long>(bits));
+				}else if(conversion == 'b'){
+					std::string digits;
+					do{
+						digits.insert(digits.begin(), static_cast<char>('0' + (bits & 1)));
+						bits >>= 1;
+					}while(bits);
+					std::snprintf(text, sizeof(text), (spec + "s").c_str(), digits.c_str());
+				}else if(conversion == 'D'){
+					/* fixed point: value scaled by 10^precision */
+					int decimals = (precision > 0) ? ((precision < 18) ? precision : 18) : 0;
+					long long scale = 1;
+					for(int i = 0; i < decimals; i++){
+						scale *= 10;
+					}
+					unsigned long long magnitude = (value < 0) ? -static_cast<unsigned long long>(value) : value;
+					char number[64];
+					if(decimals){
+						std::snprintf(number, sizeof(number), "%s%llu.%0*llu", (value < 0) ? "-" : "",
+							magnitude / scale, decimals, magnitude % scale);
+					}else{
+						std::snprintf(number, sizeof(number), "%s%llu", (value < 0) ? "-" : "", magnitude);
+					}
+					std::string fixed = spec.substr(0, spec.find('.'));
+					std::snprintf(text, sizeof(text), (fixed + "s").c_str(), number);
+				}else{
+					std::snprintf(text, sizeof(text), (spec + "ll" + conversion).c_str(), static_cast<unsigned long long>(bits));
+				}
+				break;
+			}
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				if(end - p < 4){
+					missing = true;
+					break;
+				}
+				std::snprintf(text, sizeof(text), (spec + conversion).c_str(), static_cast<double>(readLe<float>(p)));
+				p += 4;
+				break;
+			case 's':{
+				uint32_t len;
+				const uint8_t *next = VarintGet32(p, end, &len);
+				if((next == nullptr) || (static_cast<uint32_t>(end - next) < len)){
+					missing = true;
+					break;
+				}
+				std::string value(reinterpret_cast<const char *>(next), len);
+				p = next + len;
+				std::snprintf(text, sizeof(text), (spec + "s").c_str(), value.c_str());
+				break;
+			}
+			default:
+				/* not a conversion: printed as it is */
+				out.append(start, format);
+				continue;
+		}
+		out += missing ? "<?>" : text;
+	}
+	return out;
+}
+
+} // namespace
+
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	if((argc < 2) || (argc > 3)){
+		std::fprintf(stderr, "usage: %s firmware.elf [file]\n", argv[0]);
+		return 2;
+	}
+	std::vector<char> formats;
+	if(!readElfSection(argv[1], ".logfmt", formats)){
+		return 2;
+	}
+	FILE *in = stdin;
+	if((argc == 3) && (std::strcmp(argv[2], "-") != 0)){
+		in = std::fopen(argv[2], "rb");
+		if(in == nullptr){
+			std::perror(argv[2]);
+			return 2;
+		}
+	}
+	uint64_t unknown = 0;
+	telemetry::Decoder decoder([&](const telemetry::Record &r){
+		if((r.type != TELEMETRY_LOG_TEXT) && (r.type != TELEMETRY_LOG)){
+			return;
+		}
+		std::string message = r.text;
+		if(r.type == TELEMETRY_LOG){
+			const uint8_t *p = r.payload.data() + LOG_HEADER_LEN;
+			const uint8_t *end = r.payload.data() + r.payload.size();
+			uint32_t id;
+			p = VarintGet32(p, end, &id);
+			if((p == nullptr) || (id >= formats.size())){
+				/* an ELF of another build */
+				unknown++;
+				message = "<unknown format id>";
+			}else{
+				message = formatMessage(&formats[id], p, end);
+			}
+		}
+		std::printf("[%u.%03u] %c: %s\n", static_cast<unsigned>(r.timestamp / 1000), static_cast<unsigned>(r.timestamp % 1000),
+			(r.channel < sizeof(LOG_LETTERS) - 1) ? LOG_LETTERS[r.channel] : '?', message.c_str());
+	});
+	uint8_t buf[4096];
+	size_t n;
+	while((n = std::fread(buf, 1, sizeof(buf), in)) > 0){
+		decoder.feed(buf, n);
+		std::fflush(stdout);
+	}
+	if(in != stdin){
+		std::fclose(in);
+	}
+	const telemetry::Stats &s = decoder.stats();
+	std::fprintf(stderr, "frames: %llu, lost: %llu, errors: %llu, unknown ids: %llu\n", (unsigned long long)s.frames,
+		(unsigned long long)s.lost, (unsigned long long)s.errors(), (unsigned long long)unknown);
+	return (s.errors() || s.lost || unknown) ? 1 : 0;
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,149 @@
+/**
+ * @file telemetry_cli.cpp
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Command line decoder of the binary telemetry stream (drivers/utils/inc/telemetry.h).
+ *
+ * Reads the stream from a file, a serial port (configured beforehand, e.g. with stty) or the
+ * standard input, and prints the records, converts them to CSV or only validates the stream.
+ * Counters (frames, errors, lost frames) are printed to the standard error at the end.
+ *
+ * Usage:
+ *   telemetry_cli [-m print|csv|validate] [file]
+ *
+ * @version 0.1
+ * @date 2024-07-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "telemetry_decoder.hpp"
+
+/*==================[macros and definitions]=================================*/
+namespace {
+
+enum class Mode {
+	Print,
+	Csv,
+	Validate,
+};
+
+void printRecord(const telemetry::Record &r){
+	std::printf("#%05u %-8s", r.sequence, telemetry::typeName(r.type).c_str());
+	if(r.type == TELEMETRY_TEXT){
+		std::printf(" %s\n", r.text.c_str());
+		return;
+	}
+	if(r.type == TELEMETRY_LOG_TEXT){
+		std::printf(" [%u.%03u] %u: %s\n", static_cast<unsigned>(r.timestamp / 1000),
+			static_cast<unsigned>(r.timestamp % 1000), r.channel, r.text.c_str());
+		return;
+	}
+	if(r.type == TELEMETRY_LOG){
+		/* without the ELF only the id and the arguments can be shown (see log_decoder) */
+		std::printf(" [%u.%03u] %u:", static_cast<unsigned>(r.timestamp / 1000),
+			static_cast<unsigned>(r.timestamp % 1000), r.channel);
+		for(size_t i = 5; i < r.payload.size(); i++){
+			std::printf(" %02x", r.payload[i]);
+		}
+		std::printf("\n");
+		return;
+	}
+	if(r.type >= TELEMETRY_USER){
+		for(uint8_t b : r.payload){
+			std::printf(" %02x", b);
+		}
+		std::printf("\n");
+		return;
+	}
+	std::printf(" ch%u", r.channel);
+	if((r.type == TELEMETRY_SAMPLES) || (r.type == TELEMETRY_PACKED)){
+		std::printf(" t=%lld us fs=%u Hz", static_cast<long long>(r.timestamp), r.sample_frec);
+	}
+	std::printf(":");
+	for(double v : r.values){
+		std::printf(" %.9g", v);
+	}
+	std::printf("\n");
+}
+
+void csvRecord(const telemetry::Record &r){
+	if(r.values.empty()){
+		return;
+	}
+	for(size_t i = 0; i < r.values.size(); i++){
+		std::printf("%u,%s,%u,%zu,", r.sequence, telemetry::typeName(r.type).c_str(), r.channel, i);
+		if(((r.type == TELEMETRY_SAMPLES) || (r.type == TELEMETRY_PACKED)) && r.sample_frec){
+			std::printf("%.1f", r.timestamp + i * 1e6 / r.sample_frec);
+		}
+		std::printf(",%.9g\n", r.values[i]);
+	}
+}
+
+} // namespace
+
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	Mode mode = Mode::Print;
+	const char *path = nullptr;
+	for(int i = 1; i < argc; i++){
+		if((std::strcmp(argv[i], "-m") == 0) && (i + 1 < argc)){
+			std::string m = argv[++i];
+			if(m == "print"){
+				mode = Mode::Print;
+			}else if(m == "csv"){
+				mode = Mode::Csv;
+			}else if(m == "validate"){
+				mode = Mode::Validate;
+			}else{
+				std::fprintf(stderr, "unknown mode: %s\n", m.c_str());
+				return 2;
+			}
+		}else if(argv[i][0] == '-' && argv[i][1] != '\0'){
+			std::fprintf(stderr, "usage: %s [-m print|csv|validate] [file]\n", argv[0]);
+			return 2;
+		}else{
+			path = argv[i];
+		}
+	}
+	FILE *in = stdin;
+	if(path != nullptr && std::strcmp(path, "-") != 0){
+		in = std::fopen(path, "rb");
+		if(in == nullptr){
+			std::perror(path);
+			return 2;
+		}
+	}
+	if(mode == Mode::Csv){
+		std::printf("sequence,type,channel,index,time_us,value\n");
+	}
+	telemetry::Decoder decoder([mode](const telemetry::Record &r){
+		if(mode == Mode::Print){
+			printRecord(r);
+		}else if(mode == Mode::Csv){
+			csvRecord(r);
+		}
+	});
+	uint8_t buf[4096];
+	size_t n;
+	while((n = std::fread(buf, 1, sizeof(buf), in)) > 0){
+		decoder.feed(buf, n);
+		if(mode == Mode::Print){
+			std::fflush(stdout);
+		}
+	}
+	if(in != stdin){
+		std::fclose(in);
+	}
+	const telemetry::Stats &s = decoder.stats();
+	std::fprintf(stderr, "bytes: %llu, frames: %llu, lost: %llu, errors: %llu (cobs %llu, length %llu, crc %llu), skipped: %llu bytes\n",
+		(unsigned long long)s.bytes, (unsigned long long)s.frames, (unsigned long long)s.lost,
+		(unsigned long long)s.errors(), (unsigned long long)s.cobs_errors, (unsigned long long)s.length_errors,
+		(unsigned long long)s.crc_errors, (unsigned long long)s.skipped);
+	return (s.errors() || s.lost) ? 1 : 0;
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,316 @@
+/**
+ * @file telemetry_decoder.cpp
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host decoder of the binary telemetry stream.
+ * @version 0.1
+ * @date 2024-07-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "telemetry_decoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+namespace telemetry {
+
+/*==================[macros and definitions]=================================*/
+namespace {
+
+constexpr size_t SAMPLES_HEADER_LEN = 13;	/* channel, timestamp and sample rate */
+constexpr size_t LOG_HEADER_LEN = 5;		/* level and timestamp */
+constexpr size_t PACKED_HEADER_LEN = 15;	/* channel, timestamp, sample rate and number of samples */
+
+bool readVarint(const uint8_t *&p, const uint8_t *end, uint32_t &value){
+	value = 0;
+	for(int shift = 0; (shift < 35) && (p < end); shift += 7){
+		uint8_t byte = *p++;
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if(!(byte & 0x80)){
+			return true;
+		}
+	}
+	return false;
+}
+
+int32_t unzigzag(uint32_t value){
+	return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+/* payload values are little endian, as the ESP32 stores them */
+template <typename T>
+T readLe(const uint8_t *p){
+	T value;
+	std::memcpy(&value, p, sizeof(T));
+	return value;
+}
+
+template <typename T>
+void readValues(const uint8_t *p, size_t n, std::vector<double> &values){
+	values.reserve(n);
+	for(size_t i = 0; i < n; i++){
+		values.push_back(readLe<T>(p + i * sizeof(T)));
+	}
+}
+
+} // namespace
+
+/*==================[external functions definition]==========================*/
+uint16_t crc16(const uint8_t *data, size_t n, uint16_t crc){
+	while(n--){
+		crc ^= static_cast<uint16_t>(*data++) << 8;
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+		}
+	}
+	return crc;
+}
+
+bool cobsDecode(const uint8_t *in, size_t n, std::vector<uint8_t> &out){
+	out.clear();
+	size_t i = 0;
+	while(i < n){
+		uint8_t code = in[i++];
+		if((code == 0) || (i + code - 1 > n)){
+			return false;
+		}
+		for(uint8_t k = 1; k < code; k++){
+			if(in[i] == 0){
+				return false;
+			}
+			out.push_back(in[i++]);
+		}
+		if((code != 0xFF) && (i < n)){
+			out.push_back(0);
+		}
+	}
+	return true;
+}
+
+bool deltaDecode(const uint8_t *in, size_t len, size_t n, std::vector<uint32_t> &samples){
+	const uint8_t *p = in;
+	const uint8_t *end = in + len;
+	uint32_t value;
+	samples.clear();
+	if((n == 0) || !readVarint(p, end, value)){
+		return false;
+	}
+	samples.reserve(n);
+	samples.push_back(unzigzag(value));
+	/* the sample before the first one is taken equal to it */
+	uint32_t prev = samples[0];
+	uint32_t prev2 = prev;
+	while(samples.size() < n){
+		if(p >= end){
+			return false;
+		}
+		size_t count = std::min<size_t>(CODEC_GROUP, n - samples.size());
+		bool order2 = *p & CODEC_GROUP_ORDER2;
+		uint8_t width = *p++ & ~CODEC_GROUP_ORDER2;
+		bool varint = (width == CODEC_GROUP_VARINT);
+		if(!varint && ((width > 32) || (static_cast<size_t>(end - p) < (count * width + 7) / 8))){
+			return false;
+		}
+		uint64_t acc = 0;
+		unsigned acc_bits = 0;
+		for(size_t i = 0; i < count; i++){
+			if(varint){
+				if(!readVarint(p, end, value)){
+					return false;
+				}
+			}else{
+				while(acc_bits < width){
+					acc |= static_cast<uint64_t>(*p++) << acc_bits;
+					acc_bits += 8;
+				}
+				value = static_cast<uint32_t>(acc & ((1ull << width) - 1));
+				acc >>= width;
+				acc_bits -= width;
+			}
+			uint32_t sample = (order2 ? 2 * prev - prev2 : prev) + unzigzag(value);
+			prev2 = prev;
+			prev = sample;
+			samples.push_back(sample);
+		}
+	}
+	return p == end;
+}
+
+Error decodeFrame(const uint8_t *frame, size_t n, Record &record){
+	std::vector<uint8_t> raw;
+	if(!cobsDecode(frame, n, raw)){
+		return Error::Cobs;
+	}
+	if((raw.size() < TELEMETRY_HEADER_LEN + TELEMETRY_CRC_LEN) || (raw.size() > TELEMETRY_MAX_RAW)){
+		return Error::Length;
+	}
+	size_t len = raw.size() - TELEMETRY_CRC_LEN;
+	if(crc16(raw.data(), len) != readLe<uint16_t>(&raw[len])){
+		return Error::Crc;
+	}
+	record = Record();
+	record.type = raw[0];
+	record.sequence = readLe<uint16_t>(&raw[1]);
+	record.payload.assign(raw.begin() + TELEMETRY_HEADER_LEN, raw.begin() + len);
+	const uint8_t *p = record.payload.data();
+	size_t size = record.payload.size();
+	switch(record.type){
+		case TELEMETRY_TEXT:
+			record.text.assign(record.payload.begin(), record.payload.end());
+			break;
+		case TELEMETRY_U16:
+		case TELEMETRY_I16:
+			if((size < 1) || ((size - 1) % 2)){
+				return Error::Length;
+			}
+			record.channel = p[0];
+			if(record.type == TELEMETRY_U16){
+				readValues<uint16_t>(p + 1, (size - 1) / 2, record.values);
+			}else{
+				readValues<int16_t>(p + 1, (size - 1) / 2, record.values);
+			}
+			break;
+		case TELEMETRY_I32:
+		case TELEMETRY_F32:
+			if((size < 1) || ((size - 1) % 4)){
+				return Error::Length;
+			}
+			record.channel = p[0];
+			if(record.type == TELEMETRY_I32){
+				readValues<int32_t>(p + 1, (size - 1) / 4, record.values);
+			}else{
+				readValues<float>(p + 1, (size - 1) / 4, record.values);
+			}
+			break;
+		case TELEMETRY_SAMPLES:
+			if((size < SAMPLES_HEADER_LEN) || ((size - SAMPLES_HEADER_LEN) % 2)){
+				return Error::Length;
+			}
+			record.channel = p[0];
+			record.timestamp = readLe<int64_t>(p + 1);
+			record.sample_frec = readLe<uint32_t>(p + 9);
+			readValues<uint16_t>(p + SAMPLES_HEADER_LEN, (size - SAMPLES_HEADER_LEN) / 2, record.values);
+			break;
+		case TELEMETRY_PACKED:{
+			if(size < PACKED_HEADER_LEN){
+				return Error::Length;
+			}
+			record.channel = p[0];
+			record.timestamp = readLe<int64_t>(p + 1);
+			record.sample_frec = readLe<uint32_t>(p + 9);
+			std::vector<uint32_t> samples;
+			if(!deltaDecode(p + PACKED_HEADER_LEN, size - PACKED_HEADER_LEN, readLe<uint16_t>(p + 13), samples)){
+				return Error::Length;
+			}
+			for(uint32_t sample : samples){
+				record.values.push_back(static_cast<uint16_t>(sample));
+			}
+			break;
+		}
+		case TELEMETRY_LOG_TEXT:
+		case TELEMETRY_LOG:
+			/* the deferred message stays in payload: it needs the format strings of the ELF (log_decoder) */
+			if(size < LOG_HEADER_LEN){
+				return Error::Length;
+			}
+			record.channel = p[0];
+			record.timestamp = readLe<uint32_t>(p + 1);
+			if(record.type == TELEMETRY_LOG_TEXT){
+				record.text.assign(record.payload.begin() + LOG_HEADER_LEN, record.payload.end());
+			}
+			break;
+		default:
+			/* user types: raw payload only */
+			break;
+	}
+	return Error::None;
+}
+
+std::string typeName(uint8_t type){
+	switch(type){
+		case TELEMETRY_TEXT: return "text";
+		case TELEMETRY_U16: return "u16";
+		case TELEMETRY_I16: return "i16";
+		case TELEMETRY_I32: return "i32";
+		case TELEMETRY_F32: return "f32";
+		case TELEMETRY_SAMPLES: return "samples";
+		case TELEMETRY_LOG_TEXT: return "log_text";
+		case TELEMETRY_LOG: return "log";
+		case TELEMETRY_PACKED: return "packed";
+		default:{
+			char name[16];
+			std::snprintf(name, sizeof(name), "%s_0x%02x", (type >= TELEMETRY_USER) ? "user" : "unknown", type);
+			return name;
+		}
+	}
+}
+
+Decoder::Decoder(Callback callback) : callback_(std::move(callback)){
+	frame_.reserve(TELEMETRY_MAX_FRAME);
+}
+
+void Decoder::feed(const uint8_t *data, size_t n){
+	stats_.bytes += n;
+	for(size_t i = 0; i < n; i++){
+		if(data[i] == 0){
+			frameEnd();
+			continue;
+		}
+		if(frame_.size() < TELEMETRY_MAX_FRAME){
+			frame_.push_back(data[i]);
+		}else{
+			overflow_ = true;
+		}
+	}
+}
+
+void Decoder::frameEnd(){
+	/* the first frame may have started before the stream was opened: if it is not valid its
+	 * bytes are only skipped, not counted as an error */
+	bool first = !synced_;
+	synced_ = true;
+	if(overflow_){
+		if(first){
+			stats_.skipped += frame_.size();
+		}else{
+			stats_.length_errors++;
+		}
+	}else if(!frame_.empty()){
+		Record record;
+		Error error = decodeFrame(frame_.data(), frame_.size(), record);
+		if(first && (error != Error::None)){
+			stats_.skipped += frame_.size();
+		}else{
+			switch(error){
+				case Error::None:
+					stats_.frames++;
+					if(have_sequence_ && (record.sequence != next_sequence_)){
+						stats_.lost += static_cast<uint16_t>(record.sequence - next_sequence_);
+					}
+					have_sequence_ = true;
+					next_sequence_ = record.sequence + 1;
+					if(callback_){
+						callback_(record);
+					}
+					break;
+				case Error::Cobs:
+					stats_.cobs_errors++;
+					break;
+				case Error::Length:
+					stats_.length_errors++;
+					break;
+				case Error::Crc:
+					stats_.crc_errors++;
+					break;
+			}
+		}
+	}
+	frame_.clear();
+	overflow_ = false;
+}
+
+} // namespace telemetry
+/*==================[end of file]============================================*/
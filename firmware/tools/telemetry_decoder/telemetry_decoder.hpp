@@ -0,0 +1,139 @@
+/**
+ * @file telemetry_decoder.hpp
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host decoder of the binary telemetry stream (drivers/utils/inc/telemetry.h).
+ *
+ * Bytes are fed as they arrive (from a serial port or a file): frames are split at the zero
+ * delimiters, COBS decoded, checked (length and CRC-16) and parsed into records. Sequence
+ * numbers are followed to count lost frames.
+ *
+ * @version 0.1
+ * @date 2024-07-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef TELEMETRY_DECODER_HPP
+#define TELEMETRY_DECODER_HPP
+
+/*==================[inclusions]=============================================*/
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+extern "C" {
+#include "telemetry.h"
+#include "delta_codec.h"
+}
+
+namespace telemetry {
+
+/*==================[typedef]================================================*/
+/**
+ * @brief Decoded record
+ */
+struct Record {
+	uint8_t type = 0;					/*!< Record type (telemetry_type_t or user type) */
+	uint16_t sequence = 0;				/*!< Frame number */
+	uint8_t channel = 0;				/*!< Channel (numeric records), level (log records) */
+	std::string text;					/*!< Text (TELEMETRY_TEXT, TELEMETRY_LOG_TEXT) */
+	std::vector<double> values;			/*!< Values (numeric records) */
+	int64_t timestamp = 0;				/*!< Time of the first sample, us (TELEMETRY_SAMPLES, TELEMETRY_PACKED), or of the message, ms (log records) */
+	uint32_t sample_frec = 0;			/*!< Sample rate, Hz (TELEMETRY_SAMPLES, TELEMETRY_PACKED) */
+	std::vector<uint8_t> payload;		/*!< Raw payload */
+};
+
+/**
+ * @brief Frame errors
+ */
+enum class Error {
+	None,
+	Cobs,				/*!< Not valid COBS */
+	Length,				/*!< Too short or too long, or payload size not matching its type */
+	Crc,				/*!< CRC mismatch */
+};
+
+/**
+ * @brief Stream counters
+ */
+struct Stats {
+	uint64_t bytes = 0;				/*!< Bytes received */
+	uint64_t skipped = 0;			/*!< Bytes of a first frame not valid (stream joined midway) */
+	uint64_t frames = 0;			/*!< Valid frames */
+	uint64_t cobs_errors = 0;
+	uint64_t length_errors = 0;
+	uint64_t crc_errors = 0;
+	uint64_t lost = 0;				/*!< Frames missing according to the sequence numbers */
+	uint64_t errors() const { return cobs_errors + length_errors + crc_errors; }
+};
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief CRC-16/CCITT-FALSE, as Crc16() in the firmware
+ */
+uint16_t crc16(const uint8_t *data, size_t n, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief COBS decoding of a frame (without delimiter)
+ *
+ * @return false if the input is not valid COBS
+ */
+bool cobsDecode(const uint8_t *in, size_t n, std::vector<uint8_t> &out);
+
+/**
+ * @brief Decoding of a block of samples compressed with the delta codec (drivers/utils/inc/delta_codec.h)
+ *
+ * @param in Encoded block
+ * @param len Encoded block length
+ * @param n Number of samples of the block
+ * @param samples Decoded samples (modulo 2^32: cast to the type that was encoded)
+ * @return false if the block is not valid
+ */
+bool deltaDecode(const uint8_t *in, size_t len, size_t n, std::vector<uint32_t> &samples);
+
+/**
+ * @brief Decode and parse one frame (without delimiter)
+ */
+Error decodeFrame(const uint8_t *frame, size_t n, Record &record);
+
+/**
+ * @brief Record type name ("text", "u16", ..., "log", "user_0x80")
+ */
+std::string typeName(uint8_t type);
+
+/**
+ * @brief Stream decoder
+ */
+class Decoder {
+public:
+	using Callback = std::function<void(const Record &)>;
+
+	/**
+	 * @param callback Called for every valid record
+	 */
+	explicit Decoder(Callback callback);
+
+	/**
+	 * @brief Feed received bytes (any amount, frames can be split between calls)
+	 */
+	void feed(const uint8_t *data, size_t n);
+
+	const Stats &stats() const { return stats_; }
+
+private:
+	void frameEnd();
+
+	Callback callback_;
+	Stats stats_;
+	std::vector<uint8_t> frame_;
+	bool synced_ = false;				/*!< A delimiter was seen */
+	bool overflow_ = false;				/*!< Current frame longer than TELEMETRY_MAX_FRAME */
+	bool have_sequence_ = false;
+	uint16_t next_sequence_ = 0;
+};
+
+} // namespace telemetry
+
+#endif /* TELEMETRY_DECODER_HPP */
+/*==================[end of file]============================================*/
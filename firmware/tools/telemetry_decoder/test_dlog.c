@@ -0,0 +1,125 @@
+/**
+ * @file test_dlog.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Firmware side of the deferred log round trip test (dlog_round_trip.cmake): DLOG
+ * messages of every argument type go through logger.c, telemetry.c and uart_mcu.c, on the
+ * simulated IDF of ../host_tests/stubs, and what the UART sends is saved with the lines
+ * log_decoder must print for it, given this program as the ELF (its .logfmt section).
+ *
+ * Usage: test_dlog capture.bin expected.txt
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "idf_sim.h"
+#include "dlog.h"
+/*==================[macros and definitions]=================================*/
+#define TIME_MS		1234		/*!< Time of every message ("[1.234]") */
+#define MAX_EXPECTED	16
+
+/*==================[internal data definition]===============================*/
+static char expected[LOGGER_LEVELS][MAX_EXPECTED][LOGGER_MSG_LEN + 32];
+static uint32_t n_expected[LOGGER_LEVELS];
+/** Format of the truncated string message, encoded here with its id known */
+static const char long_format[] __attribute__((section(DLOG_SECTION), used)) = "largo %s";
+
+/*==================[internal functions definition]==========================*/
+static void expect(logger_level_t level, const char *text){
+	snprintf(expected[level][n_expected[level]++], sizeof(expected[0][0]), "[%u.%03u] %c: %s\n",
+		TIME_MS / 1000, TIME_MS % 1000, "EWID"[level], text);
+}
+
+static void log_messages(void){
+	uint16_t mv = 2475;
+	float t = 37.25f;
+	const char *name = "termopila";
+	int32_t neg = -42;
+	uint8_t small = 200;
+	long long big = -1234567890123LL;
+	unsigned long long ubig = 18446744073709551615ULL;
+	DLOG_I("adc %u mV, t = %.2f C", mv, t);
+	expect(LOGGER_INFO, "adc 2475 mV, t = 37.25 C");
+	DLOG_W("sensor %s: %d (0x%08x) %hhu", name, neg, neg, small);
+	expect(LOGGER_WARN, "sensor termopila: -42 (0xffffffd6) 200");
+	DLOG_E("sin argumentos");
+	expect(LOGGER_ERROR, "sin argumentos");
+	DLOG_D("64: %lld %llu %7.1D%% [%-6s] %c %b %p", big, ubig, 2534, "ab", 'Z', 5, (void *)0x3fc80000);
+	expect(LOGGER_DEBUG, "64: -1234567890123 18446744073709551615   253.4% [ab    ] Z 101 0x3fc80000");
+	DLOG_I("%x %5d|%-5u|%05X %o %c%c", 0xbeefu, -7, 7u, 0xab, 8, 'o', 'k');
+	expect(LOGGER_INFO, "beef    -7|7    |000AB 10 ok");
+	DLOG_W("%e %g %s", 1.5e-3f, -0.25, "");
+	expect(LOGGER_WARN, "1.500000e-03 -0.25 ");
+	/* a string longer than the message: truncated to fill it */
+	char text[LOGGER_MSG_LEN * 2] = {0};
+	memset(text, 'x', sizeof(text) - 1);
+	uint8_t buf[LOGGER_MSG_LEN + 1];
+	uint8_t *p = VarintPut32(buf, (uint32_t)(uintptr_t)long_format);
+	uint32_t kept = LOGGER_MSG_LEN - (p - buf) - 1;
+	p = DLOG_PUT(p, buf + LOGGER_MSG_LEN, (const char *)text);
+	CHECK(p == buf + LOGGER_MSG_LEN);
+	CHECK(LoggerWriteDeferred(LOGGER_INFO, buf, p - buf));
+	char line[LOGGER_MSG_LEN + 8] = "largo ";
+	memset(line + 6, 'x', kept);
+	expect(LOGGER_INFO, line);
+	/* other arguments that do not fit (10 bytes each): the message is dropped, and counted */
+	long long huge = -INT64_MAX;
+	DLOG_I("%lld %lld %lld %lld %lld %lld %lld %lld", huge, huge, huge, huge, huge, huge, huge, huge);
+	/* text messages in between */
+	LOGGER_I("texto %d", 7);
+	expect(LOGGER_INFO, "texto 7");
+}
+
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	static telemetry_t telemetry;
+	if(argc != 3){
+		fprintf(stderr, "usage: %s capture.bin expected.txt\n", argv[0]);
+		return 2;
+	}
+	SimAdvanceMs(TIME_MS);
+	serial_config_t port = {.port = UART_PC, .baud_rate = 921600, .func_p = UART_NO_INT, .tx_buffer_size = 4096};
+	UartInit(&port);
+	TelemetryInit(&telemetry, UART_PC, false);
+	logger_config_t config = {.port = UART_PC, .level = LOGGER_DEBUG, .telemetry = &telemetry};
+	CHECK(LoggerInit(&config));
+	log_messages();
+	logger_stats_t stats;
+	LoggerGetStats(&stats);
+	CHECK(stats.dropped[LOGGER_INFO] == 1);
+	CHECK(stats.written[LOGGER_INFO] == n_expected[LOGGER_INFO]);
+	/* the drain task sends them all, by priority, and then reports the drop */
+	SimRunTasks();
+	LoggerGetStats(&stats);
+	CHECK(stats.sent == n_expected[LOGGER_ERROR] + n_expected[LOGGER_WARN] + n_expected[LOGGER_INFO] + n_expected[LOGGER_DEBUG]);
+	expect(LOGGER_WARN, "logger dropped E0 W0 I1 D0");
+	CHECK(UartTxFlush(UART_PC, 100));
+	const uint8_t *line;
+	uint32_t n = SimUartLine(UART_NUM_0, &line);
+	CHECK((n > 0) && (n <= SIM_LINE_CAPTURE));
+	FILE *capture = fopen(argv[1], "wb");
+	FILE *text = fopen(argv[2], "w");
+	if((capture == NULL) || (text == NULL)){
+		perror("test_dlog");
+		return 2;
+	}
+	fwrite(line, 1, n, capture);
+	for(int level = 0; level < LOGGER_LEVELS; level++){
+		/* the report is the last line, after every queue */
+		for(uint32_t i = 0; i < n_expected[level] - (level == LOGGER_WARN); i++){
+			fputs(expected[level][i], text);
+		}
+	}
+	fputs(expected[LOGGER_WARN][n_expected[LOGGER_WARN] - 1], text);
+	fclose(capture);
+	fclose(text);
+	return TEST_END("dlog");
+}
+/*==================[end of file]============================================*/
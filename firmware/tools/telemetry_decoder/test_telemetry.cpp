@@ -0,0 +1,345 @@
+/**
+ * @file test_telemetry.cpp
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Round trip test: frames built by the firmware (drivers/utils/src/telemetry.c, compiled
+ * for the PC with the UART replaced by a buffer) are decoded with telemetry::Decoder.
+ *
+ * Checks that every record comes back unchanged (payloads with runs of zeros and long non zero
+ * blocks, the COBS corner cases), that packed samples (delta_codec.c) are decoded unchanged by
+ * telemetry::deltaDecode, that corrupted frames are detected and not delivered, and that dropped
+ * frames are counted from the sequence numbers (also across their wrap around).
+ *
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "telemetry_decoder.hpp"
+
+/*==================[macros and definitions]=================================*/
+namespace {
+
+std::vector<uint8_t> uart;				/* bytes "sent" by the firmware */
+uint32_t uart_writes = 0;
+uint32_t drop_every = 0;				/* frames not written (lost), 0: none */
+uint32_t corrupt_every = 0;				/* frames with one byte changed, 0: none */
+uint32_t failures = 0;
+
+#define CHECK(cond) do {																\
+	if(!(cond)){																		\
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);	\
+		failures++;																		\
+	}																					\
+} while(0)
+
+uint32_t uartWrite(const void *data, uint32_t n){
+	uart_writes++;
+	if(drop_every && (uart_writes % drop_every == 0)){
+		/* reported as sent: lost on the way */
+		return n;
+	}
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	size_t start = uart.size();
+	uart.insert(uart.end(), bytes, bytes + n);
+	if(corrupt_every && (uart_writes % corrupt_every == 0)){
+		/* one byte of the frame changed, never to zero (that would split it in two frames) */
+		uint8_t &b = uart[start + (uart_writes * 7) % (n - 1)];
+		b ^= (b == 0x10) ? 0x01 : 0x10;
+	}
+	return n;
+}
+
+struct Sent {
+	uint8_t type;
+	std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief Feeds the captured bytes to a decoder in chunks of random length
+ */
+std::vector<telemetry::Record> decode(telemetry::Stats &stats, std::mt19937 &rng){
+	std::vector<telemetry::Record> records;
+	telemetry::Decoder decoder([&](const telemetry::Record &r){ records.push_back(r); });
+	size_t done = 0;
+	while(done < uart.size()){
+		size_t n = std::min<size_t>(uart.size() - done, 1 + rng() % 300);
+		decoder.feed(&uart[done], n);
+		done += n;
+	}
+	stats = decoder.stats();
+	return records;
+}
+
+/**
+ * @brief Payloads of every length with runs of zeros, long non zero blocks, all zeros and all 0xFF
+ */
+std::vector<uint8_t> makePayload(uint32_t k, std::mt19937 &rng){
+	std::vector<uint8_t> payload(k % (TELEMETRY_MAX_PAYLOAD + 1));
+	switch(k % 4){
+		case 0:
+			break;
+		case 1:
+			std::fill(payload.begin(), payload.end(), 0xFF);
+			break;
+		case 2:
+			for(auto &b : payload){
+				b = (rng() % 5) ? 0 : rng();
+			}
+			break;
+		default:
+			for(auto &b : payload){
+				b = 1 + rng() % 255;
+			}
+			break;
+	}
+	return payload;
+}
+
+/**
+ * @brief COBS of the firmware against the decoder's, around the 254 bytes blocks
+ */
+void testCobs(std::mt19937 &rng){
+	const size_t lengths[] = {0, 1, 253, 254, 255, 256, 507, 508, 509, 1000};
+	for(size_t len : lengths){
+		for(int pattern = 0; pattern < 3; pattern++){
+			std::vector<uint8_t> in(len);
+			for(size_t i = 0; i < len; i++){
+				in[i] = (pattern == 0) ? 1 + rng() % 255 : (pattern == 1) ? 0 : ((i % 254 == 253) ? 0 : 1 + rng() % 255);
+			}
+			std::vector<uint8_t> encoded(COBS_MAX_ENCODED(len));
+			uint32_t n = CobsEncode(in.data(), len, encoded.data());
+			CHECK(n <= COBS_MAX_ENCODED(len));
+			CHECK(std::memchr(encoded.data(), 0, n) == nullptr);
+			std::vector<uint8_t> out;
+			CHECK(telemetry::cobsDecode(encoded.data(), n, out));
+			CHECK(out == in);
+			std::vector<uint8_t> out2(n);
+			CHECK(CobsDecode(encoded.data(), n, out2.data()) == len);
+			CHECK(std::equal(in.begin(), in.end(), out2.begin()));
+		}
+	}
+	/* code byte pointing past the end */
+	const uint8_t bad[] = {0x05, 0x01, 0x02};
+	std::vector<uint8_t> out;
+	CHECK(!telemetry::cobsDecode(bad, sizeof(bad), out));
+}
+
+/**
+ * @brief Every record type, decoded without errors and unchanged
+ */
+void testRoundTrip(std::mt19937 &rng){
+	telemetry_t tm;
+	TelemetryInit(&tm, UART_PC, false);
+	uart.assign({0x12, 0x34, 0x56, 0x00});	/* joined midway: skipped, not an error */
+	std::vector<Sent> sent;
+	for(uint32_t k = 0; k < 2000; k++){
+		std::vector<uint8_t> payload = makePayload(k, rng);
+		uint8_t type = TELEMETRY_USER + k % 16;
+		CHECK(TelemetrySend(&tm, type, payload.data(), payload.size()));
+		sent.push_back({type, payload});
+	}
+	CHECK(!TelemetrySend(&tm, TELEMETRY_USER, uart.data(), TELEMETRY_MAX_PAYLOAD + 1));
+	CHECK(TelemetrySendText(&tm, "hola mundo"));
+	int16_t i16[] = {-32768, -1, 0, 32767};
+	CHECK(TelemetrySendValues(&tm, TELEMETRY_I16, 2, i16, 4));
+	float f32[] = {3.25f, -1e-3f, 0.0f};
+	CHECK(TelemetrySendValues(&tm, TELEMETRY_F32, 3, f32, 3));
+	uint16_t samples[113];
+	for(int i = 0; i < 113; i++){
+		samples[i] = (i % 3) ? (i * 37) & 0xFFF : 0;
+	}
+	CHECK(TelemetrySendSamples(&tm, 1, 123456789012LL, 1000, samples, 113));
+	CHECK(!TelemetrySendSamples(&tm, 1, 0, 1000, samples, 114));
+
+	telemetry::Stats stats;
+	std::vector<telemetry::Record> records = decode(stats, rng);
+	CHECK(stats.skipped == 3);
+	CHECK(stats.errors() == 0);
+	CHECK(stats.lost == 0);
+	CHECK(records.size() == sent.size() + 4);
+	for(size_t i = 0; (i < sent.size()) && (i < records.size()); i++){
+		CHECK(records[i].type == sent[i].type);
+		CHECK(records[i].sequence == i);
+		CHECK(records[i].payload == sent[i].payload);
+	}
+	if(records.size() == sent.size() + 4){
+		const telemetry::Record *r = &records[sent.size()];
+		CHECK((r[0].type == TELEMETRY_TEXT) && (r[0].text == "hola mundo"));
+		CHECK((r[1].type == TELEMETRY_I16) && (r[1].channel == 2) && (r[1].values == std::vector<double>({-32768, -1, 0, 32767})));
+		CHECK((r[2].type == TELEMETRY_F32) && (r[2].channel == 3) && (r[2].values == std::vector<double>({3.25f, -1e-3f, 0.0f})));
+		CHECK((r[3].type == TELEMETRY_SAMPLES) && (r[3].timestamp == 123456789012LL) && (r[3].sample_frec == 1000));
+		CHECK(r[3].values == std::vector<double>(samples, samples + 113));
+	}
+	CHECK(tm.frames == sent.size() + 4);
+	CHECK(tm.dropped == 0);
+}
+
+/**
+ * @brief Blocks of the firmware's delta codec, every mode, decoded by telemetry::deltaDecode
+ */
+void testDeltaCodec(std::mt19937 &rng){
+	const size_t n = 1000;
+	std::vector<int32_t> x(n);
+	for(int signal = 0; signal < 3; signal++){
+		for(size_t i = 0; i < n; i++){
+			switch(signal){
+				case 0: x[i] = static_cast<int32_t>(2048 + 1500 * std::sin(i / 30.0)); break;
+				case 1: x[i] = (i % 2) ? INT32_MIN : INT32_MAX - static_cast<int32_t>(rng() % 5); break;
+				default: x[i] = static_cast<int32_t>(rng() >> (rng() % 32)); break;
+			}
+		}
+		for(codec_mode_t mode : {CODEC_AUTO, CODEC_PACKED, CODEC_VARINT}){
+			for(size_t len : {size_t(1), size_t(2), size_t(CODEC_GROUP), size_t(CODEC_GROUP + 1), n}){
+				std::vector<uint8_t> block(CODEC_MAX_ENCODED(len));
+				uint32_t size;
+				CHECK(CodecEncodeI32(x.data(), len, mode, block.data(), block.size(), &size) == len);
+				std::vector<uint32_t> samples;
+				CHECK(telemetry::deltaDecode(block.data(), size, len, samples));
+				CHECK(std::equal(samples.begin(), samples.end(), x.begin(),
+					[](uint32_t a, int32_t b){ return static_cast<int32_t>(a) == b; }) && (samples.size() == len));
+				CHECK(!telemetry::deltaDecode(block.data(), size - 1, len, samples));
+			}
+		}
+	}
+}
+
+/**
+ * @brief TelemetrySendPacked(): records of whole groups, each with the time of its first sample
+ */
+void testPacked(std::mt19937 &rng){
+	telemetry_t tm;
+	TelemetryInit(&tm, UART_PC, false);
+	uart.clear();
+	const uint32_t frec = 500;
+	const int64_t start = 1000000;
+	std::vector<uint16_t> samples(10000);
+	for(size_t i = 0; i < samples.size(); i++){
+		double t = static_cast<double>(i) / frec;
+		double phase = std::fmod(t, 0.8);
+		samples[i] = static_cast<uint16_t>(2048 + 60 * std::sin(2 * M_PI * 1.2 * t)
+			+ 900 * std::exp(-std::pow((phase - 0.3) / 0.012, 2)) + rng() % 7);
+	}
+	samples[5000] = 0xFFFF;
+	samples[5001] = 0;
+	CHECK(TelemetrySendPacked(&tm, 3, start, frec, samples.data(), samples.size()));
+	telemetry::Stats stats;
+	std::vector<telemetry::Record> records = decode(stats, rng);
+	CHECK(stats.errors() == 0);
+	CHECK(stats.lost == 0);
+	std::vector<double> decoded;
+	for(const auto &r : records){
+		CHECK((r.type == TELEMETRY_PACKED) && (r.channel == 3) && (r.sample_frec == frec));
+		CHECK(r.timestamp == start + static_cast<int64_t>(decoded.size()) * 1000000 / frec);
+		decoded.insert(decoded.end(), r.values.begin(), r.values.end());
+	}
+	CHECK(decoded == std::vector<double>(samples.begin(), samples.end()));
+	/* less than half the bytes of TELEMETRY_SAMPLES records */
+	size_t packed_bytes = uart.size();
+	uart.clear();
+	for(size_t i = 0; i < samples.size(); i += 113){
+		TelemetrySendSamples(&tm, 3, start, frec, &samples[i], std::min<size_t>(113, samples.size() - i));
+	}
+	CHECK(packed_bytes * 2 < uart.size());
+}
+
+/**
+ * @brief Corrupted frames: counted as errors (CRC, COBS or length) and not delivered
+ */
+void testCorruption(std::mt19937 &rng){
+	telemetry_t tm;
+	TelemetryInit(&tm, UART_PC, false);
+	uart.clear();
+	uart_writes = 0;
+	corrupt_every = 7;
+	const uint32_t frames = 3000;
+	for(uint32_t k = 0; k < frames; k++){
+		std::vector<uint8_t> payload = makePayload(k * 13, rng);
+		TelemetrySend(&tm, TELEMETRY_USER, payload.data(), payload.size());
+	}
+	corrupt_every = 0;
+	uint32_t corrupted = frames / 7;
+	telemetry::Stats stats;
+	std::vector<telemetry::Record> records = decode(stats, rng);
+	CHECK(stats.errors() == corrupted);
+	CHECK(stats.crc_errors > 0);
+	CHECK(stats.frames == frames - corrupted);
+	CHECK(stats.lost == corrupted);
+	CHECK(records.size() == frames - corrupted);
+	for(const auto &r : records){
+		CHECK((r.sequence + 1) % 7 != 0);
+	}
+}
+
+/**
+ * @brief Frames lost on the way: counted from the sequence numbers, also when they wrap around
+ */
+void testSequenceGaps(std::mt19937 &rng){
+	telemetry_t tm;
+	TelemetryInit(&tm, UART_PC, false);
+	tm.sequence = 65536 - 1000;
+	uart.clear();
+	uart_writes = 0;
+	drop_every = 10;
+	const uint32_t frames = 5000;
+	for(uint32_t k = 0; k < frames; k++){
+		uint32_t value = k;
+		TelemetrySendValues(&tm, TELEMETRY_I32, 0, &value, 1);
+	}
+	/* a burst longer than anything sent meanwhile */
+	drop_every = 1;
+	for(uint32_t k = 0; k < 300; k++){
+		TelemetrySendText(&tm, "perdido");
+	}
+	drop_every = 0;
+	TelemetrySendText(&tm, "fin");
+	telemetry::Stats stats;
+	std::vector<telemetry::Record> records = decode(stats, rng);
+	CHECK(stats.errors() == 0);
+	CHECK(stats.frames == frames - frames / 10 + 1);
+	/* the first frame is not dropped, so every loss is between two received frames */
+	CHECK(stats.lost == frames / 10 + 300);
+	CHECK(!records.empty() && (records.back().text == "fin"));
+	CHECK(tm.sequence == static_cast<uint16_t>(65536 - 1000 + frames + 301));
+}
+
+} // namespace
+
+/*==================[external functions definition]==========================*/
+/* UART of the firmware (uart_mcu.h) */
+extern "C" uint32_t UartTxFree(uart_mcu_port_t port){
+	return TELEMETRY_MAX_FRAME;
+}
+
+extern "C" uint32_t UartWriteNonBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+	return uartWrite(data, nbytes);
+}
+
+extern "C" uint32_t UartWriteBlocking(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+	return uartWrite(data, nbytes);
+}
+
+int main(){
+	std::mt19937 rng(1234);
+	testCobs(rng);
+	testRoundTrip(rng);
+	testDeltaCodec(rng);
+	testPacked(rng);
+	testCorruption(rng);
+	testSequenceGaps(rng);
+	if(failures){
+		std::fprintf(stderr, "%u checks failed\n", failures);
+		return 1;
+	}
+	std::printf("telemetry round trip: ok\n");
+	return 0;
+}
+/*==================[end of file]============================================*/